@@ -0,0 +1,189 @@
+// Aes128.cpp
+#include "Aes128.h"
+#include "Endian.h"
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__i386__)
+#define PPC_AES_NI 1
+#include <wmmintrin.h>
+#include <emmintrin.h>
+// MSVC deja usar cualquier intrínseco sin opciones de compilación; GCC/Clang lo piden por función
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define AES_NI
+#else
+#define AES_NI __attribute__((target("aes,sse2")))
+#endif
+#endif
+
+namespace {
+
+// S-box, su inversa y las tablas T del descifrado, generadas una vez
+struct Tables {
+	uint8_t sbox[256];
+	uint8_t inv[256];
+	uint32_t td[4][256]; // td[k][x] = InvMixColumns de InvS[x] en la fila k, columnas empaquetadas big-endian
+
+	Tables() {
+		// Inverso multiplicativo en GF(2^8) recorriendo las potencias de 3, y transformación afín
+		uint8_t p = 1, q = 1;
+		do {
+			p = uint8_t(p ^ (p << 1) ^ (p & 0x80 ? 0x1B : 0));
+			q ^= q << 1;
+			q ^= q << 2;
+			q ^= q << 4;
+			if (q & 0x80) q ^= 0x09;
+			const uint8_t x = uint8_t(q ^ Rotl8(q, 1) ^ Rotl8(q, 2) ^ Rotl8(q, 3) ^ Rotl8(q, 4));
+			sbox[p] = x ^ 0x63;
+		} while (p != 1);
+		sbox[0] = 0x63;
+		for (int i = 0; i < 256; ++i) inv[sbox[i]] = uint8_t(i);
+
+		for (int x = 0; x < 256; ++x) {
+			const uint8_t y = inv[x];
+			const uint32_t t = uint32_t(Mul(y, 0x0E)) << 24 | uint32_t(Mul(y, 0x09)) << 16 | uint32_t(Mul(y, 0x0D)) << 8 | Mul(y, 0x0B);
+			td[0][x] = t;
+			td[1][x] = Rotr(t, 8);
+			td[2][x] = Rotr(t, 16);
+			td[3][x] = Rotr(t, 24);
+		}
+	}
+
+	static uint8_t Rotl8(uint8_t x, int n) { return uint8_t((x << n) | (x >> (8 - n))); }
+	static uint32_t Rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+	static uint8_t Mul(uint8_t a, uint8_t b) {
+		uint8_t r = 0;
+		for (; b; b >>= 1) {
+			if (b & 1) r ^= a;
+			a = uint8_t((a << 1) ^ (a & 0x80 ? 0x1B : 0));
+		}
+		return r;
+	}
+};
+
+const Tables& T() {
+	static const Tables tables;
+	return tables;
+}
+
+// InvMixColumns de una columna: td sobre S[x] deja sólo la multiplicación
+uint32_t InvMixColumn(const Tables& t, uint32_t w) {
+	return t.td[0][t.sbox[w >> 24]] ^ t.td[1][t.sbox[(w >> 16) & 0xFF]] ^ t.td[2][t.sbox[(w >> 8) & 0xFF]] ^ t.td[3][t.sbox[w & 0xFF]];
+}
+
+void DecryptTables(const uint8_t (&rk)[11][16], const uint8_t in[16], uint8_t out[16]) {
+	const Tables& t = T();
+	uint32_t s[4], n[4];
+	for (int c = 0; c < 4; ++c) s[c] = LoadBE32(in + 4 * c) ^ LoadBE32(rk[0] + 4 * c);
+	for (int r = 1; r < 10; ++r) {
+		// InvShiftRows: la fila k de la columna c viene de la columna c - k
+		for (int c = 0; c < 4; ++c)
+			n[c] = t.td[0][s[c] >> 24] ^ t.td[1][(s[(c + 3) & 3] >> 16) & 0xFF]
+				^ t.td[2][(s[(c + 2) & 3] >> 8) & 0xFF] ^ t.td[3][s[(c + 1) & 3] & 0xFF] ^ LoadBE32(rk[r] + 4 * c);
+		std::memcpy(s, n, sizeof(s));
+	}
+	for (int c = 0; c < 4; ++c) {
+		const uint32_t w = uint32_t(t.inv[s[c] >> 24]) << 24 | uint32_t(t.inv[(s[(c + 3) & 3] >> 16) & 0xFF]) << 16
+			| uint32_t(t.inv[(s[(c + 2) & 3] >> 8) & 0xFF]) << 8 | t.inv[s[(c + 1) & 3] & 0xFF];
+		StoreBE32(out + 4 * c, w ^ LoadBE32(rk[10] + 4 * c));
+	}
+}
+
+#if defined(PPC_AES_NI)
+AES_NI void DecryptCBCNI(const uint8_t (&rk)[11][16], const uint8_t* in, uint8_t* out, size_t size, uint8_t iv[16]) {
+	__m128i k[11];
+	for (int r = 0; r < 11; ++r) k[r] = _mm_load_si128(reinterpret_cast<const __m128i*>(rk[r]));
+	__m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+	// CBC descifra en paralelo: cuatro bloques a la vez para llenar el pipeline de aesdec
+	size_t i = 0;
+	for (; i + 64 <= size; i += 64) {
+		__m128i c[4], x[4];
+		for (int j = 0; j < 4; ++j) {
+			c[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 16 * j));
+			x[j] = _mm_xor_si128(c[j], k[0]);
+		}
+		for (int r = 1; r < 10; ++r)
+			for (int j = 0; j < 4; ++j) x[j] = _mm_aesdec_si128(x[j], k[r]);
+		for (int j = 0; j < 4; ++j) {
+			x[j] = _mm_xor_si128(_mm_aesdeclast_si128(x[j], k[10]), j ? c[j - 1] : prev);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 16 * j), x[j]);
+		}
+		prev = c[3];
+	}
+	for (; i < size; i += 16) {
+		const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		__m128i x = _mm_xor_si128(c, k[0]);
+		for (int r = 1; r < 10; ++r) x = _mm_aesdec_si128(x, k[r]);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(_mm_aesdeclast_si128(x, k[10]), prev));
+		prev = c;
+	}
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(iv), prev);
+}
+
+bool DetectAesNI() {
+#if defined(_MSC_VER) && !defined(__clang__)
+	int r[4];
+	__cpuid(r, 1);
+	return (r[2] >> 25) & 1;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("aes");
+#endif
+}
+#endif
+
+} // namespace
+
+bool Aes128Decryptor::HasHardwareSupport() {
+#if defined(PPC_AES_NI)
+	static const bool supported = DetectAesNI();
+	return supported;
+#else
+	return false;
+#endif
+}
+
+Aes128Decryptor::Aes128Decryptor(const uint8_t key[16]) : hardware_(HasHardwareSupport()) {
+	// Expansión de la clave de cifrado: 44 palabras
+	const Tables& t = T();
+	uint32_t w[44];
+	for (int i = 0; i < 4; ++i) w[i] = LoadBE32(key + 4 * i);
+	uint8_t rcon = 1;
+	for (int i = 4; i < 44; ++i) {
+		uint32_t x = w[i - 1];
+		if (i % 4 == 0) {
+			x = (x << 8) | (x >> 24);
+			x = uint32_t(t.sbox[x >> 24]) << 24 | uint32_t(t.sbox[(x >> 16) & 0xFF]) << 16 | uint32_t(t.sbox[(x >> 8) & 0xFF]) << 8 | t.sbox[x & 0xFF];
+			x ^= uint32_t(rcon) << 24;
+			rcon = uint8_t((rcon << 1) ^ (rcon & 0x80 ? 0x1B : 0));
+		}
+		w[i] = w[i - 4] ^ x;
+	}
+	// Orden inverso; las rondas intermedias con InvMixColumns (lo mismo que aesimc)
+	for (int r = 0; r < 11; ++r)
+		for (int c = 0; c < 4; ++c) {
+			const uint32_t k = w[4 * (10 - r) + c];
+			StoreBE32(roundKeys_[r] + 4 * c, (r == 0 || r == 10) ? k : InvMixColumn(t, k));
+		}
+}
+
+void Aes128Decryptor::DecryptBlock(const uint8_t in[16], uint8_t out[16]) const {
+	uint8_t iv[16] = {};
+	DecryptCBC(in, out, 16, iv);
+}
+
+void Aes128Decryptor::DecryptCBC(const uint8_t* in, uint8_t* out, size_t size, uint8_t iv[16]) const {
+#if defined(PPC_AES_NI)
+	if (hardware_) {
+		DecryptCBCNI(roundKeys_, in, out, size, iv);
+		return;
+	}
+#endif
+	uint8_t block[16], cipher[16];
+	for (size_t i = 0; i < size; i += 16) {
+		std::memcpy(cipher, in + i, 16);
+		DecryptTables(roundKeys_, cipher, block);
+		for (int j = 0; j < 16; ++j) out[i + j] = block[j] ^ iv[j];
+		std::memcpy(iv, cipher, 16);
+	}
+}
@@ -0,0 +1,27 @@
+// Aes128.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// AES-128 (FIPS-197), sólo descifrado: es lo que piden las imágenes XEX2 cifradas (la clave de la
+// imagen va cifrada en ECB con la clave de consola y la imagen en CBC con IV a cero).
+// Usa AES-NI si el host lo tiene; si no, tablas T de 32 bits.
+class Aes128Decryptor {
+public:
+    explicit Aes128Decryptor(const uint8_t key[16]);
+
+    // Un bloque, ECB. in y out pueden ser el mismo buffer.
+    void DecryptBlock(const uint8_t in[16], uint8_t out[16]) const;
+    // CBC sobre size bytes (múltiplo de 16). iv entra con el bloque cifrado anterior (o ceros) y sale
+    // con el último bloque cifrado, para seguir el mismo flujo en la siguiente llamada.
+    // in y out pueden ser el mismo buffer.
+    void DecryptCBC(const uint8_t* in, uint8_t* out, size_t size, uint8_t iv[16]) const;
+
+    static bool HasHardwareSupport();
+
+private:
+    // Claves de ronda del "equivalent inverse cipher": [0] = última de cifrado, [1..9] con
+    // InvMixColumns aplicado, [10] = la clave original. Bytes en el orden del estado.
+    alignas(16) uint8_t roundKeys_[11][16];
+    bool hardware_;
+};
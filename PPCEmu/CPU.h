@@ -3,11 +3,18 @@
 #define CPU_H
 
 #include "MMU.h"
+#include "VectorRegister.h"
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include "Log.h"
-#include <mutex>
 #include "Display.h"
+#include "PPCBlockCache.h"
+#include "PPCJit.h"
+#include "CycleScheduler.h"
+
+class ReplayLog;
 
 union CR_t {
     uint32_t value;
@@ -187,21 +194,6 @@ union PVRegister {
 #endif
 };
 
-// Segment Lookaside Buffer Entry
-struct SLBEntry {
-    u8 V;
-    u8 LP; // Large Page selector
-    u8 C;
-    u8 L;
-    u8 N;
-    u8 Kp;
-    u8 Ks;
-    u64 VSID;
-    u64 ESID;
-    u64 vsidReg;
-    u64 esidReg;
-};
-
 // Traslation lookaside buffer.
 // Holds a cache of the recently used PTE's.
 
@@ -509,82 +501,265 @@ class CPU {
 public:
     CPU(MMU* mmu, Display* display);
     CPU(MMU* mmu);      
+    ~CPU();
 
     void SetDisplay(Display* disp) { this->display = disp; } // opcional si quers asignarlo luego
 
-    void Reset(uint32_t start_pc, std::array<uint32_t, 32> GPR);
+    void Reset(uint32_t start_pc, std::array<uint64_t, 32> GPR);
     void Reset();
     void Step();
+    // Ejecuta un bloque bsico cacheado, devuelve instrucciones ejecutadas. Con limit, como mucho
+    // limit instrucciones (el resto del bloque queda para la siguiente llamada)
+    uint32_t RunBlock(uint32_t limit = UINT32_MAX);
+    void SetJitMode(JitMode mode) { jitMode = mode; }
+    JitMode GetJitMode() const { return jitMode; }
     uint32_t FetchInstruction();
     void DumpRegisters() const;
     bool IsRunning() const { return running; }
+    // Hilo de hardware (0..5 = ncleo * 2 + SMT); es lo que devuelve mfspr PIR
+    void SetThreadId(uint32_t id) { threadId = id; }
+    uint32_t GetThreadId() const { return threadId; }
+    // Lnea de interrupcin externa (IIC). Se puede llamar desde cualquier hilo; la CPU la
+    // atiende entre bloques, con MSR[EE] activo, saltando al vector 0x500.
+    void RaiseExternalInterrupt() { pendingEvents.fetch_or(EVENT_EXTERNAL_INTERRUPT, std::memory_order_release); }
+
+    // Canal de control para depurador/UI, sin locks: se puede llamar desde cualquier hilo y la
+    // CPU lo atiende en su propio hilo, entre bloques. Pausada, RunBlock/Step no ejecutan nada.
+    void RequestPause() { SetControlFlags(CONTROL_PAUSE, true); }
+    void RequestResume() { SetControlFlags(CONTROL_PAUSE, false); }
+    void RequestStop() { SetControlFlags(CONTROL_STOP, true); }
+    // request corre en el hilo de la CPU con el estado quieto (leer registros, poner breakpoints...)
+    void Post(std::function<void(CPU&)> request);
+    bool IsPaused() const { return paused.load(std::memory_order_relaxed); }
     uint32_t GetPC() const { return PC; }
     uint32_t GetCTR() const { return CTR; }
-    uint32_t GetGPR(uint32_t reg) const { return GPR[reg]; }
+    uint64_t GetGPR(uint32_t reg) const { return GPR[reg]; }
+    uint64_t GetMSR() const { return MSR; }
     uint32_t GetSPR(uint32_t spr) const { return SPR[spr]; }
+    const VectorRegister& GetVR(uint32_t reg) const { return VPR[reg]; }
     void SetPC(uint32_t value) { PC = value; }
     void SetLR(uint32_t value) { LR = value; }
     void SetCTR(uint32_t value) { CTR = value; }
-    void SetMSR(uint32_t value) { MSR = value; }
-    void SetGPR(uint32_t index, uint32_t value) { GPR[index] = value; }
+    // Todo cambio de MSR pasa por aqu: la MMU decide si cambia la traduccin (IR/DR/PR/HV)
+    void SetMSR(uint64_t value) { MSR = value; mmu->SetMSR(value); }
+    void SetGPR(uint32_t index, uint64_t value) { GPR[index] = value; }
+    void SetVR(uint32_t reg, const VectorRegister& value) { VPR[reg] = value; }
     void SetSPR(uint32_t spr, uint32_t value) { SPR[spr] = value; }
     uint32_t MaskFromMBME(uint32_t MB, uint32_t ME);
+
+    // Reloj virtual: instrucciones retiradas por este hilo. Avanza al final de cada bloque (dentro
+    // de un bloque vale lo mismo, interpretado o nativo), as que slo depende de la ejecucin.
+    // La time base lo sigue a 1/16: a la velocidad nominal (729 MHz) son ~45.6 MHz, cerca de los
+    // 49.875 MHz del Xenon. mtspr TBL/TBU la desplaza. DEC y HDEC bajan al ritmo de la time base
+    // y se calculan al leerlos; el paso de 0 a -1 es un evento del CycleScheduler (0x900/0x980).
+    static constexpr uint32_t TIMEBASE_SHIFT = 4;
+    uint64_t GetInstructionsRetired() const { return instructionsRetired; }
+    uint64_t GetTimeBase() const { return timeBaseOffset + (instructionsRetired >> TIMEBASE_SHIFT); }
+    void SetTimeBase(uint64_t value) { timeBaseOffset = value - (instructionsRetired >> TIMEBASE_SHIFT); }
+    // Record/replay (Replay.h): las interrupciones externas que se toman se graban, o al reproducir
+    // llegan del log en lugar de la lnea real. nullptr = ejecucin normal.
+    void SetReplayLog(ReplayLog* log);
+
+    // MSR[SF]: modo de 64 bits. En modo de 32 bits las direcciones efectivas se truncan a 32 bits
+    // y CR0/XER[CA] miran slo la palabra baja; los GPR se calculan siempre en 64 bits.
+    static constexpr uint64_t MSR_SF = 1ull << 63;
+    bool Is64BitMode() const { return (MSR & MSR_SF) != 0; }
+    uint64_t EffectiveAddress(uint64_t ea) const { return Is64BitMode() ? ea : uint32_t(ea); }
     void SerializeState(std::ostream& out);
     void DeserializeState(std::istream& in);
 
     void DecodeExecute(uint32_t instr);
     //void execute(uint32_t instr);
-    unsigned int invertirBytes(unsigned int valor);
-    void TriggerException(uint32_t vector); // Exception handling
+    // Excepciones: quedan pendientes (bits PPU_EX_*) y DispatchExceptions las entrega por prioridad
+    // slo entre bloques o instrucciones, con PC/SRR0/SRR1 coherentes: primero la sncrona (PC
+    // sigue en su instruccin), despus el bit ms bajo.
+    // RaiseException es para las sncronas de una instruccin (PROG, SC, FPU, TRACE): PC se queda
+    // en ella y el bloque termina ah. reason = bits de SRR1 (PROGRAM_* para PPU_EX_PROG).
+    static constexpr uint64_t PROGRAM_ILLEGAL = 0x80000;
+    static constexpr uint64_t PROGRAM_PRIVILEGED = 0x40000;
+    static constexpr uint64_t PROGRAM_TRAP = 0x20000;
+    void RaiseException(uint32_t exception, uint64_t reason = 0);
+    // La instruccin que acaba de correr lanz una excepcin que la anula (trap, ilegal...): no se
+    // retira. sc s se completa antes de entrar al vector
+    bool InstructionAborted() const { return (pendingExceptions & ABORTING_EXCEPTIONS) != 0; }
+    // DSI/ISI/alignment de la MMU: DAR/DSISR y la excepcin pendiente en la instruccin que fall
+    void RaiseFault(const GuestFault& fault);
+    // sc: llamada al host (imprime GPR[3] en la pantalla) y vuelta a SRR0 con MSR = SRR1
     void HandleSyscall();
     void haltInvalidOpcode(uint32_t opcode) { LOG_ERROR("[CPU]", "Ivalid OPCODE 0x%008X", opcode); }
-    // helpers para vector-loads y traps    
-    std::array<uint32_t, 32> LoadVectorShiftLeft(uint32_t addr);   // carga 16 bytes desde addr
-    std::array<uint32_t, 32> LoadVectorShiftRight(uint32_t addr);  // idem    
+    // helpers para vector-loads y traps
+    VectorRegister LoadVectorShiftLeft(uint64_t addr) const;   // lvsl: control de vperm para addr
+    VectorRegister LoadVectorShiftRight(uint64_t addr) const;  // lvsr
+    // lvx/stvx (addr & ~15), lvlx/lvrx y stvlx/stvrx (la parte del bloque de 16 bytes a cada lado de addr)
+    void LoadVector(uint32_t vd, uint64_t addr);
+    void StoreVector(uint32_t vs, uint64_t addr);
+    void LoadVectorLeft(uint32_t vd, uint64_t addr);
+    void LoadVectorRight(uint32_t vd, uint64_t addr);
+    void StoreVectorLeft(uint32_t vs, uint64_t addr);
+    void StoreVectorRight(uint32_t vs, uint64_t addr);
     void __sync_synchronize() const { std::atomic_thread_fence(std::memory_order_seq_cst); }
-    // --- TriggerTrap: usar excepcin de programa/prog trap ---
+    // tw/td/twi/tdi: excepcin de programa con SRR1[TRAP]
     void TriggerTrap();
-    void HandleCRInstructions(uint32_t instr, uint32_t sub);
-    void HandleBranchConditional(uint32_t instr, bool to_ctr);
     void HandleISync();
 
+    // Helpers usados por los handlers de PPCInterpreter
+    uint64_t MoveFromSPR(uint32_t spr) const;
+    void MoveToSPR(uint32_t spr, uint64_t value);
+    // crf 0..7, CR0 en los bits altos (numeracin IBM)
+    void SetCRField(uint32_t crf, uint32_t value) {
+        const uint32_t shift = (7 - crf) * 4;
+        CR.value = (CR.value & ~(0xFu << shift)) | ((value & 0xF) << shift);
+    }
+    void UpdateCR0(uint64_t result) {
+        const int64_t r = Is64BitMode() ? int64_t(result) : int64_t(int32_t(result));
+        SetCRField(0, (r < 0 ? 0x8 : (r > 0 ? 0x4 : 0x2)) | GetXERSO());
+    }
+    uint32_t GetXERSO() const { return (XER >> 31) & 1; }
+    uint32_t GetXERCA() const { return (XER >> 29) & 1; }
+    void SetXERCA(bool ca) { XER = ca ? (XER | 0x20000000) : (XER & ~0x20000000u); }
+
+    friend struct PPCInterpreter;
+    friend class PPCJit;
+
 
 private:
-    MMU* mmu;
-    Display* display;  // nueva dependencia
-    uint32_t PC;       // Program Counter
+    // Estado comparado/restaurado por el modo diferencial del JIT
+    struct JitCheckState {
+        std::array<uint64_t, 32> GPR;
+        std::array<double, 32> FPR;
+        uint32_t CR, LR, CTR, XER, PC;
+        uint64_t MSR;
+        uint32_t SRR0;
+        uint64_t SRR1;
+        uint64_t instructionsRetired;
+        uint32_t pendingExceptions;
+        uint64_t exceptionReason;
+        uint64_t reservation_addr;
+        bool reservation_valid;
+        uint64_t reservation_stamp, reservation_value;
+    };
+    JitCheckState SaveJitCheckState() const;
+    void RestoreJitCheckState(const JitCheckState& state);
+
+    // lwarx/ldarx y stwcx./stdcx. (size 4 u 8) sobre la tabla de reservas compartida de la MMU
+    uint64_t LoadReserved(uint64_t ea, uint32_t size);
+    bool StoreConditional(uint64_t ea, uint32_t size, uint64_t value);
+    void SetReservationValid(bool valid);
+
+    uint32_t InterpretBlock(const PPCBlock& block, uint32_t limit = UINT32_MAX);
+    bool PrepareJit(PPCBlock& block);
+    uint32_t RunBlockNative(PPCBlock& block);
+    uint32_t RunBlockDifferential(PPCBlock& block);
+    // Eventos que llegan desde otros hilos: escrituras sobre cdigo e interrupciones externas
+    // Sin eventos, una sola carga relajada por bloque
+    void CheckAsyncEvents() {
+        mmu->PollRemoteCodeWrites();
+        if (pendingEvents.load(std::memory_order_relaxed)) HandleAsyncEvents();
+    }
+    void HandleAsyncEvents();
+    void SetControlFlags(uint32_t flags, bool set);
+    // Entrega la excepcin pendiente de ms prioridad que MSR deje entrar, si hay alguna
+    void DispatchExceptions();
+    // Eventos del CycleScheduler vencidos: una comparacin por bloque
+    void CheckTimers() {
+        if (instructionsRetired >= scheduler.NextDeadline()) RunTimers();
+    }
+    void RunTimers();
+    // DEC/HDEC: valor actual, y escritura (reprograma el paso a -1)
+    uint32_t ReadDecrementer(CycleScheduler::Event timer) const;
+    void WriteDecrementer(CycleScheduler::Event timer, uint32_t value);
+    // DEC = HDEC = 0x7FFFFFFF desde el instante actual, sin nada pendiente
+    void ResetTimers();
+
+    // pendingEvents
+    static constexpr uint32_t EVENT_EXTERNAL_INTERRUPT = 1;
+    static constexpr uint32_t EVENT_CONTROL = 2;
+    static constexpr uint32_t EVENT_REPLAY = 4;    // fijo mientras se reproduce: HandleAsyncEvents en cada bloque
+    // Excepciones que esperan a MSR[EE]; el resto entra siempre
+    static constexpr uint32_t MASKABLE_EXCEPTIONS = PPU_EX_EXT | PPU_EX_DEC | PPU_EX_HDEC | PPU_EX_PERFMON;
+    // Del hipervisor: guardan en HSRR0/HSRR1, ponen MSR[HV] y fuera del hipervisor (MSR[HV] = 0)
+    // entran aunque MSR[EE] = 0
+    static constexpr uint32_t HYPERVISOR_EXCEPTIONS = PPU_EX_HDEC;
+    // Las que provoca una instruccin (RaiseException/RaiseFault); a lo sumo hay una pendiente
+    static constexpr uint32_t SYNCHRONOUS_EXCEPTIONS = PPU_EX_DATASTOR | PPU_EX_DATASEGM | PPU_EX_INSSTOR |
+        PPU_EX_INSTSEGM | PPU_EX_ALIGNM | PPU_EX_PROG | PPU_EX_FPU | PPU_EX_SC | PPU_EX_TRACE;
+    // De ellas, las que dejan SRR0 en la instruccin sin completarla
+    static constexpr uint32_t ABORTING_EXCEPTIONS = SYNCHRONOUS_EXCEPTIONS & ~(PPU_EX_SC | PPU_EX_TRACE);
+    // controlFlags
+    static constexpr uint32_t CONTROL_PAUSE = 1;
+    static constexpr uint32_t CONTROL_STOP = 2;
+    struct ControlRequest {
+        std::function<void(CPU&)> run;
+        ControlRequest* next;
+    };
+
+    // Estado caliente: lo toca casi cada instruccin. Va al principio del objeto, en las primeras
+    // lneas de cach, y el JIT lo alcanza con desplazamientos de 8 bits (PPCJit::STATE_BIAS):
+    // PC..CR y r0-r28 caen en la ventana de 256 bytes.
+    // PC, LR y CTR siguen siendo de 32 bits: el cdigo del guest corre en los 4 GB bajos.
+    alignas(64) uint32_t PC; // Program Counter
+    uint32_t NIA;      // Next Instruction Address (lo fija el handler, Step lo copia a PC)
     uint32_t LR;       // Link Register
     uint32_t CTR;      // Count Register
     uint32_t XER;      // Fixed-point Exception Register
-    uint32_t MSR;      // Machine State Register
+    CR_t CR;           // Condition Register
+    std::array<uint64_t, 32> GPR; // General Purpose Registers (64 bits, PPC64)
+    uint64_t MSR;      // Machine State Register
+    MMU* mmu;
+    bool running;
+    std::atomic<bool> paused{ false }; // lo escribe slo el hilo de la CPU
+
+    // Estado templado: FPU y reservas
+    std::array<double, 32> FPR;   // Floating-Point Registers
     uint32_t FPSCR;    // Floating-Point Status and Control Register
-    uint32_t SRR0;     // Save/Restore Register 0 (for exceptions)
-    uint32_t SRR1;     // Save/Restore Register 1 (for exceptions)
+    uint64_t reservation_addr = 0;  // direccin real (ver LoadReserved)
+    bool reservation_valid = false;
+    uint32_t reservation_size = 0;
+    uint64_t reservation_stamp = 0;  // sello del granulo al hacer lwarx (XenonReservations)
+    uint64_t reservation_value = 0;  // valor ledo por lwarx, lo compara el CAS de stwcx.
+    JitMode jitMode = JitMode::Off;
+    uint32_t threadId = 0;
+    uint64_t instructionsRetired = 0;
+    ReplayLog* replay = nullptr;
+    CycleScheduler scheduler;
+    // DEC y HDEC: valor escrito y tick de la time base (sin timeBaseOffset) en que se escribi
+    struct Decrementer {
+        uint32_t value = 0x7FFFFFFF;
+        uint64_t baseTick = 0;
+    };
+    std::array<Decrementer, CycleScheduler::EVENT_COUNT> decrementers{};
+    uint32_t pendingExceptions = 0; // PPU_EX_*: slo lo toca el hilo de la CPU
+    uint64_t exceptionReason = 0;   // bits de SRR1 de la excepcin sncrona pendiente
+
+    // Lo que escriben otros hilos, en su propia lnea para no invalidar la del estado caliente
+    alignas(64) std::atomic<uint32_t> pendingEvents{ 0 };
+    std::atomic<uint32_t> controlFlags{ 0 };
+    std::atomic<ControlRequest*> controlRequests{ nullptr }; // pila LIFO, se invierte al atenderla
+
+    // Estado fro: SPRs, vectores, caches de traduccin
+    alignas(64) uint32_t SRR0;     // Save/Restore Register 0 (for exceptions)
+    uint64_t SRR1;     // Save/Restore Register 1 (for exceptions), copia del MSR
+    uint64_t HSRR0 = 0, HSRR1 = 0; // Hypervisor Save/Restore (HYPERVISOR_EXCEPTIONS, hrfid)
     uint32_t SPRG0, SPRG1, SPRG2, SPRG3; // Special Purpose Registers General
     uint32_t HID0, HID1; // Hardware Implementation Dependent
     uint32_t HID4;     // Xenon-specific
-    uint32_t DEC;      // Decrementer
-    uint32_t TBL, TBU; // Time Base Lower/Upper
-    std::array<uint32_t, 32> GPR; // General Purpose Registers
-    std::array<double, 32> FPR;   // Floating-Point Registers
-    std::array<uint32_t, 32> VPR; // Vector Registers    
-    //std::array<std::array<uint8_t, 16>, 32> VPR; // 32 registers, each 128 bits (16 bytes)    
-    std::array<uint32_t, 1024> SPR; // Special Purpose Registers
-    std::array<uint32_t, 8> GQR;   // Graphics Quantization Registers
-
-    uint64_t VACC; // Vector accumulator para instrucciones de sumas y multiplies
-    uint64_t VPR_acc; // acumulador para 128-bit ops   
-
-    CR_t CR;                       // Condition Register    
-
+    uint64_t timeBaseOffset = 0; // time base = timeBaseOffset + reloj virtual >> TIMEBASE_SHIFT
     // Floating-Point Status Control Register
     FPSCRegister FPSCRegs;
-    uint32_t reservation_addr;
-    bool reservation_valid;
-    bool running;
     // reservation and vector trap flag
     bool trapFlag;
-    std::mutex cpu_mutex;
+    // Vector Status and Control Register: NJ (non-Java, denormales a cero) y SAT (saturacin,
+    // pegajoso). NJ se guarda pero no se modela: VMXKernels siempre conserva los denormales.
+    uint32_t VSCR;
+    static constexpr uint32_t VSCR_NJ = 0x00010000;
+    static constexpr uint32_t VSCR_SAT = 0x00000001;
+    // Vector Registers: VR0-VR31 de VMX son los 32 primeros de VMX128
+    std::array<VectorRegister, VMX128_REGISTER_COUNT> VPR;
+    std::array<uint32_t, 8> GQR;   // Graphics Quantization Registers
+    std::array<uint32_t, 1024> SPR; // Special Purpose Registers
+    Display* display;  // nueva dependencia
+    PPCBlockCache blockCache; // bloques bsicos predecodificados por PC
+    PPCJit jit;               // bloques calientes compilados a x86-64
 
 };
 
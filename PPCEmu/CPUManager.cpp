@@ -0,0 +1,120 @@
+// CPUManager.cpp
+#include "CPUManager.h"
+#include "Log.h"
+#include <chrono>
+#include <stdexcept>
+
+CPUManager::CPUManager(MMU& mmu, CPU& primary, int threadCount) : primary_(primary), threadCount_(threadCount) {
+	if (threadCount < 1 || threadCount > MAX_THREADS)
+		throw std::invalid_argument("CPUManager: thread count must be 1.." + std::to_string(MAX_THREADS));
+	primary_.SetThreadId(0);
+	for (int id = 1; id < threadCount; ++id) {
+		auto hw = std::make_unique<HardwareThread>();
+		hw->id = id;
+		hw->mmu = mmu.CreateThreadView();
+		hw->cpu = std::make_unique<CPU>(hw->mmu.get());
+		hw->cpu->SetThreadId(uint32_t(id));
+		hw->cpu->SetJitMode(primary.GetJitMode());
+		secondary_.push_back(std::move(hw));
+	}
+	LOG_INFO("CPU", "CPUManager: %d hardware threads", threadCount);
+}
+
+CPUManager::~CPUManager() {
+	Stop();
+}
+
+void CPUManager::Start() {
+	if (started_) return;
+	started_ = true;
+	stop_.store(false, std::memory_order_relaxed);
+	for (auto& hw : secondary_)
+		hw->host = std::thread(&CPUManager::ThreadMain, this, std::ref(*hw));
+}
+
+void CPUManager::Stop() {
+	if (!started_) return;
+	stop_.store(true, std::memory_order_release);
+	for (auto& hw : secondary_) {
+		{
+			std::lock_guard<std::mutex> lock(hw->mutex);
+		}
+		hw->wake.notify_all();
+		if (hw->host.joinable()) hw->host.join();
+	}
+	started_ = false;
+}
+
+CPU& CPUManager::GetCPU(int id) {
+	if (id == 0) return primary_;
+	if (id < 0 || id >= threadCount_) throw std::out_of_range("CPUManager: no such hardware thread");
+	return *secondary_[id - 1]->cpu;
+}
+
+void CPUManager::StartThread(int id, uint32_t pc) {
+	if (id <= 0 || id >= threadCount_) throw std::out_of_range("CPUManager: StartThread needs a secondary thread");
+	HardwareThread& hw = *secondary_[id - 1];
+	{
+		std::lock_guard<std::mutex> lock(hw.mutex);
+		hw.startPC = pc;
+		hw.startRequested.store(true, std::memory_order_release);
+	}
+	hw.wake.notify_one();
+}
+
+void CPUManager::SignalExternalInterrupt(int id) {
+	if (id == 0) {
+		primary_.RaiseExternalInterrupt();
+		return;
+	}
+	if (id < 0 || id >= threadCount_) return;
+	HardwareThread& hw = *secondary_[id - 1];
+	hw.cpu->RaiseExternalInterrupt();
+	if (hw.halted.load(std::memory_order_acquire))
+		StartThread(id, RESET_VECTOR);
+}
+
+uint64_t CPUManager::GetSecondaryInstructions() const {
+	uint64_t total = 0;
+	for (const auto& hw : secondary_)
+		total += hw->executed.load(std::memory_order_relaxed);
+	return total;
+}
+
+// Bucle de un hilo secundario: duerme mientras esté parado, corre porciones de SLICE_INSTRUCTIONS
+void CPUManager::ThreadMain(HardwareThread& hw) {
+	CPU& cpu = *hw.cpu;
+	while (!stop_.load(std::memory_order_acquire)) {
+		if (hw.halted.load(std::memory_order_relaxed) || hw.startRequested.load(std::memory_order_acquire)) {
+			uint32_t pc;
+			{
+				std::unique_lock<std::mutex> lock(hw.mutex);
+				hw.wake.wait(lock, [&] { return stop_.load(std::memory_order_acquire) || hw.startRequested.load(std::memory_order_acquire); });
+				if (stop_.load(std::memory_order_acquire)) break;
+				hw.startRequested.store(false, std::memory_order_relaxed);
+				pc = hw.startPC;
+			}
+			cpu.Reset();
+			cpu.SetPC(pc);
+			hw.halted.store(false, std::memory_order_release);
+			LOG_INFO("CPU", "Hardware thread %d started at 0x%08X", hw.id, pc);
+		}
+
+		uint64_t executed = 0;
+		try {
+			while (executed < SLICE_INSTRUCTIONS && cpu.IsRunning()) {
+				const uint32_t n = cpu.RunBlock();
+				if (!n && cpu.IsPaused()) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					break;
+				}
+				executed += n;
+			}
+		}
+		catch (const std::exception& e) {
+			LOG_ERROR("CPU", "Hardware thread %d halted: %s", hw.id, e.what());
+		}
+		hw.executed.fetch_add(executed, std::memory_order_relaxed);
+		if (!cpu.IsRunning()) hw.halted.store(true, std::memory_order_release);
+	}
+}
@@ -1,11 +1,62 @@
+// CPUManager.h
+#pragma once
 #include "MMU.h"
 #include "CPU.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
+// Xenon: 3 núcleos x 2 hilos SMT. El hilo 0 es la CPU principal de PPCEmu y corre en el hilo del
+// emulador; CPUManager lanza un hilo del host por cada hilo de hardware adicional. Cada uno tiene
+// su CPU (registros, block cache, JIT) y su vista de la MMU (TLB propio); RAM y dispositivos son
+// comunes. Los hilos secundarios arrancan parados hasta StartThread o un IPI.
 class CPUManager {
 public:
-    CPUManager(MMU* mmu) {
-        for (int i = 0; i < 3; ++i) cpu_cores[i] = std::make_unique<CPU>(mmu);
-    }
+    static constexpr int MAX_THREADS = 6;
+    // Instrucciones entre comprobaciones de Stop/StartThread
+    static constexpr uint64_t SLICE_INSTRUCTIONS = 10000;
+    // Un hilo parado que recibe una interrupción externa arranca aquí (system reset)
+    static constexpr uint32_t RESET_VECTOR = 0x100;
+
+    // Crea las CPUs secundarias con una vista de mmu; el mapa de memoria tiene que estar completo
+    CPUManager(MMU& mmu, CPU& primary, int threadCount);
+    ~CPUManager();
+    CPUManager(const CPUManager&) = delete;
+    CPUManager& operator=(const CPUManager&) = delete;
+
+    void Start();
+    void Stop();
+
+    int GetThreadCount() const { return threadCount_; }
+    CPU& GetCPU(int id);
+    // Reinicia el hilo id y lo pone a ejecutar desde pc. Seguro desde cualquier hilo.
+    void StartThread(int id, uint32_t pc);
+    // Línea externa del IIC hacia el hilo id
+    void SignalExternalInterrupt(int id);
+    // Instrucciones ejecutadas por los hilos 1..N-1
+    uint64_t GetSecondaryInstructions() const;
+
 private:
-    std::array<std::unique_ptr<CPU>, 3> cpu_cores;
-};
\ No newline at end of file
+    struct HardwareThread {
+        int id = 0;
+        std::unique_ptr<MMU> mmu;
+        std::unique_ptr<CPU> cpu;
+        std::thread host;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::atomic<bool> startRequested{ false };
+        std::atomic<bool> halted{ true };
+        uint32_t startPC = 0;    // protegido por mutex
+        std::atomic<uint64_t> executed{ 0 };
+    };
+    void ThreadMain(HardwareThread& hw);
+
+    CPU& primary_;
+    int threadCount_;
+    std::vector<std::unique_ptr<HardwareThread>> secondary_; // hilos 1..N-1
+    std::atomic<bool> stop_{ false };
+    bool started_ = false;
+};
@@ -0,0 +1,67 @@
+// CycleScheduler.cpp
+#include "CycleScheduler.h"
+#include <algorithm>
+
+namespace {
+
+// std::*_heap con este orden deja arriba el plazo más cercano
+struct Later {
+	template <typename Entry>
+	bool operator()(const Entry& a, const Entry& b) const { return a.deadline > b.deadline; }
+};
+
+} // namespace
+
+void CycleScheduler::Schedule(Event event, uint64_t deadline) {
+	deadlines_[event] = deadline;
+	++generations_[event];
+	if (heap_.size() >= MAX_ENTRIES) {
+		Rebuild();
+		return;
+	}
+	heap_.push_back({ deadline, generations_[event], event });
+	std::push_heap(heap_.begin(), heap_.end(), Later());
+	Settle();
+}
+
+void CycleScheduler::Cancel(Event event) {
+	if (deadlines_[event] == NEVER) return;
+	deadlines_[event] = NEVER;
+	++generations_[event];
+	Settle();
+}
+
+void CycleScheduler::Clear() {
+	heap_.clear();
+	deadlines_.fill(NEVER);
+	for (uint32_t& generation : generations_) ++generation;
+	next_ = NEVER;
+}
+
+bool CycleScheduler::PopDue(uint64_t now, Event& event) {
+	if (next_ > now) return false;
+	event = heap_.front().event;
+	std::pop_heap(heap_.begin(), heap_.end(), Later());
+	heap_.pop_back();
+	deadlines_[event] = NEVER;
+	++generations_[event];
+	Settle();
+	return true;
+}
+
+void CycleScheduler::Settle() {
+	while (!heap_.empty() && IsStale(heap_.front())) {
+		std::pop_heap(heap_.begin(), heap_.end(), Later());
+		heap_.pop_back();
+	}
+	next_ = heap_.empty() ? NEVER : heap_.front().deadline;
+}
+
+void CycleScheduler::Rebuild() {
+	heap_.clear();
+	for (uint8_t i = 0; i < EVENT_COUNT; ++i) {
+		if (deadlines_[i] != NEVER) heap_.push_back({ deadlines_[i], generations_[i], Event(i) });
+	}
+	std::make_heap(heap_.begin(), heap_.end(), Later());
+	next_ = heap_.empty() ? NEVER : heap_.front().deadline;
+}
@@ -0,0 +1,45 @@
+// CycleScheduler.h
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Eventos temporizados de un hilo de hardware, con el plazo en ciclos del guest (instrucciones
+// retiradas, CPU::GetInstructionsRetired). Montículo de mínimos: la CPU sólo compara el reloj con
+// NextDeadline() entre bloques y recorta el bloque que lo cruzaría, así que los eventos llegan en
+// su ciclo exacto sin contar nada por instrucción.
+// Cada evento tiene a lo sumo un plazo: Schedule lo sustituye y Cancel lo quita. Las entradas
+// sustituidas se quedan en el montículo y se descartan al llegar arriba.
+class CycleScheduler {
+public:
+    enum Event : uint8_t { TIMER_DEC, TIMER_HDEC, EVENT_COUNT };
+    static constexpr uint64_t NEVER = UINT64_MAX;
+
+    void Schedule(Event event, uint64_t deadline);
+    void Cancel(Event event);
+    void Clear();
+    uint64_t GetDeadline(Event event) const { return deadlines_[event]; }
+    uint64_t NextDeadline() const { return next_; }
+    // Saca el primer evento vencido (plazo <= now); false si no queda ninguno
+    bool PopDue(uint64_t now, Event& event);
+
+private:
+    struct Entry {
+        uint64_t deadline;
+        uint32_t generation;
+        Event event;
+    };
+    // Con más entradas que esto (reprogramaciones sin vencer), se rehace desde deadlines_
+    static constexpr size_t MAX_ENTRIES = 64;
+
+    bool IsStale(const Entry& entry) const { return entry.generation != generations_[entry.event]; }
+    // Quita las entradas obsoletas de arriba y actualiza next_
+    void Settle();
+    void Rebuild();
+
+    std::vector<Entry> heap_;
+    std::array<uint64_t, EVENT_COUNT> deadlines_{ NEVER, NEVER };
+    std::array<uint32_t, EVENT_COUNT> generations_{};
+    uint64_t next_ = NEVER;
+};
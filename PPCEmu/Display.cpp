@@ -1,82 +1,36 @@
 ﻿// Display.cpp: Supports both RAM-backed and internal framebuffer
 #include "Display.h"
 #include "MemoryDevice.h"
+#include "Log.h"
 #include <stdexcept>
 #include <iostream>
 #include <cstring>
-#include <windows.h>
-
-static const wchar_t* WC_NAME = L"EmuFrameWnd";
+#include <istream>
+#include <ostream>
 
 Display::Display(const std::string& name, uint64_t baseAddress, int width, int height)
-	: MemoryDevice(name), pixels_(static_cast<size_t>(width)* height * 4), base_(baseAddress), width_(width), height_(height) {
-	initWindow();
-	std::cout << "Display initialized: " << name << " at 0x" << std::hex << baseAddress
-		<< ", size=0x" << pixels_.size() << std::dec << std::endl;
+	: MemoryDevice(name), presenter_(std::make_unique<NullPresenter>()), pixels_(static_cast<size_t>(width)* height * 4), base_(baseAddress), width_(width), height_(height) {
+	LOG_INFO("Display", "Display initialized: %s at 0x%016llX, size=0x%zX", name.c_str(), baseAddress, pixels_.size());
 }
 
 Display::Display(const std::string& name, std::shared_ptr<MemoryDevice> ram, uint64_t baseAddress, int width, int height)
-	: MemoryDevice(name), ram_(ram), base_(baseAddress), width_(width), height_(height) {
-	initWindow();
-}
-
-Display::~Display() {
-	if (hdcMem_) DeleteDC(hdcMem_);
-	if (hBmp_) DeleteObject(hBmp_);
-	if (hwnd_) DestroyWindow(hwnd_);
+	: MemoryDevice(name), presenter_(std::make_unique<NullPresenter>()), base_(baseAddress), width_(width), height_(height), ram_(ram) {
 }
 
-void Display::initWindow() {
-	ZeroMemory(&bmi_, sizeof(bmi_));
-	bmi_.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-	bmi_.bmiHeader.biWidth = width_;
-	bmi_.bmiHeader.biHeight = -height_;
-	bmi_.bmiHeader.biPlanes = 1;
-	bmi_.bmiHeader.biBitCount = 32;
-	bmi_.bmiHeader.biCompression = BI_RGB;
-
-	WNDCLASSW wc = {};
-	wc.lpfnWndProc = WndProc;
-	wc.hInstance = GetModuleHandle(nullptr);
-	wc.lpszClassName = WC_NAME;
-
-	static bool classRegistered = false;
-	if (!classRegistered) {
-		RegisterClassW(&wc);
-		classRegistered = true;
-	}
+Display::~Display() = default;
 
-	std::wstring wtitle(name_.begin(), name_.end());
-	hwnd_ = CreateWindowExW(0, WC_NAME, wtitle.c_str(), WS_OVERLAPPEDWINDOW,
-		CW_USEDEFAULT, CW_USEDEFAULT, width_ + 16, height_ + 39,
-		nullptr, nullptr, GetModuleHandle(nullptr), this);
-	if (!hwnd_) throw std::runtime_error("Failed to create display window");
-
-	ShowWindow(hwnd_, SW_SHOW);
-	HDC hdcWindow = GetDC(hwnd_);
-	hdcMem_ = CreateCompatibleDC(hdcWindow);
-	hBmp_ = CreateCompatibleBitmap(hdcWindow, width_, height_);
-	SelectObject(hdcMem_, hBmp_);
-	ReleaseDC(hwnd_, hdcWindow);
+void Display::SetPresenter(std::unique_ptr<FramePresenter> presenter) {
+	presenter_ = presenter ? std::move(presenter) : std::make_unique<NullPresenter>();
 }
 
 bool Display::ProcessMessages() {
-	MSG msg;
-	while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
-		if (msg.message == WM_QUIT) return false;
-		TranslateMessage(&msg);
-		DispatchMessage(&msg);
-	}
-	return true;
+	return presenter_->ProcessEvents();
 }
 
 void Display::Present() {
-	HDC hdcWindow = GetDC(hwnd_);
 	const uint8_t* data = ram_ ? ram_->GetPointerToAddress(base_) : pixels_.data();
 	if (!data) return;
-	SetDIBits(hdcMem_, hBmp_, 0, height_, data, &bmi_, DIB_RGB_COLORS);
-	BitBlt(hdcWindow, 0, 0, width_, height_, hdcMem_, 0, 0, SRCCOPY);
-	ReleaseDC(hwnd_, hdcWindow);
+	presenter_->Present(data, width_, height_);
 }
 
 #define FB_ACCESS(method, type, sz, op) \
@@ -114,8 +68,7 @@ void Display::Write8(uint64_t addr, uint8_t value) {
 		throw std::runtime_error("Display: Write out of bounds");
 	}
 	uint64_t offset = addr - base_;
-	std::cout << "Display::Write8: addr=0x" << std::hex << addr << ", offset=0x" << offset
-		<< ", value=0x" << (int)value << " ('" << (char)value << "')\n";
+	LOG_TRACE("Display", "Write8: addr=0x%016llX, offset=0x%016llX, value=0x%02X", addr, offset, value);
 	if (textMode_) {
 		uint32_t charIndex = offset;
 		if (charIndex < width_ * height_) {
@@ -128,7 +81,7 @@ void Display::Write8(uint64_t addr, uint8_t value) {
 }
 
 void Display::Write16(uint64_t address, uint16_t val) {
-	std::cout << "Display::Write16: addr=0x" << std::hex << address << ", val=0x" << val << std::dec << "\n";
+	LOG_TRACE("Display", "Write16: addr=0x%016llX, val=0x%04X", address, val);
 	uint8_t bytes[2] = { (uint8_t)(val >> 8), (uint8_t)(val & 0xFF) };
 	Write(address, bytes, 2);
 }
@@ -142,7 +95,7 @@ void Display::Read(uint64_t address, void* buffer, size_t size) {
 }
 
 void Display::Write(uint64_t address, const void* buffer, size_t size) {
-	std::cout << "Display::Write: addr=0x" << std::hex << address << ", size=" << std::dec << size << "\n";
+	LOG_TRACE("Display", "Write: addr=0x%016llX, size=%zu", address, size);
 	size_t off = size_t(address - base_);
 	if (off + size > width_ * height_ * 4) {
 		std::cerr << "Error: Write out of bounds: off=0x" << std::hex << off << ", size=" << std::dec << size
@@ -152,10 +105,8 @@ void Display::Write(uint64_t address, const void* buffer, size_t size) {
 	uint8_t* ptr = pixels_.data() + off;
 	memcpy(ptr, buffer, size);
 	if (textMode_) {
-		std::cout << "Display::Write: Calling UpdateText with size=" << std::dec << size << "\n";
 		std::vector<uint8_t> textData((uint8_t*)buffer, (uint8_t*)buffer + size);
 		UpdateText(textData, 0, 0, 0xFFFFFFFF);
-		std::cout << "Display::Write: UpdateText completed\n";
 	}
 }
 
@@ -175,22 +126,30 @@ uint8_t* Display::GetPointerToAddress(uint64_t address) {
 }
 
 
-uint8_t* Display::GetBuffer() {
-	return ram_ ? ram_->GetPointerToAddress(base_) : pixels_.data();
+void Display::SerializeState(std::ostream& out) {
+	const int32_t fields[] = { textMode_, textCursorX_, textCursorY_, textColor_ };
+	const uint64_t size = pixels_.size();
+	out.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+	out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+	out.write(reinterpret_cast<const char*>(pixels_.data()), std::streamsize(size));
 }
 
-LRESULT CALLBACK Display::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
-	switch (msg) {
-	case WM_CREATE: {
-		auto cs = reinterpret_cast<CREATESTRUCT*>(lParam);
-		SetWindowLongPtr(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(cs->lpCreateParams));
-		break;
-	}
-	case WM_DESTROY:
-		PostQuitMessage(0);
-		return 0;
-	}
-	return DefWindowProc(hwnd, msg, wParam, lParam);
+void Display::DeserializeState(std::istream& in) {
+	int32_t fields[4];
+	uint64_t size = 0;
+	in.read(reinterpret_cast<char*>(fields), sizeof(fields));
+	in.read(reinterpret_cast<char*>(&size), sizeof(size));
+	if (!in || size != pixels_.size()) throw std::runtime_error("Display: framebuffer state does not match");
+	in.read(reinterpret_cast<char*>(pixels_.data()), std::streamsize(size));
+	if (!in) throw std::runtime_error("Display: truncated state");
+	textMode_ = fields[0] != 0;
+	textCursorX_ = fields[1];
+	textCursorY_ = fields[2];
+	textColor_ = fields[3];
+}
+
+uint8_t* Display::GetBuffer() {
+	return ram_ ? ram_->GetPointerToAddress(base_) : pixels_.data();
 }
 
 void Display::UpdateText(const std::vector<uint8_t>& textData, int x, int y, uint32_t color) {
@@ -205,8 +164,7 @@ void Display::UpdateText(const std::vector<uint8_t>& textData, int x, int y, uin
 // Graphic Toolkit
 void Display::PutChar(char c) {
 	const int CHAR_W = 8, CHAR_H = 8;
-	std::cout << "PutChar: '" << c << "' at ("
-		<< textCursorX_ << "," << textCursorY_ << ")\n";
+	LOG_TRACE("Display", "PutChar: '%c' at (%d,%d)", c, textCursorX_, textCursorY_);
 
 	if (c == '\n') {
 		textCursorX_ = 0;
@@ -1,16 +1,18 @@
 // Display.h
 #pragma once
 #include "MemoryDevice.h"
-#include <windows.h>
+#include "FramePresenter.h"
 #include <vector>
 #include <cstdint>
+#include <memory>
 #include <string>
 
 #include <iostream>
-#include <shellscalingapi.h>
 #include <stdexcept>
 #include <cstring>
 
+// Framebuffer como MemoryDevice, independiente de la plataforma: 32 bpp BGRX en memoria.
+// La salida (ventana, volcado a disco, memoria compartida...) la hace el FramePresenter.
 class Display : public MemoryDevice {
 public:
 
@@ -18,6 +20,11 @@ public:
 	Display(const std::string& name, std::shared_ptr<MemoryDevice> ram, uint64_t baseAddress, int width, int height);
 	~Display() override;
 
+	// Por defecto NullPresenter
+	void SetPresenter(std::unique_ptr<FramePresenter> presenter);
+	int GetWidth() const { return width_; }
+	int GetHeight() const { return height_; }
+
 	bool textMode_ = false;
 
 	// MemoryDevice overrides
@@ -35,13 +42,17 @@ public:
 	void Write(uint64_t address, const void* buffer, size_t size) override;
 	void MemSet(uint64_t address, uint8_t value, size_t size) override;
 	uint8_t* GetPointerToAddress(uint64_t address) override;
+	// Snapshots: cursor de texto y, si el framebuffer es interno, los pxeles
+	void SerializeState(std::ostream& out) override;
+	void DeserializeState(std::istream& in) override;
+	// Los pxeles slo cambian con lo que escribe el guest: no hace falta grabar sus lecturas
+	bool ReadsDependOnHost() const override { return false; }
 	uint64_t GetSize() const override { return pixels_.size(); }
 	uint8_t* GetBuffer();// { return pixels_.data(); }
 	uint64_t GetBaseAddress() const { return base_; }
 	void UpdateText(const std::vector<uint8_t>& textData, int x, int y, uint32_t color);
 
-	// Window and rendering
-	void initWindow();
+	// Presentation: forwarded to the presenter
 	bool ProcessMessages();
 	void Present();	
 
@@ -64,14 +75,9 @@ public:
 	void FillTriangle(int x1, int y1, int x2, int y2, int x3, int y3, uint32_t color);
 
 private:
-	//void createWindow();
 	static constexpr u64 XBOX360_RAM_SIZE = 512ULL * 1024 * 1024;
-	static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
-	HWND hwnd_{ nullptr };
-	HDC hdcMem_{ nullptr };
-	HBITMAP hBmp_{ nullptr };
-	BITMAPINFO bmi_{};
+	std::unique_ptr<FramePresenter> presenter_;
 	std::vector<uint8_t> pixels_; // Buffer de pxeles del framebuffer
 	uint64_t base_;
 	int width_, height_;
@@ -0,0 +1,115 @@
+// Endian.h
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
+
+// Acceso big-endian (el orden del Xenon) sobre memoria del host. Todo pasa por aquí: dispositivos,
+// MMU, cargadores e instrucciones de byte-reverse. La carga es memcpy + bswap, que el compilador
+// baja a un mov+bswap (o movbe con -mmovbe / -march=native) sin exigir alineación.
+
+#if defined(_MSC_VER)
+#define PPC_HOST_LITTLE_ENDIAN 1 // MSVC sólo genera código little-endian (x86, x64, ARM64)
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define PPC_HOST_LITTLE_ENDIAN 1
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define PPC_HOST_LITTLE_ENDIAN 0
+#else
+#error "Unknown host byte order"
+#endif
+
+inline uint16_t ByteSwap16(uint16_t v) {
+#if defined(_MSC_VER)
+    return _byteswap_ushort(v);
+#else
+    return __builtin_bswap16(v);
+#endif
+}
+
+inline uint32_t ByteSwap32(uint32_t v) {
+#if defined(_MSC_VER)
+    return _byteswap_ulong(v);
+#else
+    return __builtin_bswap32(v);
+#endif
+}
+
+inline uint64_t ByteSwap64(uint64_t v) {
+#if defined(_MSC_VER)
+    return _byteswap_uint64(v);
+#else
+    return __builtin_bswap64(v);
+#endif
+}
+
+// Invierte el orden de bytes de cualquier entero de 1, 2, 4 u 8 bytes
+template <typename T>
+inline T ByteSwap(T v) {
+    static_assert(std::is_integral<T>::value, "ByteSwap needs an integer type");
+    if constexpr (sizeof(T) == 1) return v;
+    else if constexpr (sizeof(T) == 2) return T(ByteSwap16(uint16_t(v)));
+    else if constexpr (sizeof(T) == 4) return T(ByteSwap32(uint32_t(v)));
+    else {
+        static_assert(sizeof(T) == 8, "unsupported integer size");
+        return T(ByteSwap64(uint64_t(v)));
+    }
+}
+
+// Valor big-endian ya leído (p.ej. un campo de una cabecera ELF) <-> valor del host
+template <typename T>
+inline T FromBE(T v) {
+#if PPC_HOST_LITTLE_ENDIAN
+    return ByteSwap(v);
+#else
+    return v;
+#endif
+}
+
+template <typename T>
+inline T ToBE(T v) { return FromBE(v); }
+
+template <typename T>
+inline T LoadBE(const void* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return FromBE(v);
+}
+
+template <typename T>
+inline void StoreBE(void* p, T v) {
+    v = ToBE(v);
+    std::memcpy(p, &v, sizeof(T));
+}
+
+inline uint16_t LoadBE16(const void* p) { return LoadBE<uint16_t>(p); }
+inline uint32_t LoadBE32(const void* p) { return LoadBE<uint32_t>(p); }
+inline uint64_t LoadBE64(const void* p) { return LoadBE<uint64_t>(p); }
+inline void StoreBE16(void* p, uint16_t v) { StoreBE(p, v); }
+inline void StoreBE32(void* p, uint32_t v) { StoreBE(p, v); }
+inline void StoreBE64(void* p, uint64_t v) { StoreBE(p, v); }
+
+// Little-endian: formatos del host que lo usan (flujos LZX de las imágenes XEX2)
+template <typename T>
+inline T LoadLE(const void* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+#if PPC_HOST_LITTLE_ENDIAN
+    return v;
+#else
+    return ByteSwap(v);
+#endif
+}
+
+template <typename T>
+inline void StoreLE(void* p, T v) {
+#if !PPC_HOST_LITTLE_ENDIAN
+    v = ByteSwap(v);
+#endif
+    std::memcpy(p, &v, sizeof(T));
+}
+
+inline uint32_t LoadLE32(const void* p) { return LoadLE<uint32_t>(p); }
+inline void StoreLE32(void* p, uint32_t v) { StoreLE(p, v); }
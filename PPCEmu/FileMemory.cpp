@@ -0,0 +1,130 @@
+// FileMemory.cpp
+#include "FileMemory.h"
+#include "Endian.h"
+#include "Log.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+FileMemory::FileMemory(const std::string& name, const std::string& path, bool copyOnWrite)
+	: MemoryDevice(name),
+	file_(path, copyOnWrite ? MappedFile::Access::CopyOnWrite : MappedFile::Access::ReadOnly),
+	writable_(copyOnWrite) {
+	// En sólo lectura la proyección no admite escrituras: nada escribe por data_ (ver WritePointer)
+	data_ = const_cast<uint8_t*>(file_.GetData());
+	if (writable_) {
+		const uint64_t pages = (file_.GetSize() + DIRTY_PAGE_SIZE - 1) >> DIRTY_PAGE_SHIFT;
+		dirtyWords_ = (pages + 63) / 64;
+		dirty_.reset(new std::atomic<uint64_t>[dirtyWords_]());
+	}
+	LOG_INFO("Memory", "[%s] %s: %llu bytes, %s%s", name.c_str(), path.c_str(), (unsigned long long)file_.GetSize(),
+		writable_ ? "copy-on-write" : "read-only", file_.IsMapped() ? "" : " (not mappable, copied)");
+}
+
+void FileMemory::CheckBounds(uint64_t address, uint64_t size) const {
+	if (address > file_.GetSize() || size > file_.GetSize() - address) {
+		LOG_ERROR("Memory", "[%s] access out of bounds: addr=0x%016llX, size=%llu, limit=%llu", name_.c_str(),
+			(unsigned long long)address, (unsigned long long)size, (unsigned long long)file_.GetSize());
+		throw std::out_of_range("FileMemory: access out of bounds");
+	}
+}
+
+uint8_t* FileMemory::WritePointer(uint64_t address, uint64_t size) {
+	CheckBounds(address, size);
+	if (!writable_) throw std::runtime_error("FileMemory: write to read-only image " + file_.GetPath());
+	MarkDirtyPages(dirty_.get(), address, size);
+	return data_ + address;
+}
+
+void FileMemory::Read(uint64_t address, void* data, size_t size) {
+	CheckBounds(address, size);
+	memcpy(data, data_ + address, size);
+}
+
+void FileMemory::Write(uint64_t address, const void* data, size_t size) {
+	memcpy(WritePointer(address, size), data, size);
+}
+
+void FileMemory::MemSet(uint64_t address, uint8_t value, size_t size) {
+	memset(WritePointer(address, size), value, size);
+}
+
+uint32_t FileMemory::Read32(uint64_t address) {
+	CheckBounds(address, 4);
+	return LoadBE32(data_ + address);
+}
+
+uint64_t FileMemory::Read64(uint64_t address) {
+	CheckBounds(address, 8);
+	return LoadBE64(data_ + address);
+}
+
+void FileMemory::Write32(uint64_t address, uint32_t value) {
+	StoreBE32(WritePointer(address, 4), value);
+}
+
+void FileMemory::Write64(uint64_t address, uint64_t value) {
+	StoreBE64(WritePointer(address, 8), value);
+}
+
+uint8_t* FileMemory::GetPointerToAddress(uint64_t address) {
+	CheckBounds(address, 1);
+	return data_ + address;
+}
+
+void FileMemory::ResetPages(uint64_t offset, uint64_t size) {
+	CheckBounds(offset, size);
+	if (!writable_ || !size) return;
+	std::ifstream in(file_.GetPath(), std::ios::binary);
+	in.seekg(std::streamoff(offset));
+	in.read(reinterpret_cast<char*>(data_ + offset), std::streamsize(size));
+	if (!in) throw std::runtime_error("Cannot read file: " + file_.GetPath());
+	const uint64_t last = (offset + size - 1) >> DIRTY_PAGE_SHIFT;
+	for (uint64_t page = offset >> DIRTY_PAGE_SHIFT; page <= last; ++page)
+		dirty_[page >> 6].fetch_and(~(1ull << (page & 63)), std::memory_order_relaxed);
+}
+
+bool FileMemory::IsPageDirty(uint64_t offset) const {
+	if (!dirty_ || offset >= file_.GetSize()) return false;
+	const uint64_t page = offset >> DIRTY_PAGE_SHIFT;
+	return (dirty_[page >> 6].load(std::memory_order_relaxed) >> (page & 63)) & 1;
+}
+
+uint64_t FileMemory::CountDirtyPages() const {
+	uint64_t count = 0;
+	for (uint64_t i = 0; i < dirtyWords_; ++i) {
+		uint64_t word = dirty_[i].load(std::memory_order_relaxed);
+		for (; word; word &= word - 1) ++count;
+	}
+	return count;
+}
+
+std::vector<uint64_t> FileMemory::GetDirtyPageOffsets() const {
+	std::vector<uint64_t> offsets;
+	for (uint64_t i = 0; i < dirtyWords_; ++i) {
+		const uint64_t word = dirty_[i].load(std::memory_order_relaxed);
+		for (int bit = 0; bit < 64; ++bit)
+			if ((word >> bit) & 1) offsets.push_back(((i << 6) + bit) << DIRTY_PAGE_SHIFT);
+	}
+	return offsets;
+}
+
+uint64_t FileMemory::WriteDirtyPages(const std::string& path) const {
+	std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+	if (!out) {
+		std::ofstream create(path, std::ios::binary);
+		out.open(path, std::ios::binary | std::ios::in | std::ios::out);
+	}
+	if (!out) throw std::runtime_error("Cannot open file: " + path);
+
+	const std::vector<uint64_t> pages = GetDirtyPageOffsets();
+	for (uint64_t offset : pages) {
+		const uint64_t size = (std::min)(DIRTY_PAGE_SIZE, file_.GetSize() - offset);
+		out.seekp(std::streamoff(offset));
+		out.write(reinterpret_cast<const char*>(data_ + offset), std::streamsize(size));
+	}
+	if (!out) throw std::runtime_error("Cannot write file: " + path);
+	LOG_INFO("Memory", "[%s] %zu dirty pages written to %s", name_.c_str(), pages.size(), path.c_str());
+	return pages.size();
+}
@@ -0,0 +1,54 @@
+// FileMemory.h
+#pragma once
+#include "MemoryDevice.h"
+#include "MappedFile.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Memoria del guest respaldada por un fichero (ROM, NAND, volcados) sin copiarlo: el fichero se
+// proyecta y la MMU accede por puntero, igual que a la RAM.
+//  - Sólo lectura: las regiones sobre el dispositivo nunca son escribibles.
+//  - Copy-on-write: el guest puede escribir; las páginas tocadas pasan a ser privadas del proceso
+//    y el fichero no cambia. El bitmap de páginas sucias dice cuáles hay que guardar.
+class FileMemory : public MemoryDevice {
+public:
+    FileMemory(const std::string& name, const std::string& path, bool copyOnWrite);
+    FileMemory(const FileMemory&) = delete;
+    FileMemory& operator=(const FileMemory&) = delete;
+
+    void Read(uint64_t address, void* data, size_t size) override;
+    void Write(uint64_t address, const void* data, size_t size) override;
+    void MemSet(uint64_t address, uint8_t value, size_t size) override;
+    uint32_t Read32(uint64_t address) override;
+    uint64_t Read64(uint64_t address) override;
+    void Write32(uint64_t address, uint32_t value) override;
+    void Write64(uint64_t address, uint64_t value) override;
+    // Las escrituras directas por este puntero no se registran como sucias
+    uint8_t* GetPointerToAddress(uint64_t address) override;
+    bool IsDirectMapped() const override { return true; }
+    bool IsReadOnly() const override { return !writable_; }
+    uint64_t GetSize() const override { return file_.GetSize(); }
+    std::atomic<uint64_t>* GetDirtyPages() override { return dirty_.get(); }
+    // Copy-on-write: vuelve a leer esas páginas del fichero
+    void ResetPages(uint64_t offset, uint64_t size) override;
+
+    const std::string& GetPath() const { return file_.GetPath(); }
+    bool IsPageDirty(uint64_t offset) const;
+    uint64_t CountDirtyPages() const;
+    // Offsets (múltiplos de DIRTY_PAGE_SIZE) de las páginas modificadas, en orden
+    std::vector<uint64_t> GetDirtyPageOffsets() const;
+    // Escribe sólo las páginas modificadas, cada una en su offset, en path (se crea si no existe;
+    // con la ruta de la imagen original la actualiza). Devuelve el número de páginas escritas.
+    uint64_t WriteDirtyPages(const std::string& path) const;
+
+private:
+    void CheckBounds(uint64_t address, uint64_t size) const;
+    uint8_t* WritePointer(uint64_t address, uint64_t size);
+
+    MappedFile file_;
+    uint8_t* data_ = nullptr; // escribible sólo en copy-on-write
+    bool writable_;
+    uint64_t dirtyWords_ = 0;
+    std::unique_ptr<std::atomic<uint64_t>[]> dirty_; // nullptr en sólo lectura
+};
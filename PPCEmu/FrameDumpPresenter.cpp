@@ -0,0 +1,123 @@
+// FrameDumpPresenter.cpp
+#include "FrameDumpPresenter.h"
+#include "Log.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+FrameDumpPresenter::FrameDumpPresenter(const std::string& directory, Format format, uint32_t interval)
+	: directory_(directory), format_(format), interval_(interval ? interval : 1) {
+	std::filesystem::create_directories(directory_);
+}
+
+void FrameDumpPresenter::Present(const uint8_t* pixels, int width, int height) {
+	if (frame_++ % interval_ != 0) return;
+
+	// BGRX -> RGB, común a los dos formatos
+	rgb_.resize(size_t(width) * height * 3);
+	for (size_t i = 0, n = size_t(width) * height; i < n; ++i) {
+		rgb_[i * 3 + 0] = pixels[i * 4 + 2];
+		rgb_[i * 3 + 1] = pixels[i * 4 + 1];
+		rgb_[i * 3 + 2] = pixels[i * 4 + 0];
+	}
+
+	char name[32];
+	snprintf(name, sizeof(name), "frame_%06llu.%s", (unsigned long long)frame_ - 1, format_ == Format::PNG ? "png" : "ppm");
+	const std::string path = (std::filesystem::path(directory_) / name).string();
+	if (format_ == Format::PNG)
+		WritePNG(path, rgb_.data(), width, height);
+	else
+		WritePPM(path, rgb_.data(), width, height);
+	++written_;
+	LOG_DEBUG("Display", "Frame written to %s", path.c_str());
+}
+
+void FrameDumpPresenter::WritePPM(const std::string& path, const uint8_t* rgb, int width, int height) {
+	std::ofstream out(path, std::ios::binary);
+	if (!out) throw std::runtime_error("FrameDumpPresenter: cannot write " + path);
+	out << "P6\n" << width << " " << height << "\n255\n";
+	out.write(reinterpret_cast<const char*>(rgb), std::streamsize(size_t(width) * height * 3));
+}
+
+namespace {
+
+uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+	static uint32_t table[256];
+	static bool init = false;
+	if (!init) {
+		for (uint32_t n = 0; n < 256; ++n) {
+			uint32_t c = n;
+			for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			table[n] = c;
+		}
+		init = true;
+	}
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+void PutBE32(std::vector<uint8_t>& out, uint32_t v) {
+	out.push_back(uint8_t(v >> 24));
+	out.push_back(uint8_t(v >> 16));
+	out.push_back(uint8_t(v >> 8));
+	out.push_back(uint8_t(v));
+}
+
+void WriteChunk(std::ofstream& out, const char type[4], const std::vector<uint8_t>& data) {
+	std::vector<uint8_t> chunk;
+	PutBE32(chunk, uint32_t(data.size()));
+	chunk.insert(chunk.end(), type, type + 4);
+	chunk.insert(chunk.end(), data.begin(), data.end());
+	PutBE32(chunk, Crc32(chunk.data() + 4, chunk.size() - 4));
+	out.write(reinterpret_cast<const char*>(chunk.data()), std::streamsize(chunk.size()));
+}
+
+} // namespace
+
+void FrameDumpPresenter::WritePNG(const std::string& path, const uint8_t* rgb, int width, int height) {
+	std::ofstream out(path, std::ios::binary);
+	if (!out) throw std::runtime_error("FrameDumpPresenter: cannot write " + path);
+	static const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	out.write(reinterpret_cast<const char*>(SIGNATURE), sizeof(SIGNATURE));
+
+	std::vector<uint8_t> ihdr;
+	PutBE32(ihdr, uint32_t(width));
+	PutBE32(ihdr, uint32_t(height));
+	ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 }); // 8 bits, RGB, deflate, filtro 0, sin entrelazado
+	WriteChunk(out, "IHDR", ihdr);
+
+	// Scanlines con filtro 0 (None)
+	const size_t stride = size_t(width) * 3;
+	std::vector<uint8_t> raw;
+	raw.reserve((stride + 1) * height);
+	for (int y = 0; y < height; ++y) {
+		raw.push_back(0);
+		raw.insert(raw.end(), rgb + y * stride, rgb + (y + 1) * stride);
+	}
+
+	// zlib con bloques deflate "stored" (sin compresión) de hasta 65535 bytes
+	std::vector<uint8_t> idat = { 0x78, 0x01 };
+	size_t pos = 0;
+	do {
+		const size_t len = std::min<size_t>(raw.size() - pos, 65535);
+		const bool last = pos + len == raw.size();
+		idat.push_back(last ? 1 : 0);
+		idat.push_back(uint8_t(len));
+		idat.push_back(uint8_t(len >> 8));
+		idat.push_back(uint8_t(~len));
+		idat.push_back(uint8_t(~len >> 8));
+		idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+		pos += len;
+	} while (pos < raw.size());
+	uint32_t a = 1, b = 0; // Adler-32
+	for (uint8_t byte : raw) {
+		a = (a + byte) % 65521;
+		b = (b + a) % 65521;
+	}
+	PutBE32(idat, (b << 16) | a);
+	WriteChunk(out, "IDAT", idat);
+	WriteChunk(out, "IEND", {});
+}
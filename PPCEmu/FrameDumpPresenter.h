@@ -0,0 +1,28 @@
+// FrameDumpPresenter.h
+#pragma once
+#include "FramePresenter.h"
+#include <string>
+#include <vector>
+
+// Writes every Nth presented frame to directory/frame_NNNNNN.ppm|png.
+// PNG is written uncompressed (stored deflate blocks), so it needs no zlib.
+class FrameDumpPresenter : public FramePresenter {
+public:
+    enum class Format { PPM, PNG };
+
+    FrameDumpPresenter(const std::string& directory, Format format, uint32_t interval = 1);
+
+    void Present(const uint8_t* pixels, int width, int height) override;
+    uint64_t GetFramesWritten() const { return written_; }
+
+private:
+    void WritePPM(const std::string& path, const uint8_t* pixels, int width, int height);
+    void WritePNG(const std::string& path, const uint8_t* pixels, int width, int height);
+
+    std::string directory_;
+    Format format_;
+    uint32_t interval_;
+    uint64_t frame_ = 0;
+    uint64_t written_ = 0;
+    std::vector<uint8_t> rgb_;  // scratch buffer for BGRX -> RGB
+};
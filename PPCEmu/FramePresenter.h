@@ -0,0 +1,19 @@
+// FramePresenter.h
+#pragma once
+#include <cstdint>
+
+// Destination for Display frames. Present receives the framebuffer as-is:
+// 32 bpp BGRX, top-down, pitch = width * 4.
+class FramePresenter {
+public:
+    virtual ~FramePresenter() = default;
+    virtual void Present(const uint8_t* pixels, int width, int height) = 0;
+    // Platform events (window messages); false once the user closed the output
+    virtual bool ProcessEvents() { return true; }
+};
+
+// Discards every frame: headless runs with no video output
+class NullPresenter : public FramePresenter {
+public:
+    void Present(const uint8_t*, int, int) override {}
+};
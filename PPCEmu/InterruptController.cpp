@@ -0,0 +1,159 @@
+// InterruptController.cpp
+#include "InterruptController.h"
+#include "Endian.h"
+#include "Log.h"
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+static int HighestBit(uint32_t mask) {
+	int bit = -1;
+	while (mask) { ++bit; mask >>= 1; }
+	return bit;
+}
+
+InterruptController::InterruptController(const std::string& name) : MemoryDevice(name) {
+	LOG_INFO("System", "[%s] interrupt controller: %d threads", name.c_str(), MAX_THREADS);
+}
+
+void InterruptController::SetAssertHandler(AssertHandler handler) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	onAssert_ = std::move(handler);
+}
+
+void InterruptController::SendInterrupt(uint32_t threadMask, uint32_t priority) {
+	uint32_t asserted = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		const uint32_t level = (priority >> 2) & 31;
+		for (int thread = 0; thread < MAX_THREADS; ++thread) {
+			if (!(threadMask & (1u << thread))) continue;
+			threads_[thread].pending |= 1u << level;
+			LOG_DEBUG("System", "IIC: interrupt 0x%02X -> thread %d", level << 2, thread);
+			asserted |= Update(thread);
+		}
+	}
+	AssertLines(asserted);
+}
+
+uint32_t InterruptController::Acknowledge(int thread) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	ThreadState& state = threads_[thread];
+	const int level = HighestBit(state.pending);
+	if (level < 0) return 0;
+	state.pending &= ~(1u << level);
+	state.inService |= 1u << level;
+	return uint32_t(level) << 2;
+}
+
+void InterruptController::EndOfInterrupt(int thread) {
+	uint32_t asserted;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		ThreadState& state = threads_[thread];
+		const int level = HighestBit(state.inService);
+		if (level >= 0) state.inService &= ~(1u << level);
+		asserted = Update(thread);
+	}
+	AssertLines(asserted);
+}
+
+uint32_t InterruptController::Update(int thread) const {
+	const ThreadState& state = threads_[thread];
+	const int level = HighestBit(state.pending);
+	return level >= 0 && (uint32_t(level) << 2) > state.taskPriority ? 1u << thread : 0;
+}
+
+// El handler se copia con el IIC bloqueado y se llama fuera: si arranca hilos o vuelve a entrar
+// en el IIC no hay interbloqueo
+void InterruptController::AssertLines(uint32_t threadMask) {
+	if (!threadMask) return;
+	AssertHandler handler;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		handler = onAssert_;
+	}
+	if (!handler) return;
+	for (int thread = 0; thread < MAX_THREADS; ++thread)
+		if (threadMask & (1u << thread)) handler(thread);
+}
+
+uint64_t InterruptController::ReadRegister(uint64_t address) {
+	const int thread = int(address / THREAD_STRIDE);
+	if (thread >= MAX_THREADS) throw std::out_of_range("IIC: thread block out of range");
+	switch (address % THREAD_STRIDE) {
+	case REG_TASK_PRIORITY: {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return threads_[thread].taskPriority;
+	}
+	case REG_ACK:
+		return Acknowledge(thread);
+	default:
+		return 0;
+	}
+}
+
+void InterruptController::WriteRegister(uint64_t address, uint64_t value) {
+	const int thread = int(address / THREAD_STRIDE);
+	if (thread >= MAX_THREADS) throw std::out_of_range("IIC: thread block out of range");
+	switch (address % THREAD_STRIDE) {
+	case REG_TASK_PRIORITY: {
+		uint32_t asserted;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			threads_[thread].taskPriority = uint32_t(value) & 0x7C;
+			asserted = Update(thread);
+		}
+		AssertLines(asserted);
+		break;
+	}
+	case REG_IPI_DISPATCH:
+		SendInterrupt(uint32_t(value >> 16) & 0x3F, uint32_t(value) & 0x7C);
+		break;
+	case REG_EOI:
+		EndOfInterrupt(thread);
+		break;
+	default:
+		LOG_DEBUG("System", "IIC: write to unknown register 0x%llX = 0x%llX", address, value);
+		break;
+	}
+}
+
+// Los registros son de 32/64 bits: los accesos de otro tamaño no tienen efecto
+void InterruptController::Read(uint64_t address, void* data, size_t size) {
+	if (size == 8) StoreBE64(data, ReadRegister(address));
+	else if (size == 4) StoreBE32(data, uint32_t(ReadRegister(address)));
+	else memset(data, 0, size);
+}
+
+void InterruptController::Write(uint64_t address, const void* data, size_t size) {
+	if (size == 8) WriteRegister(address, LoadBE64(data));
+	else if (size == 4) WriteRegister(address, LoadBE32(data));
+}
+
+void InterruptController::MemSet(uint64_t, uint8_t, size_t) {
+}
+
+void InterruptController::SerializeState(std::ostream& out) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (const ThreadState& state : threads_) {
+		const uint32_t fields[] = { state.pending, state.inService, state.taskPriority };
+		out.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+	}
+}
+
+void InterruptController::DeserializeState(std::istream& in) {
+	uint32_t asserted = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (ThreadState& state : threads_) {
+			uint32_t fields[3];
+			in.read(reinterpret_cast<char*>(fields), sizeof(fields));
+			if (!in) throw std::runtime_error("IIC: truncated state");
+			state = { fields[0], fields[1], fields[2] };
+		}
+		for (int thread = 0; thread < MAX_THREADS; ++thread) asserted |= Update(thread);
+	}
+	AssertLines(asserted);
+}
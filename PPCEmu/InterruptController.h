@@ -0,0 +1,69 @@
+// InterruptController.h
+#pragma once
+#include "MemoryDevice.h"
+#include <array>
+#include <functional>
+#include <mutex>
+
+// IIC del Xenon: un bloque de registros de THREAD_STRIDE bytes por hilo de hardware.
+//   +0x08 prioridad de tarea (R/W): sólo se señalan prioridades por encima de ésta
+//   +0x10 envío de IPI (W): bits 16..21 = máscara de hilos destino, bits 0..7 = prioridad
+//   +0x50 ACK (R): prioridad pendiente más alta, que pasa a "en servicio"; 0 si no hay ninguna
+//   +0x60 EOI (W): termina la interrupción en servicio de mayor prioridad
+// Las prioridades son múltiplos de 4 (0x04..0x7C). Mientras quede alguna pendiente por encima
+// de la prioridad de tarea, la línea externa del hilo se vuelve a activar (onAssert).
+class InterruptController : public MemoryDevice {
+public:
+    static constexpr int MAX_THREADS = 6;
+    static constexpr uint64_t THREAD_STRIDE = 0x1000;
+    static constexpr uint64_t REG_TASK_PRIORITY = 0x08;
+    static constexpr uint64_t REG_IPI_DISPATCH = 0x10;
+    static constexpr uint64_t REG_ACK = 0x50;
+    static constexpr uint64_t REG_EOI = 0x60;
+
+    // Se llama cuando la línea externa de un hilo se activa, ya sin el IIC bloqueado: puede
+    // arrancar hilos (CPUManager) o volver a entrar en el IIC
+    using AssertHandler = std::function<void(int thread)>;
+
+    explicit InterruptController(const std::string& name);
+    void SetAssertHandler(AssertHandler handler);
+
+    // Marca priority como pendiente en cada hilo de threadMask (bit n = hilo n)
+    void SendInterrupt(uint32_t threadMask, uint32_t priority);
+    uint32_t Acknowledge(int thread);
+    void EndOfInterrupt(int thread);
+
+    void Read(uint64_t address, void* data, size_t size) override;
+    void Write(uint64_t address, const void* data, size_t size) override;
+    void MemSet(uint64_t address, uint8_t value, size_t size) override;
+    uint32_t Read32(uint64_t address) override { return uint32_t(ReadRegister(address)); }
+    uint64_t Read64(uint64_t address) override { return ReadRegister(address); }
+    void Write32(uint64_t address, uint32_t value) override { WriteRegister(address, value); }
+    void Write64(uint64_t address, uint64_t value) override { WriteRegister(address, value); }
+    uint8_t* GetPointerToAddress(uint64_t) override { return nullptr; }
+    uint64_t GetSize() const override { return MAX_THREADS * THREAD_STRIDE; }
+    // pending/inService/taskPriority de cada hilo; al restaurar se vuelven a activar las líneas
+    void SerializeState(std::ostream& out) override;
+    void DeserializeState(std::istream& in) override;
+    // Sólo las IPI que envía el propio guest le dan estado: sus lecturas no se graban
+    bool ReadsDependOnHost() const override { return false; }
+
+private:
+    struct ThreadState {
+        uint32_t pending = 0;    // bit n = prioridad n * 4
+        uint32_t inService = 0;
+        uint32_t taskPriority = 0;
+    };
+
+    uint64_t ReadRegister(uint64_t address);
+    void WriteRegister(uint64_t address, uint64_t value);
+    // Con mutex_ tomado: la línea del hilo tiene que activarse (algo pendiente por encima de la
+    // prioridad de tarea). Devuelve el bit del hilo para AssertLines, o 0.
+    uint32_t Update(int thread) const;
+    // Sin mutex_: llama a onAssert_ por cada hilo de threadMask
+    void AssertLines(uint32_t threadMask);
+
+    std::mutex mutex_;
+    std::array<ThreadState, MAX_THREADS> threads_{};
+    AssertHandler onAssert_;
+};
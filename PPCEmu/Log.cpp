@@ -0,0 +1,167 @@
+// Log.cpp
+#include "Log.h"
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <new>
+#include <thread>
+
+namespace {
+
+constexpr size_t RING_SIZE = 4096;     // potencia de 2
+constexpr size_t MESSAGE_SIZE = 256;
+
+const char* const LEVEL_PREFIX[] = {
+	"[TRACE]    ", "[DEBUG]    ", "[INFO]     ", "[WARNING]  ", "[ERROR]    ", "[CRITICAL] ",
+};
+const char* const CATEGORY_NAME[] = { "", "CPU", "MMU", "Memory", "JIT", "Display", "Loader", "System" };
+static_assert(sizeof(CATEGORY_NAME) / sizeof(CATEGORY_NAME[0]) == size_t(Log::Category::Count), "CATEGORY_NAME out of sync");
+
+// Cola MPSC acotada (Vyukov): cada slot lleva un número de secuencia que indica si está libre
+// (== posición de escritura) o listo para el consumidor (== posición + 1). Los productores sólo
+// hacen un CAS sobre head_; el único consumidor es el hilo writer_.
+class AsyncSink {
+public:
+	AsyncSink() {
+		for (size_t i = 0; i < RING_SIZE; ++i)
+			slots_[i].sequence.store(i, std::memory_order_relaxed);
+		writer_ = std::thread(&AsyncSink::Run, this);
+	}
+
+	~AsyncSink() {
+		stop_.store(true, std::memory_order_release);
+		writer_.join();
+	}
+
+	void Push(Log::Level level, Log::Category category, const char* fmt, va_list args) {
+		const bool must_deliver = level >= Log::Level::Warning;
+		uint64_t pos = head_.load(std::memory_order_relaxed);
+		Slot* slot;
+		while (true) {
+			slot = &slots_[pos & (RING_SIZE - 1)];
+			const uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+			const int64_t diff = int64_t(seq) - int64_t(pos);
+			if (diff == 0) {
+				if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+			}
+			else if (diff < 0) {
+				// Lleno: lo de poca importancia se descarta, el resto espera al consumidor
+				if (!must_deliver) {
+					dropped_.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+				std::this_thread::yield();
+				pos = head_.load(std::memory_order_relaxed);
+			}
+			else {
+				pos = head_.load(std::memory_order_relaxed);
+			}
+		}
+
+		slot->level = level;
+		slot->category = category;
+		vsnprintf(slot->text, MESSAGE_SIZE, fmt, args);
+		slot->sequence.store(pos + 1, std::memory_order_release);
+
+		if (level >= Log::Level::Error) WaitFor(pos + 1);
+	}
+
+	void Flush() { WaitFor(head_.load(std::memory_order_acquire)); }
+
+	// Hijo de fork(): writer_ es el handle de un hilo que en este proceso no existe. Se abandona
+	// (ni join ni destructor) y se arranca otro consumidor sobre la misma cola.
+	void RestartWriter() {
+		new (&writer_) std::thread(&AsyncSink::Run, this);
+	}
+
+	uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+	struct Slot {
+		std::atomic<uint64_t> sequence;
+		Log::Level level;
+		Log::Category category;
+		char text[MESSAGE_SIZE];
+	};
+
+	// Espera a que el consumidor haya escrito todo hasta la posición end (exclusiva)
+	void WaitFor(uint64_t end) {
+		while (tail_.load(std::memory_order_acquire) < end)
+			std::this_thread::yield();
+	}
+
+	// Devuelve false si no hay nada listo
+	bool Drain() {
+		bool wrote = false;
+		uint64_t pos = tail_.load(std::memory_order_relaxed);
+		while (true) {
+			Slot& slot = slots_[pos & (RING_SIZE - 1)];
+			if (slot.sequence.load(std::memory_order_acquire) != pos + 1) break;
+			const char* category = CATEGORY_NAME[size_t(slot.category)];
+			if (*category)
+				fprintf(stdout, "%s[%s] %s\n", LEVEL_PREFIX[size_t(slot.level)], category, slot.text);
+			else
+				fprintf(stdout, "%s%s\n", LEVEL_PREFIX[size_t(slot.level)], slot.text);
+			slot.sequence.store(pos + RING_SIZE, std::memory_order_release);
+			tail_.store(++pos, std::memory_order_release);
+			wrote = true;
+		}
+		if (wrote) fflush(stdout);
+		return wrote;
+	}
+
+	void Run() {
+		while (true) {
+			if (Drain()) continue;
+			if (stop_.load(std::memory_order_acquire)) {
+				Drain();
+				return;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	Slot slots_[RING_SIZE];
+	alignas(64) std::atomic<uint64_t> head_{ 0 };
+	alignas(64) std::atomic<uint64_t> tail_{ 0 };
+	std::atomic<uint64_t> dropped_{ 0 };
+	std::atomic<bool> stop_{ false };
+	std::thread writer_;
+};
+
+AsyncSink& Sink() {
+	static AsyncSink sink;
+	return sink;
+}
+
+} // namespace
+
+namespace Log {
+
+void Write(Level level, Category category, const char* fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	Sink().Push(level, category, fmt, args);
+	va_end(args);
+}
+
+void Flush() {
+	Sink().Flush();
+}
+
+void BeforeFork() {
+	Sink().Flush();
+	fflush(stdout);
+	std::cout.flush();
+}
+
+void AfterForkChild() {
+	Sink().RestartWriter();
+}
+
+uint64_t DroppedCount() {
+	return Sink().Dropped();
+}
+
+} // namespace Log
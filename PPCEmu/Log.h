@@ -1,7 +1,115 @@
+// Log.h
+#pragma once
+#include <cstdint>
 #include <iostream>
 
-#define LOG_INFO(system, msg, ...)    printf("[INFO]    " msg "\n", ##__VA_ARGS__)
-#define LOG_ERROR(system, msg, ...)    printf("[ERROR]    " msg "\n", ##__VA_ARGS__)
-#define LOG_WARNING(system, msg, ...) printf("[WARNING] " msg "\n", ##__VA_ARGS__)
-#define LOG_CRITICAL(system, msg, ...) printf("[CRITICAL] " msg "\n", ##__VA_ARGS__)
+// Niveles de log. Lo que est por debajo de PPC_LOG_LEVEL desaparece en compilacin
+// (los argumentos ni siquiera se evalan).
+#define PPC_LOG_LEVEL_TRACE    0
+#define PPC_LOG_LEVEL_DEBUG    1
+#define PPC_LOG_LEVEL_INFO     2
+#define PPC_LOG_LEVEL_WARNING  3
+#define PPC_LOG_LEVEL_ERROR    4
+#define PPC_LOG_LEVEL_CRITICAL 5
+#define PPC_LOG_LEVEL_OFF      6
+
+#ifndef PPC_LOG_LEVEL
+#ifdef NDEBUG
+#define PPC_LOG_LEVEL PPC_LOG_LEVEL_INFO
+#else
+#define PPC_LOG_LEVEL PPC_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+// Mscara de categoras habilitadas (bit = Log::Category), p.ej. /DPPC_LOG_CATEGORIES=0x6 para CPU+MMU
+#ifndef PPC_LOG_CATEGORIES
+#define PPC_LOG_CATEGORIES 0xFFFFFFFFu
+#endif
+
+namespace Log {
+
+enum class Level : uint8_t { Trace, Debug, Info, Warning, Error, Critical };
+enum class Category : uint8_t { General, CPU, MMU, Memory, JIT, Display, Loader, System, Count };
+
+// Compara el nombre del subsistema ("CPU" o "[CPU]") con name
+constexpr bool MatchName(const char* system, const char* name) {
+    if (*system == '[') ++system;
+    while (*name && *system == *name) { ++system; ++name; }
+    return *name == '\0' && (*system == '\0' || *system == ']');
+}
+
+// El argumento system de las macros LOG_* se resuelve a su categora en compilacin
+constexpr Category CategoryFromName(const char* system) {
+    return MatchName(system, "CPU") ? Category::CPU
+        : MatchName(system, "MMU") ? Category::MMU
+        : MatchName(system, "Memory") ? Category::Memory
+        : MatchName(system, "JIT") ? Category::JIT
+        : MatchName(system, "Display") ? Category::Display
+        : MatchName(system, "Loader") ? Category::Loader
+        : MatchName(system, "System") ? Category::System
+        : Category::General;
+}
+
+constexpr bool CategoryEnabled(Category category) {
+    return ((PPC_LOG_CATEGORIES) >> unsigned(category)) & 1u;
+}
+
+// Formatea en el hilo que llama y encola en el ring buffer; un hilo aparte hace la E/S.
+// Warning o superior nunca se descarta; Error y Critical esperan a que el mensaje salga.
+void Write(Level level, Category category, const char* fmt, ...);
+// Espera a que se escriba todo lo encolado hasta ahora
+void Flush();
+// fork(): antes, en el padre, vaca la cola y los buffers de stdout/std::cout (si no, el hijo
+// los repetira); despus, en el hijo, arranca otra vez el hilo escritor, que fork() no copia
+void BeforeFork();
+void AfterForkChild();
+// Mensajes Trace/Debug/Info perdidos por ring buffer lleno
+uint64_t DroppedCount();
+
+// Nivel compilado fuera: slo para sizeof, as los argumentos se comprueban y cuentan como usados
+// sin evaluarse
+template <typename... Args>
+int Discard(const char* fmt, const Args&... args);
+
+} // namespace Log
+
+#define PPC_LOG(level, system, msg, ...) do { \
+        constexpr ::Log::Category ppc_log_category_ = ::Log::CategoryFromName(system); \
+        if constexpr (::Log::CategoryEnabled(ppc_log_category_)) \
+            ::Log::Write(level, ppc_log_category_, msg, ##__VA_ARGS__); \
+    } while (0)
+
+#define PPC_LOG_DISCARD(msg, ...) ((void)sizeof(::Log::Discard(msg, ##__VA_ARGS__)))
+
+#if PPC_LOG_LEVEL <= PPC_LOG_LEVEL_TRACE
+#define LOG_TRACE(system, msg, ...)    PPC_LOG(::Log::Level::Trace, system, msg, ##__VA_ARGS__)
+#else
+#define LOG_TRACE(system, msg, ...)    PPC_LOG_DISCARD(msg, ##__VA_ARGS__)
+#endif
+#if PPC_LOG_LEVEL <= PPC_LOG_LEVEL_DEBUG
+#define LOG_DEBUG(system, msg, ...)    PPC_LOG(::Log::Level::Debug, system, msg, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(system, msg, ...)    PPC_LOG_DISCARD(msg, ##__VA_ARGS__)
+#endif
+#if PPC_LOG_LEVEL <= PPC_LOG_LEVEL_INFO
+#define LOG_INFO(system, msg, ...)     PPC_LOG(::Log::Level::Info, system, msg, ##__VA_ARGS__)
+#else
+#define LOG_INFO(system, msg, ...)     PPC_LOG_DISCARD(msg, ##__VA_ARGS__)
+#endif
+#if PPC_LOG_LEVEL <= PPC_LOG_LEVEL_WARNING
+#define LOG_WARNING(system, msg, ...)  PPC_LOG(::Log::Level::Warning, system, msg, ##__VA_ARGS__)
+#else
+#define LOG_WARNING(system, msg, ...)  PPC_LOG_DISCARD(msg, ##__VA_ARGS__)
+#endif
+#if PPC_LOG_LEVEL <= PPC_LOG_LEVEL_ERROR
+#define LOG_ERROR(system, msg, ...)    PPC_LOG(::Log::Level::Error, system, msg, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(system, msg, ...)    PPC_LOG_DISCARD(msg, ##__VA_ARGS__)
+#endif
+#if PPC_LOG_LEVEL <= PPC_LOG_LEVEL_CRITICAL
+#define LOG_CRITICAL(system, msg, ...) PPC_LOG(::Log::Level::Critical, system, msg, ##__VA_ARGS__)
+#else
+#define LOG_CRITICAL(system, msg, ...) PPC_LOG_DISCARD(msg, ##__VA_ARGS__)
+#endif
+
 #define SYSTEM_PAUSE() std::cin.get()
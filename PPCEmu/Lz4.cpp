@@ -0,0 +1,149 @@
+// Lz4.cpp
+#include "Lz4.h"
+#include <cstring>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;  // el bloque termina siempre con al menos 5 literales
+constexpr size_t MF_LIMIT = 12;      // y la última coincidencia empieza 12 bytes antes del final
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_LOG = 13;
+constexpr int SKIP_TRIGGER = 6;      // tras 2^6 fallos seguidos el paso de búsqueda crece
+
+uint32_t Load32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+uint64_t Load64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761u) >> (32 - HASH_LOG); }
+
+int CountTrailingZeros(uint64_t v) {
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanForward64(&index, v);
+	return int(index);
+#else
+	return __builtin_ctzll(v);
+#endif
+}
+
+// Longitud como 4 bits del token + bytes de 255 + resto
+uint8_t* WriteLength(uint8_t* op, size_t length) {
+	for (length -= 15; length >= 255; length -= 255) *op++ = 255;
+	*op++ = uint8_t(length);
+	return op;
+}
+
+uint8_t* WriteSequence(uint8_t* op, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) {
+	uint8_t* token = op++;
+	*token = uint8_t((literalCount < 15 ? literalCount : 15) << 4);
+	if (literalCount >= 15) op = WriteLength(op, literalCount);
+	std::memcpy(op, literals, literalCount);
+	op += literalCount;
+	if (!matchLength) return op; // última secuencia: sólo literales
+	*op++ = uint8_t(offset);
+	*op++ = uint8_t(offset >> 8);
+	const size_t m = matchLength - MIN_MATCH;
+	*token |= uint8_t(m < 15 ? m : 15);
+	if (m >= 15) op = WriteLength(op, m);
+	return op;
+}
+
+// Longitud extendida: bytes que se suman mientras valgan 255
+bool ReadLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+	uint8_t b;
+	do {
+		if (ip >= end) return false;
+		b = *ip++;
+		length += b;
+	} while (b == 255);
+	return true;
+}
+
+} // namespace
+
+size_t Lz4Compress(const uint8_t* src, size_t size, uint8_t* dst) {
+	const uint8_t* const end = src + size;
+	const uint8_t* anchor = src;
+	uint8_t* op = dst;
+
+	if (size > MF_LIMIT) {
+		// Posiciones (relativas a src) de la última aparición de cada hash de 4 bytes
+		uint32_t table[1 << HASH_LOG] = {};
+		const uint8_t* const matchLimit = end - LAST_LITERALS;
+		const uint8_t* const mfLimit = end - MF_LIMIT;
+		const uint8_t* ip = src + 1;
+
+		while (ip < mfLimit) {
+			// Búsqueda: el paso crece con los fallos, así los datos incompresibles pasan rápido
+			const uint8_t* match;
+			uint32_t attempts = 1u << SKIP_TRIGGER;
+			for (;;) {
+				const uint32_t h = Hash(Load32(ip));
+				match = src + table[h];
+				table[h] = uint32_t(ip - src);
+				if (size_t(ip - match) <= MAX_OFFSET && Load32(match) == Load32(ip)) break;
+				ip += attempts++ >> SKIP_TRIGGER;
+				if (ip >= mfLimit) goto last_literals;
+			}
+			// Extender hacia atrás sobre los literales pendientes y hacia delante
+			while (ip > anchor && match > src && ip[-1] == match[-1]) { --ip; --match; }
+			const uint8_t* p = ip + MIN_MATCH;
+			const uint8_t* m = match + MIN_MATCH;
+			while (p + 8 <= matchLimit) {
+				const uint64_t diff = Load64(p) ^ Load64(m);
+				if (diff) { p += CountTrailingZeros(diff) >> 3; goto match_end; }
+				p += 8;
+				m += 8;
+			}
+			while (p < matchLimit && *p == *m) { ++p; ++m; }
+		match_end:
+			op = WriteSequence(op, anchor, size_t(ip - anchor), size_t(ip - match), size_t(p - ip));
+			ip = anchor = p;
+			if (ip < mfLimit) table[Hash(Load32(ip - 2))] = uint32_t(ip - 2 - src);
+		}
+	}
+last_literals:
+	return size_t(WriteSequence(op, anchor, size_t(end - anchor), 0, 0) - dst);
+}
+
+bool Lz4Decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t dstSize) {
+	const uint8_t* ip = src;
+	const uint8_t* const end = src + size;
+	uint8_t* op = dst;
+	uint8_t* const outEnd = dst + dstSize;
+
+	while (ip < end) {
+		const uint8_t token = *ip++;
+		size_t literals = token >> 4;
+		if (literals == 15 && !ReadLength(ip, end, literals)) return false;
+		if (literals > size_t(end - ip) || literals > size_t(outEnd - op)) return false;
+		std::memcpy(op, ip, literals);
+		op += literals;
+		ip += literals;
+		if (ip == end) break; // la última secuencia no lleva coincidencia
+
+		if (end - ip < 2) return false;
+		const size_t offset = size_t(ip[0]) | size_t(ip[1]) << 8;
+		ip += 2;
+		size_t length = token & 15;
+		if (length == 15 && !ReadLength(ip, end, length)) return false;
+		length += MIN_MATCH;
+		if (!offset || offset > size_t(op - dst) || length > size_t(outEnd - op)) return false;
+
+		const uint8_t* match = op - offset;
+		if (offset >= length) std::memcpy(op, match, length);
+		else {
+			// Solapa: la salida repite un patrón de offset bytes. Tras los primeros step bytes (un
+			// múltiplo de offset >= 8) se copia de 8 en 8 desde step bytes atrás, ya escritos.
+			const size_t step = offset >= 8 ? offset : offset * ((8 + offset - 1) / offset);
+			size_t i = 0;
+			for (; i < step && i < length; ++i) op[i] = match[i];
+			for (; i + 8 <= length; i += 8) std::memcpy(op + i, op + i - step, 8);
+			for (; i < length; ++i) op[i] = match[i];
+		}
+		op += length;
+	}
+	return op == outEnd;
+}
@@ -0,0 +1,18 @@
+// Lz4.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Compresión LZ4, formato de bloque (secuencias token/literales/offset/longitud, sin cabecera de
+// frame ni checksums). Rápida en los dos sentidos, pensada para páginas de RAM en los snapshots:
+// cada bloque se comprime y descomprime por separado, así que se reparten entre hilos.
+
+// Tamaño máximo que puede ocupar size bytes comprimidos (datos incompresibles)
+inline size_t Lz4CompressBound(size_t size) { return size + size / 255 + 16; }
+
+// Comprime src en dst (al menos Lz4CompressBound(size) bytes); devuelve el tamaño comprimido
+size_t Lz4Compress(const uint8_t* src, size_t size, uint8_t* dst);
+
+// Descomprime un bloque que tiene que dar exactamente dstSize bytes. false si no es válido
+// (nunca lee ni escribe fuera de los buffers).
+bool Lz4Decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t dstSize);
@@ -0,0 +1,341 @@
+// LzxDecoder.cpp
+#include "LzxDecoder.h"
+#include "Endian.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+enum BlockType { BLOCK_VERBATIM = 1, BLOCK_ALIGNED = 2, BLOCK_UNCOMPRESSED = 3 };
+
+constexpr uint32_t MIN_MATCH = 2;
+constexpr uint32_t NUM_PRIMARY_LENGTHS = 7;
+constexpr size_t NUM_CHARS = 256;
+constexpr size_t PRETREE_SIZE = 20;
+constexpr size_t LENGTH_TREE_SIZE = 249;
+constexpr size_t ALIGNED_TREE_SIZE = 8;
+constexpr int MAX_POSITION_SLOTS = 50;
+
+// Bits extra y base de cada position slot
+struct PositionSlots {
+	uint8_t extra[MAX_POSITION_SLOTS];
+	uint32_t base[MAX_POSITION_SLOTS];
+	PositionSlots() {
+		uint32_t base_ = 0;
+		for (int i = 0; i < MAX_POSITION_SLOTS; ++i) {
+			extra[i] = uint8_t(i < 4 ? 0 : (std::min)((i - 2) / 2, 17));
+			base[i] = base_;
+			base_ += 1u << extra[i];
+		}
+	}
+};
+const PositionSlots SLOTS;
+
+// Ventanas de 2^15 a 2^21
+int PositionSlotCount(uint32_t windowSize) {
+	static const int slots[] = { 30, 32, 34, 36, 38, 42, 50 };
+	for (int bits = 15; bits <= 21; ++bits)
+		if (windowSize == 1u << bits) return slots[bits - 15];
+	throw std::runtime_error("LZX: invalid window size " + std::to_string(windowSize));
+}
+
+} // namespace
+
+LzxDecoder::LzxDecoder(uint32_t windowSize)
+	: windowSize_(windowSize),
+	main_(NUM_CHARS + size_t(PositionSlotCount(windowSize)) * 8),
+	length_(LENGTH_TREE_SIZE),
+	aligned_(ALIGNED_TREE_SIZE),
+	pretree_(PRETREE_SIZE) {
+	window_.resize(windowSize_);
+}
+
+void LzxDecoder::Huffman::Build() {
+	std::fill(std::begin(count), std::end(count), uint16_t(0));
+	for (uint8_t l : lengths) ++count[l];
+	count[0] = 0;
+	fast.assign(size_t(1) << FAST_BITS, 0);
+	sorted.clear();
+	empty = std::all_of(lengths.begin(), lengths.end(), [](uint8_t l) { return l == 0; });
+	if (empty) return; // válido mientras no se use (p.ej. árbol de longitudes sin coincidencias largas)
+
+	int left = 1;
+	for (int len = 1; len <= MAX_CODE_LENGTH; ++len) {
+		left = (left << 1) - count[len];
+		if (left < 0) throw std::runtime_error("LZX: oversubscribed Huffman table");
+	}
+	if (left > 0) throw std::runtime_error("LZX: incomplete Huffman table");
+
+	uint16_t offsets[MAX_CODE_LENGTH + 2] = {};
+	for (int len = 1; len <= MAX_CODE_LENGTH; ++len) offsets[len + 1] = uint16_t(offsets[len] + count[len]);
+	sorted.resize(offsets[MAX_CODE_LENGTH + 1]);
+	for (size_t sym = 0; sym < lengths.size(); ++sym)
+		if (lengths[sym]) sorted[offsets[lengths[sym]]++] = uint16_t(sym);
+
+	// Códigos canónicos cortos: todas las entradas que empiezan por el código
+	uint32_t code = 0, index = 0;
+	for (int len = 1; len <= FAST_BITS; ++len) {
+		for (int i = 0; i < count[len]; ++i, ++code) {
+			const uint16_t entry = uint16_t(sorted[index++] << 5 | len);
+			const uint32_t first = code << (FAST_BITS - len), last = (code + 1) << (FAST_BITS - len);
+			std::fill(fast.begin() + first, fast.begin() + last, entry);
+		}
+		code <<= 1;
+	}
+}
+
+uint8_t LzxDecoder::NextByte() {
+	if (pushbackCount_) return pushback_[2 - pushbackCount_--];
+	while (in_ == inEnd_) {
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+		if (!(*input_)(data, size)) {
+			// Como mspack: unos pocos ceros tras el final, por si el último frame se lee de más
+			if (++padding_ > 16) throw std::runtime_error("LZX: input truncated");
+			return 0;
+		}
+		in_ = data;
+		inEnd_ = data + size;
+	}
+	return *in_++;
+}
+
+void LzxDecoder::EnsureBits(int n) {
+	while (bitsLeft_ < n) {
+		const uint32_t lo = NextByte();
+		const uint32_t hi = NextByte();
+		bitBuffer_ |= (hi << 8 | lo) << (16 - bitsLeft_);
+		bitsLeft_ += 16;
+	}
+}
+
+uint32_t LzxDecoder::ReadBits(int n) {
+	if (!n) return 0;
+	EnsureBits(n);
+	const uint32_t v = bitBuffer_ >> (32 - n);
+	RemoveBits(n);
+	return v;
+}
+
+uint32_t LzxDecoder::Decode(const Huffman& h) {
+	EnsureBits(MAX_CODE_LENGTH);
+	const uint32_t peek = bitBuffer_ >> (32 - MAX_CODE_LENGTH);
+	if (const uint16_t entry = h.fast[peek >> (MAX_CODE_LENGTH - FAST_BITS)]) {
+		RemoveBits(entry & 31);
+		return entry >> 5;
+	}
+	// Código largo: recorrido canónico por longitudes (como puff de zlib)
+	int code = 0, first = 0, index = 0;
+	for (int len = 1; len <= MAX_CODE_LENGTH; ++len) {
+		code |= (peek >> (MAX_CODE_LENGTH - len)) & 1;
+		const int count = h.count[len];
+		if (code - first < count) {
+			RemoveBits(len);
+			return h.sorted[index + code - first];
+		}
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+	throw std::runtime_error(h.empty ? "LZX: symbol from an empty Huffman table" : "LZX: invalid Huffman code");
+}
+
+void LzxDecoder::AlignToBytes() {
+	// Se descartan de 1 a 16 bits; si ya se había leído la palabra siguiente entera, se devuelve
+	if (bitsLeft_ == 0) EnsureBits(16);
+	if (bitsLeft_ > 16) {
+		const uint32_t word = (bitBuffer_ >> (32 - bitsLeft_)) & 0xFFFF;
+		pushback_[0] = uint8_t(word);
+		pushback_[1] = uint8_t(word >> 8);
+		pushbackCount_ = 2;
+	}
+	bitBuffer_ = 0;
+	bitsLeft_ = 0;
+}
+
+// Longitudes de un rango del árbol, codificadas con el pretree como deltas sobre las anteriores
+void LzxDecoder::ReadLengths(Huffman& h, size_t first, size_t last) {
+	for (size_t i = 0; i < PRETREE_SIZE; ++i) pretree_.lengths[i] = uint8_t(ReadBits(4));
+	pretree_.Build();
+	auto delta = [&](size_t x, uint32_t z) { return uint8_t((h.lengths[x] + 17 - z) % 17); };
+	for (size_t x = first; x < last;) {
+		const uint32_t z = Decode(pretree_);
+		uint32_t run;
+		uint8_t value = 0;
+		if (z == 17) run = ReadBits(4) + 4;
+		else if (z == 18) run = ReadBits(5) + 20;
+		else if (z == 19) {
+			run = ReadBits(1) + 4;
+			value = delta(x, Decode(pretree_));
+		}
+		else {
+			h.lengths[x] = delta(x, z);
+			++x;
+			continue;
+		}
+		if (run > last - x) throw std::runtime_error("LZX: code length run overflows the table");
+		std::fill_n(h.lengths.begin() + x, run, value);
+		x += run;
+	}
+}
+
+void LzxDecoder::ReadBlockHeader() {
+	// Un bloque sin comprimir de longitud impar lleva un byte de relleno
+	if (blockType_ == BLOCK_UNCOMPRESSED && (blockLength_ & 1)) NextByte();
+
+	blockType_ = int(ReadBits(3));
+	const uint32_t hi = ReadBits(16);
+	const uint32_t lo = ReadBits(8);
+	blockLength_ = blockRemaining_ = hi << 8 | lo;
+	if (!blockLength_) throw std::runtime_error("LZX: empty block");
+
+	switch (blockType_) {
+	case BLOCK_ALIGNED:
+		for (size_t i = 0; i < ALIGNED_TREE_SIZE; ++i) aligned_.lengths[i] = uint8_t(ReadBits(3));
+		aligned_.Build();
+		[[fallthrough]]; // el resto como en verbatim
+	case BLOCK_VERBATIM:
+		ReadLengths(main_, 0, NUM_CHARS);
+		ReadLengths(main_, NUM_CHARS, main_.lengths.size());
+		main_.Build();
+		if (main_.lengths[0xE8]) intelStarted_ = true;
+		ReadLengths(length_, 0, LENGTH_TREE_SIZE);
+		length_.Build();
+		break;
+	case BLOCK_UNCOMPRESSED: {
+		intelStarted_ = true;
+		AlignToBytes();
+		uint8_t r[12];
+		for (uint8_t& b : r) b = NextByte();
+		for (int i = 0; i < 3; ++i) r_[i] = LoadLE32(r + 4 * i);
+		break;
+	}
+	default:
+		throw std::runtime_error("LZX: invalid block type " + std::to_string(blockType_));
+	}
+}
+
+uint32_t LzxDecoder::DecodeRun(uint32_t run) {
+	const uint32_t mask = windowSize_ - 1;
+	uint8_t* window = window_.data();
+	uint32_t done = 0;
+
+	if (blockType_ == BLOCK_UNCOMPRESSED) {
+		for (; done < run; ++done, ++pos_) window[pos_ & mask] = NextByte();
+		return done;
+	}
+
+	while (done < run) {
+		uint32_t sym = Decode(main_);
+		if (sym < NUM_CHARS) {
+			window[pos_ & mask] = uint8_t(sym);
+			++pos_;
+			++done;
+			continue;
+		}
+
+		sym -= NUM_CHARS;
+		uint32_t length = sym & 7;
+		if (length == NUM_PRIMARY_LENGTHS) length += Decode(length_);
+		length += MIN_MATCH;
+
+		const uint32_t slot = sym >> 3;
+		uint32_t offset;
+		if (slot < 3) {
+			// R0, R1 o R2: el usado pasa a R0
+			offset = r_[slot];
+			r_[slot] = r_[0];
+			r_[0] = offset;
+		}
+		else {
+			const int extra = SLOTS.extra[slot];
+			offset = SLOTS.base[slot] - 2;
+			if (blockType_ == BLOCK_ALIGNED && extra >= 3) {
+				offset += ReadBits(extra - 3) << 3;
+				offset += Decode(aligned_);
+			}
+			else offset += ReadBits(extra);
+			r_[2] = r_[1];
+			r_[1] = r_[0];
+			r_[0] = offset;
+		}
+
+		if (offset > pos_ || offset > windowSize_)
+			throw std::runtime_error("LZX: match offset beyond the start of the stream");
+		const uint32_t dst = uint32_t(pos_ & mask);
+		if (dst + length > windowSize_)
+			throw std::runtime_error("LZX: match runs over the end of the window");
+		// Byte a byte: origen y destino pueden solapar (offset < length)
+		const uint32_t src = uint32_t((pos_ - offset) & mask);
+		for (uint32_t i = 0; i < length; ++i) window[dst + i] = window[(src + i) & mask];
+		pos_ += length;
+		done += length;
+	}
+	return done;
+}
+
+void LzxDecoder::Decompress(uint64_t outputSize, const InputFn& input, const OutputFn& output) {
+	input_ = &input;
+	in_ = inEnd_ = nullptr;
+	pushbackCount_ = 0;
+	padding_ = 0;
+	bitBuffer_ = 0;
+	bitsLeft_ = 0;
+	pos_ = 0;
+	r_[0] = r_[1] = r_[2] = 1;
+	blockType_ = 0;
+	blockLength_ = blockRemaining_ = 0;
+	intelStarted_ = false;
+	intelFileSize_ = 0;
+	std::fill(main_.lengths.begin(), main_.lengths.end(), uint8_t(0));
+	std::fill(length_.lengths.begin(), length_.lengths.end(), uint8_t(0));
+
+	// Cabecera del flujo: traducción E8 y tamaño de fichero que usa
+	if (ReadBits(1)) {
+		const uint32_t hi = ReadBits(16);
+		const uint32_t lo = ReadBits(16);
+		intelFileSize_ = int32_t(hi << 16 | lo);
+	}
+
+	const uint32_t mask = windowSize_ - 1;
+	uint64_t frameStart = 0;
+	for (uint64_t frame = 0; frameStart < outputSize; ++frame) {
+		const uint32_t frameSize = uint32_t((std::min<uint64_t>)(FRAME_SIZE, outputSize - frameStart));
+		const uint64_t frameEnd = frameStart + frameSize;
+		while (pos_ < frameEnd) {
+			if (!blockRemaining_) ReadBlockHeader();
+			const uint32_t run = uint32_t((std::min<uint64_t>)(blockRemaining_, frameEnd - pos_));
+			const uint32_t done = DecodeRun(run);
+			if (done > blockRemaining_) throw std::runtime_error("LZX: match runs past the end of the block");
+			blockRemaining_ -= done;
+		}
+
+		// Cada frame termina alineado a 16 bits
+		if (bitsLeft_ > 0) EnsureBits(16);
+		if (bitsLeft_ & 15) RemoveBits(bitsLeft_ & 15);
+
+		// Traducción de llamadas x86 (E8 + destino absoluto) si la pide la cabecera; sobre una copia,
+		// la ventana se queda como estaba
+		uint8_t* data = window_.data() + (frameStart & mask);
+		if (intelStarted_ && intelFileSize_ && frame < 32768 && frameSize > 10) {
+			e8Buffer_.assign(data, data + frameSize);
+			int32_t cur = int32_t(frameStart);
+			for (uint32_t i = 0; i < frameSize - 10;) {
+				if (e8Buffer_[i] != 0xE8) {
+					++i;
+					++cur;
+					continue;
+				}
+				const int32_t abs = int32_t(LoadLE32(&e8Buffer_[i + 1]));
+				if (abs >= -cur && abs < intelFileSize_)
+					StoreLE32(&e8Buffer_[i + 1], uint32_t(abs >= 0 ? abs - cur : abs + intelFileSize_));
+				i += 5;
+				cur += 5;
+			}
+			output(e8Buffer_.data(), frameSize);
+		}
+		else output(data, frameSize);
+		frameStart = frameEnd;
+	}
+}
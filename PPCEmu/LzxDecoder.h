@@ -0,0 +1,81 @@
+// LzxDecoder.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Descompresor LZX (el de los CAB y XCompress, que usan las imágenes XEX2 comprimidas).
+// La entrada llega en trozos por un callback (los chunks de cada bloque del XEX, ya descifrados) y
+// la salida sale frame a frame (32 KiB) por otro: la memoria que usa es la ventana (32 KiB a 2 MiB),
+// nunca la imagen entera. Los frames comparten la ventana, así que no se pueden descomprimir en paralelo.
+class LzxDecoder {
+public:
+    // Siguiente trozo de entrada comprimida; false = no hay más
+    using InputFn = std::function<bool(const uint8_t*& data, size_t& size)>;
+    // Bytes descomprimidos, en orden
+    using OutputFn = std::function<void(const uint8_t* data, size_t size)>;
+
+    // windowSize: potencia de 2 entre 32 KiB y 2 MiB
+    explicit LzxDecoder(uint32_t windowSize);
+
+    // Descomprime outputSize bytes. Lanza std::runtime_error si el flujo no es válido.
+    void Decompress(uint64_t outputSize, const InputFn& input, const OutputFn& output);
+
+    static constexpr uint32_t FRAME_SIZE = 32768;
+
+private:
+    static constexpr int MAX_CODE_LENGTH = 16;
+    static constexpr int FAST_BITS = 10;
+
+    // Código de Huffman canónico: tabla directa para los códigos de hasta FAST_BITS bits y
+    // recorrido por longitudes para el resto
+    struct Huffman {
+        std::vector<uint8_t> lengths; // se conservan entre bloques (los nuevos van en delta)
+        std::vector<uint16_t> fast;   // símbolo << 5 | longitud; 0 = código más largo que FAST_BITS
+        std::vector<uint16_t> sorted; // símbolos por (longitud, valor)
+        uint16_t count[MAX_CODE_LENGTH + 1] = {};
+        bool empty = true;
+        explicit Huffman(size_t symbols) : lengths(symbols, 0) {}
+        void Build();
+    };
+
+    // Entrada: palabras de 16 bits little-endian, bits del más significativo al menos
+    uint8_t NextByte();
+    void EnsureBits(int n);
+    uint32_t ReadBits(int n);
+    void RemoveBits(int n) { bitBuffer_ <<= n; bitsLeft_ -= n; }
+    uint32_t Decode(const Huffman& h);
+    // Alinea a byte para un bloque sin comprimir, devolviendo la palabra leída de más
+    void AlignToBytes();
+
+    void ReadLengths(Huffman& h, size_t first, size_t last);
+    void ReadBlockHeader();
+    // Descomprime al menos run bytes del bloque actual (una coincidencia puede pasarse); devuelve cuántos
+    uint32_t DecodeRun(uint32_t run);
+
+    uint32_t windowSize_;
+    std::vector<uint8_t> window_;
+    std::vector<uint8_t> e8Buffer_; // frame con la traducción E8 aplicada
+    Huffman main_;
+    Huffman length_;
+    Huffman aligned_;
+    Huffman pretree_;
+
+    const InputFn* input_ = nullptr;
+    const uint8_t* in_ = nullptr;
+    const uint8_t* inEnd_ = nullptr;
+    uint8_t pushback_[2] = {};
+    int pushbackCount_ = 0;
+    int padding_ = 0;          // bytes a cero entregados tras el final de la entrada
+    uint32_t bitBuffer_ = 0;
+    int bitsLeft_ = 0;
+
+    uint64_t pos_ = 0;         // bytes descomprimidos (la ventana es pos_ & (windowSize_ - 1))
+    uint32_t r_[3] = { 1, 1, 1 };
+    int blockType_ = 0;
+    uint32_t blockLength_ = 0;
+    uint32_t blockRemaining_ = 0;
+    bool intelStarted_ = false;
+    int32_t intelFileSize_ = 0;
+};
@@ -1,14 +1,97 @@
 ﻿// MMU.cpp
 #include "MMU.h"
+#include "Endian.h"
 #include "Log.h"
+#include "Replay.h"
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <stdexcept>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 constexpr size_t ALIGN_2 = 2;
 constexpr size_t ALIGN_4 = 4;
 constexpr size_t ALIGN_8 = 8;
 
+// Puntero del host para [addr, addr+size) si la región es RAM y el rango cabe en ella
+static inline uint8_t* RegionHost(const MemoryRegion* region, uint64_t addr, uint64_t size) {
+	if (!region->host || addr + size > region->virtual_end) return nullptr;
+	return region->host + (addr - region->virtual_start);
+}
+
+// Igual, para escribir: marca las páginas sucias si el dispositivo las lleva
+static inline uint8_t* RegionHostWrite(const MemoryRegion* region, uint64_t addr, uint64_t size) {
+	uint8_t* p = RegionHost(region, addr, size);
+	if (p && region->dirty) MarkDirtyPages(region->dirty, addr - region->virtual_start + region->physical_start, size);
+	return p;
+}
+
+// Record/replay: lo leído de un dispositivo que depende del host es una entrada del guest
+static inline uint64_t DeviceInput(ReplayLog* replay, const MemoryRegion* region, uint64_t value) {
+	if (!replay || !region->device->ReadsDependOnHost()) return value;
+	return replay->Input(ReplayLog::EVENT_MMIO_READ, value);
+}
+
+// Estado común a las MMU de todos los hilos de hardware (una sola si no hay SMP)
+struct MMUShared {
+	static constexpr size_t CODE_PAGE_WORDS = (1ull << (32 - MMU::CODE_PAGE_SHIFT)) / 64;
+	std::unique_ptr<std::atomic<uint64_t>[]> code_pages{ new std::atomic<uint64_t>[CODE_PAGE_WORDS]() };
+	std::mutex device_mutex;
+	std::mutex views_mutex;
+	std::vector<MMU*> views;
+	std::atomic<bool> smp{ false };
+	XenonReservations reservations;
+};
+
+// CAS sobre memoria del host (big-endian ya aplicado por el llamador)
+static inline bool HostCompareExchange32(uint8_t* p, uint32_t expected, uint32_t desired) {
+#if defined(_MSC_VER)
+	return _InterlockedCompareExchange(reinterpret_cast<volatile long*>(p), long(desired), long(expected)) == long(expected);
+#else
+	return __atomic_compare_exchange_n(reinterpret_cast<uint32_t*>(p), &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline bool HostCompareExchange64(uint8_t* p, uint64_t expected, uint64_t desired) {
+#if defined(_MSC_VER)
+	return _InterlockedCompareExchange64(reinterpret_cast<volatile long long*>(p), (long long)desired, (long long)expected) == (long long)expected;
+#else
+	return __atomic_compare_exchange_n(reinterpret_cast<uint64_t*>(p), &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+MMU::MMU() : shared_(std::make_shared<MMUShared>()) {
+	code_pages_ = shared_->code_pages.get();
+	reservations_ = &shared_->reservations;
+	shared_->views.push_back(this);
+}
+
+MMU::~MMU() {
+	std::lock_guard<std::mutex> lock(shared_->views_mutex);
+	auto& views = shared_->views;
+	views.erase(std::remove(views.begin(), views.end(), this), views.end());
+}
+
+std::unique_ptr<MMU> MMU::CreateThreadView() {
+	std::unique_ptr<MMU> view(new MMU());
+	view->shared_ = shared_;
+	view->code_pages_ = shared_->code_pages.get();
+	view->reservations_ = &shared_->reservations;
+	view->regions = regions;
+	view->verbose_logging_ = verbose_logging_;
+	std::lock_guard<std::mutex> lock(shared_->views_mutex);
+	shared_->views.push_back(view.get());
+	shared_->smp.store(true, std::memory_order_relaxed);
+	return view;
+}
+
+std::unique_lock<std::mutex> MMU::LockDevice() {
+	if (!shared_->smp.load(std::memory_order_relaxed)) return std::unique_lock<std::mutex>();
+	return std::unique_lock<std::mutex>(shared_->device_mutex);
+}
+
 void MMU::MapMemory(std::shared_ptr<MemoryDevice> device,
 	uint64_t virtual_start,
 	uint64_t virtual_end,
@@ -16,6 +99,20 @@ void MMU::MapMemory(std::shared_ptr<MemoryDevice> device,
 	bool readable,
 	bool writable,
 	bool executable) {
+	if (virtual_end <= virtual_start) {
+		LOG_WARNING("MMU", "MapMemory: empty range 0x%016llX-0x%016llX for %s, ignored",
+			virtual_start, virtual_end, device->GetName().c_str());
+		return;
+	}
+	const size_t index = RegionIndex(virtual_start);
+	if (index < regions.size() && regions[index].virtual_start < virtual_end) {
+		const MemoryRegion& other = regions[index];
+		char ranges[96];
+		snprintf(ranges, sizeof(ranges), " 0x%016llX-0x%016llX overlaps 0x%016llX-0x%016llX ",
+			(unsigned long long)virtual_start, (unsigned long long)virtual_end,
+			(unsigned long long)other.virtual_start, (unsigned long long)other.virtual_end);
+		throw std::runtime_error("MMU: " + device->GetName() + ranges + other.device->GetName());
+	}
 	MemoryRegion region;
 	region.device = device;
 	region.virtual_start = virtual_start;
@@ -24,140 +121,509 @@ void MMU::MapMemory(std::shared_ptr<MemoryDevice> device,
 	region.readable = readable;
 	region.writable = writable;
 	region.executable = executable;
-	regions.push_back(region);
-	LOG_INFO("MMU", "Mapped region 0x%016llX-0x%016llX to %s, readable=%d, writable=%d, executable=%d",
-		virtual_start, virtual_end, device->GetName().c_str(), readable, writable, executable);
-	std::cout << "[DEBUG] MMU::MapMemory: Added region 0x" << std::hex << virtual_start
-		<< "-0x" << virtual_end << ", physical_start=0x" << physical_start
-		<< ", device=" << device->GetName() << ", total regions=" << regions.size() << std::dec << "\n";
+	if (writable && device->IsReadOnly()) {
+		LOG_WARNING("MMU", "MapMemory: %s is read-only, mapping 0x%016llX-0x%016llX without write access",
+			device->GetName().c_str(), virtual_start, virtual_end);
+		region.writable = false;
+	}
+	// RAM si el dispositivo da memoria del host contigua para toda la región; si no, MMIO
+	if (device->IsDirectMapped() && virtual_end > virtual_start &&
+		physical_start + (virtual_end - virtual_start) <= device->GetSize()) {
+		region.host = device->GetPointerToAddress(physical_start);
+		region.dirty = device->GetDirtyPages();
+	}
+	InsertRegion(region);
+	LOG_INFO("MMU", "Mapped region 0x%016llX-0x%016llX to %s (%s), readable=%d, writable=%d, executable=%d",
+		virtual_start, virtual_end, device->GetName().c_str(), region.host ? "RAM" : "MMIO", readable, region.writable, executable);
+	LOG_DEBUG("MMU", "MapMemory: physical_start=0x%016llX, total regions=%zu", physical_start, regions.size());
+}
+
+void MMU::RemapMemory(std::shared_ptr<MemoryDevice> device,
+	uint64_t virtual_start,
+	uint64_t virtual_end,
+	uint64_t physical_start,
+	bool readable,
+	bool writable,
+	bool executable) {
+	UnmapMemory(virtual_start, virtual_end);
+	MapMemory(std::move(device), virtual_start, virtual_end, physical_start, readable, writable, executable);
+}
+
+void MMU::UnmapMemory(uint64_t virtual_start, uint64_t virtual_end) {
+	if (virtual_end <= virtual_start) return;
+	const size_t first = RegionIndex(virtual_start);
+	size_t last = first;
+	while (last < regions.size() && regions[last].virtual_start < virtual_end) ++last;
+	if (last == first) return;
+
+	// Las regiones de los extremos pueden salirse del rango: se queda la parte de fuera
+	const MemoryRegion head = regions[first];
+	const MemoryRegion tail = regions[last - 1];
+	regions.erase(regions.begin() + first, regions.begin() + last);
+	if (tail.virtual_end > virtual_end) {
+		MemoryRegion rest = tail;
+		const uint64_t cut = virtual_end - tail.virtual_start;
+		rest.virtual_start = virtual_end;
+		rest.physical_start += cut;
+		if (rest.host) rest.host += cut;
+		regions.insert(regions.begin() + first, rest);
+	}
+	if (head.virtual_start < virtual_start) {
+		MemoryRegion rest = head;
+		rest.virtual_end = virtual_start;
+		regions.insert(regions.begin() + first, rest);
+	}
+	RegionsChanged();
+	LOG_INFO("MMU", "Unmapped 0x%016llX-0x%016llX (%zu regions touched)", virtual_start, virtual_end, last - first);
+}
+
+// Las regiones no se solapan y están ordenadas por inicio, así que los finales también lo están
+size_t MMU::RegionIndex(uint64_t address) const {
+	const auto it = std::upper_bound(regions.begin(), regions.end(), address,
+		[](uint64_t value, const MemoryRegion& region) { return value < region.virtual_end; });
+	return size_t(it - regions.begin());
+}
+
+void MMU::InsertRegion(const MemoryRegion& region) {
+	regions.insert(regions.begin() + RegionIndex(region.virtual_start), region);
+	RegionsChanged();
+}
+
+void MMU::RegionsChanged() {
+	FlushTLB(); // los punteros a MemoryRegion se invalidan al modificar el vector
+	NotifyCodeFlush(); // cambió la traducción, el código decodificado ya no es confiable
+	// Cada hilo tiene su copia del mapa: la nueva le llega en PollRemoteCodeWrites
+	if (!shared_->smp.load(std::memory_order_relaxed)) return;
+	std::lock_guard<std::mutex> lock(shared_->views_mutex);
+	for (MMU* view : shared_->views)
+		if (view != this) view->PostRemoteRegions(regions);
 }
 
 MemoryRegion* MMU::FindRegion(uint64_t addr, bool read, bool write, bool execute) {
-	std::cout << "[DEBUG] MMU::FindRegion: Searching for addr=0x" << std::hex << addr
-		<< ", read=" << read << ", write=" << write << ", execute=" << execute << std::dec << "\n";
-	for (auto& region : regions) {
-		std::cout << "[DEBUG] MMU::FindRegion: Checking region 0x" << std::hex << region.virtual_start
-			<< "-0x" << region.virtual_end << ", device=" << region.device->GetName()
-			<< ", readable=" << region.readable << ", writable=" << region.writable
-			<< ", executable=" << region.executable << std::dec << "\n";
-		if (addr >= region.virtual_start && addr < region.virtual_end) {
-			if ((read && !region.readable) || (write && !region.writable) || (execute && !region.executable)) {
-				std::cerr << "Access denied: addr=0x" << std::hex << addr << ", read=" << read
-					<< ", write=" << write << ", execute=" << execute << std::dec << "\n";
-				return nullptr;
-			}
-			std::cout << "[DEBUG] MMU::FindRegion: Found region for addr=0x" << std::hex << addr
-				<< ", device=" << region.device->GetName() << std::dec << "\n";
-			return &region;
-		}
-		else {
-			std::cout << "[DEBUG] MMU::FindRegion: Address 0x" << std::hex << addr
-				<< " not in region 0x" << region.virtual_start << "-0x" << region.virtual_end << std::dec << "\n";
-		}
+	LOG_TRACE("MMU", "FindRegion: addr=0x%016llX, read=%d, write=%d, execute=%d", addr, read, write, execute);
+	const size_t index = RegionIndex(addr);
+	if (index == regions.size() || regions[index].virtual_start > addr) {
+		LOG_WARNING("MMU", "FindRegion: No region found for addr=0x%016llX", addr);
+		return nullptr;
+	}
+	MemoryRegion& region = regions[index];
+	if ((read && !region.readable) || (write && !region.writable) || (execute && !region.executable)) {
+		LOG_WARNING("MMU", "Access denied: addr=0x%016llX, read=%d, write=%d, execute=%d", addr, read, write, execute);
+		return nullptr;
+	}
+	LOG_TRACE("MMU", "FindRegion: addr=0x%016llX -> %s", addr, region.device->GetName().c_str());
+	return &region;
+}
+
+bool MMU::IsMapped(uint64_t start, uint64_t end) const {
+	for (size_t i = RegionIndex(start); i < regions.size() && regions[i].virtual_start <= start; ++i) {
+		if (end <= regions[i].virtual_end) return true;
+		start = regions[i].virtual_end;
 	}
-	std::cerr << "[DEBUG] MMU::FindRegion: No region found for addr=0x" << std::hex << addr << std::dec << "\n";
-	return nullptr;
+	return false;
 }
 
 void MMU::ClearRegions() {
 	regions.clear();
+	RegionsChanged();
+}
+
+void MMU::FlushTLB() {
+	tlb.fill(TLBEntry{});
+}
+
+void MMU::ClearDirtyPages(MemoryDevice& device) {
+	std::atomic<uint64_t>* dirty = device.GetDirtyPages();
+	if (!dirty) return;
+	const uint64_t pages = (device.GetSize() + MemoryDevice::DIRTY_PAGE_SIZE - 1) >> MemoryDevice::DIRTY_PAGE_SHIFT;
+	for (uint64_t i = 0; i < (pages + 63) / 64; ++i)
+		dirty[i].store(0, std::memory_order_relaxed);
+	FlushTLB();
+	// Los TLB de los demás hilos sólo se tocan desde su hilo: se vacían en PollRemoteCodeWrites
+	std::lock_guard<std::mutex> lock(shared_->views_mutex);
+	for (MMU* view : shared_->views)
+		if (view != this) view->PostRemoteFlush(false);
+}
+
+// Fallo del TLB: traduce la dirección, busca la región y, si cubre la página real completa, deja
+// cacheada la página efectiva. Una página partida entre dos regiones no se cachea.
+MemoryRegion* MMU::RefillTLB(uint64_t addr, TLBAccess access, uint8_t*& host, uint64_t& real) {
+	host = nullptr;
+	real = TranslateAddress(addr, access);
+	MemoryRegion* region = FindRegion(real, access == TLB_READ, access == TLB_WRITE, access == TLB_EXEC);
+	if (!region) return nullptr;
+
+	const uint64_t page = addr >> TLB_PAGE_SHIFT;
+	const uint64_t page_start = real & ~TLB_PAGE_MASK;
+	const uint64_t page_end = page_start + TLB_PAGE_SIZE;
+	if (page_start < region->virtual_start || page_end > region->virtual_end) return region;
+
+	TLBEntry& entry = tlb[page & (TLB_SIZE - 1)];
+	const bool same_page = entry.tag[TLB_READ] == page || entry.tag[TLB_WRITE] == page || entry.tag[TLB_EXEC] == page;
+	if (!same_page || entry.region != region || entry.real != page_start) {
+		entry = TLBEntry{};
+		entry.region = region;
+		entry.real = page_start;
+		if (region->host) entry.host = region->host + (page_start - region->virtual_start);
+	}
+	entry.tag[access] = page;
+	if (entry.host) host = entry.host + (addr & TLB_PAGE_MASK);
+	// A partir de aquí las escrituras en la página van por puntero sin pasar por la MMU
+	if (access == TLB_WRITE && region->dirty)
+		MarkDirtyPages(region->dirty, page_start - region->virtual_start + region->physical_start, TLB_PAGE_SIZE);
+	return region;
+}
+
+// Traducción de direcciones (ver MMU.h). Formatos de la arquitectura PowerPC de 64 bits:
+// SDR1 = HTABORG | HTABSIZE (2^(11+HTABSIZE) grupos de 8 PTE de 16 bytes); el VA es VSID || EA[36:63].
+namespace {
+
+constexpr uint32_t SEGMENT_SHIFT = 28;
+constexpr uint64_t SEGMENT_MASK = (1ull << SEGMENT_SHIFT) - 1;
+constexpr uint64_t REAL_MODE_NO_OFFSET = 1ull << 63; // EA[0] en modo real del hipervisor: sin HRMOR
+constexpr uint64_t SDR1_HTABORG = 0x0FFFFFFFFFFC0000ull;
+constexpr uint64_t SDR1_HTABSIZE = 0x1F;
+constexpr uint64_t HASH_VSID_MASK = (1ull << 39) - 1;
+constexpr uint64_t AVPN_MASK = (1ull << 57) - 1;
+// PTE: doubleword 0
+constexpr uint64_t PTE_V = 0x1;
+constexpr uint64_t PTE_H = 0x2;   // está en el grupo secundario
+constexpr uint64_t PTE_L = 0x4;
+// PTE: doubleword 1
+constexpr uint64_t PTE_RPN = 0x3FFFFFFFFFFFF000ull;
+constexpr uint64_t PTE_R = 0x100;
+constexpr uint64_t PTE_C = 0x80;
+constexpr uint64_t PTE_N = 0x4;
+constexpr uint64_t PTE_PP = 0x3;
+// Causa del fallo: DSISR (DSI) o bits de SRR1 (ISI)
+constexpr uint32_t FAULT_NOT_FOUND = 0x40000000;
+constexpr uint32_t FAULT_NO_EXECUTE = 0x10000000;
+constexpr uint32_t FAULT_PROTECTION = 0x08000000;
+constexpr uint32_t DSISR_STORE = 0x02000000;
+
+// Tamaño de página del segmento (log2). Las páginas grandes de Xenon son de 64 KiB o 16 MiB según
+// SLB[LP], con HID6[LB] en su valor de arranque.
+uint32_t PageShift(const SLBEntry& segment) {
+	if (!segment.L) return 12;
+	return segment.LP ? 16 : 24;
+}
+
+} // namespace
+
+uint64_t MMU::TranslateAddress(uint64_t ea, TLBAccess access) {
+	if (!IsTranslated(access)) {
+		if (!(msr_ & MSR_HV)) return ea | translation_.rmor;
+		return (ea & REAL_MODE_NO_OFFSET) ? ea & ~REAL_MODE_NO_OFFSET : ea | translation_.hrmor;
+	}
+	return WalkPageTable(ea, access);
+}
+
+uint64_t MMU::WalkPageTable(uint64_t ea, TLBAccess access) {
+	const bool fetch = access == TLB_EXEC;
+	const bool store = access == TLB_WRITE;
+	const SLBEntry* segment = nullptr;
+	for (const SLBEntry& entry : translation_.slb) {
+		if (entry.V && entry.ESID == ea >> SEGMENT_SHIFT) {
+			segment = &entry;
+			break;
+		}
+	}
+	if (!segment)
+		throw GuestFault(fetch ? GuestFault::Kind::InstructionSegment : GuestFault::Kind::DataSegment, ea);
+
+	const uint32_t shift = PageShift(*segment);
+	const uint64_t offset = ea & SEGMENT_MASK;
+	const uint64_t hash = (segment->VSID & HASH_VSID_MASK) ^ (offset >> shift);
+	// El PTE guarda VA >> 23; en páginas de 16 MiB el último bit de eso ya es parte del offset
+	const uint64_t avpn = ((segment->VSID << (SEGMENT_SHIFT - 23)) | (offset >> 23)) & AVPN_MASK;
+	const uint64_t avpn_mask = shift > 23 ? ~((1ull << (shift - 23)) - 1) : ~0ull;
+	const uint64_t group_mask = (1ull << (11 + (translation_.sdr1 & SDR1_HTABSIZE))) - 1;
+	const uint64_t htab = translation_.sdr1 & SDR1_HTABORG;
+
+	for (uint64_t secondary = 0; secondary < 2; ++secondary) {
+		const uint64_t group = htab + (((secondary ? ~hash : hash) & group_mask) << 7);
+		for (uint64_t pte = group; pte < group + 128; pte += 16) {
+			const uint64_t pte0 = ReadReal64(pte);
+			if (!(pte0 & PTE_V) || ((pte0 & PTE_H) != 0) != (secondary != 0) || ((pte0 & PTE_L) != 0) != (segment->L != 0))
+				continue;
+			if ((((pte0 >> 7) ^ avpn) & avpn_mask & AVPN_MASK) != 0) continue;
+
+			// PP con la clave de la SLB (Kp en problem state): 00 rw/--, 01 rw/r-, 10 rw/rw, 11 r-/r-
+			const uint64_t pte1 = ReadReal64(pte + 8);
+			const bool key = (msr_ & MSR_PR) ? segment->Kp : segment->Ks;
+			const uint64_t pp = pte1 & PTE_PP;
+			const bool can_read = !key || pp != 0;
+			const bool can_write = key ? pp == 2 : pp != 3;
+			if (fetch) {
+				if ((pte1 & PTE_N) || segment->N) throw GuestFault(GuestFault::Kind::InstructionStorage, ea, FAULT_NO_EXECUTE);
+				if (!can_read) throw GuestFault(GuestFault::Kind::InstructionStorage, ea, FAULT_PROTECTION);
+			}
+			else if (store ? !can_write : !can_read) {
+				throw GuestFault(GuestFault::Kind::DataStorage, ea, FAULT_PROTECTION | (store ? DSISR_STORE : 0));
+			}
+			// Referenced/Changed: el TLB no vuelve por aquí mientras la entrada siga cacheada, y la
+			// de escritura sólo se rellena con una escritura
+			const uint64_t rc = PTE_R | (store ? PTE_C : 0);
+			if ((pte1 & rc) != rc) WriteReal64(pte + 8, pte1 | rc);
+			const uint64_t page_mask = (1ull << shift) - 1;
+			return (pte1 & PTE_RPN & ~page_mask) | (ea & page_mask);
+		}
+	}
+	if (fetch) throw GuestFault(GuestFault::Kind::InstructionStorage, ea, FAULT_NOT_FOUND);
+	throw GuestFault(GuestFault::Kind::DataStorage, ea, FAULT_NOT_FOUND | (store ? DSISR_STORE : 0));
+}
+
+uint64_t MMU::ReadReal64(uint64_t address) {
+	MemoryRegion* region = FindRegion(address, true, false, false);
+	if (!region) throw std::runtime_error("MMU: page table outside mapped memory");
+	if (const uint8_t* p = RegionHost(region, address, 8)) return LoadBE64(p);
+	auto device_lock = LockDevice();
+	return region->device->Read64(address - region->virtual_start + region->physical_start);
+}
+
+void MMU::WriteReal64(uint64_t address, uint64_t value) {
+	MemoryRegion* region = FindRegion(address, false, true, false);
+	if (!region) throw std::runtime_error("MMU: page table outside mapped memory");
+	if (uint8_t* p = RegionHostWrite(region, address, 8)) {
+		StoreBE64(p, value);
+		return;
+	}
+	auto device_lock = LockDevice();
+	region->device->Write64(address - region->virtual_start + region->physical_start, value);
+}
+
+// PR sólo cuenta con traducción (clave de la SLB) y HV sólo sin ella (HRMOR o RMOR)
+void MMU::SetMSR(uint64_t msr) {
+	const uint64_t changed = msr_ ^ msr;
+	msr_ = msr;
+	if ((changed & (MSR_IR | MSR_DR | MSR_HV)) || ((changed & MSR_PR) && (msr & (MSR_IR | MSR_DR)))) FlushTLB();
+}
+
+void MMU::SetTranslation(const TranslationRegisters& registers) {
+	translation_ = registers;
+	TranslationChanged();
+}
+
+void MMU::SetSDR1(uint64_t value) {
+	translation_.sdr1 = value;
+	TranslationChanged();
+}
+
+void MMU::SetHRMOR(uint64_t value) {
+	translation_.hrmor = value;
+	TranslationChanged();
+}
+
+void MMU::SetRMOR(uint64_t value) {
+	translation_.rmor = value;
+	TranslationChanged();
+}
+
+// RB = ESID | V | índice; RS = VSID | Ks | Kp | N | L | C | LP
+void MMU::SLBMoveTo(uint64_t rs, uint64_t rb) {
+	SLBEntry& entry = translation_.slb[rb & (SLB_ENTRIES - 1)];
+	entry.esidReg = rb;
+	entry.vsidReg = rs;
+	entry.ESID = rb >> SEGMENT_SHIFT;
+	entry.V = (rb >> 27) & 1;
+	entry.VSID = rs >> 12;
+	entry.Ks = (rs >> 11) & 1;
+	entry.Kp = (rs >> 10) & 1;
+	entry.N = (rs >> 9) & 1;
+	entry.L = (rs >> 8) & 1;
+	entry.C = (rs >> 7) & 1;
+	entry.LP = (rs >> 4) & 3;
+	TranslationChanged();
+}
+
+void MMU::SLBInvalidateEntry(uint64_t rb) {
+	for (SLBEntry& entry : translation_.slb) {
+		if (entry.V && entry.ESID == rb >> SEGMENT_SHIFT) entry.V = 0;
+	}
+	TranslationChanged();
+}
+
+// Como en la arquitectura, la entrada 0 se queda
+void MMU::SLBInvalidateAll() {
+	for (size_t i = 1; i < SLB_ENTRIES; ++i) translation_.slb[i].V = 0;
+	TranslationChanged();
+}
+
+uint64_t MMU::SLBMoveFromESID(uint64_t rb) const {
+	const SLBEntry& entry = translation_.slb[rb & (SLB_ENTRIES - 1)];
+	return entry.V ? (entry.ESID << SEGMENT_SHIFT) | (1ull << 27) : 0;
+}
+
+uint64_t MMU::SLBMoveFromVSID(uint64_t rb) const {
+	const SLBEntry& entry = translation_.slb[rb & (SLB_ENTRIES - 1)];
+	return entry.V ? entry.vsidReg & ~0xFull : 0;
+}
+
+void MMU::InvalidateTranslations(bool global) {
+	TranslationChanged();
+	if (!global || !shared_->smp.load(std::memory_order_relaxed)) return;
+	std::lock_guard<std::mutex> lock(shared_->views_mutex);
+	for (MMU* view : shared_->views)
+		if (view != this) view->PostRemoteFlush(true);
+}
+
+// Los bloques decodificados van por dirección efectiva: con otra traducción pueden ser otro código
+void MMU::TranslationChanged() {
+	FlushTLB();
+	NotifyCodeFlush();
 }
 
 bool MMU::Read(uint64_t address, uint8_t* data, uint64_t size)
 {
-	auto* region = FindRegion(address, true, false, false);
-	uint64_t offset = address - region->virtual_start + region->physical_start;
+	if (CrossesTranslatedPage(address, size, TLB_READ)) {
+		ForEachPage(address, size, [&](uint64_t page, uint64_t done, uint64_t chunk) { Read(page, data + done, chunk); });
+		return true;
+	}
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(address, TLB_READ, host, real);
+	if (!region) throw std::runtime_error("MMU: unmapped address");
+	if (const uint8_t* p = RegionHost(region, real, size)) {
+		memcpy(data, p, size);
+		return true;
+	}
+	uint64_t offset = real - region->virtual_start + region->physical_start;
+	auto device_lock = LockDevice();
 	region->device->Read(offset, data, size);
+	for (uint64_t i = 0; replay_ && i < size; i += 8) {
+		uint64_t chunk = 0;
+		const size_t n = size_t(std::min<uint64_t>(8, size - i));
+		memcpy(&chunk, data + i, n);
+		chunk = DeviceInput(replay_, region, chunk);
+		memcpy(data + i, &chunk, n);
+	}
 	return true;
 }
 
 void MMU::Write(uint64_t addr, const uint8_t* src, uint64_t size) {
-	auto region = FindRegion(addr, false, true, false);
+	if (CrossesTranslatedPage(addr, size, TLB_WRITE)) {
+		ForEachPage(addr, size, [&](uint64_t page, uint64_t done, uint64_t chunk) { Write(page, src + done, chunk); });
+		return;
+	}
+	uint8_t* host;
+	uint64_t real;
+	auto region = Translate(addr, TLB_WRITE, host, real);
 	if (!region) {
-		std::cerr << "MMU::Write: No region found for addr=0x" << std::hex << addr << std::dec << "\n";
+		LOG_ERROR("MMU", "Write: No region found for addr=0x%016llX", addr);
 		throw std::runtime_error("MMU: Write to unmapped region");
 	}
-	uint64_t offset = addr - region->virtual_start + region->physical_start;
-	std::cout << "[DEBUG] MMU::Write: addr=0x" << std::hex << addr << ", offset=0x" << offset
-		<< ", size=" << std::dec << size << ", device=" << region->device->GetName() << "\n";
+	TrackWrite(addr, real, size);
+	if (uint8_t* p = RegionHostWrite(region, real, size)) {
+		memcpy(p, src, size);
+		return;
+	}
+	uint64_t offset = real - region->virtual_start + region->physical_start;
+	auto device_lock = LockDevice();
+	LOG_TRACE("MMU", "Write: addr=0x%016llX, offset=0x%016llX, size=%llu, device=%s", addr, offset, size, region->device->GetName().c_str());
 	region->device->Write(offset, src, size);
 }
 
 void MMU::MemSet(uint64_t address, uint8_t value, uint64_t size)
 {
-	auto* region = FindRegion(address, false, true, false);
-	uint64_t offset = address - region->virtual_start + region->physical_start;
+	if (CrossesTranslatedPage(address, size, TLB_WRITE)) {
+		ForEachPage(address, size, [&](uint64_t page, uint64_t, uint64_t chunk) { MemSet(page, value, chunk); });
+		return;
+	}
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(address, TLB_WRITE, host, real);
+	if (!region) throw std::runtime_error("MMU: unmapped address");
+	TrackWrite(address, real, size);
+	if (uint8_t* p = RegionHostWrite(region, real, size)) {
+		memset(p, value, size);
+		return;
+	}
+	uint64_t offset = real - region->virtual_start + region->physical_start;
+	auto device_lock = LockDevice();
 	region->device->MemSet(offset, value, size);
 }
 
 uint8_t* MMU::GetPointerToAddress(uint64_t address)
 {
-	auto* region = FindRegion(address, true, false, false);
-	uint64_t offset = address - region->virtual_start + region->physical_start;
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(address, TLB_READ, host, real);
+	if (!region) throw std::runtime_error("MMU: unmapped address");
+	if (uint8_t* p = RegionHost(region, real, 1)) return p;
+	uint64_t offset = real - region->virtual_start + region->physical_start;
 	return region->device->GetPointerToAddress(offset);
 }
 
-// Accesos de lectura
-uint8_t MMU::Read8(uint64_t addr)
+// Caminos lentos de los accesos tipados (los rápidos están inline en MMU.h): rellenan el TLB
+// y, si la región es RAM, acceden igualmente por puntero (p.ej. páginas que el TLB no cachea).
+uint8_t MMU::Read8Slow(uint64_t addr)
 {
-	auto* region = FindRegion(addr, true, false, false);
-	return region->device->Read8(addr - region->virtual_start + region->physical_start);
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(addr, TLB_READ, host, real);
+	if (!region) throw std::runtime_error("MMU: unmapped address");
+	if (const uint8_t* p = RegionHost(region, real, 1)) return *p;
+	auto device_lock = LockDevice();
+	return uint8_t(DeviceInput(replay_, region, region->device->Read8(real - region->virtual_start + region->physical_start)));
 }
 
-uint16_t MMU::Read16(uint64_t addr)
+uint16_t MMU::Read16Slow(uint64_t addr)
 {
 	CheckAlignment(addr, 2);
-	auto* region = FindRegion(addr, true, false, false);
-	return region->device->Read16(addr - region->virtual_start + region->physical_start);
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(addr, TLB_READ, host, real);
+	if (!region) throw std::runtime_error("MMU: unmapped address");
+	if (const uint8_t* p = RegionHost(region, real, 2)) return LoadBE16(p);
+	auto device_lock = LockDevice();
+	return uint16_t(DeviceInput(replay_, region, region->device->Read16(real - region->virtual_start + region->physical_start)));
 }
 
-/*
-uint32_t MMU::Read32(uint64_t addr) {
-	CheckAlignment(addr, 4);
-	auto* region = FindRegion(addr, true, false, false);
-	if (!region) {
-		std::cerr << "MMU::Read32: Unmapped address 0x" << std::hex << addr << std::dec << "\n";
-		throw std::runtime_error("MMU: unmapped address");
+uint32_t MMU::Read32Slow(uint64_t addr) {
+	if (CrossesTranslatedPage(addr, 4, TLB_READ)) {
+		uint8_t bytes[4];
+		Read(addr, bytes, sizeof(bytes));
+		return LoadBE32(bytes);
 	}
-	uint64_t offset = addr - region->virtual_start + region->physical_start;
-	uint32_t value = region->device->Read32(offset);
-	std::cout << "MMU::Read32: addr=0x" << std::hex << addr << ", offset=0x" << offset
-		<< ", device=" << region->device->GetName() << ", value=0x" << value << std::dec << "\n";
-	return value;
-}*/
-uint32_t MMU::Read32(uint64_t addr) {
-	auto* region = FindRegion(addr, true, false, false);
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(addr, TLB_READ, host, real);
 	if (!region) throw std::runtime_error("MMU: unmapped address");
+	if (const uint8_t* p = RegionHost(region, real, 4)) return LoadBE32(p);
 
-	uint64_t offset = addr - region->virtual_start + region->physical_start;
+	uint64_t offset = real - region->virtual_start + region->physical_start;
+	auto device_lock = LockDevice();
 
 	// Si está alineado, podemos delegar directamente
 	if ((addr & 0x3) == 0) {
-		return region->device->Read32(offset);
+		return uint32_t(DeviceInput(replay_, region, region->device->Read32(offset)));
 	}
-	// Si NO está alineado, leemos byte a byte (big-endian)
-	uint8_t b0 = region->device->Read8(offset + 0);
-	uint8_t b1 = region->device->Read8(offset + 1);
-	uint8_t b2 = region->device->Read8(offset + 2);
-	uint8_t b3 = region->device->Read8(offset + 3);
-	return (uint32_t(b0) << 24)
-		| (uint32_t(b1) << 16)
-		| (uint32_t(b2) << 8)
-		| (uint32_t(b3) << 0);
+	// Si NO está alineado, copiamos los 4 bytes y los interpretamos big-endian
+	uint8_t bytes[4];
+	region->device->Read(offset, bytes, sizeof(bytes));
+	return uint32_t(DeviceInput(replay_, region, LoadBE32(bytes)));
 }
 
-uint64_t MMU::Read64(uint64_t addr)
+uint64_t MMU::Read64Slow(uint64_t addr)
 {
 	CheckAlignment(addr, 8);
-	auto* region = FindRegion(addr, true, false, false);
-	return region->device->Read64(addr - region->virtual_start + region->physical_start);
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(addr, TLB_READ, host, real);
+	if (!region) throw std::runtime_error("MMU: unmapped address");
+	if (const uint8_t* p = RegionHost(region, real, 8)) return LoadBE64(p);
+	auto device_lock = LockDevice();
+	return DeviceInput(replay_, region, region->device->Read64(real - region->virtual_start + region->physical_start));
 }
 
-uint64_t MMU::Read128(uint32_t addr)
-{
-	uint64_t low = Read64(addr);
-	uint64_t high = Read64(addr + 8);
-	return (high << 64) | low;
+uint32_t MMU::Fetch32Slow(uint64_t addr) {
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(addr, TLB_EXEC, host, real);
+	if (!region) throw std::runtime_error("MMU: instruction fetch from unmapped or non-executable address");
+	if (const uint8_t* p = RegionHost(region, real, 4)) return LoadBE32(p);
+	auto device_lock = LockDevice();
+	return region->device->Read32(real - region->virtual_start + region->physical_start);
 }
 
 std::vector<uint8_t> MMU::ReadBytes(uint64_t address, size_t size)
@@ -167,43 +633,64 @@ std::vector<uint8_t> MMU::ReadBytes(uint64_t address, size_t size)
 	return buffer;
 }
 
-// Escrituras
-void MMU::Write8(uint64_t addr, uint8_t val) {
-	auto region = FindRegion(addr, false, true, false);
+// Escrituras (caminos lentos)
+void MMU::Write8Slow(uint64_t addr, uint8_t val) {
+	uint8_t* host;
+	uint64_t real;
+	auto region = Translate(addr, TLB_WRITE, host, real);
 	if (!region || !region->device) {
-		std::cerr << "MMU::Write: No region found for addr=0x" << std::hex << addr << std::dec << "\n";
+		LOG_ERROR("MMU", "Write8: No region found for addr=0x%016llX", addr);
 		throw std::runtime_error("MMU: Write to unmapped region");
 	}
-	uint64_t offset = addr - region->virtual_start;
-	std::cout << "MMU::Write8: addr=0x" << std::hex << addr << ", offset=0x" << offset
-		<< ", val=0x" << (int)val << " ('" << (char)val << "'), device=" << region->device->GetName() << "\n";
-	std::cout << "MMU::Write8: Calling device->Write8 with addr=0x" << std::hex << addr << std::dec << "\n";
-	region->device->Write8(addr, val);
+	TrackWrite(addr, real, 1);
+	if (uint8_t* p = RegionHostWrite(region, real, 1)) {
+		*p = val;
+		return;
+	}
+	uint64_t offset = real - region->virtual_start + region->physical_start;
+	auto device_lock = LockDevice();
+	LOG_TRACE("MMU", "Write8: addr=0x%016llX, offset=0x%016llX, val=0x%02X, device=%s", addr, offset, val, region->device->GetName().c_str());
+	region->device->Write8(offset, val);
 }
 
-void MMU::Write16(uint64_t addr, uint16_t val) {
-	auto* region = FindRegion(addr, false, true, false);
+void MMU::Write16Slow(uint64_t addr, uint16_t val) {
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(addr, TLB_WRITE, host, real);
 	if (!region) {
-		std::cerr << "MMU::Write16: Unmapped address 0x" << std::hex << addr << std::dec << "\n";
+		LOG_ERROR("MMU", "Write16: Unmapped address 0x%016llX", addr);
 		throw std::runtime_error("MMU: unmapped address");
 	}
-	uint64_t offset = addr - region->virtual_start + region->physical_start;
-	std::cout << "MMU::Write16: addr=0x" << std::hex << addr << ", offset=0x" << offset
-		<< ", val=0x" << val << ", device=" << region->device->GetName() << std::dec << "\n";
+	TrackWrite(addr, real, 2);
+	if (uint8_t* p = RegionHostWrite(region, real, 2)) {
+		StoreBE16(p, val);
+		return;
+	}
+	uint64_t offset = real - region->virtual_start + region->physical_start;
+	auto device_lock = LockDevice();
+	LOG_TRACE("MMU", "Write16: addr=0x%016llX, offset=0x%016llX, val=0x%04X, device=%s", addr, offset, val, region->device->GetName().c_str());
 	region->device->Write16(offset, val);
 }
 
-/*void MMU::Write32(uint64_t addr, uint32_t value)
-{
-	CheckAlignment(addr, 4);
-	auto* region = FindRegion(addr, false, true, false);
-	region->device->Write32(addr - region->virtual_start + region->physical_start, value);
-}*/
-void MMU::Write32(uint64_t addr, uint32_t value) {
-	auto* region = FindRegion(addr, false, true, false);
+void MMU::Write32Slow(uint64_t addr, uint32_t value) {
+	if (CrossesTranslatedPage(addr, 4, TLB_WRITE)) {
+		uint8_t bytes[4];
+		StoreBE32(bytes, value);
+		Write(addr, bytes, sizeof(bytes));
+		return;
+	}
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(addr, TLB_WRITE, host, real);
 	if (!region) throw std::runtime_error("MMU: unmapped address");
+	TrackWrite(addr, real, 4);
+	if (uint8_t* p = RegionHostWrite(region, real, 4)) {
+		StoreBE32(p, value);
+		return;
+	}
 
-	uint64_t offset = addr - region->virtual_start + region->physical_start;
+	uint64_t offset = real - region->virtual_start + region->physical_start;
+	auto device_lock = LockDevice();
 
 	// Si está alineado, podemos delegar
 	if ((addr & 0x3) == 0) {
@@ -217,60 +704,164 @@ void MMU::Write32(uint64_t addr, uint32_t value) {
 	region->device->Write8(offset + 3, uint8_t(value >> 0));
 }
 
-void MMU::Write64(uint64_t addr, uint64_t value)
+void MMU::Write64Slow(uint64_t addr, uint64_t value)
 {
 	CheckAlignment(addr, 8);
-	auto* region = FindRegion(addr, false, true, false);
-	region->device->Write64(addr - region->virtual_start + region->physical_start, value);
-}
-
-void MMU::Write128(uint32_t addr, uint64_t val)
-{
-	Write64(addr, val);        // LSB
-	Write64(addr + 8, val);    // MSB (si deseas 128 bits de mismo valor)
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(addr, TLB_WRITE, host, real);
+	if (!region) throw std::runtime_error("MMU: unmapped address");
+	TrackWrite(addr, real, 8);
+	if (uint8_t* p = RegionHostWrite(region, real, 8)) {
+		StoreBE64(p, value);
+		return;
+	}
+	auto device_lock = LockDevice();
+	region->device->Write64(real - region->virtual_start + region->physical_start, value);
 }
 
-// SIMD y pseudo SIMD
-uint64_t MMU::ReadLeft(uint32_t addr) { return Read64(addr); }
-uint64_t MMU::ReadRight(uint32_t addr) { return Read64(addr + 8); }
-void MMU::WriteLeft(uint32_t addr, uint64_t val) { Write64(addr, val); }
-void MMU::WriteRight(uint32_t addr, uint64_t val) { Write64(addr + 8, val); }
-
-uint64_t MMU::LoadVectorShiftLeft(uint32_t addr)
-{
-	uint64_t val = Read64(addr);
-	return val << 8;
+bool MMU::CompareExchange32(uint64_t addr, uint32_t expected, uint32_t desired) {
+	CheckAlignment(addr, ALIGN_4);
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(addr, TLB_WRITE, host, real);
+	if (!region) throw std::runtime_error("MMU: unmapped address");
+	TrackWrite(addr, real, 4);
+	if (uint8_t* p = RegionHostWrite(region, real, 4))
+		return HostCompareExchange32(p, ToBE(expected), ToBE(desired));
+	const uint64_t offset = real - region->virtual_start + region->physical_start;
+	auto device_lock = LockDevice();
+	if (region->device->Read32(offset) != expected) return false;
+	region->device->Write32(offset, desired);
+	return true;
 }
 
-uint64_t MMU::LoadVectorShiftRight(uint32_t addr)
-{
-	uint64_t val = Read64(addr);
-	return val >> 8;
+bool MMU::CompareExchange64(uint64_t addr, uint64_t expected, uint64_t desired) {
+	CheckAlignment(addr, ALIGN_8);
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(addr, TLB_WRITE, host, real);
+	if (!region) throw std::runtime_error("MMU: unmapped address");
+	TrackWrite(addr, real, 8);
+	if (uint8_t* p = RegionHostWrite(region, real, 8))
+		return HostCompareExchange64(p, ToBE(expected), ToBE(desired));
+	const uint64_t offset = real - region->virtual_start + region->physical_start;
+	auto device_lock = LockDevice();
+	if (region->device->Read64(offset) != expected) return false;
+	region->device->Write64(offset, desired);
+	return true;
 }
 
-uint64_t MMU::LoadVectorRight(uint32_t addr) { return Read64(addr + 8); }
-uint64_t MMU::LoadVectorLeft(uint32_t addr) { return Read64(addr); }
-
 // Cachés (mock)
 void MMU::DCACHE_Store(uint32_t addr) {
-	if (verbose_logging_) std::cout << "[DCACHE_Store] addr=0x" << std::hex << addr << std::dec << "\n";
+	if (verbose_logging_) LOG_TRACE("MMU", "DCACHE_Store addr=0x%08X", addr);
 }
 
 void MMU::DCACHE_Flush(uint32_t addr) {
-	if (verbose_logging_) std::cout << "[DCACHE_Flush] addr=0x" << std::hex << addr << std::dec << "\n";
+	if (verbose_logging_) LOG_TRACE("MMU", "DCACHE_Flush addr=0x%08X", addr);
 }
 
 void MMU::DCACHE_CleanInvalidate(uint32_t addr) {
-	if (verbose_logging_) std::cout << "[DCACHE_CleanInvalidate] addr=0x" << std::hex << addr << std::dec << "\n";
+	if (verbose_logging_) LOG_TRACE("MMU", "DCACHE_CleanInvalidate addr=0x%08X", addr);
 }
 
 void MMU::ICACHE_Invalidate(uint32_t addr) {
-	if (verbose_logging_) std::cout << "[ICACHE_Invalidate] addr=0x" << std::hex << addr << std::dec << "\n";
+	if (verbose_logging_) LOG_TRACE("MMU", "ICACHE_Invalidate addr=0x%08X", addr);
+	// icbi opera sobre una línea de 128 bytes, traducida como una lectura
+	const uint64_t real = RealAddress(addr, TLB_READ);
+	if (IsCodePage(real)) NotifyCodeWrite(real & ~127ull, 128);
+}
+
+// Block cache: avisa a los listeners y libera las páginas, que se vuelven a marcar al redecodificar.
+// address es real (ver TrackWrite).
+void MMU::NotifyCodeWrite(uint64_t address, uint64_t size) {
+	for (CodeWriteListener* listener : code_listeners_)
+		listener->OnCodeWrite(address, size);
+	if (shared_->smp.load(std::memory_order_relaxed)) {
+		std::lock_guard<std::mutex> lock(shared_->views_mutex);
+		for (MMU* view : shared_->views)
+			if (view != this) view->PostRemoteCodeWrite(address, size);
+	}
+	const uint64_t first = (address & 0xFFFFFFFF) >> CODE_PAGE_SHIFT;
+	const uint64_t last = ((address + size - 1) & 0xFFFFFFFF) >> CODE_PAGE_SHIFT;
+	for (uint64_t page = first; page <= last; ++page)
+		code_pages_[page >> 6].fetch_and(~(1ull << (page & 63)), std::memory_order_relaxed);
+}
+
+void MMU::JournalWrite(uint64_t address, uint64_t size) {
+	uint8_t* host;
+	uint64_t real;
+	auto* region = Translate(address, TLB_WRITE, host, real);
+	if (!region) return; // la escritura va a fallar igual
+	JournalEntry entry{ address, journal_data_.size(), size_t(size) };
+	journal_data_.resize(entry.offset + entry.size);
+	auto device_lock = LockDevice();
+	region->device->Read(real - region->virtual_start + region->physical_start, journal_data_.data() + entry.offset, entry.size);
+	journal_.push_back(entry);
+}
+
+void MMU::EndWriteJournal(bool rollback) {
+	journaling_ = false;
+	if (rollback) {
+		for (auto it = journal_.rbegin(); it != journal_.rend(); ++it)
+			Write(it->address, journal_data_.data() + it->offset, it->size);
+	}
+	journal_.clear();
+	journal_data_.clear();
+}
+
+void MMU::NotifyCodeFlush() {
+	for (CodeWriteListener* listener : code_listeners_)
+		listener->OnCodeFlush();
+	// Con SMP las páginas pueden seguir siendo código de otro hilo: los bits sobrantes sólo cuestan un aviso de más
+	if (shared_->smp.load(std::memory_order_relaxed)) return;
+	for (size_t i = 0; i < MMUShared::CODE_PAGE_WORDS; ++i)
+		code_pages_[i].store(0, std::memory_order_relaxed);
+}
+
+void MMU::PostRemoteCodeWrite(uint64_t address, uint64_t size) {
+	std::lock_guard<std::mutex> lock(remote_mutex_);
+	remote_writes_.push_back(CodeRange{ address, size });
+	remote_pending_.store(true, std::memory_order_release);
+}
+
+void MMU::PostRemoteFlush(bool translation) {
+	std::lock_guard<std::mutex> lock(remote_mutex_);
+	(translation ? remote_flush_ : remote_tlb_flush_) = true;
+	remote_pending_.store(true, std::memory_order_release);
+}
+
+void MMU::PostRemoteRegions(const std::vector<MemoryRegion>& table) {
+	auto copy = std::make_unique<std::vector<MemoryRegion>>(table);
+	std::lock_guard<std::mutex> lock(remote_mutex_);
+	remote_regions_ = std::move(copy);
+	remote_pending_.store(true, std::memory_order_release);
+}
+
+void MMU::DrainRemoteCodeWrites() {
+	std::vector<CodeRange> writes;
+	std::unique_ptr<std::vector<MemoryRegion>> table;
+	bool flush = false;
+	bool tlb_flush = false;
+	{
+		std::lock_guard<std::mutex> lock(remote_mutex_);
+		writes.swap(remote_writes_);
+		table.swap(remote_regions_);
+		std::swap(flush, remote_flush_);
+		std::swap(tlb_flush, remote_tlb_flush_);
+		remote_pending_.store(false, std::memory_order_relaxed);
+	}
+	if (table) regions.swap(*table);
+	if (flush || table) TranslationChanged();
+	else if (tlb_flush) FlushTLB();
+	for (const CodeRange& range : writes)
+		for (CodeWriteListener* listener : code_listeners_)
+			listener->OnCodeWrite(range.address, range.size);
 }
 
 void MMU::CheckAlignment(uint64_t address, size_t alignment) const
 {
 	if (address % alignment != 0) {
-		throw std::runtime_error("Unaligned access at address: " + std::to_string(address));
+		throw GuestFault(GuestFault::Kind::Alignment, address);
 	}
 }
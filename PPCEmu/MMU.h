@@ -1,8 +1,29 @@
 // MMU.h
 #pragma once
 #include "MemoryDevice.h"
+#include "Endian.h"
+#include "XenonReservations.h"
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+// Fallo de un acceso que el guest ve como excepcin (DSI/ISI/alignment), no como error del
+// emulador. Corta la instruccin sin escribir sus registros; la CPU lo deja pendiente con PC en
+// esa instruccin (CPU::RaiseFault) y lo entrega en la siguiente frontera.
+class GuestFault : public std::runtime_error {
+public:
+    enum class Kind { DataStorage, DataSegment, InstructionStorage, InstructionSegment, Alignment };
+    GuestFault(Kind kind, uint64_t address, uint32_t dsisr = 0)
+        : std::runtime_error("Guest fault at address " + std::to_string(address)), kind(kind), address(address), dsisr(dsisr) {}
+    Kind kind;
+    uint64_t address;   // DAR
+    uint32_t dsisr;     // DSISR (DSI) o bits de SRR1 (ISI)
+};
 
 struct MemoryRegion {
     std::shared_ptr<MemoryDevice> device;
@@ -12,51 +33,166 @@ struct MemoryRegion {
     bool readable;
     bool writable;
     bool executable;
+    // RAM: puntero del host para virtual_start (el dispositivo es IsDirectMapped y cubre toda la
+    // regin). nullptr = MMIO, cada acceso pasa por los mtodos virtuales del dispositivo.
+    uint8_t* host = nullptr;
+    // Bitmap de pginas sucias del dispositivo (MemoryDevice::GetDirtyPages), o nullptr
+    std::atomic<uint64_t>* dirty = nullptr;
+    bool IsRAM() const { return host != nullptr; }
 };
 
+// Recibe avisos cuando se escribe sobre pginas que tienen cdigo ya decodificado
+// (block cache), para que self-modifying code siga funcionando. address es real: la escritura
+// puede llegar por otra EA que la del fetch.
+struct CodeWriteListener {
+    virtual ~CodeWriteListener() = default;
+    virtual void OnCodeWrite(uint64_t address, uint64_t size) = 0;
+    virtual void OnCodeFlush() = 0;
+};
+
+enum TLBAccess { TLB_READ = 0, TLB_WRITE = 1, TLB_EXEC = 2 };
+
+// Entrada del TLB software: una pgina de 4 KiB ya resuelta a su regin.
+// Cada tipo de acceso tiene su propio tag, as una pgina de slo lectura nunca acierta una escritura.
 struct TLBEntry {
-    uint64_t vaddr_base;
-    uint64_t vaddr_end;
-    MemoryRegion* region;
+    static constexpr uint64_t INVALID = ~0ull;
+    uint64_t tag[3] = { INVALID, INVALID, INVALID }; // nmero de pgina virtual, por TLBAccess
+    MemoryRegion* region = nullptr;
+    uint8_t* host = nullptr;  // inicio de la pgina en memoria del host; nullptr si es un dispositivo (MMIO)
+    uint64_t real = 0;        // inicio de la pgina en espacio real (el del mapa de regiones)
 };
 
+// Segment Lookaside Buffer Entry: un segmento de 256 MiB, ESID -> VSID.
+// vsidReg/esidReg guardan los operandos de slbmte tal cual (slbmfev/slbmfee).
+struct SLBEntry {
+    uint8_t V;
+    uint8_t LP; // Large Page selector
+    uint8_t C;
+    uint8_t L;
+    uint8_t N;
+    uint8_t Kp;
+    uint8_t Ks;
+    uint64_t VSID;
+    uint64_t ESID;
+    uint64_t vsidReg;
+    uint64_t esidReg;
+};
+
+// Registros de traduccin de un hilo de hardware (ver MMU::TranslateAddress)
+struct TranslationRegisters {
+    uint64_t sdr1 = 0;
+    uint64_t hrmor = 0;
+    uint64_t rmor = 0;
+    std::array<SLBEntry, 64> slb{};
+};
+
+struct MMUShared;
+class ReplayLog;
+
 class MMU {
 public:
+    MMU();
+    ~MMU();
+    MMU(const MMU&) = delete;
+    MMU& operator=(const MMU&) = delete;
+
+    // SMP: MMU para otro hilo de hardware. Copia el mapa de regiones actual (los dispositivos se
+    // comparten), con TLB, journal y listeners propios. Las pginas de cdigo son comunes: una
+    // escritura sobre cdigo decodificado por otro hilo le llega en PollRemoteCodeWrites, igual
+    // que los cambios posteriores del mapa de regiones y los vaciados del TLB de otros hilos.
+    std::unique_ptr<MMU> CreateThreadView();
+    // Lo llama cada CPU entre bloques, en su propio hilo
+    void PollRemoteCodeWrites() {
+        if (remote_pending_.load(std::memory_order_acquire)) DrainRemoteCodeWrites();
+    }
+
+    // Mapa de regiones: ordenado por virtual_start y sin solapes, bsqueda binaria en cada fallo
+    // del TLB. MapMemory lanza std::runtime_error si [virtual_start, virtual_end) toca una regin
+    // ya mapeada; RemapMemory sustituye lo que hubiera en ese rango (las regiones que lo cruzan se
+    // recortan) y UnmapMemory slo lo deja libre.
     void MapMemory(std::shared_ptr<MemoryDevice> device, uint64_t virtual_start, uint64_t virtual_end,
         uint64_t physical_start, bool readable, bool writable, bool executable);
+    void RemapMemory(std::shared_ptr<MemoryDevice> device, uint64_t virtual_start, uint64_t virtual_end,
+        uint64_t physical_start, bool readable, bool writable, bool executable);
+    void UnmapMemory(uint64_t virtual_start, uint64_t virtual_end);
 
     bool Read(uint64_t address, uint8_t* data, uint64_t size);
     void Write(uint64_t address, const uint8_t* data, uint64_t size);
     void MemSet(uint64_t address, uint8_t value, uint64_t size);
     uint8_t* GetPointerToAddress(uint64_t address);
 
-    uint8_t Read8(uint64_t addr);
-    uint16_t Read16(uint64_t addr);
-    uint32_t Read32(uint64_t addr);
-    uint64_t Read64(uint64_t addr);
-    uint64_t Read128(uint32_t addr);
+    // Accesos tipados. Camino rpido inline: acierto en el TLB sobre RAM y acceso alineado, sin
+    // llamadas virtuales. Fallo de TLB, MMIO o desalineado van por el camino lento (MMU.cpp).
+    uint8_t Read8(uint64_t addr) {
+        if (const uint8_t* p = HostFast(addr, TLB_READ, 1)) return *p;
+        return Read8Slow(addr);
+    }
+    uint16_t Read16(uint64_t addr) {
+        if (const uint8_t* p = HostFast(addr, TLB_READ, 2)) return LoadBE16(p);
+        return Read16Slow(addr);
+    }
+    uint32_t Read32(uint64_t addr) {
+        if (const uint8_t* p = HostFast(addr, TLB_READ, 4)) return LoadBE32(p);
+        return Read32Slow(addr);
+    }
+    uint64_t Read64(uint64_t addr) {
+        if (const uint8_t* p = HostFast(addr, TLB_READ, 8)) return LoadBE64(p);
+        return Read64Slow(addr);
+    }
+    // lectura de instruccin: exige permiso de ejecucin
+    uint32_t Fetch32(uint64_t addr) {
+        if (const uint8_t* p = HostFast(addr, TLB_EXEC, 4)) return LoadBE32(p);
+        return Fetch32Slow(addr);
+    }
+    // lvx/stvx: 16 bytes tal cual, en el orden del guest (VectorRegister::u8)
+    void Read128(uint64_t addr, uint8_t* data) {
+        if (const uint8_t* p = HostFast(addr, TLB_READ, 16)) { std::memcpy(data, p, 16); return; }
+        Read(addr, data, 16);
+    }
 
     std::vector<uint8_t> ReadBytes(uint64_t address, size_t size);
 
-    void Write8(uint64_t addr, uint8_t val);
-    void Write16(uint64_t addr, uint16_t value);
-    void Write32(uint64_t addr, uint32_t value);
-    void Write64(uint64_t address, uint64_t value);    
-    void Write128(uint32_t addr, uint64_t val);
+    void Write8(uint64_t addr, uint8_t val) {
+        if (uint8_t* p = HostFast(addr, TLB_WRITE, 1)) { TrackWrite(addr, CachedReal(addr), 1); *p = val; return; }
+        Write8Slow(addr, val);
+    }
+    void Write16(uint64_t addr, uint16_t value) {
+        if (uint8_t* p = HostFast(addr, TLB_WRITE, 2)) { TrackWrite(addr, CachedReal(addr), 2); StoreBE16(p, value); return; }
+        Write16Slow(addr, value);
+    }
+    void Write32(uint64_t addr, uint32_t value) {
+        if (uint8_t* p = HostFast(addr, TLB_WRITE, 4)) { TrackWrite(addr, CachedReal(addr), 4); StoreBE32(p, value); return; }
+        Write32Slow(addr, value);
+    }
+    void Write64(uint64_t addr, uint64_t value) {
+        if (uint8_t* p = HostFast(addr, TLB_WRITE, 8)) { TrackWrite(addr, CachedReal(addr), 8); StoreBE64(p, value); return; }
+        Write64Slow(addr, value);
+    }
+    void Write128(uint64_t addr, const uint8_t* data) {
+        if (uint8_t* p = HostFast(addr, TLB_WRITE, 16)) { TrackWrite(addr, CachedReal(addr), 16); std::memcpy(p, data, 16); return; }
+        Write(addr, data, 16);
+    }
+    // stwcx./stdcx.: escribe desired slo si la memoria sigue valiendo expected (CAS del host en RAM)
+    bool CompareExchange32(uint64_t addr, uint32_t expected, uint32_t desired);
+    bool CompareExchange64(uint64_t addr, uint64_t expected, uint64_t desired);
+    // Tabla de reservas de lwarx/ldarx, comn a todos los hilos de hardware. Va por direccin
+    // real: dos EA que traducen a la misma lnea comparten reserva
+    XenonReservations& Reservations() { return *reservations_; }
+    // Direccin real de ea para ese acceso, por el TLB (lo rellena si hace falta). Lanza
+    // GuestFault como el acceso mismo.
+    uint64_t RealAddress(uint64_t ea, TLBAccess access) {
+        uint8_t* host;
+        uint64_t real;
+        Translate(ea, access, host, real);
+        return real;
+    }
 
-    uint64_t ReadLeft(uint32_t addr);
-    uint64_t ReadRight(uint32_t addr);
-    void WriteLeft(uint32_t addr, uint64_t val);
-    void WriteRight(uint32_t addr, uint64_t val);
     void ClearRegions();
 
-    uint64_t LoadVectorShiftLeft(uint32_t addr);
-    uint64_t LoadVectorShiftRight(uint32_t addr);
-    // vectores: carga 128-bits desde memoria
-    uint64_t LoadVectorRight(uint32_t addr);
-    uint64_t LoadVectorLeft(uint32_t addr);   
-
     size_t GetRegionCount() const { return regions.size(); }
+    const std::vector<MemoryRegion>& GetRegions() const { return regions; }
+    // true si todo [start, end) est mapeado (puede ser por varias regiones contiguas)
+    bool IsMapped(uint64_t start, uint64_t end) const;
     void SetVerboseLogging(bool verbose) { verbose_logging_ = verbose; } // Nuevo mtodo
     // D-cache & I-cache operations
     void DCACHE_Store(uint32_t addr);
@@ -64,16 +200,180 @@ public:
     void DCACHE_CleanInvalidate(uint32_t addr);
     void ICACHE_Invalidate(uint32_t addr);   
     
+    // Lanza GuestFault (alignment) si address no es mltiplo de alignment
     void CheckAlignment(uint64_t address, size_t alignment) const;
 
+    // TLB software (direct-mapped, pginas de 4 KiB). Hace de TLB en sombra: cachea la traduccin
+    // completa de la pgina efectiva a su regin y puntero del host. Se vaca al cambiar el mapa
+    // de regiones o el contexto de traduccin (ver SetMSR), y con slb*/tlbie.
+    static constexpr uint32_t TLB_PAGE_SHIFT = 12;
+    static constexpr uint64_t TLB_PAGE_SIZE = 1ull << TLB_PAGE_SHIFT;
+    static constexpr uint64_t TLB_PAGE_MASK = TLB_PAGE_SIZE - 1;
+    void FlushTLB();
+
+    // Traduccin de direcciones. El mapa de regiones est en espacio real. Con MSR[IR]
+    // (instrucciones) o MSR[DR] (datos) a 0 la direccin real es la efectiva con HRMOR (hipervisor,
+    // salvo con EA[0] = 1, que se quita) o RMOR; a 1, la SLB da el segmento y la tabla de pginas
+    // con hash (HTAB, en SDR1) la pgina. Slo un fallo del TLB recorre la SLB y la HTAB.
+    static constexpr uint64_t MSR_DR = 0x10;
+    static constexpr uint64_t MSR_IR = 0x20;
+    static constexpr uint64_t MSR_PR = 0x4000;
+    static constexpr uint64_t MSR_HV = 1ull << 60;
+    static constexpr size_t SLB_ENTRIES = 64;
+    // La CPU avisa de cada cambio de MSR; slo vaca el TLB si cambia la traduccin
+    void SetMSR(uint64_t msr);
+    const TranslationRegisters& GetTranslation() const { return translation_; }
+    void SetTranslation(const TranslationRegisters& registers);
+    void SetSDR1(uint64_t value);
+    void SetHRMOR(uint64_t value);
+    void SetRMOR(uint64_t value);
+    // slbmte/slbie/slbia/slbmfee/slbmfev (operandos RS/RB tal cual)
+    void SLBMoveTo(uint64_t rs, uint64_t rb);
+    void SLBInvalidateEntry(uint64_t rb);
+    void SLBInvalidateAll();
+    uint64_t SLBMoveFromESID(uint64_t rb) const;
+    uint64_t SLBMoveFromVSID(uint64_t rb) const;
+    // tlbie/tlbiel/tlbia: se descartan enteros el TLB y el cdigo decodificado. global = tambin
+    // en los dems hilos de hardware (lo atienden en PollRemoteCodeWrites).
+    void InvalidateTranslations(bool global);
+    // Direccin efectiva -> real para ese acceso, sin pasar por el TLB. Actualiza R/C en el PTE.
+    // Lanza GuestFault (DSI/ISI o de segmento) si no hay traduccin o no hay permiso.
+    uint64_t TranslateAddress(uint64_t ea, TLBAccess access);
+
+    // Seguimiento de pginas de cdigo (4 KiB, en espacio real mdulo 4 GB: un alias slo cuesta
+    // un aviso de ms). Se marcan con la direccin real del fetch (PPCBlockCache).
+    static constexpr uint32_t CODE_PAGE_SHIFT = 12;
+    void AddCodeWriteListener(CodeWriteListener* listener) { code_listeners_.push_back(listener); }
+    void RemoveCodeWriteListener(CodeWriteListener* listener) {
+        code_listeners_.erase(std::remove(code_listeners_.begin(), code_listeners_.end(), listener), code_listeners_.end());
+    }
+    void MarkCodePage(uint64_t address) {
+        const uint64_t page = (address & 0xFFFFFFFF) >> CODE_PAGE_SHIFT;
+        code_pages_[page >> 6].fetch_or(1ull << (page & 63), std::memory_order_relaxed);
+    }
+    bool IsCodePage(uint64_t address) const {
+        const uint64_t page = (address & 0xFFFFFFFF) >> CODE_PAGE_SHIFT;
+        return (code_pages_[page >> 6].load(std::memory_order_relaxed) >> (page & 63)) & 1;
+    }
+
+    // Pginas sucias: el TLB slo deja escribir por puntero en pginas ya marcadas (se marcan al
+    // rellenar la entrada de escritura), as que al borrar el bitmap hay que vaciar el TLB de todos
+    // los hilos (los dems lo hacen en su PollRemoteCodeWrites). Slo con las CPUs paradas.
+    void ClearDirtyPages(MemoryDevice& device);
+
+    // Journal de escrituras: guarda el contenido previo para poder deshacerlas (JIT diferencial)
+    void BeginWriteJournal() { journal_.clear(); journal_data_.clear(); journaling_ = true; }
+    void EndWriteJournal(bool rollback);
+
+    // Record/replay: las lecturas de dispositivos con ReadsDependOnHost se graban o se toman del
+    // log (Replay.h). nullptr = ejecucin normal. Slo la MMU del hilo 0.
+    void SetReplayLog(ReplayLog* log) { replay_ = log; }
+
 
 private:
+    // Puntero del host si la pgina est en el TLB para ese acceso y es RAM. Slo accesos con
+    // alineacin natural (size potencia de 2), que nunca cruzan el final de la pgina.
+    uint8_t* HostFast(uint64_t addr, TLBAccess access, uint64_t size) const {
+        if (addr & (size - 1)) return nullptr;
+        const TLBEntry& entry = tlb[(addr >> TLB_PAGE_SHIFT) & (TLB_SIZE - 1)];
+        if (entry.tag[access] != (addr >> TLB_PAGE_SHIFT) || !entry.host) return nullptr;
+        return entry.host + (addr & TLB_PAGE_MASK);
+    }
+    // Direccin real de addr cuando HostFast acaba de acertar en el TLB
+    uint64_t CachedReal(uint64_t addr) const {
+        return tlb[(addr >> TLB_PAGE_SHIFT) & (TLB_SIZE - 1)].real + (addr & TLB_PAGE_MASK);
+    }
+    uint8_t Read8Slow(uint64_t addr);
+    uint16_t Read16Slow(uint64_t addr);
+    uint32_t Read32Slow(uint64_t addr);
+    uint64_t Read64Slow(uint64_t addr);
+    uint32_t Fetch32Slow(uint64_t addr);
+    void Write8Slow(uint64_t addr, uint8_t val);
+    void Write16Slow(uint64_t addr, uint16_t value);
+    void Write32Slow(uint64_t addr, uint32_t value);
+    void Write64Slow(uint64_t addr, uint64_t value);
+
     MemoryRegion* FindRegion(uint64_t address, bool read, bool write, bool execute);
+    // ndice de la primera regin que termina despus de address (regions.size() si no hay)
+    size_t RegionIndex(uint64_t address) const;
+    void InsertRegion(const MemoryRegion& region);
+    void RegionsChanged();
+    // Camino rpido: tag compare. host apunta al byte de addr si la pgina es RAM directa;
+    // real es addr en espacio real.
+    MemoryRegion* Translate(uint64_t addr, TLBAccess access, uint8_t*& host, uint64_t& real) {
+        TLBEntry& entry = tlb[(addr >> TLB_PAGE_SHIFT) & (TLB_SIZE - 1)];
+        if (entry.tag[access] != (addr >> TLB_PAGE_SHIFT)) return RefillTLB(addr, access, host, real);
+        host = entry.host ? entry.host + (addr & TLB_PAGE_MASK) : nullptr;
+        real = entry.real + (addr & TLB_PAGE_MASK);
+        return entry.region;
+    }
+    MemoryRegion* RefillTLB(uint64_t addr, TLBAccess access, uint8_t*& host, uint64_t& real);
+    bool IsTranslated(TLBAccess access) const { return (msr_ & (access == TLB_EXEC ? MSR_IR : MSR_DR)) != 0; }
+    // Con traduccin la pgina siguiente puede estar en otro sitio: esos accesos van pgina a pgina
+    bool CrossesTranslatedPage(uint64_t addr, uint64_t size, TLBAccess access) const {
+        return IsTranslated(access) && (addr & TLB_PAGE_MASK) + size > TLB_PAGE_SIZE;
+    }
+    template <typename Fn> void ForEachPage(uint64_t addr, uint64_t size, Fn&& fn) {
+        for (uint64_t done = 0; done < size;) {
+            const uint64_t chunk = std::min(size - done, TLB_PAGE_SIZE - ((addr + done) & TLB_PAGE_MASK));
+            fn(addr + done, done, chunk);
+            done += chunk;
+        }
+    }
+    uint64_t WalkPageTable(uint64_t ea, TLBAccess access);
+    // Lectura/escritura de los PTE, en espacio real
+    uint64_t ReadReal64(uint64_t address);
+    void WriteReal64(uint64_t address, uint64_t value);
+    // SLB, HTAB o registros de traduccin cambiados: TLB y cdigo decodificado fuera
+    void TranslationChanged();
+    // Se llama antes de cada escritura de la CPU. El journal va por EA; reservas y pginas de
+    // cdigo por direccin real (real = address traducida)
+    void TrackWrite(uint64_t address, uint64_t real, uint64_t size) {
+        if (journaling_) JournalWrite(address, size);
+        if (reservations_->Active()) reservations_->Invalidate(real, size);
+        if (IsCodePage(real) || IsCodePage(real + size - 1)) NotifyCodeWrite(real, size);
+    }
+    void JournalWrite(uint64_t address, uint64_t size);
+    void NotifyCodeWrite(uint64_t address, uint64_t size);
+    void NotifyCodeFlush();
+    void PostRemoteCodeWrite(uint64_t address, uint64_t size);
+    // translation = tambin el cdigo decodificado (tlbie); si no, slo el TLB (ClearDirtyPages)
+    void PostRemoteFlush(bool translation);
+    void PostRemoteRegions(const std::vector<MemoryRegion>& table);
+    void DrainRemoteCodeWrites();
+    // Con varios hilos de hardware los accesos a MMIO se serializan (los dispositivos no son thread-safe)
+    std::unique_lock<std::mutex> LockDevice();
     //MemoryRegion* FindRegion(u64 address, bool write_access, bool exec_access);
-    std::vector<MemoryRegion> regions;
+    std::vector<MemoryRegion> regions; // ordenadas, sin solapes (ver MapMemory)
+    ReplayLog* replay_ = nullptr;
     bool verbose_logging_ = true; // Por defecto, logs activados   
 
-    static constexpr int TLB_SIZE = 16;
-    //std::array<TLBEntry, TLB_SIZE> tlb;
-    int tlb_next = 0; // ndice circular para reemplazo simple
+    static constexpr int TLB_SIZE = 1024; // potencia de 2
+    std::array<TLBEntry, TLB_SIZE> tlb;
+
+    std::shared_ptr<MMUShared> shared_;
+    std::atomic<uint64_t>* code_pages_; // 1 bit por pgina, en shared_
+    XenonReservations* reservations_;   // en shared_
+    std::vector<CodeWriteListener*> code_listeners_;
+
+    // Escrituras de otros hilos sobre pginas de cdigo: se entregan en el hilo dueo de los listeners
+    struct CodeRange { uint64_t address, size; };
+    std::atomic<bool> remote_pending_{ false };
+    std::mutex remote_mutex_;
+    std::vector<CodeRange> remote_writes_;
+    bool remote_flush_ = false;     // tlbie de otro hilo pendiente (con remote_mutex_)
+    bool remote_tlb_flush_ = false; // ClearDirtyPages de otro hilo pendiente (con remote_mutex_)
+    std::unique_ptr<std::vector<MemoryRegion>> remote_regions_; // mapa nuevo de otro hilo (con remote_mutex_)
+
+    uint64_t msr_ = 0;
+    TranslationRegisters translation_;
+
+    struct JournalEntry {
+        uint64_t address;
+        size_t offset;  // en journal_data_
+        size_t size;
+    };
+    bool journaling_ = false;
+    std::vector<JournalEntry> journal_;
+    std::vector<uint8_t> journal_data_;
 };
\ No newline at end of file
@@ -1,10 +1,140 @@
 // Main.cpp
 #include "PPCEmu.h"
 #include "PPCEmuConfig.h"
+#include "Log.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <string>
+
+static const char* USAGE = "Usage: PPCEmu [--jit off|on|diff] [--run free|realtime] [--count N] [--threads 1..6]\n"
+	"              [--vmx scalar|sse4.1|avx2] [--present window|null|ppm[:dir]|png[:dir]|shm[:name]]\n"
+	"              [--dump-interval N] [--map ADDR:FILE] [--map-cow ADDR:FILE] [--xex-key FILE]\n"
+	"              [--load-snapshot FILE] [--save-snapshot FILE] [--fork N]\n"
+	"              [--record FILE] [--snapshot-interval N] [--replay FILE] [--seek N] [binary]";
 
 int main(int argc, char* argv[]) {
 	PPCEmuConfig cfg;
+	std::string path = "./kernel/lk.elf";
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--jit" && i + 1 < argc) {
+			const std::string mode = argv[++i];
+			if (mode == "off") cfg.jitMode = JitMode::Off;
+			else if (mode == "on") cfg.jitMode = JitMode::On;
+			else if (mode == "diff") cfg.jitMode = JitMode::Differential;
+			else {
+				std::cerr << USAGE << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--run" && i + 1 < argc) {
+			const std::string mode = argv[++i];
+			if (mode == "free") cfg.runMode = RunMode::FreeRun;
+			else if (mode == "realtime") cfg.runMode = RunMode::RealTime;
+			else {
+				std::cerr << USAGE << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--present" && i + 1 < argc) {
+			// kind[:target], p.ej. png:out/frames o shm:PPCEmuFB
+			const std::string spec = argv[++i];
+			const size_t colon = spec.find(':');
+			const std::string kind = spec.substr(0, colon);
+			if (colon != std::string::npos) cfg.presenterTarget = spec.substr(colon + 1);
+			if (kind == "window") cfg.presenter = PresenterKind::Window;
+			else if (kind == "null") cfg.presenter = PresenterKind::Null;
+			else if (kind == "ppm") cfg.presenter = PresenterKind::PPM;
+			else if (kind == "png") cfg.presenter = PresenterKind::PNG;
+			else if (kind == "shm") cfg.presenter = PresenterKind::SharedMemory;
+			else {
+				std::cerr << USAGE << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--dump-interval" && i + 1 < argc) {
+			cfg.dumpInterval = uint32_t(std::strtoul(argv[++i], nullptr, 0));
+		}
+		else if (arg == "--threads" && i + 1 < argc) {
+			cfg.hardwareThreads = std::atoi(argv[++i]);
+			if (cfg.hardwareThreads < 1 || cfg.hardwareThreads > CPUManager::MAX_THREADS) {
+				std::cerr << USAGE << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--vmx" && i + 1 < argc) {
+			// Por defecto el mejor nivel del host; escalar sirve para descartar las versiones SIMD
+			const std::string isa = argv[++i];
+			if (isa == "scalar") cfg.vmxIsa = VMXIsa::Scalar;
+			else if (isa == "sse4.1") cfg.vmxIsa = VMXIsa::SSE41;
+			else if (isa == "avx2") cfg.vmxIsa = VMXIsa::AVX2;
+			else {
+				std::cerr << USAGE << std::endl;
+				return 1;
+			}
+			if (!VMXIsaSupported(cfg.vmxIsa)) {
+				std::cerr << "--vmx " << isa << ": not supported by this CPU" << std::endl;
+				return 1;
+			}
+		}
+		else if ((arg == "--map" || arg == "--map-cow") && i + 1 < argc) {
+			// ADDR:FILE, p.ej. 0x200C8000000:nand.bin (la ruta puede llevar ':' en Windows)
+			const std::string spec = argv[++i];
+			char* end = nullptr;
+			const uint64_t address = std::strtoull(spec.c_str(), &end, 0);
+			if (*end != ':' || end[1] == '\0') {
+				std::cerr << USAGE << std::endl;
+				return 1;
+			}
+			cfg.fileMappings.push_back({ address, end + 1, arg == "--map-cow" });
+		}
+		else if (arg == "--xex-key" && i + 1 < argc) {
+			cfg.xexKeyFiles.push_back(argv[++i]);
+		}
+		else if (arg == "--load-snapshot" && i + 1 < argc) {
+			cfg.snapshotLoad = argv[++i];
+		}
+		else if (arg == "--save-snapshot" && i + 1 < argc) {
+			cfg.snapshotSave = argv[++i];
+		}
+		else if (arg == "--fork" && i + 1 < argc) {
+			char* end = nullptr;
+			cfg.forkCount = std::strtoull(argv[++i], &end, 0);
+			if (cfg.forkCount == 0 || *end != '\0') {
+				std::cerr << USAGE << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--record" && i + 1 < argc) {
+			cfg.recordPath = argv[++i];
+		}
+		else if (arg == "--replay" && i + 1 < argc) {
+			cfg.replayPath = argv[++i];
+		}
+		else if ((arg == "--snapshot-interval" || arg == "--seek") && i + 1 < argc) {
+			char* end = nullptr;
+			const uint64_t value = std::strtoull(argv[++i], &end, 0);
+			if (*end != '\0') {
+				std::cerr << USAGE << std::endl;
+				return 1;
+			}
+			(arg == "--seek" ? cfg.replaySeek : cfg.snapshotInterval) = value;
+		}
+		else if (arg == "--count" && i + 1 < argc) {
+			char* end = nullptr;
+			cfg.instructionCount = std::strtoull(argv[++i], &end, 0);
+			if (cfg.instructionCount == 0 || *end != '\0') {
+				std::cerr << USAGE << std::endl;
+				return 1;
+			}
+			cfg.runMode = RunMode::FixedCount;
+		}
+		else {
+			path = arg;
+		}
+	}
 	// Optional: parse command-line args to override defaults
 	// e.g. cfg.fbWidth = std::stoi(argv[1]);
 	//      cfg.userBase = std::stoull(argv[2], nullptr, 16);
@@ -14,14 +144,47 @@ int main(int argc, char* argv[]) {
 	// emu.AutoLoad("./kernel/lk.elf");		
 
 	try {
+		const auto startup = std::chrono::steady_clock::now();
 		PPCEmu emu(cfg);
 		// Load binary (adjust path or pass as argv)
 		//emu.AutoLoad("./kernel/test.bin"); // ok
-		emu.AutoLoad("./kernel/lk.elf");
+		if (!cfg.replayPath.empty())
+			emu.StartReplay(cfg.replayPath, cfg.replaySeek);
+		else if (!cfg.snapshotLoad.empty())
+			emu.LoadSnapshot(cfg.snapshotLoad);
+		else
+			emu.AutoLoad(path);
+		if (!cfg.recordPath.empty())
+			emu.StartRecording(cfg.recordPath, cfg.snapshotInterval);
+		LOG_INFO("System", "Startup: %.1f ms, resident memory %.1f MB",
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startup).count(),
+			PPCEmu::GetResidentMemory() / (1024.0 * 1024.0));
+		if (cfg.forkCount) {
+			// Cada copia arranca desde el mismo punto con su índice en r3 y devuelve dónde acabó
+			const auto results = emu.ForkRun(cfg.forkCount, [](PPCEmu& copy, size_t index) {
+				copy.GetCPU().SetGPR(3, index);
+				copy.Run(60);
+				char summary[128];
+				snprintf(summary, sizeof(summary), "pc=0x%llX r3=0x%llX instructions=%llu",
+					(unsigned long long)copy.GetCPU().GetPC(), (unsigned long long)copy.GetCPU().GetGPR(3),
+					(unsigned long long)copy.GetInstructionCount());
+				return std::string(summary);
+			});
+			int failed = 0;
+			for (const ForkResult& r : results) {
+				LOG_INFO("System", "Copy %zu: status %d, %s", r.index, r.status, r.output.c_str());
+				failed += r.status != 0;
+			}
+			Log::Flush();
+			return failed ? 1 : 0;
+		}
 		// Run at 60 FPS
 		emu.Run(60);
+		if (!cfg.snapshotSave.empty())
+			emu.SaveSnapshot(cfg.snapshotSave);
 	}
 	catch (const std::exception& e) {
+		Log::Flush(); // que los mensajes encolados salgan antes del error
 		std::cerr << "Error: " << e.what() << std::endl;
 		return 1;
 	}
@@ -0,0 +1,84 @@
+// MappedFile.cpp
+#include "MappedFile.h"
+#include "Log.h"
+#include <fstream>
+#include <stdexcept>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path, Access access) : path_(path), access_(access) {
+#ifdef _WIN32
+	const bool cow = access == Access::CopyOnWrite;
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		access == Access::Load ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open file: " + path);
+	LARGE_INTEGER size{};
+	GetFileSizeEx(file, &size);
+	size_ = uint64_t(size.QuadPart);
+	HANDLE mapping = size_ ? CreateFileMappingA(file, nullptr, cow ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	void* view = mapping ? MapViewOfFile(mapping, cow ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (view) {
+		file_ = file;
+		mapping_ = mapping;
+		data_ = static_cast<uint8_t*>(view);
+		mapped_ = true;
+		return;
+	}
+	if (mapping) CloseHandle(mapping);
+	CloseHandle(file);
+#else
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) throw std::runtime_error("Cannot open file: " + path);
+	struct stat st{};
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		size_ = uint64_t(st.st_size);
+		const int prot = access == Access::CopyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+		void* view = mmap(nullptr, size_, prot, MAP_PRIVATE, fd, 0);
+		if (view != MAP_FAILED) {
+			if (access == Access::Load) {
+				// Se va a copiar entero y en orden: lectura anticipada agresiva
+				madvise(view, size_, MADV_SEQUENTIAL);
+				madvise(view, size_, MADV_WILLNEED);
+			}
+			close(fd);
+			data_ = static_cast<uint8_t*>(view);
+			mapped_ = true;
+			return;
+		}
+	}
+	close(fd);
+#endif
+	// Sin proyección: lectura en bloque
+	std::ifstream f(path, std::ios::binary | std::ios::ate);
+	if (!f) throw std::runtime_error("Cannot open file: " + path);
+	buffer_.resize(size_t(f.tellg()));
+	f.seekg(0);
+	if (!buffer_.empty() && !f.read(reinterpret_cast<char*>(buffer_.data()), std::streamsize(buffer_.size())))
+		throw std::runtime_error("Cannot read file: " + path);
+	data_ = buffer_.data();
+	size_ = buffer_.size();
+	LOG_DEBUG("Loader", "%s: not mappable, read %llu bytes", path.c_str(), (unsigned long long)size_);
+}
+
+MappedFile::~MappedFile() {
+	if (!mapped_) return;
+#ifdef _WIN32
+	UnmapViewOfFile(data_);
+	CloseHandle(mapping_);
+	CloseHandle(file_);
+#else
+	munmap(data_, size_);
+#endif
+}
+
+const uint8_t* MappedFile::At(uint64_t offset, uint64_t size) const {
+	if (offset > size_ || size > size_ - offset)
+		throw std::runtime_error(path_ + ": range 0x" + std::to_string(offset) + "+" + std::to_string(size) + " out of bounds");
+	return data_ + offset;
+}
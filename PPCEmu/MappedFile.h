@@ -0,0 +1,49 @@
+// MappedFile.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Fichero de imagen (ELF, RAW, XEX) proyectado en memoria de sólo lectura. Los cargadores validan
+// las cabeceras en su sitio y copian cada segmento a la RAM del guest con una sola transferencia
+// desde la proyección, sin leer el fichero a un std::vector antes.
+// Si el SO no puede proyectarlo (fichero vacío, tubería...) se lee entero a un buffer.
+// FileMemory la usa también como RAM del guest respaldada por el fichero (ReadOnly/CopyOnWrite).
+class MappedFile {
+public:
+    enum class Access {
+        Load,        // sólo lectura, se va a leer entero y en orden: lectura anticipada
+        ReadOnly,    // sólo lectura, páginas bajo demanda
+        CopyOnWrite, // escribible; las páginas modificadas son privadas y el fichero no cambia
+    };
+    explicit MappedFile(const std::string& path, Access access = Access::Load);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* GetData() const { return data_; }
+    // nullptr salvo en CopyOnWrite
+    uint8_t* GetWritableData() const { return access_ == Access::CopyOnWrite ? data_ : nullptr; }
+    uint64_t GetSize() const { return size_; }
+    const std::string& GetPath() const { return path_; }
+    bool IsMapped() const { return mapped_; }
+
+    // Puntero a [offset, offset + size) del fichero; lanza std::runtime_error si se sale
+    const uint8_t* At(uint64_t offset, uint64_t size) const;
+    // Estructura en disco (cabecera, tabla de secciones) leída en su sitio, con comprobación de límites
+    template <typename T> const T& As(uint64_t offset) const {
+        return *reinterpret_cast<const T*>(At(offset, sizeof(T)));
+    }
+
+private:
+    std::string path_;
+    Access access_;
+    uint8_t* data_ = nullptr;
+    uint64_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<uint8_t> buffer_; // sólo si no se pudo proyectar
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
@@ -1,112 +1,152 @@
 ﻿// Memory.cpp
 #include "Memory.h"
+#include "Endian.h"
 #include "Log.h"
 #include <cstring>
-
-Memory::Memory(const std::string& name) : MemoryDevice(name) {
-	data_.resize(XBOX360_RAM_SIZE); // 512 MB
-	LOG_INFO("Memory", "[%s] initialized: %zu bytes.", name.c_str(), data_.size());
+#include <new>
+#include <stdexcept>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+Memory::Memory(const std::string& name, uint64_t size) : MemoryDevice(name), size_(size) {
+	// Reserva sin inicializar: el SO entrega páginas a cero en el primer acceso (commit bajo demanda).
+	// En Windows el commit sólo descuenta del límite de commit; la página física llega al tocarla.
+#ifdef _WIN32
+	data_ = static_cast<uint8_t*>(VirtualAlloc(nullptr, size_, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+	if (!data_) throw std::bad_alloc();
+#else
+	void* base = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (base == MAP_FAILED) throw std::bad_alloc();
+	data_ = static_cast<uint8_t*>(base);
+#endif
+	const uint64_t pages = (size_ + DIRTY_PAGE_SIZE - 1) >> DIRTY_PAGE_SHIFT;
+	dirtyWords_ = (pages + 63) / 64;
+	dirty_.reset(new std::atomic<uint64_t>[dirtyWords_]());
+	LOG_INFO("Memory", "[%s] reserved: %llu bytes.", name.c_str(), size_);
+}
+
+Memory::~Memory() {
+#ifdef _WIN32
+	VirtualFree(data_, 0, MEM_RELEASE);
+#else
+	munmap(data_, size_);
+#endif
 }
 
 void Memory::Read(uint64_t address, void* data, size_t size) {
-	if (address + size > data_.size()) {
-		std::cout << "Memory read out of bounds: addr=0x" << std::hex << address
-			<< ", size=" << std::dec << size << ", limit=" << data_.size() << std::endl;
+	if (address + size > size_) {
+		LOG_ERROR("Memory", "Read out of bounds: addr=0x%016llX, size=%zu, limit=%llu", address, size, size_);
 		throw std::out_of_range("Read: Memory out of bounds");
 	}
-	memcpy(data, data_.data() + address, size);
-	std::cout << "Memory::Read: addr=0x" << std::hex << address << ", size=" << std::dec << size << "\n";
+	memcpy(data, data_ + address, size);
+	LOG_TRACE("Memory", "Read: addr=0x%016llX, size=%zu", address, size);
 }
 
 void Memory::Write(uint64_t offset, const void* src, uint64_t size) {
-	if (offset + size > XBOX360_RAM_SIZE) {
-		std::cerr << "Memory write out of bounds: offset=0x" << std::hex << offset
-			<< ", size=0x" << size << ", limit=0x" << XBOX360_RAM_SIZE << std::dec << "\n";
+	if (offset + size > size_) {
+		LOG_ERROR("Memory", "Write out of bounds: offset=0x%016llX, size=0x%llX, limit=0x%llX", offset, size, size_);
 		throw std::runtime_error("Memory: Write out of bounds");
 	}
-	std::cout << "[DEBUG] Memory::Write: offset=0x" << std::hex << offset
-		<< ", size=" << std::dec << size << ", endAddr=0x" << std::hex << (offset + size - 1)
-		<< ", limit=0x" << XBOX360_RAM_SIZE << std::dec << "\n";
-	memcpy(&data_[offset], src, size);
+	LOG_TRACE("Memory", "Write: offset=0x%016llX, size=%llu", offset, size);
+	MarkDirtyPages(dirty_.get(), offset, size);
+	memcpy(data_ + offset, src, size);
 }
 
 void Memory::MemSet(uint64_t address, uint8_t value, size_t size) {
-	if (address + size > data_.size()) {
+	if (address + size > size_) {
 		throw std::out_of_range("MemSet: Memory out of bounds");
 	}
-	memset(data_.data() + address, value, size);
+	MarkDirtyPages(dirty_.get(), address, size);
+	memset(data_ + address, value, size);
+}
+
+void Memory::ResetPages(uint64_t offset, uint64_t size) {
+	if (offset + size > size_) throw std::out_of_range("ResetPages: Memory out of bounds");
+	uint64_t start = offset, end = offset + size;
+#ifndef _WIN32
+	// Las páginas del host enteras se devuelven al SO (vuelven a leerse a cero, sin ocupar RAM);
+	// los bordes, si la página del host es mayor que DIRTY_PAGE_SIZE, se ponen a cero a mano
+	const uint64_t hostPage = uint64_t(sysconf(_SC_PAGESIZE));
+	const uint64_t alignedStart = (start + hostPage - 1) & ~(hostPage - 1), alignedEnd = end & ~(hostPage - 1);
+	if (alignedStart < alignedEnd && madvise(data_ + alignedStart, alignedEnd - alignedStart, MADV_DONTNEED) == 0) {
+		memset(data_ + start, 0, alignedStart - start);
+		start = alignedEnd;
+	}
+#endif
+	memset(data_ + start, 0, end - start);
+	for (uint64_t page = offset >> DIRTY_PAGE_SHIFT; page < (end + DIRTY_PAGE_SIZE - 1) >> DIRTY_PAGE_SHIFT; ++page)
+		dirty_[page >> 6].fetch_and(~(1ull << (page & 63)), std::memory_order_relaxed);
+}
+
+uint64_t Memory::CountDirtyPages() const {
+	uint64_t count = 0;
+	for (uint64_t i = 0; i < dirtyWords_; ++i) {
+		uint64_t word = dirty_[i].load(std::memory_order_relaxed);
+		for (; word; word &= word - 1) ++count;
+	}
+	return count;
 }
 
 uint8_t* Memory::GetPointerToAddress(uint64_t address) {
-	if (address >= data_.size()) {
-		std::cerr << "Error: GetPointerToAddress: addr=0x" << std::hex << address << " out of bounds, size=0x" << data_.size() << std::dec << "\n";
+	if (address >= size_) {
+		LOG_ERROR("Memory", "GetPointerToAddress: addr=0x%016llX out of bounds, size=0x%llX", address, size_);
 		throw std::out_of_range("GetPointerToAddress: Memory address out of bounds");
 	}
-	return data_.data() + address;
+	return data_ + address;
 }
 
 uint16_t Memory::Read16(uint64_t address) {
 	CheckAlignment(address, 2);
-	if (address + 2 > data_.size()) {
+	if (address + 2 > size_) {
 		throw std::out_of_range("Read16: Memory out of bounds");
 	}
-	uint8_t* ptr = data_.data() + address;
-	uint16_t value = (ptr[0] << 8) | ptr[1]; // Big-endian
-	std::cout << "Memory::Read16: addr=0x" << std::hex << address << ", value=0x" << value << std::dec << "\n";
+	uint16_t value = LoadBE16(data_ + address);
+	LOG_TRACE("Memory", "Read16: addr=0x%016llX, value=0x%04X", address, value);
 	return value;
 }
 
 uint32_t Memory::Read32(uint64_t address) {
 	CheckAlignment(address, 4);
-	if (address + 4 > data_.size()) {
-		std::cerr << "Error: Read32: addr=0x" << std::hex << address << " out of bounds, size=0x" << data_.size() << std::dec << "\n";
+	if (address + 4 > size_) {
+		LOG_ERROR("Memory", "Read32: addr=0x%016llX out of bounds, size=0x%llX", address, size_);
 		throw std::out_of_range("Read32: Memory out of bounds");
 	}
-	uint8_t* ptr = data_.data() + address;
-	uint32_t value = (ptr[0] << 24) | (ptr[1] << 16) | (ptr[2] << 8) | ptr[3]; // Big-endian
-	std::cout << "Memory::Read32: addr=0x" << std::hex << address << ", value=0x" << value << std::dec << "\n";
+	uint32_t value = LoadBE32(data_ + address);
+	LOG_TRACE("Memory", "Read32: addr=0x%016llX, value=0x%08X", address, value);
 	return value;
 }
 
 
 uint64_t Memory::Read64(uint64_t address) {
-	if (address + 8 > data_.size()) {
+	if (address + 8 > size_) {
 		throw std::out_of_range("Read64: Memory out of bounds");
 	}
-	uint8_t* ptr = data_.data() + address;
-	uint64_t value = ((uint64_t)ptr[0] << 56) | ((uint64_t)ptr[1] << 48) | ((uint64_t)ptr[2] << 40) | ((uint64_t)ptr[3] << 32) |
-		((uint64_t)ptr[4] << 24) | ((uint64_t)ptr[5] << 16) | ((uint64_t)ptr[6] << 8) | ptr[7]; // Big-endian
-	std::cout << "Memory::Read64: addr=0x" << std::hex << address << ", value=0x" << value << std::dec << "\n";
+	uint64_t value = LoadBE64(data_ + address);
+	LOG_TRACE("Memory", "Read64: addr=0x%016llX, value=0x%016llX", address, value);
 	return value;
 }
 
 void Memory::Write32(uint64_t address, uint32_t value) {
 	CheckAlignment(address, 4);
-	if (address + 4 > data_.size()) {
+	if (address + 4 > size_) {
 		throw std::out_of_range("Write32: Memory out of bounds");
 	}
-	uint8_t* ptr = data_.data() + address;
-	ptr[0] = (value >> 24) & 0xFF;
-	ptr[1] = (value >> 16) & 0xFF;
-	ptr[2] = (value >> 8) & 0xFF;
-	ptr[3] = value & 0xFF; // Big-endian
-	std::cout << "Memory::Write32: addr=0x" << std::hex << address << ", value=0x" << value << std::dec << "\n";
+	MarkDirtyPages(dirty_.get(), address, 4);
+	StoreBE32(data_ + address, value);
+	LOG_TRACE("Memory", "Write32: addr=0x%016llX, value=0x%08X", address, value);
 }
 
 void Memory::Write64(uint64_t address, uint64_t value) {
-	if (address + 8 > data_.size()) {
+	if (address + 8 > size_) {
 		throw std::out_of_range("Write64: Memory out of bounds");
 	}
-	uint8_t* ptr = data_.data() + address;
-	ptr[0] = (value >> 56) & 0xFF;
-	ptr[1] = (value >> 48) & 0xFF;
-	ptr[2] = (value >> 40) & 0xFF;
-	ptr[3] = (value >> 32) & 0xFF;
-	ptr[4] = (value >> 24) & 0xFF;
-	ptr[5] = (value >> 16) & 0xFF;
-	ptr[6] = (value >> 8) & 0xFF;
-	ptr[7] = value & 0xFF; // Big-endian
-	std::cout << "Memory::Write64: addr=0x" << std::hex << address << ", value=0x" << value << std::dec << "\n";
+	MarkDirtyPages(dirty_.get(), address, 8);
+	StoreBE64(data_ + address, value);
+	LOG_TRACE("Memory", "Write64: addr=0x%016llX, value=0x%016llX", address, value);
 }
 
 void Memory::CheckAlignment(uint64_t address, size_t alignment) const {
@@ -117,7 +157,7 @@ void Memory::CheckAlignment(uint64_t address, size_t alignment) const {
 }
 
 uint64_t Memory::GetOffset(uint64_t address) const {
-	if (address >= XBOX360_RAM_SIZE) {
+	if (address >= size_) {
 		LOG_CRITICAL("System", "Invalid memory access at 0x%016llX!", address);
 		throw std::out_of_range("GetOffset: Invalid memory address");
 	}
@@ -125,21 +165,17 @@ uint64_t Memory::GetOffset(uint64_t address) const {
 }
 
 uint16_t Memory::Swap16(uint16_t value) const {
-	return ((value & 0xFF) << 8) | ((value >> 8) & 0xFF);
+	return ByteSwap16(value);
 }
 
 uint32_t Memory::Swap32(uint32_t value) const {
-	return ((value & 0xFF) << 24) | ((value & 0xFF00) << 8) |
-		((value >> 8) & 0xFF00) | ((value >> 24) & 0xFF);
+	return ByteSwap32(value);
 }
 
 uint64_t Memory::Swap64(uint64_t value) const {
-	return ((value & 0xFF) << 56) | ((value & 0xFF00) << 40) |
-		((value & 0xFF0000) << 24) | ((value & 0xFF000000) << 8) |
-		((value >> 8) & 0xFF000000) | ((value >> 24) & 0xFF0000) |
-		((value >> 40) & 0xFF00) | ((value >> 56) & 0xFF);
+	return ByteSwap64(value);
 }
 
 uint64_t Memory::GetSize() const {
-	return data_.size();
+	return size_;
 }
@@ -4,7 +4,7 @@
 #include <string>
 #include <cstdint>
 #include <memory>
-#include <vector>
+#include <atomic>
 #include "MemoryDevice.h"
 
 using u8 = uint8_t;
@@ -17,11 +17,22 @@ static constexpr u64 XBOX360_RAM_SIZE = 512ULL * 1024 * 1024;
 
 class Memory : public MemoryDevice {
 public:
-    Memory(const std::string& name);
+    // Reserva el espacio de direcciones sin tocarlo: las pginas se materializan (a cero) en el
+    // primer acceso, as una RAM de 512 MB apenas usada no cuesta 512 MB residentes.
+    explicit Memory(const std::string& name, uint64_t size = XBOX360_RAM_SIZE);
+    ~Memory() override;
+    Memory(const Memory&) = delete;
+    Memory& operator=(const Memory&) = delete;
     void Read(uint64_t address, void* data, size_t size) override;
     void Write(uint64_t address, const void* data, size_t size) override;    
     void MemSet(uint64_t address, uint8_t value, size_t size) override;
     uint8_t* GetPointerToAddress(uint64_t address) override;
+    bool IsDirectMapped() const override { return true; }
+    // Pginas escritas desde el arranque (o desde la ltima restauracin): las que van al snapshot
+    std::atomic<uint64_t>* GetDirtyPages() override { return dirty_.get(); }
+    // Vuelven a ser pginas a cero sin materializar (madvise en POSIX)
+    void ResetPages(uint64_t offset, uint64_t size) override;
+    uint64_t CountDirtyPages() const;
     uint16_t Read16(uint64_t address);
     uint32_t Read32(uint64_t address) override;
     void Write32(uint64_t address, uint32_t value) override;
@@ -35,6 +46,9 @@ public:
     uint64_t GetSize() const override;
 
 private:
-    std::vector<uint8_t> data_;
+    uint8_t* data_ = nullptr;
+    uint64_t size_ = 0;
+    uint64_t dirtyWords_ = 0;
+    std::unique_ptr<std::atomic<uint64_t>[]> dirty_;
 };
 #endif
\ No newline at end of file
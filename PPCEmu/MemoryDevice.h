@@ -1,7 +1,10 @@
 // MemoryDevice.h
 #pragma once
+#include <atomic>
 #include <cstdint>
+#include <iosfwd>
 #include <string>
+#include "Endian.h"
 
 using u8 = uint8_t;
 using u16 = uint16_t;
@@ -19,16 +22,16 @@ public:
     virtual void Write(uint64_t address, const void* data, size_t size) = 0;
     virtual void MemSet(uint64_t address, uint8_t value, size_t size) = 0;
 
-    // Typed accessors
+    // Typed accessors: el contenido del dispositivo es big-endian, como lo ve el Xenon
     virtual uint8_t Read8(uint64_t address) {
         uint8_t v;
         Read(address, &v, 1);
         return v;
     }
     virtual uint16_t Read16(uint64_t address) {
-        uint16_t v;
-        Read(address, &v, 2);
-        return v;
+        uint8_t bytes[2];
+        Read(address, bytes, 2);
+        return LoadBE16(bytes);
     }
     virtual uint32_t Read32(uint64_t address) = 0;
     virtual uint64_t Read64(uint64_t address) = 0;
@@ -37,13 +40,37 @@ public:
         Write(address, &value, 1);
     }
     virtual void Write16(uint64_t address, uint16_t value) {
-        Write(address, &value, 2);
+        uint8_t bytes[2];
+        StoreBE16(bytes, value);
+        Write(address, bytes, 2);
     }
     virtual void Write32(uint64_t address, uint32_t value) = 0;
     virtual void Write64(uint64_t address, uint64_t value) = 0;
 
     // Direct pointer access (for optimization/MMIO mapping)
     virtual uint8_t* GetPointerToAddress(uint64_t address) = 0;
+    // True if GetPointerToAddress returns stable, contiguous host memory that can be
+    // read and written directly (no side effects), so the MMU may cache the pointer
+    virtual bool IsDirectMapped() const { return false; }
+    // Las regiones sobre un dispositivo de sólo lectura nunca se mapean como escribibles
+    virtual bool IsReadOnly() const { return false; }
+    // Seguimiento de páginas modificadas (DIRTY_PAGE_SIZE, por offset dentro del dispositivo):
+    // un bit por página, o nullptr si el dispositivo no lo lleva. Lo marcan el propio dispositivo
+    // y la MMU en las escrituras por puntero del host (ver MMU::ClearDirtyPages).
+    static constexpr uint32_t DIRTY_PAGE_SHIFT = 12;
+    static constexpr uint64_t DIRTY_PAGE_SIZE = 1ull << DIRTY_PAGE_SHIFT;
+    virtual std::atomic<uint64_t>* GetDirtyPages() { return nullptr; }
+    // Devuelve [offset, offset + size) a su contenido inicial (ceros en la RAM, el fichero en
+    // copy-on-write) y lo deja limpio. Lo usa la restauración de snapshots.
+    virtual void ResetPages(uint64_t offset, uint64_t size) { MemSet(offset, 0, size); }
+
+    // Estado propio del dispositivo que no está en su memoria (registros, buffers internos),
+    // para los snapshots (ver Snapshot.h)
+    virtual void SerializeState(std::ostream& out) { (void)out; }
+    virtual void DeserializeState(std::istream& in) { (void)in; }
+    // Record/replay (Replay.h): las lecturas por la MMU de un dispositivo no directo son entradas
+    // del guest y se graban, salvo que devuelvan sólo lo que el propio guest escribió (false)
+    virtual bool ReadsDependOnHost() const { return true; }
 
     // Total size of the device's memory    
     virtual uint64_t GetSize() const = 0;
@@ -53,3 +80,14 @@ public:
 protected:
     std::string name_;
 };
+
+// Marca como sucias las páginas de [offset, offset + size) en el bitmap de GetDirtyPages
+inline void MarkDirtyPages(std::atomic<uint64_t>* dirty, uint64_t offset, uint64_t size) {
+    if (!size) return;
+    const uint64_t last = (offset + size - 1) >> MemoryDevice::DIRTY_PAGE_SHIFT;
+    for (uint64_t page = offset >> MemoryDevice::DIRTY_PAGE_SHIFT; page <= last; ++page) {
+        const uint64_t bit = 1ull << (page & 63);
+        if (!(dirty[page >> 6].load(std::memory_order_relaxed) & bit))
+            dirty[page >> 6].fetch_or(bit, std::memory_order_relaxed);
+    }
+}
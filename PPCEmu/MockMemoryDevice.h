@@ -27,23 +27,23 @@ public:
     }
 
     uint32_t Read32(uint64_t address) override {
-        uint32_t value;
-        Read(address, &value, sizeof(value));
-        return value;
+        CheckBounds(address, 4);
+        return LoadBE32(&memory[address]);
     }
 
     uint64_t Read64(uint64_t address) override {
-        uint64_t value;
-        Read(address, &value, sizeof(value));
-        return value;
+        CheckBounds(address, 8);
+        return LoadBE64(&memory[address]);
     }
 
     void Write32(uint64_t address, uint32_t value) override {
-        Write(address, &value, sizeof(value));
+        CheckBounds(address, 4);
+        StoreBE32(&memory[address], value);
     }
 
     void Write64(uint64_t address, uint64_t value) override {
-        Write(address, &value, sizeof(value));
+        CheckBounds(address, 8);
+        StoreBE64(&memory[address], value);
     }
 
     uint8_t* GetPointerToAddress(uint64_t address) override {
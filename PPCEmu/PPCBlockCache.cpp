@@ -0,0 +1,111 @@
+// PPCBlockCache.cpp
+#include "PPCBlockCache.h"
+#include <stdexcept>
+
+PPCBlockCache::PPCBlockCache(MMU* mmu) : mmu_(mmu) {
+	mmu_->AddCodeWriteListener(this);
+}
+
+PPCBlockCache::~PPCBlockCache() {
+	mmu_->RemoveCodeWriteListener(this);
+}
+
+// b, bc, sc, bclr, bcctr, rfi, rfid, hrfid y mtspr DEC/HDEC
+bool PPCBlockCache::IsBlockTerminator(uint32_t instr) {
+	switch (instr >> 26) {
+	case 16:
+	case 17:
+	case 18:
+		return true;
+	case 19:
+		switch ((instr >> 1) & 0x3FF) {
+		case 16:  // bclr
+		case 18:  // rfid
+		case 50:  // rfi
+		case 274: // hrfid
+		case 528: // bcctr
+			return true;
+		}
+		return false;
+	case 31:
+		// mtspr DEC/HDEC: RunBlock fija el corte del timer al entrar en el bloque
+		if (((instr >> 1) & 0x3FF) == 467) {
+			const uint32_t spr = ((instr >> 16) & 0x1F) | (((instr >> 11) & 0x1F) << 5);
+			return spr == 22 || spr == 310;
+		}
+		return false;
+	default:
+		return false;
+	}
+}
+
+PPCBlock* PPCBlockCache::Lookup(uint32_t pc, bool translated) {
+	if (!retired_.empty()) retired_.clear();
+	const uint32_t key = Key(pc, translated);
+	auto it = blocks_.find(key);
+	if (it != blocks_.end()) return it->second.get();
+	return Translate(pc, key);
+}
+
+PPCBlock* PPCBlockCache::Translate(uint32_t pc, uint32_t key) {
+	if (pc % 4 != 0) {
+		throw std::runtime_error("FetchInstruction: PC misaligned");
+	}
+	auto block = std::make_unique<PPCBlock>();
+	block->start_pc = pc;
+	const PPCDecoder& decoder = PPCDecoder::Instance();
+
+	// La primera instrucción debe poder leerse; si falla más adelante, el bloque se corta ahí
+	uint32_t addr = pc;
+	uint32_t instr = mmu_->Fetch32(addr);
+	while (true) {
+		block->ops.push_back(decoder.Decode(instr));
+		addr += 4;
+		if (IsBlockTerminator(instr) || block->ops.size() >= MAX_BLOCK_INSTRS ||
+			(addr >> PAGE_SHIFT) != (pc >> PAGE_SHIFT)) {
+			break;
+		}
+		try {
+			instr = mmu_->Fetch32(addr);
+		}
+		catch (const std::exception&) {
+			break;
+		}
+	}
+
+	// Las escrituras llegan por dirección real: el bloque se registra en su página real
+	block->real_start = mmu_->RealAddress(pc, TLB_EXEC);
+	mmu_->MarkCodePage(block->real_start);
+	page_blocks_[uint32_t(block->real_start) >> PAGE_SHIFT].push_back(key);
+	PPCBlock* result = block.get();
+	blocks_[key] = std::move(block);
+	return result;
+}
+
+void PPCBlockCache::Retire(uint32_t key) {
+	auto it = blocks_.find(key);
+	if (it == blocks_.end()) return;
+	it->second->valid = false;
+	retired_.push_back(std::move(it->second));
+	blocks_.erase(it);
+}
+
+void PPCBlockCache::Invalidate(uint64_t address, uint64_t size) {
+	const uint32_t first = uint32_t(address) >> PAGE_SHIFT;
+	const uint32_t last = uint32_t(address + (size ? size - 1 : 0)) >> PAGE_SHIFT;
+	for (uint32_t page = first; page <= last; ++page) {
+		auto it = page_blocks_.find(page);
+		if (it == page_blocks_.end()) continue;
+		for (uint32_t key : it->second) Retire(key);
+		page_blocks_.erase(it);
+	}
+}
+
+void PPCBlockCache::Flush() {
+	for (auto& entry : blocks_) {
+		entry.second->valid = false;
+		retired_.push_back(std::move(entry.second));
+	}
+	blocks_.clear();
+	page_blocks_.clear();
+}
@@ -0,0 +1,59 @@
+// PPCBlockCache.h
+#pragma once
+#include "MMU.h"
+#include "PPCDecoder.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Straight-line run of predecoded guest instructions, ending at the first branch/sc/rfi.
+// A block never crosses a 4 KiB page, so it sits in a single real page and page invalidation is exact.
+struct PPCBlock {
+    uint32_t start_pc = 0;
+    uint64_t real_start = 0;      // Real address start_pc was fetched from (code page tracking)
+    bool valid = true;  // Cleared when invalidated while executing
+    std::vector<PPCDecodedInstr> ops;
+    uint32_t exec_count = 0;      // Executions so far, saturates at the JIT threshold
+    void* jit_code = nullptr;     // PPCJit::BlockFn once compiled
+    bool jit_mode64 = false;      // MSR[SF] the native code was compiled for
+};
+
+// Basic-block cache keyed by guest PC and MSR[IR]: the same address fetched with and without
+// translation may be different code. Invalidated through icbi (MMU::ICACHE_Invalidate), any
+// write to a real page holding cached code (whatever EA it comes through), and MMU remaps or
+// translation changes.
+// Blocks are indexed by real page modulo 4 GB, like the MMU code page bitmap.
+class PPCBlockCache : public CodeWriteListener {
+public:
+    static constexpr uint32_t MAX_BLOCK_INSTRS = 64;
+    static constexpr uint32_t PAGE_SHIFT = MMU::CODE_PAGE_SHIFT;
+
+    explicit PPCBlockCache(MMU* mmu);
+    ~PPCBlockCache() override;
+    PPCBlockCache(const PPCBlockCache&) = delete;
+    PPCBlockCache& operator=(const PPCBlockCache&) = delete;
+
+    // Returns the block starting at pc, decoding it on a miss. translated = MSR[IR].
+    PPCBlock* Lookup(uint32_t pc, bool translated = false);
+    // address is real (see CodeWriteListener)
+    void Invalidate(uint64_t address, uint64_t size);
+    void Flush();
+    size_t GetBlockCount() const { return blocks_.size(); }
+
+    void OnCodeWrite(uint64_t address, uint64_t size) override { Invalidate(address, size); }
+    void OnCodeFlush() override { Flush(); }
+
+    static bool IsBlockTerminator(uint32_t instr);
+
+private:
+    // Block key: pc with MSR[IR] in bit 0 (pc is word-aligned)
+    static uint32_t Key(uint32_t pc, bool translated) { return pc | (translated ? 1u : 0u); }
+    PPCBlock* Translate(uint32_t pc, uint32_t key);
+    void Retire(uint32_t key);
+
+    MMU* mmu_;
+    std::unordered_map<uint32_t, std::unique_ptr<PPCBlock>> blocks_;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> page_blocks_; // real page -> block keys
+    // Blocks invalidated while possibly still running; freed on the next Lookup
+    std::vector<std::unique_ptr<PPCBlock>> retired_;
+};
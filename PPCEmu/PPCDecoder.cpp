@@ -0,0 +1,539 @@
+// PPCDecoder.cpp
+#include "PPCDecoder.h"
+#include "PPCInterpreter.h"
+
+const PPCDecoder& PPCDecoder::Instance() {
+	static const PPCDecoder decoder;
+	return decoder;
+}
+
+void PPCDecoder::Register(uint32_t primary, PPCInstrHandler handler) {
+	primary_[primary].handler = handler;
+}
+
+void PPCDecoder::AddExtendedTable(uint32_t primary, uint32_t shift, uint32_t mask) {
+	extended_[primary].assign(mask + 1, &PPCInterpreter::Legacy);
+	primary_[primary].table = extended_[primary].data();
+	primary_[primary].shift = shift;
+	primary_[primary].mask = mask;
+}
+
+void PPCDecoder::RegisterExtended(uint32_t primary, uint32_t xo, PPCInstrHandler handler) {
+	extended_[primary][xo] = handler;
+}
+
+void PPCDecoder::RegisterVMX(uint32_t primary, uint32_t xo, PPCInstrHandler handler, VMXOp kernel) {
+	if (vmxOps_[primary].empty()) vmxOps_[primary].assign(extended_[primary].size(), 0);
+	extended_[primary][xo] = handler;
+	vmxOps_[primary][xo] = uint16_t(kernel);
+}
+
+void PPCDecoder::RegisterVMX128(uint32_t primary, uint32_t mask, uint32_t value, PPCInstrHandler handler, VMXOp kernel) {
+	const PrimaryEntry& e = primary_[primary];
+	for (uint32_t xo = 0; xo <= e.mask; ++xo)
+		if (((xo << e.shift) & mask) == value) RegisterVMX(primary, xo, handler, kernel);
+}
+
+PPCDecoder::PPCDecoder() {
+	using I = PPCInterpreter;
+	for (auto& e : primary_) e.handler = &I::Legacy;
+
+	// Primary opcodes
+	Register(2, &I::tdi);
+	Register(3, &I::twi);
+	Register(7, &I::mulli);
+	Register(8, &I::subfic);
+	Register(10, &I::cmpli);
+	Register(11, &I::cmpi);
+	Register(12, &I::addic);
+	Register(13, &I::addicx);
+	Register(14, &I::addi);
+	Register(15, &I::addis);
+	Register(16, &I::bc);
+	Register(17, &I::sc);
+	Register(18, &I::b);
+	Register(20, &I::rlwimi);
+	Register(21, &I::rlwinm);
+	Register(23, &I::rlwnm);
+	Register(24, &I::ori);
+	Register(25, &I::oris);
+	Register(26, &I::xori);
+	Register(27, &I::xoris);
+	Register(28, &I::andi);
+	Register(29, &I::andis);
+	Register(32, &I::lwz);
+	Register(33, &I::lwzu);
+	Register(34, &I::lbz);
+	Register(35, &I::lbzu);
+	Register(36, &I::stw);
+	Register(37, &I::stwu);
+	Register(38, &I::stb);
+	Register(39, &I::stbu);
+	Register(40, &I::lhz);
+	Register(41, &I::lhzu);
+	Register(42, &I::lha);
+	Register(43, &I::lhau);
+	Register(44, &I::sth);
+	Register(45, &I::sthu);
+	Register(46, &I::lmw);
+	Register(47, &I::stmw);
+	Register(48, &I::lfs);
+	Register(49, &I::lfsu);
+	Register(50, &I::lfd);
+	Register(51, &I::lfdu);
+	Register(52, &I::stfs);
+	Register(53, &I::stfsu);
+	Register(54, &I::stfd);
+	Register(55, &I::stfdu);
+
+	// Opcodes 58/62: DS-form, XO in the low two bits
+	AddExtendedTable(58, 0, 3);
+	RegisterExtended(58, 0, &I::ld);
+	RegisterExtended(58, 1, &I::ldu);
+	RegisterExtended(58, 2, &I::lwa);
+	AddExtendedTable(62, 0, 3);
+	RegisterExtended(62, 0, &I::std);
+	RegisterExtended(62, 1, &I::stdu);
+
+	// Opcode 30: MD-form XO in bits 27-29 with sh[5] below it, MDS-form XO in bits 27-30
+	AddExtendedTable(30, 1, 0xF);
+	for (uint32_t sh5 = 0; sh5 < 2; ++sh5) {
+		RegisterExtended(30, 0 | sh5, &I::rldicl);
+		RegisterExtended(30, 2 | sh5, &I::rldicr);
+		RegisterExtended(30, 4 | sh5, &I::rldic);
+		RegisterExtended(30, 6 | sh5, &I::rldimi);
+	}
+	RegisterExtended(30, 8, &I::rldcl);
+	RegisterExtended(30, 9, &I::rldcr);
+
+	// Opcode 19: XL-form, XO in bits 21-30
+	AddExtendedTable(19, 1, 0x3FF);
+	RegisterExtended(19, 0, &I::mcrf);
+	RegisterExtended(19, 16, &I::bclr);
+	RegisterExtended(19, 18, &I::rfi);        // rfid
+	RegisterExtended(19, 33, &I::crlogical);  // crnor
+	RegisterExtended(19, 50, &I::rfi);
+	RegisterExtended(19, 129, &I::crlogical); // crandc
+	RegisterExtended(19, 150, &I::isync);
+	RegisterExtended(19, 193, &I::crlogical); // crxor
+	RegisterExtended(19, 225, &I::crlogical); // crnand
+	RegisterExtended(19, 257, &I::crlogical); // crand
+	RegisterExtended(19, 274, &I::hrfid);
+	RegisterExtended(19, 289, &I::crlogical); // creqv
+	RegisterExtended(19, 417, &I::crlogical); // crorc
+	RegisterExtended(19, 449, &I::crlogical); // cror
+	RegisterExtended(19, 528, &I::bcctr);
+
+	// Opcode 31: X/XO-form, XO in bits 21-30. XO-form ops are registered for OE=0 and OE=1.
+	AddExtendedTable(31, 1, 0x3FF);
+	const auto xo = [this](uint32_t sub, PPCInstrHandler h) {
+		RegisterExtended(31, sub, h);
+		RegisterExtended(31, sub | 0x200, h);
+	};
+	const auto x = [this](uint32_t sub, PPCInstrHandler h) { RegisterExtended(31, sub, h); };
+	x(0, &I::cmp);
+	x(4, &I::tw);
+	xo(8, &I::subfc);
+	x(9, &I::mulhdu);
+	xo(10, &I::addc);
+	x(11, &I::mulhwu);
+	x(19, &I::mfcr);
+	x(20, &I::lwarx);
+	x(21, &I::ldx);
+	x(23, &I::lwzx);
+	x(24, &I::slw);
+	x(26, &I::cntlzw);
+	x(27, &I::sld);
+	x(28, &I::and_);
+	x(32, &I::cmpl);
+	xo(40, &I::subf);
+	x(53, &I::ldux);
+	x(54, &I::dcbst);
+	x(55, &I::lwzux);
+	x(58, &I::cntlzd);
+	x(60, &I::andc);
+	x(68, &I::td);
+	x(73, &I::mulhd);
+	x(75, &I::mulhw);
+	x(83, &I::mfmsr);
+	x(84, &I::ldarx);
+	x(86, &I::dcbf);
+	x(87, &I::lbzx);
+	xo(104, &I::neg);
+	x(119, &I::lbzux);
+	x(124, &I::nor);
+	xo(136, &I::subfe);
+	xo(138, &I::adde);
+	x(144, &I::mtcrf);
+	x(146, &I::mtmsr);
+	x(149, &I::stdx);
+	x(150, &I::stwcx);
+	x(151, &I::stwx);
+	x(178, &I::mtmsrd);
+	x(181, &I::stdux);
+	x(183, &I::stwux);
+	xo(200, &I::subfze);
+	xo(202, &I::addze);
+	x(214, &I::stdcx);
+	x(215, &I::stbx);
+	xo(232, &I::subfme);
+	xo(233, &I::mulld);
+	xo(234, &I::addme);
+	xo(235, &I::mullw);
+	x(246, &I::nop);    // dcbtst
+	x(247, &I::stbux);
+	xo(266, &I::add);
+	x(274, &I::tlbiel);
+	x(278, &I::nop);    // dcbt
+	x(279, &I::lhzx);
+	x(284, &I::eqv);
+	x(306, &I::tlbie);
+	x(311, &I::lhzux);
+	x(316, &I::xor_);
+	x(339, &I::mfspr);
+	x(341, &I::lwax);
+	x(343, &I::lhax);
+	x(370, &I::tlbie);  // tlbia
+	x(371, &I::mftb);
+	x(373, &I::lwaux);
+	x(375, &I::lhaux);
+	x(402, &I::slbmte);
+	x(407, &I::sthx);
+	x(412, &I::orc);
+	x(434, &I::slbie);
+	x(439, &I::sthux);
+	x(444, &I::or_);
+	xo(457, &I::divdu);
+	xo(459, &I::divwu);
+	x(467, &I::mtspr);
+	x(470, &I::dcbi);
+	x(476, &I::nand);
+	x(498, &I::slbia);
+	xo(489, &I::divd);
+	xo(491, &I::divw);
+	x(512, &I::mcrxr);
+	x(532, &I::ldbrx);
+	x(534, &I::lwbrx);
+	x(536, &I::srw);
+	x(539, &I::srd);
+	x(566, &I::nop);    // tlbsync
+	x(598, &I::sync);
+	x(660, &I::stdbrx);
+	x(662, &I::stwbrx);
+	x(790, &I::lhbrx);
+	x(792, &I::sraw);
+	x(794, &I::srad);
+	x(824, &I::srawi);
+	x(826, &I::sradi);  // XS-form: XO in bits 21-29, bit 30 is sh[5]
+	x(827, &I::sradi);
+	x(851, &I::slbmfev);
+	x(854, &I::sync);   // eieio
+	x(915, &I::slbmfee);
+	x(918, &I::sthbrx);
+	x(922, &I::extsh);
+	x(954, &I::extsb);
+	x(986, &I::extsw);
+	x(982, &I::icbi);
+	x(1014, &I::dcbz);
+
+	// Opcode 4: VMX. VX-form XO in the low 11 bits; VC-form (vcmp*) in the low 10, registered for
+	// Rc=0 and Rc=1; VA-form in the low 6, registered for every vC. vsldoi128 is any encoding with
+	// bit 4 set (no VMX XO has it). The VMX128 loads/stores (low bits 0b11) stay on Legacy.
+	using K = VMXOp;
+	AddExtendedTable(4, 0, 0x7FF);
+	RegisterVMX128(4, 0x10, 0x10, &I::vmx, K::vsldoi); // vsldoi128
+	const auto vx = [this](uint32_t sub, VMXOp k) { RegisterVMX(4, sub, &I::vmx, k); };
+	const auto vc = [this](uint32_t sub, VMXOp k) {
+		RegisterVMX(4, sub, &I::vmx_cmp, k);
+		RegisterVMX(4, sub | 0x400, &I::vmx_cmp, k);
+	};
+	const auto va = [this](uint32_t sub, VMXOp k) {
+		for (uint32_t vC = 0; vC < 32; ++vC) RegisterVMX(4, sub | (vC << 6), &I::vmx, k);
+	};
+	vx(0, K::vaddubm);
+	vx(2, K::vmaxub);
+	vx(4, K::vrlb);
+	vc(6, K::vcmpequb);
+	vx(8, K::vmuloub);
+	vx(10, K::vaddfp);
+	vx(12, K::vmrghb);
+	vx(14, K::vpkuhum);
+	vx(64, K::vadduhm);
+	vx(66, K::vmaxuh);
+	vx(68, K::vrlh);
+	vc(70, K::vcmpequh);
+	vx(72, K::vmulouh);
+	vx(74, K::vsubfp);
+	vx(76, K::vmrghh);
+	vx(78, K::vpkuwum);
+	vx(128, K::vadduwm);
+	vx(130, K::vmaxuw);
+	vx(132, K::vrlw);
+	vc(134, K::vcmpequw);
+	vx(140, K::vmrghw);
+	vx(142, K::vpkuhus);
+	vc(198, K::vcmpeqfp);
+	vx(206, K::vpkuwus);
+	vx(258, K::vmaxsb);
+	vx(260, K::vslb);
+	vx(264, K::vmulosb);
+	vx(266, K::vrefp);
+	vx(268, K::vmrglb);
+	vx(270, K::vpkshus);
+	vx(322, K::vmaxsh);
+	vx(324, K::vslh);
+	vx(328, K::vmulosh);
+	vx(330, K::vrsqrtefp);
+	vx(332, K::vmrglh);
+	vx(334, K::vpkswus);
+	vx(384, K::vaddcuw);
+	vx(386, K::vmaxsw);
+	vx(388, K::vslw);
+	vx(394, K::vexptefp);
+	vx(396, K::vmrglw);
+	vx(398, K::vpkshss);
+	vx(452, K::vsl);
+	vc(454, K::vcmpgefp);
+	vx(458, K::vlogefp);
+	vx(462, K::vpkswss);
+	vx(512, K::vaddubs);
+	vx(514, K::vminub);
+	vx(516, K::vsrb);
+	vc(518, K::vcmpgtub);
+	vx(520, K::vmuleub);
+	vx(522, K::vrfin);
+	vx(524, K::vspltb);
+	vx(526, K::vupkhsb);
+	vx(576, K::vadduhs);
+	vx(578, K::vminuh);
+	vx(580, K::vsrh);
+	vc(582, K::vcmpgtuh);
+	vx(584, K::vmuleuh);
+	vx(586, K::vrfiz);
+	vx(588, K::vsplth);
+	vx(590, K::vupkhsh);
+	vx(640, K::vadduws);
+	vx(642, K::vminuw);
+	vx(644, K::vsrw);
+	vc(646, K::vcmpgtuw);
+	vx(650, K::vrfip);
+	vx(652, K::vspltw);
+	vx(654, K::vupklsb);
+	vx(708, K::vsr);
+	vc(710, K::vcmpgtfp);
+	vx(714, K::vrfim);
+	vx(718, K::vupklsh);
+	vx(768, K::vaddsbs);
+	vx(770, K::vminsb);
+	vx(772, K::vsrab);
+	vc(774, K::vcmpgtsb);
+	vx(776, K::vmulesb);
+	vx(778, K::vcfux);
+	vx(780, K::vspltisb);
+	vx(782, K::vpkpx);
+	vx(832, K::vaddshs);
+	vx(834, K::vminsh);
+	vx(836, K::vsrah);
+	vc(838, K::vcmpgtsh);
+	vx(840, K::vmulesh);
+	vx(842, K::vcfsx);
+	vx(844, K::vspltish);
+	vx(846, K::vupkhpx);
+	vx(896, K::vaddsws);
+	vx(898, K::vminsw);
+	vx(900, K::vsraw);
+	vc(902, K::vcmpgtsw);
+	vx(906, K::vctuxs);
+	vx(908, K::vspltisw);
+	vc(966, K::vcmpbfp);
+	vx(970, K::vctsxs);
+	vx(974, K::vupklpx);
+	vx(1024, K::vsububm);
+	vx(1026, K::vavgub);
+	vx(1028, K::vand);
+	vx(1034, K::vmaxfp);
+	vx(1036, K::vslo);
+	vx(1088, K::vsubuhm);
+	vx(1090, K::vavguh);
+	vx(1092, K::vandc);
+	vx(1098, K::vminfp);
+	vx(1100, K::vsro);
+	vx(1152, K::vsubuwm);
+	vx(1154, K::vavguw);
+	vx(1156, K::vor);
+	vx(1220, K::vxor);
+	vx(1282, K::vavgsb);
+	vx(1284, K::vnor);
+	vx(1346, K::vavgsh);
+	vx(1408, K::vsubcuw);
+	vx(1410, K::vavgsw);
+	vx(1536, K::vsububs);
+	RegisterExtended(4, 1540, &I::mfvscr);
+	vx(1544, K::vsum4ubs);
+	vx(1600, K::vsubuhs);
+	RegisterExtended(4, 1604, &I::mtvscr);
+	vx(1608, K::vsum4shs);
+	vx(1664, K::vsubuws);
+	vx(1672, K::vsum2sws);
+	vx(1792, K::vsubsbs);
+	vx(1800, K::vsum4sbs);
+	vx(1856, K::vsubshs);
+	vx(1920, K::vsubsws);
+	vx(1928, K::vsumsws);
+	va(32, K::vmhaddshs);
+	va(33, K::vmhraddshs);
+	va(34, K::vmladduhm);
+	va(36, K::vmsumubm);
+	va(37, K::vmsummbm);
+	va(38, K::vmsumuhm);
+	va(39, K::vmsumuhs);
+	va(40, K::vmsumshm);
+	va(41, K::vmsumshs);
+	va(42, K::vsel);
+	va(43, K::vperm);
+	va(44, K::vsldoi);
+	va(46, K::vmaddfp);
+	va(47, K::vnmsubfp);
+
+	// Opcode 5: VMX128 arithmetic, XO in bits 4-9 (VX128 mask 0x3D0; bit 5 belongs to vA).
+	// vperm128 is every encoding with bits 4 and 9 clear (vC in bits 6-8).
+	AddExtendedTable(5, 4, 0x3F);
+	const auto vx128 = [this](uint32_t primary, uint32_t mask, uint32_t value, VMXOp k) {
+		RegisterVMX128(primary, mask, value, &I::vmx, k);
+	};
+	vx128(5, 0x210, 0x000, K::vperm);
+	vx128(5, 0x3D0, 16, K::vaddfp);
+	vx128(5, 0x3D0, 80, K::vsubfp);
+	vx128(5, 0x3D0, 144, K::vmulfp128);
+	vx128(5, 0x3D0, 208, K::vmaddfp128);
+	vx128(5, 0x3D0, 272, K::vmaddcfp128);
+	vx128(5, 0x3D0, 336, K::vnmsubfp128);
+	vx128(5, 0x3D0, 400, K::vmsum3fp128);
+	vx128(5, 0x3D0, 464, K::vmsum4fp128);
+	vx128(5, 0x3D0, 512, K::vpkshss);
+	vx128(5, 0x3D0, 528, K::vand);
+	vx128(5, 0x3D0, 576, K::vpkshus);
+	vx128(5, 0x3D0, 592, K::vandc);
+	vx128(5, 0x3D0, 640, K::vpkswss);
+	vx128(5, 0x3D0, 656, K::vnor);
+	vx128(5, 0x3D0, 704, K::vpkswus);
+	vx128(5, 0x3D0, 720, K::vor);
+	vx128(5, 0x3D0, 768, K::vpkuhum);
+	vx128(5, 0x3D0, 784, K::vxor);
+	vx128(5, 0x3D0, 832, K::vpkuhus);
+	vx128(5, 0x3D0, 848, K::vsel);
+	vx128(5, 0x3D0, 896, K::vpkuwum);
+	vx128(5, 0x3D0, 912, K::vslo);
+	vx128(5, 0x3D0, 960, K::vpkuwus);
+	vx128(5, 0x3D0, 976, K::vsro);
+
+	// Opcode 6: VMX128 conversions, shifts, compares and permutes, XO in bits 4-10. The forms use
+	// different masks; the less specific ones are registered first so the exact ones win.
+	// vpkd3d128/vupkd3d128 (D3D format packing) are not implemented and stay on Legacy.
+	AddExtendedTable(6, 4, 0x7F);
+	const auto vcmp128 = [this](uint32_t value, VMXOp k) { RegisterVMX128(6, 0x390, value, &I::vmx_cmp, k); };
+	vcmp128(0, K::vcmpeqfp);
+	vcmp128(128, K::vcmpgefp);
+	vcmp128(256, K::vcmpgtfp);
+	vcmp128(384, K::vcmpbfp);
+	vcmp128(512, K::vcmpequw);
+	vx128(6, 0x630, 528, K::vpermwi128);
+	vx128(6, 0x3D0, 80, K::vrlw);
+	vx128(6, 0x3D0, 208, K::vslw);
+	vx128(6, 0x3D0, 336, K::vsraw);
+	vx128(6, 0x3D0, 464, K::vsrw);
+	vx128(6, 0x3D0, 640, K::vmaxfp);
+	vx128(6, 0x3D0, 704, K::vminfp);
+	vx128(6, 0x3D0, 768, K::vmrghw);
+	vx128(6, 0x3D0, 832, K::vmrglw);
+	vx128(6, 0x3D0, 896, K::vupkhsb);
+	vx128(6, 0x3D0, 960, K::vupklsb);
+	vx128(6, 0x730, 1808, K::vrlimi128);
+	vx128(6, 0x7F0, 560, K::vctsxs);  // vcfpsxws128
+	vx128(6, 0x7F0, 624, K::vctuxs);  // vcfpuxws128
+	vx128(6, 0x7F0, 688, K::vcfsx);   // vcsxwfp128
+	vx128(6, 0x7F0, 752, K::vcfux);   // vcuxwfp128
+	vx128(6, 0x7F0, 816, K::vrfim);
+	vx128(6, 0x7F0, 880, K::vrfin);
+	vx128(6, 0x7F0, 944, K::vrfip);
+	vx128(6, 0x7F0, 1008, K::vrfiz);
+	vx128(6, 0x7F0, 1584, K::vrefp);
+	vx128(6, 0x7F0, 1648, K::vrsqrtefp);
+	vx128(6, 0x7F0, 1712, K::vexptefp);
+	vx128(6, 0x7F0, 1776, K::vlogefp);
+	vx128(6, 0x7F0, 1840, K::vspltw);
+	vx128(6, 0x7F0, 1904, K::vspltisw);
+}
+
+PPCDecodedInstr PPCDecoder::Decode(uint32_t instr) const {
+	PPCDecodedInstr op;
+	const uint32_t primary = instr >> 26;
+	const PrimaryEntry& e = primary_[primary];
+	op.handler = e.table ? e.table[(instr >> e.shift) & e.mask] : e.handler;
+	op.instr = instr;
+	op.rD = (instr >> 21) & 0x1F;
+	op.rA = (instr >> 16) & 0x1F;
+	op.rB = (instr >> 11) & 0x1F;
+	op.sh = op.rB;
+	op.mb = (instr >> 6) & 0x1F;
+	op.me = (instr >> 1) & 0x1F;
+	op.rc = instr & 1;
+
+	switch (primary) {
+	case 16: // bc: BD, sign-extended, low bits are AA/LK
+		op.imm = int16_t(instr & 0xFFFC);
+		op.aa = (instr >> 1) & 1;
+		break;
+	case 18: { // b: LI, 26-bit sign-extended
+		int32_t li = instr & 0x03FFFFFC;
+		if (li & 0x02000000) li |= 0xFC000000;
+		op.imm = li;
+		op.aa = (instr >> 1) & 1;
+		break;
+	}
+	case 30: // MD/MDS-form: 6-bit sh and mb/me, with the high bit stored apart
+		op.sh = op.rB | (((instr >> 1) & 1) << 5);
+		op.mb = ((instr >> 6) & 0x1F) | (((instr >> 5) & 1) << 5);
+		break;
+	case 31:
+		if (((instr >> 2) & 0x1FF) == 413) op.sh |= ((instr >> 1) & 1) << 5; // sradi
+		op.imm = int16_t(instr & 0xFFFF);
+		op.aa = (instr >> 10) & 1; // OE
+		break;
+	case 4:
+	case 5:
+	case 6: {
+		const std::vector<uint16_t>& kernels = vmxOps_[primary];
+		op.imm = kernels[(instr >> e.shift) & e.mask];
+		if (primary == 4 && !(instr & 0x10)) {
+			// VMX: vC in mb; the vA field is the UIMM/SIMM of vsplt*, vcf*, vct*; vsldoi's SH is in
+			// bits 6-9; vcmp* have Rc in bit 10
+			op.sh = (instr & 0x3F) == 44 ? (instr >> 6) & 0xF : op.rA;
+			op.rc = (instr >> 10) & 1;
+			break;
+		}
+		// VMX128: 7-bit registers and vD doubles as the third operand (vmaddfp128, vsel128,
+		// vrlimi128). The immediate is in the vA field, extended by bits 6-8 for vpermwi128/vrlimi128.
+		op.rD = VX128_VD(instr);
+		op.rA = VX128_VA(instr);
+		op.rB = VX128_VB(instr);
+		op.mb = op.rD;
+		op.sh = (instr >> 16) & 0x1F;
+		op.rc = (instr >> 6) & 1; // VX128_R compares
+		if (primary == 4) op.sh = (instr >> 6) & 0xF; // vsldoi128
+		else if (primary == 5 && !(instr & 0x210)) op.mb = (instr >> 6) & 7; // vperm128: vC is v0-v7
+		else if (primary == 6 && (instr & 0x630) == 0x210) op.sh |= ((instr >> 6) & 7) << 5; // vpermwi128
+		else if (primary == 6 && (instr & 0x730) == 0x710) op.sh |= ((instr >> 6) & 3) << 5; // vrlimi128
+		break;
+	}
+	case 58: // DS-form: the low two bits are part of the XO
+	case 62:
+		op.imm = int16_t(instr & 0xFFFC);
+		break;
+	default:
+		op.imm = int16_t(instr & 0xFFFF);
+		op.aa = (instr >> 10) & 1; // OE
+		break;
+	}
+	return op;
+}
@@ -0,0 +1,66 @@
+// PPCDecoder.h
+#pragma once
+#include "VMXKernels.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class CPU;
+struct PPCDecodedInstr;
+
+// Handler for a predecoded instruction. PC sequencing is done by the caller through CPU::NIA.
+using PPCInstrHandler = void (*)(CPU& cpu, const PPCDecodedInstr& op);
+
+// Compact predecoded instruction: handler plus the operand fields, extracted once at decode time
+// so handlers never go back to the raw encoding on the hot path.
+struct PPCDecodedInstr {
+    PPCInstrHandler handler = nullptr;
+    uint32_t instr = 0;  // Raw encoding (used by the legacy fallback and rarely-used fields)
+    int32_t imm = 0;     // SIMM sign-extended, or branch displacement (LI/BD) already shifted
+    uint8_t rD = 0;      // rD / rS / BO / TO (crfD = rD >> 2)
+    uint8_t rA = 0;      // rA / BI
+    uint8_t rB = 0;      // rB
+    uint8_t sh = 0;      // SH (rlw*, srawi; 6 bits for rld*, sradi)
+    uint8_t mb = 0;      // MB (6 bits for rld*, where it is also the ME of rldicr/rldcr)
+    uint8_t me = 0;      // ME
+    uint8_t rc = 0;      // Rc / LK
+    uint8_t aa = 0;      // AA (b/bc) / OE (XO-form)
+};
+
+// VMX128 vector registers are 7 bits wide, split between the classic 5-bit field and loose bits
+// elsewhere in the encoding
+constexpr uint32_t VX128_VD(uint32_t instr) { return ((instr >> 21) & 0x1F) | (((instr >> 2) & 3) << 5); }
+constexpr uint32_t VX128_VA(uint32_t instr) { return ((instr >> 16) & 0x1F) | (((instr >> 5) & 1) << 5) | (((instr >> 10) & 1) << 6); }
+constexpr uint32_t VX128_VB(uint32_t instr) { return ((instr >> 11) & 0x1F) | ((instr & 3) << 5); }
+
+// Two-level opcode table: the primary opcode selects either a handler or an extended-opcode table.
+// Built once at startup; anything not registered falls back to the legacy CPU::DecodeExecute switch.
+class PPCDecoder {
+public:
+    static const PPCDecoder& Instance();
+
+    PPCDecodedInstr Decode(uint32_t instr) const;
+
+private:
+    PPCDecoder();
+
+    struct PrimaryEntry {
+        PPCInstrHandler handler = nullptr;
+        const PPCInstrHandler* table = nullptr; // Extended table, indexed by (instr >> shift) & mask
+        uint32_t shift = 0;
+        uint32_t mask = 0;
+    };
+
+    void Register(uint32_t primary, PPCInstrHandler handler);
+    void RegisterExtended(uint32_t primary, uint32_t xo, PPCInstrHandler handler);
+    void AddExtendedTable(uint32_t primary, uint32_t shift, uint32_t mask);
+    // VMX/VMX128 entries also carry the VMXOp the handler runs (returned in PPCDecodedInstr::imm)
+    void RegisterVMX(uint32_t primary, uint32_t xo, PPCInstrHandler handler, VMXOp kernel);
+    // VMX128 forms are identified by a mask/value over the encoding, not by a contiguous XO:
+    // registers every extended-table slot whose bits match
+    void RegisterVMX128(uint32_t primary, uint32_t mask, uint32_t value, PPCInstrHandler handler, VMXOp kernel);
+
+    std::array<PrimaryEntry, 64> primary_{};
+    std::array<std::vector<PPCInstrHandler>, 64> extended_{};
+    std::array<std::vector<uint16_t>, 64> vmxOps_{};
+};
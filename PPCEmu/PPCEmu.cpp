@@ -1,13 +1,29 @@
 // PPCEmu.cpp
 #include "PPCEmu.h"
 #include "PPCEmuConfig.h"
-#include <fstream>
+#include "Endian.h"
+#include "Log.h"
+#include "FrameDumpPresenter.h"
+#include "SharedMemoryPresenter.h"
+#include "Snapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
 #include <iomanip>
-#include <iterator>
 #include <iostream>
 #include <stdexcept>
+#include <thread>
+#ifdef _WIN32
+#include "Win32Presenter.h"
 #include <windows.h>
-#include <shellscalingapi.h>
+#include <psapi.h>
+#else
+#include <cerrno>
+#include <cstdio>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 // ELF32 header structures
 #pragma pack(push,1)
@@ -37,28 +53,51 @@ struct Elf32Phdr {
     uint32_t p_flags;
     uint32_t p_align;
 };
+struct Elf64Ehdr { unsigned char e_ident[16]; uint16_t e_type; uint16_t e_machine; uint32_t e_version; uint64_t e_entry; uint64_t e_phoff; uint64_t e_shoff; uint32_t e_flags; uint16_t e_ehsize; uint16_t e_phentsize; uint16_t e_phnum; uint16_t e_shentsize; uint16_t e_shnum; uint16_t e_shstrndx; };
+struct Elf64Phdr { uint32_t p_type; uint32_t p_flags; uint64_t p_offset; uint64_t p_vaddr; uint64_t p_paddr; uint64_t p_filesz; uint64_t p_memsz; uint64_t p_align; };
 #pragma pack(pop)
 
-// Helpers to convert big endian 32/16
-static uint32_t be32(uint32_t v) {
-    return ((v >> 24) & 0xFF) | ((v >> 8) & 0xFF00) | ((v << 8) & 0xFF0000) | ((v << 24) & 0xFF000000);
-}
-static uint16_t be16(uint16_t v) {
-    return (v >> 8) | (v << 8);
+static std::unique_ptr<FramePresenter> CreatePresenter(const PPCEmuConfig& cfg) {
+    switch (cfg.presenter) {
+    case PresenterKind::Window:
+#ifdef _WIN32
+        return std::make_unique<Win32Presenter>("ConsoleFB", cfg.fbWidth, cfg.fbHeight);
+#else
+        throw std::runtime_error("Window presenter is only available on Windows");
+#endif
+    case PresenterKind::PPM:
+    case PresenterKind::PNG:
+        return std::make_unique<FrameDumpPresenter>(cfg.presenterTarget.empty() ? "frames" : cfg.presenterTarget,
+            cfg.presenter == PresenterKind::PNG ? FrameDumpPresenter::Format::PNG : FrameDumpPresenter::Format::PPM,
+            cfg.dumpInterval);
+    case PresenterKind::SharedMemory:
+        return std::make_unique<SharedMemoryPresenter>(cfg.presenterTarget.empty() ? "PPCEmuFB" : cfg.presenterTarget,
+            cfg.fbWidth, cfg.fbHeight);
+    case PresenterKind::Null:
+    default:
+        return std::make_unique<NullPresenter>();
+    }
 }
 
 PPCEmu::PPCEmu(const PPCEmuConfig& config)
     : cfg_(config),
-    cpu_(&mmu_),
     mmu_(),
+    cpu_(&mmu_),
     ram_(std::make_shared<Memory>("RAM")),
     fb_(std::make_shared<Display>("ConsoleFB",
         cfg_.fbBase,
         cfg_.fbWidth,
-        cfg_.fbHeight))
+        cfg_.fbHeight)),
+    iic_(std::make_shared<InterruptController>("IIC"))
 {
-    // DPI awareness and text mode
-    SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_SYSTEM_AWARE);
+    // La línea externa de cada hilo de hardware llega a su CPU
+    iic_->SetAssertHandler([this](int thread) {
+        if (thread == 0) cpu_.RaiseExternalInterrupt();
+        else if (cpus_) cpus_->SignalExternalInterrupt(thread);
+    });
+
+    // Presenter and text mode
+    fb_->SetPresenter(CreatePresenter(cfg_));
     fb_->textMode_ = cfg_.textMode;
 
     if (!fb_->ProcessMessages())
@@ -68,6 +107,9 @@ PPCEmu::PPCEmu(const PPCEmuConfig& config)
 
     initMappings();
     initExceptionHandlers();
+    cpu_.SetJitMode(cfg_.jitMode);
+    SelectVMXIsa(cfg_.vmxIsa);
+    LOG_INFO("CPU", "VMX kernels: %s", VMXIsaName(VMXKernels().isa));
 
     // Optional: dump exception vector to verify
     uint8_t buf[8];
@@ -77,13 +119,9 @@ PPCEmu::PPCEmu(const PPCEmuConfig& config)
     for (auto b : buf) std::cout << std::setw(2) << int(b) << " ";
     std::cout << std::dec << "\n";
 }
-std::vector<uint8_t> PPCEmu::ReadFileToVector(const std::string& path) const {
-    std::ifstream f(path, std::ios::binary);
-    if (!f) throw std::runtime_error("Cannot open file: " + path);
-    return { std::istreambuf_iterator<char>(f), {} };
-}
-BinaryType PPCEmu::DetectFormat(const std::vector<uint8_t>& data) const {
-    if (data.size() >= 4 &&
+BinaryType PPCEmu::DetectFormat(const MappedFile& image) const {
+    const uint8_t* data = image.GetData();
+    if (image.GetSize() >= 6 &&
         data[0] == 0x7F && data[1] == 'E' &&
         data[2] == 'L' && data[3] == 'F')
     {
@@ -91,6 +129,8 @@ BinaryType PPCEmu::DetectFormat(const std::vector<uint8_t>& data) const {
         if (be && !is64) return BinaryType::ELF32_BE;
         if (be && is64)  return BinaryType::ELF64_BE;
     }
+    if (image.GetSize() >= 4 && std::memcmp(data, "XEX2", 4) == 0)
+        return BinaryType::XEX2;
     return BinaryType::RAW;
 }
 void PPCEmu::initMappings() {
@@ -110,137 +150,492 @@ void PPCEmu::initMappings() {
         0,
         true, true, true);
 
-    // Framebuffer region
+    // Framebuffer region (Display works with absolute addresses: physical == virtual)
     mmu_.MapMemory(fb_,
         cfg_.fbBase,
         cfg_.fbBase + cfg_.fbSize,
+        cfg_.fbBase,
+        true, true, false);
+
+    // Interrupt controller
+    mmu_.MapMemory(iic_,
+        cfg_.iicBase,
+        cfg_.iicBase + iic_->GetSize(),
         0,
         true, true, false);
+
+    // Ficheros proyectados: al final y con RemapMemory, tapan cualquier región de RAM que solapen
+    files_.clear();
+    for (const FileMapping& m : cfg_.fileMappings) {
+        auto file = std::make_shared<FileMemory>(std::filesystem::path(m.path).filename().string(), m.path, m.copyOnWrite);
+        mmu_.RemapMemory(file, m.address, m.address + file->GetSize(), 0, true, m.copyOnWrite, true);
+        files_.push_back(std::move(file));
+    }
 }
 void PPCEmu::initExceptionHandlers() {
     uint8_t nop_rfi[8] = { 0x60,0x00,0x00,0x00, 0x4C,0x00,0x00,0x64 };
-    constexpr uint64_t off[] = { 0x100, 0x600, 0x700 };
+    constexpr uint64_t off[] = { 0x100, 0x500, 0x600, 0x700 };
     for (auto o : off)
         mmu_.Write(cfg_.excBase + o, nop_rfi, sizeof(nop_rfi));
 }
-void PPCEmu::LoadRAW(const std::string& filename, uint64_t loadAddr) {
-    auto data = ReadFileToVector(filename);
-    std::cout << "AutoLoad RAW: " << filename
-        << ", " << data.size() << " bytes\n";
+void PPCEmu::LoadRAW(const MappedFile& image, uint64_t loadAddr) {
+    std::cout << "AutoLoad RAW: " << image.GetPath()
+        << ", " << image.GetSize() << " bytes\n";
 
-    mmu_.Write(loadAddr, data.data(), data.size());
+    mmu_.Write(loadAddr, image.GetData(), image.GetSize());
     // patch r10 → framebuffer base
     uint8_t patch[] = { 0x3D,0x4C,0xC0,0x00, 0x61,0x4A,0x00,0x00 };
     mmu_.Write(loadAddr + 0xC, patch, sizeof(patch));
 }
+XexModule PPCEmu::LoadXEX(const MappedFile& image) {
+    XexModule module = ParseXEX(image);
+    // Los XEX se cargan en 0x82000000 y alrededores: si cae fuera de userBase, ventana sobre la RAM
+    if (!mmu_.IsMapped(module.baseAddress, uint64_t(module.baseAddress) + module.imageSize))
+        LoadSegment(module.baseAddress, image.GetData(), 0, module.imageSize, true, true);
+    XexLoadOptions options;
+    options.keyFiles = cfg_.xexKeyFiles;
+    LoadXEXImage(image, module, mmu_, options);
+    return module;
+}
 void PPCEmu::AutoLoad(const std::string& path) {
-    auto data = ReadFileToVector(path);
-    auto fmt = DetectFormat(data);
+    const auto start = std::chrono::steady_clock::now();
+    const MappedFile image(path);
+    auto fmt = DetectFormat(image);
     uint64_t entry = 0;
 
     switch (fmt) {
     case BinaryType::RAW:
-        LoadRAW(path, cfg_.userBase);
+        LoadRAW(image, cfg_.userBase);
         entry = cfg_.userBase;
         break;
     case BinaryType::ELF32_BE:
-        LoadELF32(data);
+        LoadELF32(image);
         entry = cpu_.GetPC();
         break;
     case BinaryType::ELF64_BE:
-        LoadELF64(data);
+        LoadELF64(image);
         entry = cpu_.GetPC();
         break;
+    case BinaryType::XEX2:
+        entry = LoadXEX(image).entryPoint;
+        break;
     default:
         throw std::runtime_error("Unknown binary format");
     }
 
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LOG_INFO("Loader", "%s: %.1f MB loaded in %.1f ms (%.0f MB/s, %s)", path.c_str(), image.GetSize() / 1048576.0,
+        seconds * 1e3, seconds > 0 ? image.GetSize() / 1048576.0 / seconds : 0.0, image.IsMapped() ? "mmap" : "read");
+
     cpu_.Reset();
     cpu_.SetPC(entry);
     std::cout << "Entry PC: 0x" << std::hex << entry << std::dec << "\n";
 }
+namespace {
+// Dispositivos de la máquina en el orden en que se guardan (los nombres los identifican al restaurar)
+SnapshotReader::DeviceList SnapshotDevices(const std::shared_ptr<Memory>& ram, const std::shared_ptr<Display>& fb,
+    const std::shared_ptr<InterruptController>& iic, const std::vector<std::shared_ptr<FileMemory>>& files) {
+    SnapshotReader::DeviceList devices{ ram, fb, iic };
+    devices.insert(devices.end(), files.begin(), files.end());
+    return devices;
+}
+void RunForkBody(PPCEmu& machine, const PPCEmu::ForkBody& body, size_t index, ForkResult& result) {
+    try {
+        result.output = body(machine, index);
+        result.status = 0;
+    }
+    catch (const std::exception& e) {
+        result.output = e.what();
+        result.status = 1;
+    }
+}
+}
+void PPCEmu::SaveSnapshot(const std::string& path) {
+    const auto start = std::chrono::steady_clock::now();
+    SnapshotWriter writer(path);
+    writer.WriteCPU(cpu_);
+    for (const auto& device : SnapshotDevices(ram_, fb_, iic_, files_))
+        writer.WriteDevice(*device);
+    writer.WriteRegions(mmu_);
+    writer.Finish();
+    LOG_INFO("System", "Snapshot %s: %llu pages, %.1f MB in %.1f ms", path.c_str(), (unsigned long long)writer.GetPagesWritten(),
+        writer.GetBytesWritten() / 1048576.0, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+void PPCEmu::LoadSnapshot(const std::string& path) {
+    const auto start = std::chrono::steady_clock::now();
+    const SnapshotReader reader(path);
+    const auto devices = SnapshotDevices(ram_, fb_, iic_, files_);
+    reader.RestoreDevices(devices);
+    reader.RestoreCPU(0, cpu_);
+    reader.RestoreRegions(mmu_, devices);
+    LOG_INFO("System", "Snapshot %s restored: %llu pages, %.1f MB in %.1f ms", path.c_str(), (unsigned long long)reader.GetPagesRestored(),
+        reader.GetSize() / 1048576.0, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+std::vector<ForkResult> PPCEmu::ForkRun(size_t count, const ForkBody& body, unsigned maxParallel) {
+    if (replay_) throw std::runtime_error("ForkRun: not while recording or replaying");
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<ForkResult> results(count);
+    for (size_t i = 0; i < count; ++i) results[i].index = i;
+#ifdef _WIN32
+    // Sin fork(): una copia detrás de otra, cada una desde el snapshot del estado de partida
+    (void)maxParallel;
+    const std::string path = (std::filesystem::temp_directory_path() /
+        ("ppcemu_fork_" + std::to_string(GetCurrentProcessId()) + ".snap")).string();
+    SaveSnapshot(path);
+    for (size_t i = 0; i < count; ++i) {
+        if (i) LoadSnapshot(path);
+        RunForkBody(*this, body, i, results[i]);
+    }
+    if (count) LoadSnapshot(path);
+    std::filesystem::remove(path);
+#else
+    // Un hijo por copia: la RAM (mmap privado) y los ficheros proyectados quedan compartidos
+    // copy-on-write por el SO. Cada hijo devuelve su resultado por un pipe y sale con _exit.
+    if (!maxParallel) maxParallel = (std::max)(1u, std::thread::hardware_concurrency());
+    struct Child { pid_t pid; int fd; size_t index; };
+    std::vector<Child> running;
+    size_t next = 0;
+    while (next < count || !running.empty()) {
+        while (next < count && running.size() < maxParallel) {
+            int fds[2];
+            if (pipe(fds) != 0) throw std::runtime_error("ForkRun: pipe failed");
+            Log::BeforeFork();
+            const pid_t pid = fork();
+            if (pid < 0) {
+                close(fds[0]);
+                close(fds[1]);
+                throw std::runtime_error("ForkRun: fork failed");
+            }
+            if (pid == 0) {
+                Log::AfterForkChild();
+                close(fds[0]);
+                for (const Child& c : running) close(c.fd);
+                ForkResult result;
+                RunForkBody(*this, body, next, result);
+                for (size_t done = 0; done < result.output.size();) {
+                    const ssize_t n = write(fds[1], result.output.data() + done, result.output.size() - done);
+                    if (n < 0 && errno == EINTR) continue;
+                    if (n <= 0) break;
+                    done += size_t(n);
+                }
+                Log::BeforeFork(); // vacía los logs del hijo antes de _exit
+                _exit(result.status);
+            }
+            close(fds[1]);
+            running.push_back({ pid, fds[0], next++ });
+        }
+
+        std::vector<pollfd> polls;
+        for (const Child& c : running) polls.push_back({ c.fd, POLLIN, 0 });
+        if (poll(polls.data(), polls.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("ForkRun: poll failed");
+        }
+        for (size_t k = running.size(); k-- > 0;) {
+            if (!polls[k].revents) continue;
+            char buffer[4096];
+            const ssize_t n = read(running[k].fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                results[running[k].index].output.append(buffer, size_t(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            // Fin del pipe: el hijo ha terminado (o ha muerto)
+            close(running[k].fd);
+            int status = 0;
+            while (waitpid(running[k].pid, &status, 0) < 0 && errno == EINTR) {}
+            results[running[k].index].status = WIFSIGNALED(status) ? -WTERMSIG(status) : WEXITSTATUS(status);
+            running.erase(running.begin() + k);
+        }
+    }
+#endif
+    const size_t failed = size_t(std::count_if(results.begin(), results.end(), [](const ForkResult& r) { return r.status != 0; }));
+    LOG_INFO("System", "ForkRun: %zu copies in %.1f ms, %zu failed", count,
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), failed);
+    return results;
+}
+void PPCEmu::CheckReplayConfig() const {
+    if (replay_) throw std::runtime_error("Record/replay: already started");
+    if (cfg_.hardwareThreads > 1) throw std::runtime_error("Record/replay needs a single hardware thread (--threads 1)");
+    if (cfg_.jitMode == JitMode::Differential) throw std::runtime_error("Record/replay cannot run with --jit diff");
+}
+
+void PPCEmu::StartRecording(const std::string& path, uint64_t snapshotInterval) {
+    CheckReplayConfig();
+    replay_ = std::make_unique<ReplayLog>(path, ReplayLog::Mode::Record, cpu_);
+    snapshotInterval_ = snapshotInterval;
+    RecordSnapshot(); // punto de partida de la reproducción
+    cpu_.SetReplayLog(replay_.get());
+    mmu_.SetReplayLog(replay_.get());
+    LOG_INFO("System", "Recording to %s from instruction %llu", path.c_str(), (unsigned long long)cpu_.GetInstructionsRetired());
+}
+
+void PPCEmu::StartReplay(const std::string& path, uint64_t seek) {
+    CheckReplayConfig();
+    auto replay = std::make_unique<ReplayLog>(path, ReplayLog::Mode::Replay, cpu_);
+    const std::vector<uint64_t>& snapshots = replay->GetSnapshots();
+    if (snapshots.empty()) throw std::runtime_error("Replay " + path + ": no snapshot to start from");
+    const uint64_t stop = seek ? seek : replay->GetEnd();
+    if (stop < snapshots.front() || stop > replay->GetEnd())
+        throw std::runtime_error("Replay " + path + ": instruction " + std::to_string(stop) + " is outside the recording (" +
+            std::to_string(snapshots.front()) + ".." + std::to_string(replay->GetEnd()) + ")");
+    // Sin seek, la grabación entera; con seek, desde el último snapshot anterior
+    uint64_t start = snapshots.front();
+    for (uint64_t instant : snapshots)
+        if (seek && instant <= stop) start = instant;
+
+    LoadSnapshot(replay->SnapshotPath(start));
+    replay->SeekToSnapshot(start);
+    replay_ = std::move(replay);
+    replayStop_ = stop;
+    cpu_.SetReplayLog(replay_.get());
+    mmu_.SetReplayLog(replay_.get());
+    LOG_INFO("System", "Replaying %s from instruction %llu to %llu", path.c_str(), (unsigned long long)start, (unsigned long long)stop);
+}
+
+void PPCEmu::RecordSnapshot() {
+    const uint64_t now = cpu_.GetInstructionsRetired();
+    SaveSnapshot(replay_->SnapshotPath(now));
+    replay_->MarkSnapshot();
+    nextSnapshot_ = snapshotInterval_ ? now + snapshotInterval_ : UINT64_MAX;
+}
+
+void PPCEmu::FinishReplay() {
+    const uint64_t retired = cpu_.GetInstructionsRetired();
+    if (replay_->IsReplaying()) {
+        replay_->CheckDivergence();
+        if (retired < replayStop_)
+            LOG_WARNING("System", "Replay stopped at instruction %llu, before the end (%llu)", (unsigned long long)retired, (unsigned long long)replayStop_);
+        LOG_INFO("System", "Replay %s: %llu events up to instruction %llu", replay_->GetPath().c_str(),
+            (unsigned long long)replay_->GetEventCount(), (unsigned long long)retired);
+    } else {
+        replay_->Finish();
+        LOG_INFO("System", "Recorded %s: %llu events up to instruction %llu", replay_->GetPath().c_str(),
+            (unsigned long long)replay_->GetEventCount(), (unsigned long long)retired);
+    }
+    cpu_.SetReplayLog(nullptr);
+    mmu_.SetReplayLog(nullptr);
+    replay_.reset();
+}
+
+uint64_t PPCEmu::RunInstructions(uint64_t budget, uint64_t stop) {
+    uint64_t executed = 0;
+    while (executed < budget && executed < stop && cpu_.IsRunning()) {
+        const uint32_t n = cpu_.RunBlock(uint32_t((std::min<uint64_t>)(stop - executed, UINT32_MAX)));
+        if (!n && cpu_.IsPaused()) break; // pausada por el canal de control: el resto del frame queda libre
+        executed += n;
+    }
+    return executed;
+}
+
+// Scheduler: la CPU corre en porciones de SLICE_INSTRUCTIONS; entre porciones se mira el reloj.
+// En cada vsync (1/fps de tiempo real) se presenta el framebuffer y se atienden los mensajes de la ventana.
+// RealTime además limita cada frame a cpu_frequency_Hz / fps instrucciones y duerme hasta el vsync.
+// Grabando, el log se vuelca en cada vsync y la porción se corta en el próximo snapshot periódico,
+// que se toma en su instrucción exacta; reproduciendo, se para justo en la instrucción pedida (el
+// reloj del guest no depende del ritmo).
 void PPCEmu::Run(int fps) {
-    const auto frameTime = std::chrono::milliseconds(1000 / fps);
-    while (fb_->ProcessMessages()) {
-        cpu_.Step();
-        fb_->Present();     // refresca lo que se haya pintado por syscalls
-        std::this_thread::sleep_for(frameTime);
+    using clock = std::chrono::steady_clock;
+    const auto frameTime = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / fps));
+    const uint64_t frameBudget = uint64_t(cpu_frequency_Hz / fps);
+    const bool fixedCount = cfg_.runMode == RunMode::FixedCount;
+
+    // SMP: los hilos secundarios ven el mapa de memoria tal como quedó tras la carga
+    if (cfg_.hardwareThreads > 1) {
+        cpus_ = std::make_unique<CPUManager>(mmu_, cpu_, cfg_.hardwareThreads);
+        cpus_->Start();
+    }
+
+    start_time_ = std::chrono::high_resolution_clock::now();
+    cycle_count_ = 0;
+    auto nextVsync = clock::now() + frameTime;
+    uint64_t frameCycles = 0;
+    bool windowOpen = true;
+
+    while (windowOpen) {
+        uint64_t budget = SLICE_INSTRUCTIONS;
+        if (cfg_.runMode == RunMode::RealTime)
+            budget = (std::min)(budget, frameBudget - (std::min)(frameBudget, frameCycles));
+        if (fixedCount)
+            budget = (std::min)(budget, cfg_.instructionCount - cycle_count_);
+
+        const bool replaying = replay_ && replay_->IsReplaying();
+        const uint64_t retired = cpu_.GetInstructionsRetired();
+        uint64_t stop = UINT64_MAX;
+        if (replaying) stop = replayStop_ - (std::min)(replayStop_, retired);
+        else if (replay_) stop = nextSnapshot_ - (std::min)(nextSnapshot_, retired);
+        const uint64_t executed = budget && stop ? RunInstructions(budget, stop) : 0;
+        frameCycles += executed;
+        cycle_count_ += executed;
+        if (fixedCount && cycle_count_ >= cfg_.instructionCount)
+            break;
+        if (replaying && cpu_.GetInstructionsRetired() >= replayStop_)
+            break;
+        if (replay_ && !replaying && cpu_.GetInstructionsRetired() >= nextSnapshot_)
+            RecordSnapshot();
+
+        // Frame agotado (RealTime) o CPU detenida: nada que hacer hasta el próximo vsync
+        const bool idle = !cpu_.IsRunning() || cpu_.IsPaused() || (cfg_.runMode == RunMode::RealTime && frameCycles >= frameBudget);
+        if (idle)
+            std::this_thread::sleep_until(nextVsync);
+
+        const auto now = clock::now();
+        if (now >= nextVsync) {
+            fb_->Present();
+            windowOpen = fb_->ProcessMessages();
+            if (replay_ && !replay_->IsReplaying()) replay_->Flush();
+            frameCycles = 0;
+            nextVsync += frameTime;
+            if (nextVsync < now) nextVsync = now + frameTime; // no recuperar frames perdidos
+        }
+    }
+
+    fb_->Present();
+    if (replay_) FinishReplay();
+    const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time_).count();
+    LOG_INFO("System", "Emulation ended: %llu instructions in %.3f s (%.2f MIPS)",
+        (unsigned long long)cycle_count_, seconds, seconds > 0 ? cycle_count_ / seconds / 1e6 : 0.0);
+    if (cpus_) {
+        cpus_->Stop();
+        const uint64_t secondary = cpus_->GetSecondaryInstructions();
+        LOG_INFO("System", "Hardware threads 1..%d: %llu instructions (%.2f MIPS)", cfg_.hardwareThreads - 1,
+            (unsigned long long)secondary, seconds > 0 ? secondary / seconds / 1e6 : 0.0);
+        cpus_.reset();
+    }
+    for (const auto& file : files_) {
+        if (!file->IsReadOnly())
+            LOG_INFO("System", "%s: %llu dirty pages", file->GetPath().c_str(), (unsigned long long)file->CountDirtyPages());
     }
-    std::cout << "Emulation ended." << std::endl;
 }
 
-void PPCEmu::LoadELF32(const std::vector<uint8_t>&data) {
-    // 1) Cabecera ELF
-    if (data.size() < sizeof(Elf32Ehdr))
+void PPCEmu::LoadELF32(const MappedFile& image) {
+    // 1) Cabecera ELF, leída en su sitio dentro de la proyección
+    if (image.GetSize() < sizeof(Elf32Ehdr))
         throw std::runtime_error("ELF data too small");
 
-    const Elf32Ehdr* hdr = reinterpret_cast<const Elf32Ehdr*>(data.data());
+    const Elf32Ehdr* hdr = &image.As<Elf32Ehdr>(0);
     // Validar que es PowerPC BE
-    if (be16(hdr->e_machine) != 20) // EM_PPC == 20
+    if (FromBE(hdr->e_machine) != 20) // EM_PPC == 20
         throw std::runtime_error("Not a PowerPC ELF");
 
     // 2) Recorremos los headers de programa
-    uint16_t phnum = be16(hdr->e_phnum);
-    uint32_t phoff = be32(hdr->e_phoff);
-    uint16_t phentsize = be16(hdr->e_phentsize);
+    uint16_t phnum = FromBE(hdr->e_phnum);
+    uint32_t phoff = FromBE(hdr->e_phoff);
+    uint16_t phentsize = FromBE(hdr->e_phentsize);
+
+    if (phnum && phentsize < sizeof(Elf32Phdr))
+        throw std::runtime_error("ELF: bad e_phentsize");
 
     for (uint16_t i = 0; i < phnum; ++i) {
-        size_t off_hdr = phoff + i * phentsize;
-        if (off_hdr + sizeof(Elf32Phdr) > data.size())
+        uint64_t off_hdr = phoff + uint64_t(i) * phentsize;
+        if (off_hdr + sizeof(Elf32Phdr) > image.GetSize())
             throw std::runtime_error("Program header out of bounds");
 
-        const Elf32Phdr* ph = reinterpret_cast<const Elf32Phdr*>(data.data() + off_hdr);
-        if (be32(ph->p_type) != 1) continue; // solo PT_LOAD
+        const Elf32Phdr* ph = &image.As<Elf32Phdr>(off_hdr);
+        if (FromBE(ph->p_type) != 1) continue; // solo PT_LOAD
 
         // Campos
-        uint32_t vaddr = be32(ph->p_vaddr);
-        uint32_t filesz = be32(ph->p_filesz);
-        uint32_t memsz = be32(ph->p_memsz);
-        uint32_t offset = be32(ph->p_offset);
+        uint32_t vaddr = FromBE(ph->p_vaddr);
+        uint32_t filesz = FromBE(ph->p_filesz);
+        uint32_t memsz = FromBE(ph->p_memsz);
+        uint32_t offset = FromBE(ph->p_offset);
 
-        // Chequeo vector de datos
-        if (offset + filesz > data.size())
+        // Chequeo de límites contra el fichero
+        if (uint64_t(offset) + filesz > image.GetSize())
             throw std::runtime_error("ELF segment out of bounds");
 
-        // 3) Escribimos bytes del fichero
-        mmu_.Write(vaddr, data.data() + offset, filesz);
-
-        // 4) Si hay .bss (memsz > filesz), lo rellenamos a cero
-        if (memsz > filesz) {
-            mmu_.MemSet(vaddr + filesz, 0, memsz - filesz);
-        }
+        // 3) Bytes del fichero + .bss a cero, sobre la RAM compartida: una copia por segmento
+        uint32_t flags = FromBE(ph->p_flags);
+        LoadSegment(vaddr, image.GetData() + offset, filesz, memsz, flags & 0x2, flags & 0x1);
     }
 
     // 5) Ajustar PC al entry point
-    cpu_.SetPC(be32(hdr->e_entry));
+    cpu_.SetPC(FromBE(hdr->e_entry));
 }
-void PPCEmu::LoadELF64(const std::vector<uint8_t>& data) {
+void PPCEmu::LoadELF64(const MappedFile& image) {
     // ELF64 big-endian loader
-    struct Elf64Ehdr { unsigned char e_ident[16]; uint16_t e_type; uint16_t e_machine; uint32_t e_version; uint64_t e_entry; uint64_t e_phoff; uint64_t e_shoff; uint32_t e_flags; uint16_t e_ehsize; uint16_t e_phentsize; uint16_t e_phnum; uint16_t e_shentsize; uint16_t e_shnum; uint16_t e_shstrndx; };
-    struct Elf64Phdr { uint32_t p_type; uint32_t p_flags; uint64_t p_offset; uint64_t p_vaddr; uint64_t p_paddr; uint64_t p_filesz; uint64_t p_memsz; uint64_t p_align; };
-    auto* eh = reinterpret_cast<const Elf64Ehdr*>(data.data());
-    auto be64 = [&](uint64_t v) {
-        return ((v >> 56) & 0xFFULL) | ((v >> 40) & 0xFF00ULL) | ((v >> 24) & 0xFF0000ULL) |
-            ((v >> 8) & 0xFF000000ULL) | ((v << 8) & 0xFF00000000ULL) |
-            ((v << 24) & 0xFF0000000000ULL) | ((v << 40) & 0xFF000000000000ULL) |
-            ((v << 56) & 0xFF00000000000000ULL);
-        };
-    uint64_t entry = be64(eh->e_entry);
+    auto* eh = &image.As<Elf64Ehdr>(0);
+    uint64_t entry = FromBE(eh->e_entry);
+    const uint64_t phoff = FromBE(eh->e_phoff);
+    const uint16_t phentsize = FromBE(eh->e_phentsize);
+    if (FromBE(eh->e_phnum) && phentsize < sizeof(Elf64Phdr))
+        throw std::runtime_error("ELF: bad e_phentsize");
+    if (phoff > image.GetSize())
+        throw std::runtime_error("Program header out of bounds");
     // Program headers
-    for (int i = 0; i < be16(eh->e_phnum); ++i) {
-        auto* ph = reinterpret_cast<const Elf64Phdr*>(
-            data.data() + be64(eh->e_phoff) + i * be16(eh->e_phentsize));
-        if (be32(ph->p_type) != 1) continue; // PT_LOAD
-        uint64_t vaddr = be64(ph->p_vaddr);
-        uint64_t filesz = be64(ph->p_filesz);
-        uint64_t memsz = be64(ph->p_memsz);
-        uint64_t off = be64(ph->p_offset);
-        bool     rw = (be32(ph->p_flags) & 0x2);
-        bool     rx = (be32(ph->p_flags) & 0x1);
-        auto seg = std::make_shared<Memory>("SEG" + std::to_string(i));
-        seg->Write(0, data.data() + off, filesz);
-        if (memsz > filesz) seg->MemSet(filesz, 0, memsz - filesz);
-        mmu_.MapMemory(seg, vaddr, vaddr + memsz, 0, true, rw, rx);
+    for (int i = 0; i < FromBE(eh->e_phnum); ++i) {
+        auto* ph = &image.As<Elf64Phdr>(phoff + uint64_t(i) * phentsize);
+        if (FromBE(ph->p_type) != 1) continue; // PT_LOAD
+        uint64_t vaddr = FromBE(ph->p_vaddr);
+        uint64_t filesz = FromBE(ph->p_filesz);
+        uint64_t memsz = FromBE(ph->p_memsz);
+        uint64_t off = FromBE(ph->p_offset);
+        bool     rw = (FromBE(ph->p_flags) & 0x2);
+        bool     rx = (FromBE(ph->p_flags) & 0x1);
+        LoadSegment(vaddr, image.At(off, filesz), filesz, memsz, rw, rx);
     }
     cpu_.SetPC(entry);
 }
+
+// Los segmentos se tallan de la RAM física única en vez de crear un dispositivo por segmento.
+// Si la dirección ya está mapeada (p.ej. el alias userBase) se escribe a través de esa traducción
+// y conserva sus permisos; si no, se abre una ventana sobre RAM física libre (AllocateSegmentRAM),
+// que sustituye la parte que ya estuviera mapeada.
+void PPCEmu::LoadSegment(uint64_t vaddr, const uint8_t* src, uint64_t filesz, uint64_t memsz, bool writable, bool executable) {
+    if (memsz < filesz)
+        throw std::runtime_error("ELF segment: memsz < filesz");
+    if (memsz == 0) return;
+
+    if (mmu_.IsMapped(vaddr, vaddr + memsz)) {
+        mmu_.Write(vaddr, src, filesz);
+        if (memsz > filesz) mmu_.MemSet(vaddr + filesz, 0, memsz - filesz);
+        return;
+    }
+
+    const uint64_t phys = AllocateSegmentRAM(vaddr, memsz);
+    ram_->Write(phys, src, filesz);
+    if (memsz > filesz) ram_->MemSet(phys + filesz, 0, memsz - filesz);
+    mmu_.RemapMemory(ram_, vaddr, vaddr + memsz, phys, true, writable, executable);
+}
+
+// Primer hueco de RAM física (en páginas de 4 KiB) que no respalde ya otra región de ram_: ni
+// las ventanas excBase/userBase ni los segmentos anteriores. Dos regiones sobre los mismos bytes
+// se pisarían sin aviso (p.ej. un segmento encima de los vectores de excepción).
+uint64_t PPCEmu::AllocateSegmentRAM(uint64_t vaddr, uint64_t size) const {
+    constexpr uint64_t PAGE_MASK = 0xFFF;
+    std::vector<std::pair<uint64_t, uint64_t>> used;
+    for (const MemoryRegion& region : mmu_.GetRegions()) {
+        if (region.device == ram_)
+            used.emplace_back(region.physical_start, region.physical_start + (region.virtual_end - region.virtual_start));
+    }
+    std::sort(used.begin(), used.end());
+
+    size = (size + PAGE_MASK) & ~PAGE_MASK;
+    uint64_t phys = 0;
+    for (const auto& range : used) {
+        if (range.first >= phys + size) break;
+        phys = std::max(phys, (range.second + PAGE_MASK) & ~PAGE_MASK);
+    }
+    if (phys + size > ram_->GetSize()) {
+        LOG_ERROR("System", "ELF segment at 0x%llX (0x%llX bytes): no free RAM outside the excBase/userBase windows and earlier segments",
+            (unsigned long long)vaddr, (unsigned long long)size);
+        throw std::runtime_error("ELF segment does not fit in free RAM");
+    }
+    return phys;
+}
+
+uint64_t PPCEmu::GetResidentMemory() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.WorkingSetSize;
+#else
+    // /proc/self/statm: tamaño total y páginas residentes
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    unsigned long long total = 0, resident = 0;
+    const int fields = fscanf(f, "%llu %llu", &total, &resident);
+    fclose(f);
+    return fields == 2 ? resident * uint64_t(sysconf(_SC_PAGESIZE)) : 0;
+#endif
+}
@@ -4,14 +4,28 @@
 #include <memory>
 #include <string>
 #include <chrono>
+#include <functional>
 #include "CPU.h"
 #include "MMU.h"
 #include "Memory.h"
 #include "Display.h"
+#include "CPUManager.h"
+#include "InterruptController.h"
 #include "PPCEmuConfig.h"
+#include "MappedFile.h"
+#include "FileMemory.h"
+#include "XeXLoader.h"
+#include "Replay.h"
 
 // Supported binary formats
-enum class BinaryType { ELF32_BE, ELF64_BE, RAW, UNKNOWN };
+enum class BinaryType { ELF32_BE, ELF64_BE, XEX2, RAW, UNKNOWN };
+
+// Result of one child of PPCEmu::ForkRun
+struct ForkResult {
+    size_t      index;
+    int         status;     // 0 = body returned, 1 = body threw, -N = killed by signal N
+    std::string output;     // what the body returned (or the exception message)
+};
 
 class PPCEmu {
 public:
@@ -23,31 +37,89 @@ public:
     // Auto-detect and load binary
     void AutoLoad(const std::string& path);
 
-    // Run the emulation loop
+    // Run the emulation loop. fps is the vsync rate: the framebuffer is presented and the
+    // window messages pumped once per frame, regardless of how many instructions ran.
     void Run(int fps = 60);
 
+    // Guest instructions between clock checks; keeps vsync and the UI pump responsive
+    static constexpr uint64_t SLICE_INSTRUCTIONS = 100000;
+
     // Initialize exception vectors before loading
     void initExceptionHandlers();
 
+    // Snapshot of the whole machine (see Snapshot.h): CPU, devices, dirty RAM pages and the
+    // memory map. Only between runs: secondary hardware threads are not saved.
+    void SaveSnapshot(const std::string& path);
+    // Replaces AutoLoad: the machine continues exactly where the snapshot was taken
+    void LoadSnapshot(const std::string& path);
+
+    // Record/replay (see Replay.h). Only with one hardware thread and without --jit diff.
+    // StartRecording: from the current state on, the next Run logs every outside input to path,
+    // with a snapshot now and every snapshotInterval instructions (0 = only the first one).
+    void StartRecording(const std::string& path, uint64_t snapshotInterval);
+    // Replaces AutoLoad: restores the last snapshot of the recording at or before seek and the
+    // next Run replays it up to instruction seek (0 = the end of the recording)
+    void StartReplay(const std::string& path, uint64_t seek = 0);
+
+    // Runs body in count copies of this machine, each from the current state, and collects
+    // what each one returns. POSIX: one fork()ed child per copy (at most maxParallel at once,
+    // 0 = one per host core); guest RAM and file mappings are shared copy-on-write by the host,
+    // and a child that crashes only loses its own result. Elsewhere the copies run one after
+    // another in this process, each restored from a temporary snapshot (see SaveSnapshot).
+    // Call between runs; this machine is left as it was.
+    using ForkBody = std::function<std::string(PPCEmu& machine, size_t index)>;
+    std::vector<ForkResult> ForkRun(size_t count, const ForkBody& body, unsigned maxParallel = 0);
+
+    CPU& GetCPU() { return cpu_; }
+    MMU& GetMMU() { return mmu_; }
+    // Guest instructions retired by the last Run (hardware thread 0)
+    uint64_t GetInstructionCount() const { return cycle_count_; }
+
+    // Resident set size of the process in bytes (0 if the host cannot tell)
+    static uint64_t GetResidentMemory();
+
 private:
     // Mapping setup
     void initMappings();
 
     // ELF/RAW loaders
-    BinaryType DetectFormat(const std::vector<uint8_t>& data) const;
-    void LoadELF32(const std::vector<uint8_t>& data);
-    void LoadELF64(const std::vector<uint8_t>& data);
-    void LoadRAW(const std::string& filename, uint64_t loadAddr);
-    std::vector<uint8_t> ReadFileToVector(const std::string& path) const;
+    // The image is memory-mapped: headers are validated in place and each segment is copied
+    // straight from the mapping into guest RAM (see MappedFile.h)
+    BinaryType DetectFormat(const MappedFile& image) const;
+    void LoadELF32(const MappedFile& image);
+    void LoadELF64(const MappedFile& image);
+    void LoadRAW(const MappedFile& image, uint64_t loadAddr);
+    // XEX2 (see XeXLoader.h): maps the image range from RAM if needed and returns the module
+    XexModule LoadXEX(const MappedFile& image);
+    // Copies a PT_LOAD segment into the shared RAM (see LoadSegment in PPCEmu.cpp)
+    void LoadSegment(uint64_t vaddr, const uint8_t* src, uint64_t filesz, uint64_t memsz, bool writable, bool executable);
+    // Physical RAM for a segment outside every mapping; throws if none is free
+    uint64_t AllocateSegmentRAM(uint64_t vaddr, uint64_t size) const;
+
+    // Runs whole blocks until at least budget instructions retired or the CPU halts.
+    // Never past stop: the block that would cross it is cut there (replay up to an instant,
+    // recording snapshots at their exact instruction).
+    uint64_t RunInstructions(uint64_t budget, uint64_t stop = UINT64_MAX);
+    // Record/replay
+    void CheckReplayConfig() const;
+    void RecordSnapshot();
+    void FinishReplay();
 
     // Core components
     PPCEmuConfig               cfg_;
+    MMU                         mmu_;   // antes que cpu_: la CPU se registra en la MMU al construirse
     CPU                         cpu_;
-    MMU                         mmu_;
     std::shared_ptr<Memory>     ram_;
     std::shared_ptr<Display>    fb_;
+    std::shared_ptr<InterruptController> iic_;
+    std::vector<std::shared_ptr<FileMemory>> files_; // cfg_.fileMappings
+    std::unique_ptr<CPUManager> cpus_;  // hilos de hardware 1..N-1, slo durante Run()
+    std::unique_ptr<ReplayLog>  replay_;           // StartRecording/StartReplay, hasta el final de Run()
+    uint64_t                    replayStop_ = 0;   // replay: instruccin en la que se para
+    uint64_t                    snapshotInterval_ = 0;
+    uint64_t                    nextSnapshot_ = UINT64_MAX; // record: instruccin del prximo snapshot
 
-    // Profiling
+    // Profiling (un ciclo por instruccin)
     uint64_t                    cycle_count_ = 0;
     const double                cpu_frequency_Hz = 729000000.0; // 729 MHz
     std::chrono::high_resolution_clock::time_point start_time_;
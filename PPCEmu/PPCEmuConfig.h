@@ -1,6 +1,28 @@
 // PPCEmuConfig.h
 #pragma once
+#include "VMXKernels.h"
 #include <cstdint>
+#include <string>
+#include <vector>
+
+// Execution engine: interpreter only, interpreter + JIT for hot blocks, or both
+// compared after every block (differential)
+enum class JitMode { Off, On, Differential };
+
+// Where presented frames go: a window (Windows only), nowhere, image files or shared memory
+enum class PresenterKind { Window, Null, PPM, PNG, SharedMemory };
+
+// Emulation pacing: as fast as possible, locked to cpu_frequency_Hz, or a fixed number
+// of guest instructions (reproducible benchmarks; stops when reached)
+enum class RunMode { FreeRun, RealTime, FixedCount };
+
+// A host file mapped into the guest without copying it (FileMemory): ROM, NAND or dump images.
+// Copy-on-write mappings are writable; the file itself never changes.
+struct FileMapping {
+    uint64_t    address;
+    std::string path;
+    bool        copyOnWrite;
+};
 
 struct PPCEmuConfig {
     // Memory regions
@@ -15,4 +37,45 @@ struct PPCEmuConfig {
     int      fbWidth = 640;
     int      fbHeight = 480;
     bool     textMode = true;
+
+    // Presentation: --present window|null|ppm[:dir]|png[:dir]|shm[:name]
+#ifdef _WIN32
+    PresenterKind presenter = PresenterKind::Window;
+#else
+    PresenterKind presenter = PresenterKind::Null;
+#endif
+    std::string presenterTarget;        // dump directory or shared memory name (empty = default)
+    uint32_t dumpInterval = 60;         // PPM/PNG: write one frame out of N
+
+    // CPU
+    JitMode  jitMode = JitMode::On;     // --jit off|on|diff
+    int      hardwareThreads = 1;       // --threads N (1..6): Xenon = 3 cores x 2 SMT threads
+    VMXIsa   vmxIsa = BestVMXIsa();     // --vmx scalar|sse4.1|avx2: host ISA for the VMX kernels
+
+    // Interrupt controller (IIC): one 0x1000-byte register block per hardware thread
+    uint64_t iicBase = 0x20000050000ULL;
+
+    // --map ADDR:FILE (read-only) / --map-cow ADDR:FILE, mapped ahead of the RAM regions
+    std::vector<FileMapping> fileMappings;
+
+    // --xex-key FILE (repeatable): console AES keys tried in order on encrypted XEX2 images
+    std::vector<std::string> xexKeyFiles;
+
+    // --load-snapshot FILE: start from a snapshot instead of a binary; --save-snapshot FILE: after Run
+    std::string snapshotLoad;
+    std::string snapshotSave;
+
+    // --fork N: after loading, run N copies of the machine (PPCEmu::ForkRun), r3 = copy index
+    size_t forkCount = 0;
+
+    // --record FILE: log the run for replay, with a snapshot every --snapshot-interval N
+    // instructions (0 = only at the start); --replay FILE instead of a binary, up to --seek N
+    std::string recordPath;
+    std::string replayPath;
+    uint64_t snapshotInterval = 500000000;
+    uint64_t replaySeek = 0;
+
+    // Scheduler
+    RunMode  runMode = RunMode::RealTime;   // --run free|realtime, --count N
+    uint64_t instructionCount = 0;          // RunMode::FixedCount
 };
@@ -0,0 +1,1054 @@
+// PPCInterpreter.cpp
+#include "PPCInterpreter.h"
+#include "CPU.h"
+#include "Endian.h"
+#include "VMXKernels.h"
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Effective addresses: D-form (rA|0 + SIMM) and X-form (rA|0 + rB), truncated to 32 bits
+// unless MSR[SF] is set. The U variants are the update forms (rA != 0, rA receives the EA).
+#define EA_D(op) cpu.EffectiveAddress((op.rA ? cpu.GPR[op.rA] : 0) + uint64_t(int64_t(op.imm)))
+#define EA_X(op) cpu.EffectiveAddress((op.rA ? cpu.GPR[op.rA] : 0) + cpu.GPR[op.rB])
+#define EA_DU(op) cpu.EffectiveAddress(cpu.GPR[op.rA] + uint64_t(int64_t(op.imm)))
+#define EA_XU(op) cpu.EffectiveAddress(cpu.GPR[op.rA] + cpu.GPR[op.rB])
+#define CR0_IF_RC(op, v) if (op.rc) cpu.UpdateCR0(v)
+
+static inline uint32_t Rotl32(uint32_t v, uint32_t sh) {
+	sh &= 31;
+	return sh ? (v << sh) | (v >> (32 - sh)) : v;
+}
+
+static inline uint64_t Rotl64(uint64_t v, uint32_t sh) {
+	sh &= 63;
+	return sh ? (v << sh) | (v >> (64 - sh)) : v;
+}
+
+// rlw*: the 32-bit rotate is replicated into both halves (ROTL32 in the 64-bit ISA)
+static inline uint64_t RotlWord(uint64_t v, uint32_t sh) {
+	const uint64_t r = Rotl32(uint32_t(v), sh);
+	return r | (r << 32);
+}
+
+// MASK(mb, me) over 64 bits, big-endian bit numbering; wraps around when mb > me
+static inline uint64_t Mask64(uint32_t mb, uint32_t me) {
+	const uint64_t begin = ~0ull >> mb, end = ~0ull << (63 - me);
+	return mb <= me ? begin & end : begin | end;
+}
+
+// rlw* mask: MASK(mb + 32, me + 32). A wrapping mask also covers the high word.
+static inline uint64_t RlwMask(uint32_t mb, uint32_t me) {
+	return Mask64(mb + 32, me + 32);
+}
+
+static inline uint32_t CountLeadingZeros32(uint32_t v) {
+#if defined(_MSC_VER)
+	unsigned long idx;
+	return _BitScanReverse(&idx, v) ? 31 - idx : 32;
+#else
+	return v ? __builtin_clz(v) : 32;
+#endif
+}
+
+static inline uint32_t CountLeadingZeros64(uint64_t v) {
+#if defined(_MSC_VER)
+	unsigned long idx;
+	return _BitScanReverse64(&idx, v) ? 63 - idx : 64;
+#else
+	return v ? __builtin_clzll(v) : 64;
+#endif
+}
+
+// High 64 bits of the 128-bit product
+static inline uint64_t MulHigh64(uint64_t a, uint64_t b) {
+#if defined(_MSC_VER)
+	return __umulh(a, b);
+#else
+	return uint64_t((unsigned __int128)a * b >> 64);
+#endif
+}
+
+static inline int64_t MulHigh64Signed(int64_t a, int64_t b) {
+#if defined(_MSC_VER)
+	return __mulh(a, b);
+#else
+	return int64_t((__int128)a * b >> 64);
+#endif
+}
+
+// Carry out of a + b + c (c is 0 or 1): out of bit 0 in 64-bit mode, out of bit 32 in 32-bit mode
+static inline bool CarryOut(const CPU& cpu, uint64_t a, uint64_t b, uint64_t c) {
+	if (!cpu.Is64BitMode()) return (uint64_t(uint32_t(a)) + uint32_t(b) + c) >> 32;
+	const uint64_t s = a + b;
+	return s < a || s + c < s;
+}
+
+void PPCInterpreter::Legacy(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint32_t cia = cpu.PC;
+	cpu.DecodeExecute(op.instr);
+	if (cpu.PC != cia) cpu.NIA = cpu.PC; // legacy paths redirect through PC directly
+}
+
+// Integer arithmetic
+
+// Immediates are sign-extended to 64 bits; results are always computed over the full register
+void PPCInterpreter::addi(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = (op.rA ? cpu.GPR[op.rA] : 0) + uint64_t(int64_t(op.imm));
+}
+
+void PPCInterpreter::addis(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = (op.rA ? cpu.GPR[op.rA] : 0) + (uint64_t(int64_t(op.imm)) << 16);
+}
+
+void PPCInterpreter::addic(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA], imm = uint64_t(int64_t(op.imm));
+	cpu.GPR[op.rD] = a + imm;
+	cpu.SetXERCA(CarryOut(cpu, a, imm, 0));
+}
+
+void PPCInterpreter::addicx(CPU& cpu, const PPCDecodedInstr& op) {
+	addic(cpu, op);
+	cpu.UpdateCR0(cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::subfic(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA], imm = uint64_t(int64_t(op.imm));
+	cpu.GPR[op.rD] = imm - a;
+	cpu.SetXERCA(CarryOut(cpu, ~a, imm, 1));
+}
+
+void PPCInterpreter::mulli(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.GPR[op.rA] * uint64_t(int64_t(op.imm));
+}
+
+// XO-form: the OE variants share these handlers, XER[OV] is not tracked yet.
+void PPCInterpreter::add(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.GPR[op.rA] + cpu.GPR[op.rB];
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::addc(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA], b = cpu.GPR[op.rB];
+	cpu.GPR[op.rD] = a + b;
+	cpu.SetXERCA(CarryOut(cpu, a, b, 0));
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::adde(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA], b = cpu.GPR[op.rB], ca = cpu.GetXERCA();
+	cpu.GPR[op.rD] = a + b + ca;
+	cpu.SetXERCA(CarryOut(cpu, a, b, ca));
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::addme(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA], ca = cpu.GetXERCA();
+	cpu.GPR[op.rD] = a + ca - 1;
+	cpu.SetXERCA(CarryOut(cpu, a, ~0ull, ca));
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::addze(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA], ca = cpu.GetXERCA();
+	cpu.GPR[op.rD] = a + ca;
+	cpu.SetXERCA(CarryOut(cpu, a, 0, ca));
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::subf(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.GPR[op.rB] - cpu.GPR[op.rA];
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::subfc(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA], b = cpu.GPR[op.rB];
+	cpu.GPR[op.rD] = b - a;
+	cpu.SetXERCA(CarryOut(cpu, ~a, b, 1));
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::subfe(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA], b = cpu.GPR[op.rB], ca = cpu.GetXERCA();
+	cpu.GPR[op.rD] = ~a + b + ca;
+	cpu.SetXERCA(CarryOut(cpu, ~a, b, ca));
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::subfme(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA], ca = cpu.GetXERCA();
+	cpu.GPR[op.rD] = ~a + ca - 1;
+	cpu.SetXERCA(CarryOut(cpu, ~a, ~0ull, ca));
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::subfze(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA], ca = cpu.GetXERCA();
+	cpu.GPR[op.rD] = ~a + ca;
+	cpu.SetXERCA(CarryOut(cpu, ~a, 0, ca));
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::neg(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = ~cpu.GPR[op.rA] + 1;
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+// mullw keeps the full 64-bit product of the low words; the other word forms zero-extend
+void PPCInterpreter::mullw(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = uint64_t(int64_t(int32_t(cpu.GPR[op.rA])) * int32_t(cpu.GPR[op.rB]));
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::mulhw(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = uint32_t((int64_t(int32_t(cpu.GPR[op.rA])) * int32_t(cpu.GPR[op.rB])) >> 32);
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::mulhwu(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = uint32_t((uint64_t(uint32_t(cpu.GPR[op.rA])) * uint32_t(cpu.GPR[op.rB])) >> 32);
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::divw(CPU& cpu, const PPCDecodedInstr& op) {
+	const int32_t a = int32_t(cpu.GPR[op.rA]), b = int32_t(cpu.GPR[op.rB]);
+	// Result is undefined on /0 and 0x80000000 / -1
+	const bool invalid = b == 0 || (a == INT32_MIN && b == -1);
+	cpu.GPR[op.rD] = invalid ? (a < 0 && b == 0 ? 0xFFFFFFFF : 0) : uint32_t(a / b);
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::divwu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint32_t a = uint32_t(cpu.GPR[op.rA]), b = uint32_t(cpu.GPR[op.rB]);
+	cpu.GPR[op.rD] = b ? a / b : 0;
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::mulld(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.GPR[op.rA] * cpu.GPR[op.rB];
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::mulhd(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = uint64_t(MulHigh64Signed(int64_t(cpu.GPR[op.rA]), int64_t(cpu.GPR[op.rB])));
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::mulhdu(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = MulHigh64(cpu.GPR[op.rA], cpu.GPR[op.rB]);
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::divd(CPU& cpu, const PPCDecodedInstr& op) {
+	const int64_t a = int64_t(cpu.GPR[op.rA]), b = int64_t(cpu.GPR[op.rB]);
+	// Same undefined cases as divw, with the result left at zero
+	const bool invalid = b == 0 || (a == INT64_MIN && b == -1);
+	cpu.GPR[op.rD] = invalid ? 0 : uint64_t(a / b);
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::divdu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA], b = cpu.GPR[op.rB];
+	cpu.GPR[op.rD] = b ? a / b : 0;
+	CR0_IF_RC(op, cpu.GPR[op.rD]);
+}
+
+// Compare and trap
+
+template <typename T>
+static inline uint32_t Compare(T a, T b) {
+	return a < b ? 0x8 : (a > b ? 0x4 : 0x2);
+}
+
+// The L bit (low bit of crfD's field) selects a doubleword compare
+void PPCInterpreter::cmpi(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA];
+	const uint32_t c = (op.rD & 1) ? Compare<int64_t>(int64_t(a), op.imm) : Compare<int32_t>(int32_t(a), op.imm);
+	cpu.SetCRField(op.rD >> 2, c | cpu.GetXERSO());
+}
+
+void PPCInterpreter::cmpli(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA];
+	const uint32_t c = (op.rD & 1) ? Compare<uint64_t>(a, uint16_t(op.imm)) : Compare<uint32_t>(uint32_t(a), uint16_t(op.imm));
+	cpu.SetCRField(op.rD >> 2, c | cpu.GetXERSO());
+}
+
+void PPCInterpreter::cmp(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA], b = cpu.GPR[op.rB];
+	const uint32_t c = (op.rD & 1) ? Compare<int64_t>(int64_t(a), int64_t(b)) : Compare<int32_t>(int32_t(a), int32_t(b));
+	cpu.SetCRField(op.rD >> 2, c | cpu.GetXERSO());
+}
+
+void PPCInterpreter::cmpl(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t a = cpu.GPR[op.rA], b = cpu.GPR[op.rB];
+	const uint32_t c = (op.rD & 1) ? Compare<uint64_t>(a, b) : Compare<uint32_t>(uint32_t(a), uint32_t(b));
+	cpu.SetCRField(op.rD >> 2, c | cpu.GetXERSO());
+}
+
+// S/U: signed/unsigned types of the compared width (tw: 32 bits, td: 64)
+template <typename S, typename U>
+static inline bool TrapCondition(uint32_t to, U a, U b) {
+	return ((to & 0x10) && S(a) < S(b)) ||
+		((to & 0x08) && S(a) > S(b)) ||
+		((to & 0x04) && a == b) ||
+		((to & 0x02) && a < b) ||
+		((to & 0x01) && a > b);
+}
+
+void PPCInterpreter::tw(CPU& cpu, const PPCDecodedInstr& op) {
+	if (TrapCondition<int32_t, uint32_t>(op.rD, uint32_t(cpu.GPR[op.rA]), uint32_t(cpu.GPR[op.rB]))) cpu.TriggerTrap();
+}
+
+void PPCInterpreter::twi(CPU& cpu, const PPCDecodedInstr& op) {
+	if (TrapCondition<int32_t, uint32_t>(op.rD, uint32_t(cpu.GPR[op.rA]), uint32_t(op.imm))) cpu.TriggerTrap();
+}
+
+void PPCInterpreter::td(CPU& cpu, const PPCDecodedInstr& op) {
+	if (TrapCondition<int64_t, uint64_t>(op.rD, cpu.GPR[op.rA], cpu.GPR[op.rB])) cpu.TriggerTrap();
+}
+
+void PPCInterpreter::tdi(CPU& cpu, const PPCDecodedInstr& op) {
+	if (TrapCondition<int64_t, uint64_t>(op.rD, cpu.GPR[op.rA], uint64_t(int64_t(op.imm)))) cpu.TriggerTrap();
+}
+
+// Logical, rotate and shift (rS is in the rD slot, result goes to rA)
+
+void PPCInterpreter::ori(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = cpu.GPR[op.rD] | uint16_t(op.imm);
+}
+
+void PPCInterpreter::oris(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = cpu.GPR[op.rD] | (uint64_t(uint16_t(op.imm)) << 16);
+}
+
+void PPCInterpreter::xori(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = cpu.GPR[op.rD] ^ uint16_t(op.imm);
+}
+
+void PPCInterpreter::xoris(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = cpu.GPR[op.rD] ^ (uint64_t(uint16_t(op.imm)) << 16);
+}
+
+void PPCInterpreter::andi(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = cpu.GPR[op.rD] & uint16_t(op.imm);
+	cpu.UpdateCR0(cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::andis(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = cpu.GPR[op.rD] & (uint64_t(uint16_t(op.imm)) << 16);
+	cpu.UpdateCR0(cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::and_(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = cpu.GPR[op.rD] & cpu.GPR[op.rB];
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::andc(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = cpu.GPR[op.rD] & ~cpu.GPR[op.rB];
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::or_(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = cpu.GPR[op.rD] | cpu.GPR[op.rB];
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::orc(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = cpu.GPR[op.rD] | ~cpu.GPR[op.rB];
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::xor_(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = cpu.GPR[op.rD] ^ cpu.GPR[op.rB];
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::nand(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = ~(cpu.GPR[op.rD] & cpu.GPR[op.rB]);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::nor(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = ~(cpu.GPR[op.rD] | cpu.GPR[op.rB]);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::eqv(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = ~(cpu.GPR[op.rD] ^ cpu.GPR[op.rB]);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::extsb(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = uint64_t(int64_t(int8_t(cpu.GPR[op.rD])));
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::extsh(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = uint64_t(int64_t(int16_t(cpu.GPR[op.rD])));
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::extsw(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = uint64_t(int64_t(int32_t(cpu.GPR[op.rD])));
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::cntlzw(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = CountLeadingZeros32(uint32_t(cpu.GPR[op.rD]));
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::cntlzd(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = CountLeadingZeros64(cpu.GPR[op.rD]);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::rlwimi(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t mask = RlwMask(op.mb, op.me);
+	cpu.GPR[op.rA] = (RotlWord(cpu.GPR[op.rD], op.sh) & mask) | (cpu.GPR[op.rA] & ~mask);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::rlwinm(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = RotlWord(cpu.GPR[op.rD], op.sh) & RlwMask(op.mb, op.me);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::rlwnm(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = RotlWord(cpu.GPR[op.rD], uint32_t(cpu.GPR[op.rB])) & RlwMask(op.mb, op.me);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+// MD/MDS-form: sh and mb/me are the 6-bit fields reassembled by the decoder
+void PPCInterpreter::rldicl(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = Rotl64(cpu.GPR[op.rD], op.sh) & Mask64(op.mb, 63);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::rldicr(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = Rotl64(cpu.GPR[op.rD], op.sh) & Mask64(0, op.mb);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::rldic(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = Rotl64(cpu.GPR[op.rD], op.sh) & Mask64(op.mb, 63 - op.sh);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::rldimi(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t mask = Mask64(op.mb, 63 - op.sh);
+	cpu.GPR[op.rA] = (Rotl64(cpu.GPR[op.rD], op.sh) & mask) | (cpu.GPR[op.rA] & ~mask);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::rldcl(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = Rotl64(cpu.GPR[op.rD], uint32_t(cpu.GPR[op.rB])) & Mask64(op.mb, 63);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::rldcr(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rA] = Rotl64(cpu.GPR[op.rD], uint32_t(cpu.GPR[op.rB])) & Mask64(0, op.mb);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::slw(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint32_t sh = cpu.GPR[op.rB] & 0x3F;
+	cpu.GPR[op.rA] = sh & 0x20 ? 0 : uint32_t(cpu.GPR[op.rD]) << sh;
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::srw(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint32_t sh = cpu.GPR[op.rB] & 0x3F;
+	cpu.GPR[op.rA] = sh & 0x20 ? 0 : uint32_t(cpu.GPR[op.rD]) >> sh;
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::sraw(CPU& cpu, const PPCDecodedInstr& op) {
+	const int32_t s = int32_t(cpu.GPR[op.rD]);
+	const uint32_t sh = cpu.GPR[op.rB] & 0x3F;
+	if (sh & 0x20) {
+		cpu.GPR[op.rA] = s < 0 ? ~0ull : 0;
+		cpu.SetXERCA(s < 0);
+	}
+	else {
+		cpu.GPR[op.rA] = uint64_t(int64_t(s >> sh));
+		cpu.SetXERCA(s < 0 && sh && (uint32_t(s) << (32 - sh)) != 0);
+	}
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::srawi(CPU& cpu, const PPCDecodedInstr& op) {
+	const int32_t s = int32_t(cpu.GPR[op.rD]);
+	cpu.GPR[op.rA] = uint64_t(int64_t(s >> op.sh));
+	cpu.SetXERCA(s < 0 && op.sh && (uint32_t(s) << (32 - op.sh)) != 0);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::sld(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint32_t sh = cpu.GPR[op.rB] & 0x7F;
+	cpu.GPR[op.rA] = sh & 0x40 ? 0 : cpu.GPR[op.rD] << sh;
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::srd(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint32_t sh = cpu.GPR[op.rB] & 0x7F;
+	cpu.GPR[op.rA] = sh & 0x40 ? 0 : cpu.GPR[op.rD] >> sh;
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+// CA is set when a negative value loses 1-bits
+static inline uint64_t ShiftRightAlgebraic64(uint64_t v, uint32_t sh, bool& ca) {
+	const int64_t s = int64_t(v);
+	if (sh & 0x40) {
+		ca = s < 0;
+		return s < 0 ? ~0ull : 0;
+	}
+	ca = s < 0 && sh && (uint64_t(s) << (64 - sh)) != 0;
+	return uint64_t(s >> sh);
+}
+
+void PPCInterpreter::srad(CPU& cpu, const PPCDecodedInstr& op) {
+	bool ca;
+	cpu.GPR[op.rA] = ShiftRightAlgebraic64(cpu.GPR[op.rD], cpu.GPR[op.rB] & 0x7F, ca);
+	cpu.SetXERCA(ca);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+void PPCInterpreter::sradi(CPU& cpu, const PPCDecodedInstr& op) {
+	bool ca;
+	cpu.GPR[op.rA] = ShiftRightAlgebraic64(cpu.GPR[op.rD], op.sh, ca);
+	cpu.SetXERCA(ca);
+	CR0_IF_RC(op, cpu.GPR[op.rA]);
+}
+
+// Branch and system
+
+// BO decoding shared by bc/bclr/bcctr. Returns true if the branch is taken.
+static inline bool BranchCondition(uint32_t bo, uint32_t bi, bool decrementCTR, uint32_t& ctr, uint32_t cr) {
+	bool ctr_ok = true;
+	if (decrementCTR && !(bo & 0x04)) {
+		--ctr;
+		ctr_ok = (ctr != 0) != bool(bo & 0x02);
+	}
+	const bool cond_ok = (bo & 0x10) || (((cr >> (31 - bi)) & 1) == ((bo >> 3) & 1));
+	return ctr_ok && cond_ok;
+}
+
+void PPCInterpreter::b(CPU& cpu, const PPCDecodedInstr& op) {
+	if (op.rc) cpu.LR = cpu.PC + 4;
+	cpu.NIA = (op.aa ? 0 : cpu.PC) + uint32_t(op.imm);
+}
+
+void PPCInterpreter::bc(CPU& cpu, const PPCDecodedInstr& op) {
+	const bool taken = BranchCondition(op.rD, op.rA, true, cpu.CTR, cpu.CR.value);
+	if (op.rc) cpu.LR = cpu.PC + 4;
+	if (taken) cpu.NIA = (op.aa ? 0 : cpu.PC) + uint32_t(op.imm);
+}
+
+void PPCInterpreter::bclr(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint32_t target = cpu.LR & ~3u;
+	const bool taken = BranchCondition(op.rD, op.rA, true, cpu.CTR, cpu.CR.value);
+	if (op.rc) cpu.LR = cpu.PC + 4;
+	if (taken) cpu.NIA = target;
+}
+
+void PPCInterpreter::bcctr(CPU& cpu, const PPCDecodedInstr& op) {
+	const bool taken = BranchCondition(op.rD, op.rA, false, cpu.CTR, cpu.CR.value);
+	if (op.rc) cpu.LR = cpu.PC + 4;
+	if (taken) cpu.NIA = cpu.CTR & ~3u;
+}
+
+void PPCInterpreter::sc(CPU& cpu, const PPCDecodedInstr&) {
+	cpu.RaiseException(PPU_EX_SC);
+}
+
+void PPCInterpreter::rfi(CPU& cpu, const PPCDecodedInstr&) {
+	cpu.SetMSR(cpu.SRR1);
+	cpu.NIA = cpu.SRR0 & ~3u;
+}
+
+// Return from a hypervisor interrupt (CPU::HYPERVISOR_EXCEPTIONS)
+void PPCInterpreter::hrfid(CPU& cpu, const PPCDecodedInstr&) {
+	cpu.SetMSR(cpu.HSRR1);
+	cpu.NIA = uint32_t(cpu.HSRR0) & ~3u;
+}
+
+void PPCInterpreter::isync(CPU& cpu, const PPCDecodedInstr&) {
+	cpu.HandleISync();
+}
+
+void PPCInterpreter::mcrf(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint32_t crfS = op.rA >> 2;
+	cpu.SetCRField(op.rD >> 2, (cpu.CR.value >> ((7 - crfS) * 4)) & 0xF);
+}
+
+void PPCInterpreter::crlogical(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint32_t a = (cpu.CR.value >> (31 - op.rA)) & 1;
+	const uint32_t b = (cpu.CR.value >> (31 - op.rB)) & 1;
+	uint32_t d = 0;
+	switch ((op.instr >> 1) & 0x3FF) {
+	case 33:  d = !(a | b); break;  // crnor
+	case 129: d = a & !b; break;    // crandc
+	case 193: d = a ^ b; break;     // crxor
+	case 225: d = !(a & b); break;  // crnand
+	case 257: d = a & b; break;     // crand
+	case 289: d = !(a ^ b); break;  // creqv
+	case 417: d = a | !b; break;    // crorc
+	case 449: d = a | b; break;     // cror
+	}
+	const uint32_t bit = 1u << (31 - op.rD);
+	cpu.CR.value = d ? (cpu.CR.value | bit) : (cpu.CR.value & ~bit);
+}
+
+void PPCInterpreter::mfcr(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.CR.value;
+}
+
+void PPCInterpreter::mtcrf(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint32_t crm = (op.instr >> 12) & 0xFF;
+	uint32_t mask = 0;
+	for (int i = 0; i < 8; ++i)
+		if (crm & (0x80 >> i)) mask |= 0xF0000000u >> (i * 4);
+	cpu.CR.value = (cpu.CR.value & ~mask) | (uint32_t(cpu.GPR[op.rD]) & mask);
+}
+
+void PPCInterpreter::mcrxr(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.SetCRField(op.rD >> 2, cpu.XER >> 28);
+	cpu.XER &= 0x0FFFFFFF;
+}
+
+void PPCInterpreter::mfmsr(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.MSR;
+}
+
+// mtmsr only replaces the low word; mtmsrd also sets MSR[SF] and with it the addressing mode
+void PPCInterpreter::mtmsr(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.SetMSR((cpu.MSR & 0xFFFFFFFF00000000ull) | uint32_t(cpu.GPR[op.rD]));
+}
+
+void PPCInterpreter::mtmsrd(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.SetMSR(cpu.GPR[op.rD]);
+}
+
+// SPR number is split in two 5-bit halves, swapped
+void PPCInterpreter::mfspr(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.MoveFromSPR(op.rA | (uint32_t(op.rB) << 5));
+}
+
+void PPCInterpreter::mtspr(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.MoveToSPR(op.rA | (uint32_t(op.rB) << 5), cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::mftb(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint32_t tbr = op.rA | (uint32_t(op.rB) << 5);
+	// mftb (TBL) reads the full 64-bit time base, mftbu the upper half
+	cpu.GPR[op.rD] = tbr == SPR_TBU_RO ? cpu.GetTimeBase() >> 32 : cpu.GetTimeBase();
+}
+
+void PPCInterpreter::sync(CPU& cpu, const PPCDecodedInstr&) {
+	cpu.__sync_synchronize();
+}
+
+// Segment and TLB management: the SLB and the shadow TLB live in the MMU (MMU::TranslateAddress)
+
+void PPCInterpreter::slbmte(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->SLBMoveTo(cpu.GPR[op.rD], cpu.GPR[op.rB]);
+}
+
+void PPCInterpreter::slbie(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->SLBInvalidateEntry(cpu.GPR[op.rB]);
+}
+
+void PPCInterpreter::slbia(CPU& cpu, const PPCDecodedInstr&) {
+	cpu.mmu->SLBInvalidateAll();
+}
+
+void PPCInterpreter::slbmfee(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.mmu->SLBMoveFromESID(cpu.GPR[op.rB]);
+}
+
+void PPCInterpreter::slbmfev(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.mmu->SLBMoveFromVSID(cpu.GPR[op.rB]);
+}
+
+// tlbie (and tlbia) reach every hardware thread, tlbiel only this one. Whole flush: the operand
+// names a virtual page, and the shadow TLB is indexed by effective address.
+void PPCInterpreter::tlbie(CPU& cpu, const PPCDecodedInstr&) {
+	cpu.mmu->InvalidateTranslations(true);
+}
+
+void PPCInterpreter::tlbiel(CPU& cpu, const PPCDecodedInstr&) {
+	cpu.mmu->InvalidateTranslations(false);
+}
+
+// Cache management
+
+void PPCInterpreter::dcbst(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->DCACHE_Store(EA_X(op));
+}
+
+void PPCInterpreter::dcbf(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->DCACHE_Flush(EA_X(op));
+}
+
+void PPCInterpreter::dcbi(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->DCACHE_CleanInvalidate(EA_X(op));
+}
+
+void PPCInterpreter::dcbz(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->MemSet(EA_X(op) & ~31ull, 0, 32);
+}
+
+void PPCInterpreter::icbi(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->ICACHE_Invalidate(EA_X(op));
+}
+
+void PPCInterpreter::nop(CPU&, const PPCDecodedInstr&) {
+}
+
+// Loads and stores
+
+void PPCInterpreter::lbz(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.mmu->Read8(EA_D(op));
+}
+
+void PPCInterpreter::lbzu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_DU(op);
+	cpu.GPR[op.rD] = cpu.mmu->Read8(ea);
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::lhz(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.mmu->Read16(EA_D(op));
+}
+
+void PPCInterpreter::lhzu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_DU(op);
+	cpu.GPR[op.rD] = cpu.mmu->Read16(ea);
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::lha(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = uint64_t(int64_t(int16_t(cpu.mmu->Read16(EA_D(op)))));
+}
+
+void PPCInterpreter::lhau(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_DU(op);
+	cpu.GPR[op.rD] = uint64_t(int64_t(int16_t(cpu.mmu->Read16(ea))));
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::lwz(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.mmu->Read32(EA_D(op));
+}
+
+void PPCInterpreter::lwzu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_DU(op);
+	cpu.GPR[op.rD] = cpu.mmu->Read32(ea);
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::stb(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->Write8(EA_D(op), uint8_t(cpu.GPR[op.rD]));
+}
+
+void PPCInterpreter::stbu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_DU(op);
+	cpu.mmu->Write8(ea, uint8_t(cpu.GPR[op.rD]));
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::sth(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->Write16(EA_D(op), uint16_t(cpu.GPR[op.rD]));
+}
+
+void PPCInterpreter::sthu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_DU(op);
+	cpu.mmu->Write16(ea, uint16_t(cpu.GPR[op.rD]));
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::stw(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->Write32(EA_D(op), uint32_t(cpu.GPR[op.rD]));
+}
+
+void PPCInterpreter::stwu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_DU(op);
+	cpu.mmu->Write32(ea, uint32_t(cpu.GPR[op.rD]));
+	cpu.GPR[op.rA] = ea;
+}
+
+// Doubleword loads and stores (DS-form: the decoder already cleared the low two bits of the offset)
+
+void PPCInterpreter::ld(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.mmu->Read64(EA_D(op));
+}
+
+void PPCInterpreter::ldu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_DU(op);
+	cpu.GPR[op.rD] = cpu.mmu->Read64(ea);
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::lwa(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = uint64_t(int64_t(int32_t(cpu.mmu->Read32(EA_D(op)))));
+}
+
+void PPCInterpreter::std(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->Write64(EA_D(op), cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::stdu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_DU(op);
+	cpu.mmu->Write64(ea, cpu.GPR[op.rD]);
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::lmw(CPU& cpu, const PPCDecodedInstr& op) {
+	uint64_t ea = EA_D(op);
+	for (uint32_t r = op.rD; r < 32; ++r, ea += 4)
+		cpu.GPR[r] = cpu.mmu->Read32(ea);
+}
+
+void PPCInterpreter::stmw(CPU& cpu, const PPCDecodedInstr& op) {
+	uint64_t ea = EA_D(op);
+	for (uint32_t r = op.rD; r < 32; ++r, ea += 4)
+		cpu.mmu->Write32(ea, uint32_t(cpu.GPR[r]));
+}
+
+void PPCInterpreter::lbzx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.mmu->Read8(EA_X(op));
+}
+
+void PPCInterpreter::lbzux(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_XU(op);
+	cpu.GPR[op.rD] = cpu.mmu->Read8(ea);
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::lhzx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.mmu->Read16(EA_X(op));
+}
+
+void PPCInterpreter::lhzux(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_XU(op);
+	cpu.GPR[op.rD] = cpu.mmu->Read16(ea);
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::lhax(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = uint64_t(int64_t(int16_t(cpu.mmu->Read16(EA_X(op)))));
+}
+
+void PPCInterpreter::lhaux(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_XU(op);
+	cpu.GPR[op.rD] = uint64_t(int64_t(int16_t(cpu.mmu->Read16(ea))));
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::lwzx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.mmu->Read32(EA_X(op));
+}
+
+void PPCInterpreter::lwzux(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_XU(op);
+	cpu.GPR[op.rD] = cpu.mmu->Read32(ea);
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::stbx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->Write8(EA_X(op), uint8_t(cpu.GPR[op.rD]));
+}
+
+void PPCInterpreter::stbux(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_XU(op);
+	cpu.mmu->Write8(ea, uint8_t(cpu.GPR[op.rD]));
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::sthx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->Write16(EA_X(op), uint16_t(cpu.GPR[op.rD]));
+}
+
+void PPCInterpreter::sthux(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_XU(op);
+	cpu.mmu->Write16(ea, uint16_t(cpu.GPR[op.rD]));
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::stwx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->Write32(EA_X(op), uint32_t(cpu.GPR[op.rD]));
+}
+
+void PPCInterpreter::stwux(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_XU(op);
+	cpu.mmu->Write32(ea, uint32_t(cpu.GPR[op.rD]));
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::ldx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.mmu->Read64(EA_X(op));
+}
+
+void PPCInterpreter::ldux(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_XU(op);
+	cpu.GPR[op.rD] = cpu.mmu->Read64(ea);
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::lwax(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = uint64_t(int64_t(int32_t(cpu.mmu->Read32(EA_X(op)))));
+}
+
+void PPCInterpreter::lwaux(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_XU(op);
+	cpu.GPR[op.rD] = uint64_t(int64_t(int32_t(cpu.mmu->Read32(ea))));
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::stdx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->Write64(EA_X(op), cpu.GPR[op.rD]);
+}
+
+void PPCInterpreter::stdux(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_XU(op);
+	cpu.mmu->Write64(ea, cpu.GPR[op.rD]);
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::lhbrx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = ByteSwap16(cpu.mmu->Read16(EA_X(op)));
+}
+
+void PPCInterpreter::lwbrx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = ByteSwap32(cpu.mmu->Read32(EA_X(op)));
+}
+
+void PPCInterpreter::sthbrx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->Write16(EA_X(op), ByteSwap16(uint16_t(cpu.GPR[op.rD])));
+}
+
+void PPCInterpreter::stwbrx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->Write32(EA_X(op), ByteSwap32(uint32_t(cpu.GPR[op.rD])));
+}
+
+void PPCInterpreter::ldbrx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = ByteSwap64(cpu.mmu->Read64(EA_X(op)));
+}
+
+void PPCInterpreter::stdbrx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->Write64(EA_X(op), ByteSwap64(cpu.GPR[op.rD]));
+}
+
+void PPCInterpreter::lwarx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = uint32_t(cpu.LoadReserved(EA_X(op), 4));
+}
+
+void PPCInterpreter::stwcx(CPU& cpu, const PPCDecodedInstr& op) {
+	const bool ok = cpu.StoreConditional(EA_X(op), 4, uint32_t(cpu.GPR[op.rD]));
+	cpu.SetCRField(0, (ok ? 0x2 : 0) | cpu.GetXERSO());
+}
+
+void PPCInterpreter::ldarx(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.GPR[op.rD] = cpu.LoadReserved(EA_X(op), 8);
+}
+
+void PPCInterpreter::stdcx(CPU& cpu, const PPCDecodedInstr& op) {
+	const bool ok = cpu.StoreConditional(EA_X(op), 8, cpu.GPR[op.rD]);
+	cpu.SetCRField(0, (ok ? 0x2 : 0) | cpu.GetXERSO());
+}
+
+// Floating-point loads and stores
+
+static inline double SingleBitsToDouble(uint32_t w) {
+	float f; std::memcpy(&f, &w, 4);
+	return f;
+}
+
+static inline uint32_t DoubleToSingleBits(double d) {
+	float f = float(d);
+	uint32_t w; std::memcpy(&w, &f, 4);
+	return w;
+}
+
+static inline double DoubleFromBits(uint64_t w) {
+	double d; std::memcpy(&d, &w, 8);
+	return d;
+}
+
+static inline uint64_t DoubleToBits(double d) {
+	uint64_t w; std::memcpy(&w, &d, 8);
+	return w;
+}
+
+void PPCInterpreter::lfs(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.FPR[op.rD] = SingleBitsToDouble(cpu.mmu->Read32(EA_D(op)));
+}
+
+void PPCInterpreter::lfsu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_DU(op);
+	cpu.FPR[op.rD] = SingleBitsToDouble(cpu.mmu->Read32(ea));
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::lfd(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.FPR[op.rD] = DoubleFromBits(cpu.mmu->Read64(EA_D(op)));
+}
+
+void PPCInterpreter::lfdu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_DU(op);
+	cpu.FPR[op.rD] = DoubleFromBits(cpu.mmu->Read64(ea));
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::stfs(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->Write32(EA_D(op), DoubleToSingleBits(cpu.FPR[op.rD]));
+}
+
+void PPCInterpreter::stfsu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_DU(op);
+	cpu.mmu->Write32(ea, DoubleToSingleBits(cpu.FPR[op.rD]));
+	cpu.GPR[op.rA] = ea;
+}
+
+void PPCInterpreter::stfd(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.mmu->Write64(EA_D(op), DoubleToBits(cpu.FPR[op.rD]));
+}
+
+void PPCInterpreter::stfdu(CPU& cpu, const PPCDecodedInstr& op) {
+	const uint64_t ea = EA_DU(op);
+	cpu.mmu->Write64(ea, DoubleToBits(cpu.FPR[op.rD]));
+	cpu.GPR[op.rA] = ea;
+}
+
+// VMX / VMX128
+
+// op.imm is the VMXOp and op.mb the third operand (vC, or vD for the VMX128 forms that read it).
+// The kernel comes from the table selected for the host (VMXKernels.h).
+void PPCInterpreter::vmx(CPU& cpu, const PPCDecodedInstr& op) {
+	const VMXKernel kernel = VMXKernels().kernels[op.imm];
+	if (kernel(cpu.VPR[op.rD], cpu.VPR[op.rA], cpu.VPR[op.rB], cpu.VPR[op.mb], op.sh))
+		cpu.VSCR |= CPU::VSCR_SAT;
+}
+
+// Compares with Rc: CR6 = all elements true (0b1000) / all false (0b0010)
+void PPCInterpreter::vmx_cmp(CPU& cpu, const PPCDecodedInstr& op) {
+	VectorRegister& d = cpu.VPR[op.rD];
+	VMXKernels().kernels[op.imm](d, cpu.VPR[op.rA], cpu.VPR[op.rB], cpu.VPR[op.mb], op.sh);
+	if (!op.rc) return;
+	const bool all = (d.u64[0] & d.u64[1]) == ~0ull;
+	const bool none = (d.u64[0] | d.u64[1]) == 0;
+	cpu.SetCRField(6, (all ? 8u : 0u) | (none ? 2u : 0u));
+}
+
+void PPCInterpreter::mfvscr(CPU& cpu, const PPCDecodedInstr& op) {
+	VectorRegister v{};
+	v.SetWord(3, cpu.VSCR);
+	cpu.VPR[op.rD] = v;
+}
+
+void PPCInterpreter::mtvscr(CPU& cpu, const PPCDecodedInstr& op) {
+	cpu.VSCR = cpu.VPR[op.rB].Word(3) & (CPU::VSCR_NJ | CPU::VSCR_SAT);
+}
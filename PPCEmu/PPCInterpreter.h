@@ -0,0 +1,199 @@
+// PPCInterpreter.h
+#pragma once
+#include "PPCDecoder.h"
+
+#define PPC_HANDLER(name) static void name(CPU& cpu, const PPCDecodedInstr& op)
+
+// Table-driven instruction handlers. Friend of CPU so it can reach the register file directly.
+// Instructions not ported yet (FPU arithmetic, VMX128 loads/stores) go through Legacy.
+struct PPCInterpreter {
+    // Fallback to CPU::DecodeExecute
+    PPC_HANDLER(Legacy);
+
+    // Integer arithmetic
+    PPC_HANDLER(addi);
+    PPC_HANDLER(addis);
+    PPC_HANDLER(addic);
+    PPC_HANDLER(addicx);
+    PPC_HANDLER(subfic);
+    PPC_HANDLER(mulli);
+    PPC_HANDLER(add);
+    PPC_HANDLER(addc);
+    PPC_HANDLER(adde);
+    PPC_HANDLER(addme);
+    PPC_HANDLER(addze);
+    PPC_HANDLER(subf);
+    PPC_HANDLER(subfc);
+    PPC_HANDLER(subfe);
+    PPC_HANDLER(subfme);
+    PPC_HANDLER(subfze);
+    PPC_HANDLER(neg);
+    PPC_HANDLER(mullw);
+    PPC_HANDLER(mulhw);
+    PPC_HANDLER(mulhwu);
+    PPC_HANDLER(divw);
+    PPC_HANDLER(divwu);
+    PPC_HANDLER(mulld);
+    PPC_HANDLER(mulhd);
+    PPC_HANDLER(mulhdu);
+    PPC_HANDLER(divd);
+    PPC_HANDLER(divdu);
+
+    // Compare and trap
+    PPC_HANDLER(cmpi);
+    PPC_HANDLER(cmpli);
+    PPC_HANDLER(cmp);
+    PPC_HANDLER(cmpl);
+    PPC_HANDLER(twi);
+    PPC_HANDLER(tw);
+    PPC_HANDLER(tdi);
+    PPC_HANDLER(td);
+
+    // Logical, rotate and shift
+    PPC_HANDLER(ori);
+    PPC_HANDLER(oris);
+    PPC_HANDLER(xori);
+    PPC_HANDLER(xoris);
+    PPC_HANDLER(andi);
+    PPC_HANDLER(andis);
+    PPC_HANDLER(and_);
+    PPC_HANDLER(andc);
+    PPC_HANDLER(or_);
+    PPC_HANDLER(orc);
+    PPC_HANDLER(xor_);
+    PPC_HANDLER(nand);
+    PPC_HANDLER(nor);
+    PPC_HANDLER(eqv);
+    PPC_HANDLER(extsb);
+    PPC_HANDLER(extsh);
+    PPC_HANDLER(extsw);
+    PPC_HANDLER(cntlzw);
+    PPC_HANDLER(cntlzd);
+    PPC_HANDLER(rlwimi);
+    PPC_HANDLER(rlwinm);
+    PPC_HANDLER(rlwnm);
+    PPC_HANDLER(rldicl);
+    PPC_HANDLER(rldicr);
+    PPC_HANDLER(rldic);
+    PPC_HANDLER(rldimi);
+    PPC_HANDLER(rldcl);
+    PPC_HANDLER(rldcr);
+    PPC_HANDLER(slw);
+    PPC_HANDLER(srw);
+    PPC_HANDLER(sraw);
+    PPC_HANDLER(srawi);
+    PPC_HANDLER(sld);
+    PPC_HANDLER(srd);
+    PPC_HANDLER(srad);
+    PPC_HANDLER(sradi);
+
+    // Branch and system
+    PPC_HANDLER(b);
+    PPC_HANDLER(bc);
+    PPC_HANDLER(bclr);
+    PPC_HANDLER(bcctr);
+    PPC_HANDLER(sc);
+    PPC_HANDLER(rfi);
+    PPC_HANDLER(hrfid);
+    PPC_HANDLER(isync);
+    PPC_HANDLER(mcrf);
+    PPC_HANDLER(crlogical);
+    PPC_HANDLER(mfcr);
+    PPC_HANDLER(mtcrf);
+    PPC_HANDLER(mcrxr);
+    PPC_HANDLER(mfmsr);
+    PPC_HANDLER(mtmsr);
+    PPC_HANDLER(mtmsrd);
+    PPC_HANDLER(mfspr);
+    PPC_HANDLER(mtspr);
+    PPC_HANDLER(mftb);
+    PPC_HANDLER(sync);
+
+    // Segment and TLB management
+    PPC_HANDLER(slbmte);
+    PPC_HANDLER(slbie);
+    PPC_HANDLER(slbia);
+    PPC_HANDLER(slbmfee);
+    PPC_HANDLER(slbmfev);
+    PPC_HANDLER(tlbie);
+    PPC_HANDLER(tlbiel);
+
+    // Cache management
+    PPC_HANDLER(dcbst);
+    PPC_HANDLER(dcbf);
+    PPC_HANDLER(dcbi);
+    PPC_HANDLER(dcbz);
+    PPC_HANDLER(icbi);
+    PPC_HANDLER(nop);
+
+    // Loads and stores
+    PPC_HANDLER(lbz);
+    PPC_HANDLER(lbzu);
+    PPC_HANDLER(lhz);
+    PPC_HANDLER(lhzu);
+    PPC_HANDLER(lha);
+    PPC_HANDLER(lhau);
+    PPC_HANDLER(lwz);
+    PPC_HANDLER(lwzu);
+    PPC_HANDLER(stb);
+    PPC_HANDLER(stbu);
+    PPC_HANDLER(sth);
+    PPC_HANDLER(sthu);
+    PPC_HANDLER(stw);
+    PPC_HANDLER(stwu);
+    PPC_HANDLER(ld);
+    PPC_HANDLER(ldu);
+    PPC_HANDLER(lwa);
+    PPC_HANDLER(std);
+    PPC_HANDLER(stdu);
+    PPC_HANDLER(lmw);
+    PPC_HANDLER(stmw);
+    PPC_HANDLER(lbzx);
+    PPC_HANDLER(lbzux);
+    PPC_HANDLER(lhzx);
+    PPC_HANDLER(lhzux);
+    PPC_HANDLER(lhax);
+    PPC_HANDLER(lhaux);
+    PPC_HANDLER(lwzx);
+    PPC_HANDLER(lwzux);
+    PPC_HANDLER(stbx);
+    PPC_HANDLER(stbux);
+    PPC_HANDLER(sthx);
+    PPC_HANDLER(sthux);
+    PPC_HANDLER(stwx);
+    PPC_HANDLER(stwux);
+    PPC_HANDLER(ldx);
+    PPC_HANDLER(ldux);
+    PPC_HANDLER(lwax);
+    PPC_HANDLER(lwaux);
+    PPC_HANDLER(stdx);
+    PPC_HANDLER(stdux);
+    PPC_HANDLER(lhbrx);
+    PPC_HANDLER(lwbrx);
+    PPC_HANDLER(sthbrx);
+    PPC_HANDLER(stwbrx);
+    PPC_HANDLER(ldbrx);
+    PPC_HANDLER(stdbrx);
+    PPC_HANDLER(lwarx);
+    PPC_HANDLER(stwcx);
+    PPC_HANDLER(ldarx);
+    PPC_HANDLER(stdcx);
+
+    // Floating-point loads and stores
+    PPC_HANDLER(lfs);
+    PPC_HANDLER(lfsu);
+    PPC_HANDLER(lfd);
+    PPC_HANDLER(lfdu);
+    PPC_HANDLER(stfs);
+    PPC_HANDLER(stfsu);
+    PPC_HANDLER(stfd);
+    PPC_HANDLER(stfdu);
+
+    // VMX / VMX128: one handler for every VMXKernels op, the decoder picks the kernel
+    PPC_HANDLER(vmx);
+    PPC_HANDLER(vmx_cmp);
+    PPC_HANDLER(mfvscr);
+    PPC_HANDLER(mtvscr);
+};
+
+#undef PPC_HANDLER
@@ -0,0 +1,615 @@
+// PPCJit.cpp
+#include "PPCJit.h"
+#include "CPU.h"
+#include "PPCInterpreter.h"
+#include <cstring>
+#include <initializer_list>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+PPCJit::PPCJit(CPU& cpu) : cpu_(cpu) {
+	const auto offset = [&cpu](const void* p) {
+		return int32_t(reinterpret_cast<const uint8_t*>(p) - reinterpret_cast<const uint8_t*>(&cpu)) - STATE_BIAS;
+	};
+	off_.pc = offset(&cpu.PC);
+	off_.nia = offset(&cpu.NIA);
+	off_.lr = offset(&cpu.LR);
+	off_.ctr = offset(&cpu.CTR);
+	off_.xer = offset(&cpu.XER);
+	off_.cr = offset(&cpu.CR.value);
+	off_.gpr = offset(cpu.GPR.data());
+	off_.fault = offset(&fault_);
+
+#ifdef PPC_JIT_X64
+#if defined(_WIN32)
+	code_ = static_cast<uint8_t*>(VirtualAlloc(nullptr, CODE_CACHE_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE));
+#else
+	void* mem = mmap(nullptr, CODE_CACHE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	code_ = mem == MAP_FAILED ? nullptr : static_cast<uint8_t*>(mem);
+#endif
+	if (!code_) LOG_WARNING("JIT", "Could not allocate %zu bytes of executable memory, JIT disabled", CODE_CACHE_SIZE);
+#endif
+}
+
+PPCJit::~PPCJit() {
+	if (!code_) return;
+#if defined(_WIN32)
+	VirtualFree(code_, 0, MEM_RELEASE);
+#else
+	munmap(code_, CODE_CACHE_SIZE);
+#endif
+}
+
+void PPCJit::RethrowPendingException() {
+	std::exception_ptr e = pending_;
+	pending_ = nullptr;
+	fault_ = 0;
+	std::rethrow_exception(e);
+}
+
+void PPCJit::Fault() {
+	fault_ = 1;
+	pending_ = std::current_exception();
+}
+
+// Helpers llamados desde el código generado: las excepciones no pueden atravesar frames JIT
+uint32_t PPCJit::Read8(CPU* cpu, uint64_t ea) {
+	try { return cpu->mmu->Read8(ea); }
+	catch (...) { cpu->jit.Fault(); return 0; }
+}
+
+uint32_t PPCJit::Read16(CPU* cpu, uint64_t ea) {
+	try { return cpu->mmu->Read16(ea); }
+	catch (...) { cpu->jit.Fault(); return 0; }
+}
+
+uint32_t PPCJit::Read32(CPU* cpu, uint64_t ea) {
+	try { return cpu->mmu->Read32(ea); }
+	catch (...) { cpu->jit.Fault(); return 0; }
+}
+
+void PPCJit::Write8(CPU* cpu, uint64_t ea, uint32_t value) {
+	try { cpu->mmu->Write8(ea, uint8_t(value)); }
+	catch (...) { cpu->jit.Fault(); }
+}
+
+void PPCJit::Write16(CPU* cpu, uint64_t ea, uint32_t value) {
+	try { cpu->mmu->Write16(ea, uint16_t(value)); }
+	catch (...) { cpu->jit.Fault(); }
+}
+
+void PPCJit::Write32(CPU* cpu, uint64_t ea, uint32_t value) {
+	try { cpu->mmu->Write32(ea, value); }
+	catch (...) { cpu->jit.Fault(); }
+}
+
+uint32_t PPCJit::CallHandler(CPU* cpu, const PPCDecodedInstr* op) {
+	try { op->handler(*cpu, *op); }
+	catch (...) { cpu->jit.Fault(); return 1; }
+	return cpu->InstructionAborted() ? 1 : 0;
+}
+
+#ifdef PPC_JIT_X64
+
+namespace {
+
+enum X64Reg : uint8_t { RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7, R8 = 8 };
+enum X64Cond : uint8_t { CC_B = 0x2, CC_E = 0x4, CC_NE = 0x5, CC_A = 0x7, CC_L = 0xC, CC_G = 0xF };
+enum X64Alu : uint8_t { ALU_ADD = 0, ALU_OR = 1, ALU_AND = 4, ALU_SUB = 5, ALU_XOR = 6, ALU_CMP = 7 };
+enum X64Shift : uint8_t { SH_ROL = 0, SH_SHL = 4, SH_SHR = 5 };
+
+#if defined(_WIN32)
+constexpr X64Reg ARG1 = RCX, ARG2 = RDX, ARG3 = R8;
+constexpr uint8_t SHADOW_SPACE = 32;
+#else
+constexpr X64Reg ARG1 = RDI, ARG2 = RSI, ARG3 = RDX;
+constexpr uint8_t SHADOW_SPACE = 0;
+#endif
+
+// Minimal x86-64 encoder. Guest state is always addressed as [rbx + disp8/disp32].
+class X64Emitter {
+public:
+	std::vector<uint8_t> buf;
+
+	size_t Size() const { return buf.size(); }
+	void Byte(uint8_t b) { buf.push_back(b); }
+	void Dword(uint32_t v) { for (int i = 0; i < 4; ++i) Byte(uint8_t(v >> (i * 8))); }
+	void Qword(uint64_t v) { for (int i = 0; i < 8; ++i) Byte(uint8_t(v >> (i * 8))); }
+
+	void Rex(bool w, uint8_t reg, uint8_t rm) {
+		const uint8_t rex = 0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+		if (rex != 0x40) Byte(rex);
+	}
+	// opcode reg, [rbx + disp]; disp8 when it fits (hot CPU state), disp32 otherwise
+	void OpRegMem(std::initializer_list<uint8_t> opcode, uint8_t reg, int32_t disp, bool w = false) {
+		Rex(w, reg, RBX);
+		for (uint8_t b : opcode) Byte(b);
+		if (disp >= -128 && disp <= 127) {
+			Byte(0x40 | ((reg & 7) << 3) | RBX);
+			Byte(uint8_t(disp));
+			return;
+		}
+		Byte(0x80 | ((reg & 7) << 3) | RBX);
+		Dword(uint32_t(disp));
+	}
+	// opcode reg, rm (register direct)
+	void OpRegReg(std::initializer_list<uint8_t> opcode, uint8_t reg, uint8_t rm, bool w = false) {
+		Rex(w, reg, rm);
+		for (uint8_t b : opcode) Byte(b);
+		Byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+	}
+
+	void Load32(uint8_t reg, int32_t disp) { OpRegMem({ 0x8B }, reg, disp); }
+	void Load64(uint8_t reg, int32_t disp) { OpRegMem({ 0x8B }, reg, disp, true); }
+	void Store32(int32_t disp, uint8_t reg) { OpRegMem({ 0x89 }, reg, disp); }
+	void Store64(int32_t disp, uint8_t reg) { OpRegMem({ 0x89 }, reg, disp, true); }
+	void StoreImm32(int32_t disp, uint32_t imm) { OpRegMem({ 0xC7 }, 0, disp); Dword(imm); }
+	// imm is sign-extended to 64 bits
+	void StoreImm64(int32_t disp, uint32_t imm) { OpRegMem({ 0xC7 }, 0, disp, true); Dword(imm); }
+	void MovImm32(uint8_t reg, uint32_t imm) { Rex(false, 0, reg); Byte(0xB8 + (reg & 7)); Dword(imm); }
+	void MovImm64(uint8_t reg, uint64_t imm) { Rex(true, 0, reg); Byte(0xB8 + (reg & 7)); Qword(imm); }
+	void MovRR32(uint8_t dst, uint8_t src) { OpRegReg({ 0x89 }, src, dst); }
+	void MovRR64(uint8_t dst, uint8_t src) { OpRegReg({ 0x89 }, src, dst, true); }
+	// lea dst, [base + disp] (base != rsp/r12)
+	void Lea64(uint8_t dst, uint8_t base, int32_t disp) {
+		Rex(true, dst, base);
+		Byte(0x8D);
+		if (disp >= -128 && disp <= 127) {
+			Byte(0x40 | ((dst & 7) << 3) | (base & 7));
+			Byte(uint8_t(disp));
+			return;
+		}
+		Byte(0x80 | ((dst & 7) << 3) | (base & 7));
+		Dword(uint32_t(disp));
+	}
+
+	// w: 64-bit operand size (REX.W); immediates are then sign-extended from 32 bits
+	void AluRR(X64Alu op, uint8_t dst, uint8_t src, bool w = false) { OpRegReg({ uint8_t(op * 8 + 1) }, src, dst, w); }
+	void AluRM(X64Alu op, uint8_t reg, int32_t disp, bool w = false) { OpRegMem({ uint8_t(op * 8 + 3) }, reg, disp, w); }
+	void AluRI(X64Alu op, uint8_t reg, uint32_t imm, bool w = false) { OpRegReg({ 0x81 }, op, reg, w); Dword(imm); }
+	void Not(uint8_t reg, bool w = false) { OpRegReg({ 0xF7 }, 2, reg, w); }
+	void Neg(uint8_t reg, bool w = false) { OpRegReg({ 0xF7 }, 3, reg, w); }
+	void ImulRR(uint8_t reg, uint8_t src, bool w = false) { OpRegReg({ 0x0F, 0xAF }, reg, src, w); }
+	void ImulRRI(uint8_t reg, uint8_t src, uint32_t imm, bool w = false) { OpRegReg({ 0x69 }, reg, src, w); Dword(imm); }
+	void ShiftI(X64Shift op, uint8_t reg, uint8_t imm) { OpRegReg({ 0xC1 }, op, reg); Byte(imm); }
+	void MovsxByteM(uint8_t reg, int32_t disp, bool w = false) { OpRegMem({ 0x0F, 0xBE }, reg, disp, w); }
+	void MovsxWordM(uint8_t reg, int32_t disp, bool w = false) { OpRegMem({ 0x0F, 0xBF }, reg, disp, w); }
+	void MovsxWordR(uint8_t reg, uint8_t src, bool w = false) { OpRegReg({ 0x0F, 0xBF }, reg, src, w); }
+	void MovsxdM(uint8_t reg, int32_t disp) { OpRegMem({ 0x63 }, reg, disp, true); }
+	void Cmov(X64Cond cc, uint8_t dst, uint8_t src) { OpRegReg({ 0x0F, uint8_t(0x40 + cc) }, dst, src); }
+	void TestRR(uint8_t a, uint8_t b, bool w = false) { OpRegReg({ 0x85 }, b, a, w); }
+	void TestMI(int32_t disp, uint32_t imm) { OpRegMem({ 0xF7 }, 0, disp); Dword(imm); }
+	void DecM(int32_t disp) { OpRegMem({ 0xFF }, 1, disp); }
+	void CmpByteMI(int32_t disp, uint8_t imm) { OpRegMem({ 0x80 }, 7, disp); Byte(imm); }
+	void CmpByteAtRax(uint8_t imm) { Byte(0x80); Byte(0x38); Byte(imm); }
+
+	// Forward jumps: returns the position of the rel32 to patch
+	size_t Jcc(X64Cond cc) { Byte(0x0F); Byte(0x80 + cc); const size_t pos = Size(); Dword(0); return pos; }
+	size_t Jmp() { Byte(0xE9); const size_t pos = Size(); Dword(0); return pos; }
+	void PatchHere(size_t pos) {
+		const uint32_t rel = uint32_t(Size() - (pos + 4));
+		std::memcpy(&buf[pos], &rel, 4);
+	}
+
+	void CallRax() { Byte(0xFF); Byte(0xD0); }
+	void PushRbx() { Byte(0x53); }
+	void PopRbx() { Byte(0x5B); }
+	void Ret() { Byte(0xC3); }
+	void SubRsp(uint8_t imm) { Byte(0x48); Byte(0x83); Byte(0xEC); Byte(imm); }
+	void AddRsp(uint8_t imm) { Byte(0x48); Byte(0x83); Byte(0xC4); Byte(imm); }
+};
+
+} // namespace
+
+// Translates one PPCBlock. Every exit stores the next guest PC and returns the retired count.
+class X64BlockCompiler {
+public:
+	// El código se especializa en el modo de direccionamiento actual (MSR[SF]); CPU::PrepareJit
+	// no lo ejecuta si el modo ha cambiado desde entonces
+	X64BlockCompiler(PPCJit& jit, const PPCBlock& block)
+		: jit_(jit), off_(jit.off_), block_(block), mode64_(jit.cpu_.Is64BitMode()) {}
+
+	const std::vector<uint8_t>& Compile() {
+		Prologue();
+		const uint32_t n = uint32_t(block_.ops.size());
+		bool terminated = false;
+		for (uint32_t i = 0; i < n; ++i) {
+			const PPCDecodedInstr& op = block_.ops[i];
+			const uint32_t pc = block_.start_pc + i * 4;
+			if (i == n - 1 && PPCBlockCache::IsBlockTerminator(op.instr)) {
+				if (!EmitBranch(op, pc, n)) {
+					EmitCallOut(op, pc, i, true);
+				}
+				terminated = true;
+				break;
+			}
+			if (!EmitNative(op, pc, i)) EmitCallOut(op, pc, i, false);
+		}
+		if (!terminated) ExitTo(block_.start_pc + n * 4, n);
+		EmitPendingExits();
+		return e_.buf;
+	}
+
+private:
+	struct PendingExit {
+		size_t patch;
+		uint32_t pc;      // PC de salida (ignorado si dynamic)
+		uint32_t count;   // instrucciones retiradas
+		bool dynamic;     // PC en eax
+	};
+
+	int32_t GPR(uint32_t r) const { return off_.gpr + int32_t(r) * 8; }
+
+	void Prologue() {
+		e_.PushRbx();
+		if (SHADOW_SPACE) e_.SubRsp(SHADOW_SPACE);
+		e_.Lea64(RBX, ARG1, PPCJit::STATE_BIAS);
+	}
+
+	void Epilogue() {
+		if (SHADOW_SPACE) e_.AddRsp(SHADOW_SPACE);
+		e_.PopRbx();
+		e_.Ret();
+	}
+
+	void ExitTo(uint32_t pc, uint32_t count) {
+		e_.StoreImm32(off_.pc, pc);
+		e_.MovImm32(RAX, count);
+		Epilogue();
+	}
+
+	void ExitToEax(uint32_t count) {
+		e_.Store32(off_.pc, RAX);
+		e_.MovImm32(RAX, count);
+		Epilogue();
+	}
+
+	void EmitPendingExits() {
+		for (const PendingExit& exit : exits_) {
+			e_.PatchHere(exit.patch);
+			if (exit.dynamic) ExitToEax(exit.count);
+			else ExitTo(exit.pc, exit.count);
+		}
+	}
+
+	// A helper faulted: leave PC on the faulting instruction, like the interpreter
+	void CheckFault(uint32_t pc, uint32_t index) {
+		e_.CmpByteMI(off_.fault, 0);
+		exits_.push_back({ e_.Jcc(CC_NE), pc, index, false });
+	}
+
+	// A store or call-out may have invalidated this very block (self-modifying code)
+	void CheckBlockValid(uint32_t nextPc, uint32_t count) {
+		e_.MovImm64(RAX, reinterpret_cast<uint64_t>(&block_.valid));
+		e_.CmpByteAtRax(0);
+		exits_.push_back({ e_.Jcc(CC_E), nextPc, count, false });
+	}
+
+	// CR[crf] = LT/GT/EQ from the last cmp + XER[SO]
+	void SetCRFromFlags(uint32_t crf, bool isSigned) {
+		e_.MovImm32(RCX, 0x2);
+		e_.MovImm32(RDX, 0x8);
+		e_.Cmov(isSigned ? CC_L : CC_B, RCX, RDX);
+		e_.MovImm32(RDX, 0x4);
+		e_.Cmov(isSigned ? CC_G : CC_A, RCX, RDX);
+		e_.Load32(RDX, off_.xer);
+		e_.ShiftI(SH_SHR, RDX, 31);
+		e_.AluRR(ALU_OR, RCX, RDX);
+		const uint8_t shift = uint8_t((7 - crf) * 4);
+		if (shift) e_.ShiftI(SH_SHL, RCX, shift);
+		e_.Load32(RDX, off_.cr);
+		e_.AluRI(ALU_AND, RDX, ~(0xFu << shift));
+		e_.AluRR(ALU_OR, RDX, RCX);
+		e_.Store32(off_.cr, RDX);
+	}
+
+	// Rc=1: CR0 from the result in rax (eax in 32-bit mode)
+	void UpdateCR0() {
+		e_.TestRR(RAX, RAX, mode64_);
+		SetCRFromFlags(0, true);
+	}
+
+	void StoreResult(uint32_t reg, bool rc) {
+		e_.Store64(GPR(reg), RAX);
+		if (rc) UpdateCR0();
+	}
+
+	// rax = (rA|0) + d  or  (rA|0) + rB, truncated to 32 bits outside 64-bit mode
+	void EmitEA(const PPCDecodedInstr& op, bool indexed) {
+		if (op.rA) e_.Load64(RAX, GPR(op.rA));
+		else e_.MovImm32(RAX, 0);
+		if (indexed) e_.AluRM(ALU_ADD, RAX, GPR(op.rB), true);
+		else if (op.imm) e_.AluRI(ALU_ADD, RAX, uint32_t(op.imm), true);
+		if (!mode64_) e_.MovRR32(RAX, RAX);
+	}
+
+	void EmitCall(const void* fn) {
+		e_.Lea64(ARG1, RBX, -PPCJit::STATE_BIAS);
+		e_.MovImm64(RAX, reinterpret_cast<uint64_t>(fn));
+		e_.CallRax();
+	}
+
+	// rA += d / rB after an update-form access
+	void EmitUpdate(const PPCDecodedInstr& op, bool indexed) {
+		e_.Load64(RCX, GPR(op.rA));
+		if (indexed) e_.AluRM(ALU_ADD, RCX, GPR(op.rB), true);
+		else e_.AluRI(ALU_ADD, RCX, uint32_t(op.imm), true);
+		if (!mode64_) e_.MovRR32(RCX, RCX);
+		e_.Store64(GPR(op.rA), RCX);
+	}
+
+	// The helpers return the value in eax: zero- or sign-extend it to the full register
+	void EmitLoad(const PPCDecodedInstr& op, uint32_t pc, uint32_t index, const void* helper,
+		bool indexed, bool update, bool signExtend16) {
+		EmitEA(op, indexed);
+		e_.MovRR64(ARG2, RAX);
+		EmitCall(helper);
+		CheckFault(pc, index);
+		if (signExtend16) e_.MovsxWordR(RAX, RAX, true);
+		else e_.MovRR32(RAX, RAX);
+		e_.Store64(GPR(op.rD), RAX);
+		if (update) EmitUpdate(op, indexed);
+	}
+
+	// Stores only need the low word of rS
+	void EmitStore(const PPCDecodedInstr& op, uint32_t pc, uint32_t index, const void* helper,
+		bool indexed, bool update) {
+		EmitEA(op, indexed);
+		e_.MovRR64(ARG2, RAX);
+		e_.Load32(ARG3, GPR(op.rD));
+		EmitCall(helper);
+		CheckFault(pc, index);
+		if (update) EmitUpdate(op, indexed);
+		CheckBlockValid(pc + 4, index + 1);
+	}
+
+	// Anything without a native template: call the interpreter handler with PC/NIA set up
+	void EmitCallOut(const PPCDecodedInstr& op, uint32_t pc, uint32_t index, bool terminator) {
+		e_.StoreImm32(off_.pc, pc);
+		e_.StoreImm32(off_.nia, pc + 4);
+		e_.MovImm64(ARG2, reinterpret_cast<uint64_t>(&op));
+		EmitCall(reinterpret_cast<const void*>(&PPCJit::CallHandler));
+		// Fallo o excepción que anula la instrucción: PC se queda en ella, sin retirarla
+		e_.TestRR(RAX, RAX);
+		exits_.push_back({ e_.Jcc(CC_NE), pc, index, false });
+		e_.Load32(RAX, off_.nia);
+		// mtmsr/mtmsrd may switch MSR[SF]: the rest of the block was compiled for the old mode
+		if (terminator || op.handler == &PPCInterpreter::mtmsr || op.handler == &PPCInterpreter::mtmsrd) {
+			ExitToEax(index + 1);
+			return;
+		}
+		e_.AluRI(ALU_CMP, RAX, pc + 4);
+		exits_.push_back({ e_.Jcc(CC_NE), 0, index + 1, true });
+		CheckBlockValid(pc + 4, index + 1);
+	}
+
+	// b, bc, bclr, bcctr. sc/rfi go through the call-out path.
+	bool EmitBranch(const PPCDecodedInstr& op, uint32_t pc, uint32_t count) {
+		using I = PPCInterpreter;
+		const PPCInstrHandler h = op.handler;
+		if (h == &I::b) {
+			if (op.rc) e_.StoreImm32(off_.lr, pc + 4);
+			ExitTo((op.aa ? 0 : pc) + uint32_t(op.imm), count);
+			return true;
+		}
+		if (h != &I::bc && h != &I::bclr && h != &I::bcctr) return false;
+
+		const uint32_t bo = op.rD, bi = op.rA;
+		// Target first: bclr must see LR before LK overwrites it
+		if (h == &I::bclr) {
+			e_.Load32(RAX, off_.lr);
+			e_.AluRI(ALU_AND, RAX, ~3u);
+		}
+		else if (h == &I::bcctr) {
+			e_.Load32(RAX, off_.ctr);
+			e_.AluRI(ALU_AND, RAX, ~3u);
+		}
+		if (op.rc) e_.StoreImm32(off_.lr, pc + 4);
+
+		std::vector<size_t> notTaken;
+		if (h != &I::bcctr && !(bo & 0x04)) {
+			e_.DecM(off_.ctr);
+			notTaken.push_back(e_.Jcc((bo & 0x02) ? CC_NE : CC_E));
+		}
+		if (!(bo & 0x10)) {
+			e_.TestMI(off_.cr, 1u << (31 - bi));
+			notTaken.push_back(e_.Jcc((bo & 0x08) ? CC_E : CC_NE));
+		}
+		if (h == &I::bc) ExitTo((op.aa ? 0 : pc) + uint32_t(op.imm), count);
+		else ExitToEax(count);
+		for (size_t pos : notTaken) e_.PatchHere(pos);
+		ExitTo(pc + 4, count);
+		return true;
+	}
+
+	bool EmitNative(const PPCDecodedInstr& op, uint32_t pc, uint32_t index) {
+		using I = PPCInterpreter;
+		const PPCInstrHandler h = op.handler;
+		const uint32_t uimm = uint16_t(op.imm);
+
+		// Integer arithmetic (full 64-bit registers; immediates sign-extend like in the ISA)
+		if (h == &I::addi || h == &I::addis) {
+			const uint32_t imm = h == &I::addis ? uint32_t(op.imm) << 16 : uint32_t(op.imm);
+			if (op.rA) {
+				e_.Load64(RAX, GPR(op.rA));
+				e_.AluRI(ALU_ADD, RAX, imm, true);
+				e_.Store64(GPR(op.rD), RAX);
+			}
+			else {
+				e_.StoreImm64(GPR(op.rD), imm);
+			}
+			return true;
+		}
+		if (h == &I::add) {
+			e_.Load64(RAX, GPR(op.rA));
+			e_.AluRM(ALU_ADD, RAX, GPR(op.rB), true);
+			StoreResult(op.rD, op.rc);
+			return true;
+		}
+		if (h == &I::subf) {
+			e_.Load64(RAX, GPR(op.rB));
+			e_.AluRM(ALU_SUB, RAX, GPR(op.rA), true);
+			StoreResult(op.rD, op.rc);
+			return true;
+		}
+		if (h == &I::neg) {
+			e_.Load64(RAX, GPR(op.rA));
+			e_.Neg(RAX, true);
+			StoreResult(op.rD, op.rc);
+			return true;
+		}
+		if (h == &I::mulli) {
+			e_.Load64(RAX, GPR(op.rA));
+			e_.ImulRRI(RAX, RAX, uint32_t(op.imm), true);
+			e_.Store64(GPR(op.rD), RAX);
+			return true;
+		}
+		if (h == &I::mullw) {
+			// Full 64-bit product of the sign-extended low words
+			e_.MovsxdM(RAX, GPR(op.rA));
+			e_.MovsxdM(RCX, GPR(op.rB));
+			e_.ImulRR(RAX, RCX, true);
+			StoreResult(op.rD, op.rc);
+			return true;
+		}
+
+		// Logical (rS in rD, result in rA)
+		if (h == &I::and_ || h == &I::or_ || h == &I::xor_ || h == &I::nand || h == &I::nor || h == &I::eqv) {
+			const X64Alu alu = (h == &I::and_ || h == &I::nand) ? ALU_AND : (h == &I::or_ || h == &I::nor) ? ALU_OR : ALU_XOR;
+			e_.Load64(RAX, GPR(op.rD));
+			e_.AluRM(alu, RAX, GPR(op.rB), true);
+			if (h == &I::nand || h == &I::nor || h == &I::eqv) e_.Not(RAX, true);
+			StoreResult(op.rA, op.rc);
+			return true;
+		}
+		if (h == &I::andc || h == &I::orc) {
+			e_.Load64(RCX, GPR(op.rB));
+			e_.Not(RCX, true);
+			e_.Load64(RAX, GPR(op.rD));
+			e_.AluRR(h == &I::andc ? ALU_AND : ALU_OR, RAX, RCX, true);
+			StoreResult(op.rA, op.rc);
+			return true;
+		}
+		if (h == &I::ori || h == &I::oris || h == &I::xori || h == &I::xoris) {
+			const uint32_t imm = (h == &I::oris || h == &I::xoris) ? uimm << 16 : uimm;
+			const X64Alu alu = (h == &I::ori || h == &I::oris) ? ALU_OR : ALU_XOR;
+			e_.Load64(RAX, GPR(op.rD));
+			if (imm & 0x80000000) {
+				// The immediate is zero-extended: it can't go through the sign-extended imm32
+				e_.MovImm32(RCX, imm);
+				e_.AluRR(alu, RAX, RCX, true);
+			}
+			else {
+				e_.AluRI(alu, RAX, imm, true);
+			}
+			e_.Store64(GPR(op.rA), RAX);
+			return true;
+		}
+		if (h == &I::andi || h == &I::andis) {
+			// 32-bit and: the high word of the result is zero either way
+			e_.Load32(RAX, GPR(op.rD));
+			e_.AluRI(ALU_AND, RAX, h == &I::andis ? uimm << 16 : uimm);
+			StoreResult(op.rA, true);
+			return true;
+		}
+		if (h == &I::extsb || h == &I::extsh) {
+			if (h == &I::extsb) e_.MovsxByteM(RAX, GPR(op.rD), true);
+			else e_.MovsxWordM(RAX, GPR(op.rD), true);
+			StoreResult(op.rA, op.rc);
+			return true;
+		}
+
+		// Rotates. Only non-wrapping masks: they stay inside the low word, so the 32-bit rotate
+		// zero-extends exactly like ROTL32 & MASK(mb+32, me+32). Wrapping masks use the handler.
+		if ((h == &I::rlwinm || h == &I::rlwimi) && op.mb <= op.me) {
+			const uint32_t mask = jit_.cpu_.MaskFromMBME(op.mb, op.me);
+			e_.Load32(RAX, GPR(op.rD));
+			if (op.sh) e_.ShiftI(SH_ROL, RAX, op.sh);
+			e_.AluRI(ALU_AND, RAX, mask);
+			if (h == &I::rlwimi) {
+				e_.Load64(RCX, GPR(op.rA));
+				e_.MovImm64(RDX, ~uint64_t(mask));
+				e_.AluRR(ALU_AND, RCX, RDX, true);
+				e_.AluRR(ALU_OR, RAX, RCX, true);
+			}
+			StoreResult(op.rA, op.rc);
+			return true;
+		}
+
+		// Compares: L (low bit of the crfD field) selects a 64-bit compare
+		if (h == &I::cmpi || h == &I::cmpli) {
+			const bool l = op.rD & 1;
+			if (l) e_.Load64(RAX, GPR(op.rA));
+			else e_.Load32(RAX, GPR(op.rA));
+			e_.AluRI(ALU_CMP, RAX, h == &I::cmpi ? uint32_t(op.imm) : uimm, l);
+			SetCRFromFlags(op.rD >> 2, h == &I::cmpi);
+			return true;
+		}
+		if (h == &I::cmp || h == &I::cmpl) {
+			const bool l = op.rD & 1;
+			if (l) e_.Load64(RAX, GPR(op.rA));
+			else e_.Load32(RAX, GPR(op.rA));
+			e_.AluRM(ALU_CMP, RAX, GPR(op.rB), l);
+			SetCRFromFlags(op.rD >> 2, h == &I::cmp);
+			return true;
+		}
+
+		// Loads and stores
+		const void* r8 = reinterpret_cast<const void*>(&PPCJit::Read8);
+		const void* r16 = reinterpret_cast<const void*>(&PPCJit::Read16);
+		const void* r32 = reinterpret_cast<const void*>(&PPCJit::Read32);
+		const void* w8 = reinterpret_cast<const void*>(&PPCJit::Write8);
+		const void* w16 = reinterpret_cast<const void*>(&PPCJit::Write16);
+		const void* w32 = reinterpret_cast<const void*>(&PPCJit::Write32);
+		if (h == &I::lwz) { EmitLoad(op, pc, index, r32, false, false, false); return true; }
+		if (h == &I::lwzu) { EmitLoad(op, pc, index, r32, false, true, false); return true; }
+		if (h == &I::lwzx) { EmitLoad(op, pc, index, r32, true, false, false); return true; }
+		if (h == &I::lbz) { EmitLoad(op, pc, index, r8, false, false, false); return true; }
+		if (h == &I::lbzu) { EmitLoad(op, pc, index, r8, false, true, false); return true; }
+		if (h == &I::lbzx) { EmitLoad(op, pc, index, r8, true, false, false); return true; }
+		if (h == &I::lhz) { EmitLoad(op, pc, index, r16, false, false, false); return true; }
+		if (h == &I::lhzu) { EmitLoad(op, pc, index, r16, false, true, false); return true; }
+		if (h == &I::lhzx) { EmitLoad(op, pc, index, r16, true, false, false); return true; }
+		if (h == &I::lha) { EmitLoad(op, pc, index, r16, false, false, true); return true; }
+		if (h == &I::lhau) { EmitLoad(op, pc, index, r16, false, true, true); return true; }
+		if (h == &I::stw) { EmitStore(op, pc, index, w32, false, false); return true; }
+		if (h == &I::stwu) { EmitStore(op, pc, index, w32, false, true); return true; }
+		if (h == &I::stwx) { EmitStore(op, pc, index, w32, true, false); return true; }
+		if (h == &I::stb) { EmitStore(op, pc, index, w8, false, false); return true; }
+		if (h == &I::stbu) { EmitStore(op, pc, index, w8, false, true); return true; }
+		if (h == &I::stbx) { EmitStore(op, pc, index, w8, true, false); return true; }
+		if (h == &I::sth) { EmitStore(op, pc, index, w16, false, false); return true; }
+		if (h == &I::sthu) { EmitStore(op, pc, index, w16, false, true); return true; }
+		if (h == &I::sthx) { EmitStore(op, pc, index, w16, true, false); return true; }
+
+		return false;
+	}
+
+	PPCJit& jit_;
+	const PPCJit::Offsets& off_;
+	const PPCBlock& block_;
+	const bool mode64_;
+	X64Emitter e_;
+	std::vector<PendingExit> exits_;
+};
+
+#endif // PPC_JIT_X64
+
+PPCJit::BlockFn PPCJit::Compile(const PPCBlock& block) {
+#ifdef PPC_JIT_X64
+	if (!code_) return nullptr;
+	X64BlockCompiler compiler(*this, block);
+	const std::vector<uint8_t>& bytes = compiler.Compile();
+	const size_t start = (code_used_ + 15) & ~size_t(15);
+	if (start + bytes.size() > CODE_CACHE_SIZE) return nullptr;
+	std::memcpy(code_ + start, bytes.data(), bytes.size());
+	code_used_ = start + bytes.size();
+	return reinterpret_cast<BlockFn>(code_ + start);
+#else
+	(void)block;
+	return nullptr;
+#endif
+}
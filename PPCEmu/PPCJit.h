@@ -0,0 +1,69 @@
+// PPCJit.h
+#pragma once
+#include "PPCBlockCache.h"
+#include "PPCEmuConfig.h"
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define PPC_JIT_X64 1
+#endif
+
+class CPU;
+
+// Second execution tier: blocks that run often enough are compiled to native x86-64.
+// Guest registers stay in the CPU object (addressed off rbx); memory accesses and any
+// instruction without a native template call back into C++ helpers.
+class PPCJit {
+public:
+    static constexpr uint32_t COMPILE_THRESHOLD = 16;        // ejecuciones antes de compilar
+    static constexpr size_t CODE_CACHE_SIZE = 8 * 1024 * 1024;
+
+    // Compiled block: returns guest instructions retired, with CPU::PC already updated
+    using BlockFn = uint32_t (*)(CPU* cpu);
+
+    explicit PPCJit(CPU& cpu);
+    ~PPCJit();
+    PPCJit(const PPCJit&) = delete;
+    PPCJit& operator=(const PPCJit&) = delete;
+
+    bool IsAvailable() const { return code_ != nullptr; }
+    // Returns nullptr if the block can't be compiled or the code cache is full
+    BlockFn Compile(const PPCBlock& block);
+    // Drops every compiled block. The caller must flush the block cache first.
+    void Reset() { code_used_ = 0; }
+
+    // A helper caught a guest-visible C++ exception while native code was running
+    bool HasPendingException() const { return fault_ != 0; }
+    void RethrowPendingException();
+
+private:
+    // rbx apunta a cpu + STATE_BIAS: los primeros 256 bytes de CPU (PC, LR, CTR, XER, CR y r0-r28,
+    // de 8 bytes cada uno) quedan a un desplazamiento de 8 bits
+    static constexpr int32_t STATE_BIAS = 128;
+    struct Offsets {
+        int32_t pc, nia, lr, ctr, xer, cr, gpr, fault;
+    };
+
+    // Called from generated code
+    static uint32_t Read8(CPU* cpu, uint64_t ea);
+    static uint32_t Read16(CPU* cpu, uint64_t ea);
+    static uint32_t Read32(CPU* cpu, uint64_t ea);
+    static void Write8(CPU* cpu, uint64_t ea, uint32_t value);
+    static void Write16(CPU* cpu, uint64_t ea, uint32_t value);
+    static void Write32(CPU* cpu, uint64_t ea, uint32_t value);
+    // Non-zero if the instruction did not complete (helper fault or trap/illegal exception)
+    static uint32_t CallHandler(CPU* cpu, const PPCDecodedInstr* op);
+    void Fault();
+
+    CPU& cpu_;
+    Offsets off_{};
+    uint8_t* code_ = nullptr;
+    size_t code_used_ = 0;
+    uint8_t fault_ = 0;
+    std::exception_ptr pending_;
+
+    friend class X64BlockCompiler;
+};
@@ -0,0 +1,199 @@
+// Replay.cpp
+#include "Replay.h"
+#include "CPU.h"
+#include "Endian.h"
+#include "Log.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr char REPLAY_MAGIC[8] = { 'P', 'P', 'C', 'R', 'P', 'L', 'Y', 0 };
+constexpr uint32_t REPLAY_VERSION = 1;
+constexpr size_t HEADER_SIZE = sizeof(REPLAY_MAGIC) + 8;
+
+const char* EventName(uint8_t kind) {
+	switch (kind) {
+	case ReplayLog::EVENT_INTERRUPT: return "external interrupt";
+	case ReplayLog::EVENT_MMIO_READ: return "MMIO read";
+	case ReplayLog::EVENT_SNAPSHOT: return "snapshot";
+	case ReplayLog::EVENT_END: return "end of recording";
+	default: return "unknown event";
+	}
+}
+
+size_t PutVarint(uint8_t* out, uint64_t value) {
+	size_t size = 0;
+	while (value >= 0x80) {
+		out[size++] = uint8_t(value) | 0x80;
+		value >>= 7;
+	}
+	out[size++] = uint8_t(value);
+	return size;
+}
+
+// false si el número se sale del fichero (evento cortado al final)
+bool GetVarint(const uint8_t* data, size_t size, size_t& pos, uint64_t& value) {
+	value = 0;
+	for (unsigned shift = 0; shift < 64; shift += 7) {
+		if (pos >= size) return false;
+		const uint8_t byte = data[pos++];
+		value |= uint64_t(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) return true;
+	}
+	throw std::runtime_error("Replay: malformed event");
+}
+
+} // namespace
+
+ReplayLog::ReplayLog(const std::string& path, Mode mode, const CPU& cpu) : path_(path), mode_(mode), cpu_(cpu) {
+	if (mode_ == Mode::Record) {
+		out_.open(path_, std::ios::binary | std::ios::trunc);
+		if (!out_) throw std::runtime_error("Replay: cannot create " + path_);
+		uint8_t header[HEADER_SIZE] = {};
+		std::memcpy(header, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+		StoreLE(header + sizeof(REPLAY_MAGIC), REPLAY_VERSION);
+		out_.write(reinterpret_cast<const char*>(header), sizeof(header));
+		return;
+	}
+
+	file_ = std::make_unique<MappedFile>(path_, MappedFile::Access::ReadOnly);
+	if (file_->GetSize() < HEADER_SIZE || std::memcmp(file_->GetData(), REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0)
+		throw std::runtime_error("Replay: " + path_ + " is not a replay log");
+	if (LoadLE<uint32_t>(file_->GetData() + sizeof(REPLAY_MAGIC)) != REPLAY_VERSION)
+		throw std::runtime_error("Replay: unsupported version in " + path_);
+
+	// Una pasada para los snapshots y el final (el primer delta es el instante absoluto)
+	size_t pos = HEADER_SIZE;
+	uint64_t instant = 0;
+	Event event;
+	while (Decode(pos, instant, event)) {
+		end_ = event.instant;
+		if (event.kind == EVENT_SNAPSHOT) {
+			snapshots_.push_back(event.instant);
+			snapshotOffsets_.push_back(pos);
+		} else if (event.kind == EVENT_END) {
+			complete_ = true;
+			break;
+		}
+	}
+	if (!complete_)
+		LOG_WARNING("System", "Replay %s: no end marker (recording cut short), replaying up to instruction %llu",
+			path_.c_str(), (unsigned long long)end_);
+}
+
+ReplayLog::~ReplayLog() {
+	if (out_.is_open()) out_.flush();
+}
+
+std::string ReplayLog::SnapshotPath(uint64_t instant) const {
+	return path_ + "." + std::to_string(instant) + ".snap";
+}
+
+uint64_t ReplayLog::Now() const {
+	return cpu_.GetInstructionsRetired();
+}
+
+void ReplayLog::Put(EventKind kind, uint64_t value) {
+	const uint64_t now = Now();
+	uint8_t buffer[1 + 10 + 10];
+	size_t size = 0;
+	buffer[size++] = kind;
+	size += PutVarint(buffer + size, now - last_);
+	if (kind == EVENT_MMIO_READ) size += PutVarint(buffer + size, value);
+	out_.write(reinterpret_cast<const char*>(buffer), std::streamsize(size));
+	last_ = now;
+	++events_;
+}
+
+bool ReplayLog::Decode(size_t& pos, uint64_t& instant, Event& event) const {
+	const uint8_t* data = file_->GetData();
+	const size_t size = size_t(file_->GetSize());
+	size_t p = pos;
+	if (p >= size) return false;
+	const uint8_t kind = data[p++];
+	if (kind < EVENT_INTERRUPT || kind > EVENT_END)
+		throw std::runtime_error("Replay: bad event kind " + std::to_string(kind) + " in " + path_);
+	uint64_t delta = 0, value = 0;
+	if (!GetVarint(data, size, p, delta)) return false;
+	if (kind == EVENT_MMIO_READ && !GetVarint(data, size, p, value)) return false;
+	instant += delta;
+	event = { EventKind(kind), instant, value };
+	pos = p;
+	return true;
+}
+
+void ReplayLog::Advance() {
+	hasNext_ = false;
+	Event event;
+	while (Decode(pos_, last_, event)) {
+		if (event.kind == EVENT_END) return;
+		if (event.kind == EVENT_SNAPSHOT) continue;
+		next_ = event;
+		hasNext_ = true;
+		return;
+	}
+}
+
+void ReplayLog::SeekToSnapshot(uint64_t instant) {
+	for (size_t i = 0; i < snapshots_.size(); ++i) {
+		if (snapshots_[i] != instant) continue;
+		pos_ = snapshotOffsets_[i];
+		last_ = instant;
+		Advance();
+		return;
+	}
+	throw std::runtime_error("Replay: no snapshot at instruction " + std::to_string(instant) + " in " + path_);
+}
+
+void ReplayLog::Diverged(const std::string& what) const {
+	char where[96];
+	snprintf(where, sizeof(where), "Replay diverged at instruction %llu (PC 0x%llX): ",
+		(unsigned long long)Now(), (unsigned long long)cpu_.GetPC());
+	const std::string recorded = hasNext_
+		? std::string(EventName(next_.kind)) + " at instruction " + std::to_string(next_.instant)
+		: std::string("no more events");
+	throw std::runtime_error(where + what + ", the recording has " + recorded);
+}
+
+uint64_t ReplayLog::Input(EventKind kind, uint64_t value) {
+	if (mode_ == Mode::Record) {
+		Put(kind, value);
+		return value;
+	}
+	if (!hasNext_ || next_.kind != kind || next_.instant != Now())
+		Diverged(std::string("the guest got a ") + EventName(kind));
+	value = next_.value;
+	++events_;
+	Advance();
+	return value;
+}
+
+bool ReplayLog::TakeInterrupt() {
+	CheckDivergence();
+	if (!hasNext_ || next_.kind != EVENT_INTERRUPT || next_.instant != Now()) return false;
+	++events_;
+	Advance();
+	return true;
+}
+
+void ReplayLog::CheckDivergence() const {
+	if (hasNext_ && next_.instant < Now())
+		Diverged("the guest went past it");
+}
+
+void ReplayLog::MarkSnapshot() {
+	Put(EVENT_SNAPSHOT, 0);
+}
+
+void ReplayLog::Flush() {
+	out_.flush();
+	if (!out_) throw std::runtime_error("Replay: write error on " + path_);
+}
+
+void ReplayLog::Finish() {
+	Put(EVENT_END, 0);
+	Flush();
+	out_.close();
+}
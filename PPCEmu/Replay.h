@@ -0,0 +1,103 @@
+// Replay.h
+#pragma once
+#include "MappedFile.h"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CPU;
+
+// Grabación y reproducción determinista de la ejecución (un solo hilo de hardware).
+// El reloj del guest es virtual: DEC y la time base avanzan con las instrucciones retiradas
+// (CPU::GetInstructionsRetired), no con el tiempo del host, así que la ejecución sólo depende del
+// estado de partida y de lo que entra desde fuera. Eso es lo que se graba, con el instante en que
+// llegó (instrucciones retiradas al empezar el bloque: los bloques empiezan en los mismos sitios
+// al grabar y al reproducir):
+//   INTERRUPT  llega la línea externa (queda pendiente hasta que MSR[EE] la deje entrar)
+//   MMIO_READ  valor leído de un dispositivo cuyo contenido depende del host
+//              (MemoryDevice::ReadsDependOnHost)
+//   SNAPSHOT   snapshot de la máquina en SnapshotPath(instante): uno al empezar a grabar y otro
+//              cada cierto número de instrucciones; la reproducción arranca del último anterior
+//              al instante pedido
+//   END        fin de la grabación; sin él (proceso cortado) se reproduce hasta el último evento
+// Fichero: "PPCRPLY\0", versión (u32) y reservado (u32); luego, por evento, el tipo (1 byte), las
+// instrucciones desde el evento anterior y, en MMIO_READ, el valor leído (ambos en LEB128).
+// Al reproducir, cada entrada sale del log y no de su fuente: si el guest pide en un instante algo
+// distinto de lo grabado la ejecución ha divergido, y se lanza std::runtime_error con el instante.
+// Las peticiones de control (CPU::Post) no se graban.
+class ReplayLog {
+public:
+    enum class Mode { Record, Replay };
+    enum EventKind : uint8_t { EVENT_INTERRUPT = 1, EVENT_MMIO_READ = 2, EVENT_SNAPSHOT = 3, EVENT_END = 4 };
+
+    // Record: crea path. Replay: lo proyecta y lo recorre una vez para localizar los snapshots y
+    // el final. El reloj de los eventos es cpu.GetInstructionsRetired().
+    ReplayLog(const std::string& path, Mode mode, const CPU& cpu);
+    ~ReplayLog();
+    ReplayLog(const ReplayLog&) = delete;
+    ReplayLog& operator=(const ReplayLog&) = delete;
+
+    bool IsReplaying() const { return mode_ == Mode::Replay; }
+    const std::string& GetPath() const { return path_; }
+    // <log>.<instante>.snap
+    std::string SnapshotPath(uint64_t instant) const;
+    uint64_t GetEventCount() const { return events_; }
+
+    // Entrada del guest en el instante actual. Record: graba value y lo devuelve.
+    // Replay: devuelve el valor grabado; lanza si el siguiente evento no es éste.
+    uint64_t Input(EventKind kind, uint64_t value = 0);
+    // Replay, entre bloques: true si en este instante se tomó la interrupción externa
+    bool TakeInterrupt();
+    // Replay: lanza si el log tiene una entrada anterior al instante actual que no se consumió
+    void CheckDivergence() const;
+
+    // Record: SNAPSHOT en el instante actual (el snapshot lo guarda quien llama, en SnapshotPath)
+    void MarkSnapshot();
+    void Flush();
+    // Record: END y cierra el fichero
+    void Finish();
+
+    // Replay: instantes con snapshot, en orden
+    const std::vector<uint64_t>& GetSnapshots() const { return snapshots_; }
+    // Replay: sigue leyendo justo después del SNAPSHOT de ese instante (uno de GetSnapshots)
+    void SeekToSnapshot(uint64_t instant);
+    // Replay: último instante grabado (END o el último evento completo)
+    uint64_t GetEnd() const { return end_; }
+    bool IsComplete() const { return complete_; }
+
+private:
+    struct Event {
+        EventKind kind;
+        uint64_t instant;
+        uint64_t value;
+    };
+
+    uint64_t Now() const;
+    void Put(EventKind kind, uint64_t value);
+    // Evento en pos (el instante se acumula en instant); false al final o si está cortado
+    bool Decode(size_t& pos, uint64_t& instant, Event& event) const;
+    // next_ = siguiente entrada del guest (salta los SNAPSHOT)
+    void Advance();
+    [[noreturn]] void Diverged(const std::string& what) const;
+
+    std::string path_;
+    Mode mode_;
+    const CPU& cpu_;
+    uint64_t last_ = 0;    // instante del último evento escrito o leído: los deltas parten de él
+    uint64_t events_ = 0;
+
+    // Record
+    std::ofstream out_;
+
+    // Replay
+    std::unique_ptr<MappedFile> file_;
+    size_t pos_ = 0;
+    bool hasNext_ = false;
+    Event next_{};
+    std::vector<uint64_t> snapshots_;
+    std::vector<size_t> snapshotOffsets_; // posición tras cada SNAPSHOT
+    uint64_t end_ = 0;
+    bool complete_ = false;
+};
@@ -0,0 +1,66 @@
+// SharedMemoryPresenter.cpp
+#include "SharedMemoryPresenter.h"
+#include "Log.h"
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+SharedMemoryPresenter::SharedMemoryPresenter(const std::string& name, int width, int height) : name_(name) {
+	size_ = sizeof(SharedFrameHeader) + size_t(width) * height * 4;
+#if defined(_WIN32)
+	mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+		DWORD(uint64_t(size_) >> 32), DWORD(size_), name_.c_str());
+	if (!mapping_) throw std::runtime_error("SharedMemoryPresenter: CreateFileMapping failed for " + name_);
+	view_ = static_cast<uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size_));
+	if (!view_) {
+		CloseHandle(mapping_);
+		throw std::runtime_error("SharedMemoryPresenter: MapViewOfFile failed for " + name_);
+	}
+#else
+	// shm_open quiere un nombre que empiece con '/'
+	if (name_.empty() || name_[0] != '/') name_ = "/" + name_;
+	const int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0644);
+	if (fd < 0) throw std::runtime_error("SharedMemoryPresenter: shm_open failed for " + name_);
+	if (ftruncate(fd, off_t(size_)) != 0) {
+		close(fd);
+		throw std::runtime_error("SharedMemoryPresenter: ftruncate failed for " + name_);
+	}
+	void* view = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (view == MAP_FAILED) throw std::runtime_error("SharedMemoryPresenter: mmap failed for " + name_);
+	view_ = static_cast<uint8_t*>(view);
+#endif
+	header_ = new (view_) SharedFrameHeader{};
+	header_->width = uint32_t(width);
+	header_->height = uint32_t(height);
+	header_->pitch = uint32_t(width) * 4;
+	header_->sequence.store(0, std::memory_order_relaxed);
+	header_->magic = SharedFrameHeader::MAGIC;
+	LOG_INFO("Display", "Shared framebuffer %s: %dx%d, %zu bytes", name_.c_str(), width, height, size_);
+}
+
+SharedMemoryPresenter::~SharedMemoryPresenter() {
+#if defined(_WIN32)
+	UnmapViewOfFile(view_);
+	CloseHandle(mapping_);
+#else
+	munmap(view_, size_);
+	shm_unlink(name_.c_str());
+#endif
+}
+
+void SharedMemoryPresenter::Present(const uint8_t* pixels, int width, int height) {
+	if (uint32_t(width) != header_->width || uint32_t(height) != header_->height) return;
+	const uint64_t seq = header_->sequence.load(std::memory_order_relaxed);
+	header_->sequence.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(view_ + sizeof(SharedFrameHeader), pixels, size_t(header_->pitch) * height);
+	header_->sequence.store(seq + 2, std::memory_order_release);
+}
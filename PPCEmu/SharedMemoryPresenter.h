@@ -0,0 +1,36 @@
+// SharedMemoryPresenter.h
+#pragma once
+#include "FramePresenter.h"
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+// Header at the start of the shared segment; pixels (BGRX, pitch bytes per row) follow it.
+// sequence works as a seqlock: odd while a frame is being copied, even when it is complete.
+struct SharedFrameHeader {
+    static constexpr uint32_t MAGIC = 0x46435050; // "PPCF"
+    uint32_t magic;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    std::atomic<uint64_t> sequence;
+};
+
+// Publishes every frame into a named shared memory segment (POSIX shm / Win32 file mapping)
+// so an external viewer or test harness can read it without touching the emulator.
+class SharedMemoryPresenter : public FramePresenter {
+public:
+    SharedMemoryPresenter(const std::string& name, int width, int height);
+    ~SharedMemoryPresenter() override;
+    SharedMemoryPresenter(const SharedMemoryPresenter&) = delete;
+    SharedMemoryPresenter& operator=(const SharedMemoryPresenter&) = delete;
+
+    void Present(const uint8_t* pixels, int width, int height) override;
+
+private:
+    std::string name_;
+    size_t size_ = 0;
+    void* mapping_ = nullptr;   // HANDLE on Windows, unused elsewhere
+    uint8_t* view_ = nullptr;
+    SharedFrameHeader* header_ = nullptr;
+};
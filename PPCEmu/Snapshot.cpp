@@ -0,0 +1,488 @@
+// Snapshot.cpp
+#include "Snapshot.h"
+#include "Endian.h"
+#include "Log.h"
+#include "Lz4.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[8] = { 'P', 'P', 'C', 'S', 'N', 'A', 'P', 0 };
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+constexpr uint32_t Tag(char a, char b, char c, char d) {
+	return uint32_t(uint8_t(a)) | uint32_t(uint8_t(b)) << 8 | uint32_t(uint8_t(c)) << 16 | uint32_t(uint8_t(d)) << 24;
+}
+constexpr uint32_t TAG_CPU = Tag('C', 'P', 'U', ' ');
+constexpr uint32_t TAG_DEV = Tag('D', 'E', 'V', ' ');
+constexpr uint32_t TAG_PAGE = Tag('P', 'A', 'G', 'E');
+constexpr uint32_t TAG_MMU = Tag('M', 'M', 'U', ' ');
+constexpr uint32_t TAG_END = Tag('E', 'N', 'D', ' ');
+
+// Sección: {tag, reservado, tamaño de los datos}
+constexpr size_t SECTION_HEADER_SIZE = 16;
+// Lote de páginas: {número de páginas, bytes guardados, flags}, índices de página (u32) y datos
+constexpr uint32_t PAGES_PER_BATCH = 256; // 1 MiB sin comprimir
+constexpr uint32_t BATCH_LZ4 = 1;
+// Muestra del principio de cada lote: si no baja al menos 1/8 el lote se guarda sin comprimir
+// (datos ya comprimidos o aleatorios, donde LZ4 pierde tiempo sin ganar espacio)
+constexpr size_t PROBE_SIZE = 16384;
+// Lotes comprimidos que pueden esperar a ser escritos, por hilo de compresión
+constexpr size_t BATCHES_IN_FLIGHT_PER_THREAD = 4;
+
+unsigned ThreadCount(unsigned threads) {
+	return threads ? threads : (std::max)(1u, std::thread::hardware_concurrency());
+}
+
+template <typename T>
+void Put(std::ostream& out, T value) {
+	uint8_t bytes[sizeof(T)];
+	StoreLE(bytes, value);
+	out.write(reinterpret_cast<const char*>(bytes), sizeof(T));
+}
+
+void PutString(std::ostream& out, const std::string& s) {
+	Put(out, uint16_t(s.size()));
+	out.write(s.data(), std::streamsize(s.size()));
+}
+
+// Lectura acotada de una sección proyectada
+struct Cursor {
+	const uint8_t* p;
+	const uint8_t* end;
+
+	const uint8_t* Take(uint64_t size) {
+		if (size > uint64_t(end - p)) throw std::runtime_error("Snapshot: section truncated");
+		const uint8_t* data = p;
+		p += size;
+		return data;
+	}
+	template <typename T>
+	T Get() { return LoadLE<T>(Take(sizeof(T))); }
+	std::string GetString() {
+		const uint16_t size = Get<uint16_t>();
+		return std::string(reinterpret_cast<const char*>(Take(size)), size);
+	}
+	bool AtEnd() const { return p == end; }
+	uint64_t Remaining() const { return uint64_t(end - p); }
+};
+
+// istream sobre memoria, para los SerializeState de CPU y dispositivos
+struct MemoryBuffer : std::streambuf {
+	MemoryBuffer(const uint8_t* data, size_t size) {
+		char* p = const_cast<char*>(reinterpret_cast<const char*>(data));
+		setg(p, p, p + size);
+	}
+};
+
+bool IsZeroPage(const uint8_t* p, size_t size) {
+	size_t i = 0;
+	for (uint64_t acc = 0; i + 64 <= size; i += 64) {
+		for (size_t j = 0; j < 64; j += 8) {
+			uint64_t v;
+			std::memcpy(&v, p + i + j, 8);
+			acc |= v;
+		}
+		if (acc) return false;
+	}
+	for (; i < size; ++i)
+		if (p[i]) return false;
+	return true;
+}
+
+// scratch: al menos Lz4CompressBound(PROBE_SIZE) bytes
+bool Compressible(const std::vector<uint8_t>& data, uint8_t* scratch) {
+	if (data.size() <= PROBE_SIZE) return true;
+	return Lz4Compress(data.data(), PROBE_SIZE, scratch) < PROBE_SIZE - PROBE_SIZE / 8;
+}
+
+uint64_t PageBytes(const MemoryDevice& device, uint64_t page) {
+	const uint64_t offset = page << MemoryDevice::DIRTY_PAGE_SHIFT;
+	return (std::min)(MemoryDevice::DIRTY_PAGE_SIZE, device.GetSize() - offset);
+}
+
+MemoryDevice* FindDevice(const SnapshotReader::DeviceList& devices, const std::string& name) {
+	for (const auto& device : devices)
+		if (device->GetName() == name) return device.get();
+	throw std::runtime_error("Snapshot: device " + name + " does not exist in this machine");
+}
+
+// Reparte count tareas entre threads hilos (el que llama es uno de ellos); propaga la primera excepción
+template <typename Task>
+void ParallelFor(size_t count, unsigned threads, Task task) {
+	std::atomic<size_t> next{ 0 };
+	std::mutex errorMutex;
+	std::exception_ptr error;
+	auto worker = [&]() {
+		try {
+			for (size_t i; (i = next.fetch_add(1)) < count;) task(i);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(errorMutex);
+			if (!error) error = std::current_exception();
+			next = count;
+		}
+	};
+	std::vector<std::thread> pool;
+	for (unsigned i = 1; i < (std::min<size_t>)(threads, count); ++i) pool.emplace_back(worker);
+	worker();
+	for (std::thread& t : pool) t.join();
+	if (error) std::rethrow_exception(error);
+}
+
+} // namespace
+
+SnapshotWriter::SnapshotWriter(const std::string& path, unsigned threads)
+	: path_(path), out_(path, std::ios::binary | std::ios::trunc), threads_(ThreadCount(threads)) {
+	if (!out_) throw std::runtime_error("Cannot create snapshot: " + path);
+	out_.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	Put(out_, SNAPSHOT_VERSION);
+	Put(out_, uint32_t(0));
+}
+
+void SnapshotWriter::BeginSection(uint32_t tag) {
+	sectionStart_ = out_.tellp();
+	Put(out_, tag);
+	Put(out_, uint32_t(0));
+	Put(out_, uint64_t(0)); // se rellena en EndSection
+}
+
+void SnapshotWriter::EndSection() {
+	const std::streamoff end = out_.tellp();
+	out_.seekp(sectionStart_ + 8);
+	Put(out_, uint64_t(end - sectionStart_ - std::streamoff(SECTION_HEADER_SIZE)));
+	out_.seekp(end);
+	sectionStart_ = -1;
+}
+
+void SnapshotWriter::WriteSection(uint32_t tag, const std::string& data) {
+	Put(out_, tag);
+	Put(out_, uint32_t(0));
+	Put(out_, uint64_t(data.size()));
+	out_.write(data.data(), std::streamsize(data.size()));
+}
+
+void SnapshotWriter::WriteCPU(CPU& cpu) {
+	std::ostringstream state;
+	cpu.SerializeState(state);
+	WriteSection(TAG_CPU, state.str());
+}
+
+void SnapshotWriter::WriteRegions(const MMU& mmu) {
+	std::ostringstream table;
+	Put(table, uint32_t(mmu.GetRegions().size()));
+	for (const MemoryRegion& region : mmu.GetRegions()) {
+		PutString(table, region.device->GetName());
+		Put(table, region.virtual_start);
+		Put(table, region.virtual_end);
+		Put(table, region.physical_start);
+		Put(table, uint32_t((region.readable ? 1 : 0) | (region.writable ? 2 : 0) | (region.executable ? 4 : 0)));
+	}
+	WriteSection(TAG_MMU, table.str());
+}
+
+void SnapshotWriter::WriteDevice(MemoryDevice& device) {
+	std::ostringstream state;
+	PutString(state, device.GetName());
+	device.SerializeState(state);
+	WriteSection(TAG_DEV, state.str());
+	if (device.GetDirtyPages() && device.IsDirectMapped() && device.GetSize())
+		WritePages(device);
+}
+
+// Páginas sucias en lotes de PAGES_PER_BATCH: los hilos de compresión descartan las páginas a cero,
+// juntan el resto y lo comprimen; este hilo escribe los lotes en orden según están listos.
+void SnapshotWriter::WritePages(MemoryDevice& device) {
+	std::vector<uint32_t> dirty;
+	const std::atomic<uint64_t>* bitmap = device.GetDirtyPages();
+	const uint64_t pageCount = (device.GetSize() + MemoryDevice::DIRTY_PAGE_SIZE - 1) >> MemoryDevice::DIRTY_PAGE_SHIFT;
+	for (uint64_t i = 0; i < (pageCount + 63) / 64; ++i) {
+		for (uint64_t word = bitmap[i].load(std::memory_order_relaxed); word; word &= word - 1) {
+			int bit = 0;
+			while (!((word >> bit) & 1)) ++bit;
+			dirty.push_back(uint32_t((i << 6) + bit));
+		}
+	}
+	const uint8_t* base = device.GetPointerToAddress(0);
+
+	BeginSection(TAG_PAGE);
+	PutString(out_, device.GetName());
+	Put(out_, device.GetSize());
+	Put(out_, MemoryDevice::DIRTY_PAGE_SHIFT);
+
+	struct Batch {
+		std::vector<uint32_t> pages;
+		std::vector<uint8_t> data;
+		uint32_t flags = 0;
+		bool ready = false;
+	};
+	const size_t batchCount = (dirty.size() + PAGES_PER_BATCH - 1) / PAGES_PER_BATCH;
+	std::vector<Batch> batches(batchCount);
+	std::mutex mutex;
+	std::condition_variable changed;
+	size_t written = 0;   // lotes ya escritos (protegido por mutex)
+	bool failed = false;
+	std::atomic<size_t> next{ 0 };
+	const size_t inFlight = BATCHES_IN_FLIGHT_PER_THREAD * threads_;
+
+	auto compress = [&]() {
+		std::vector<uint8_t> gathered;
+		for (size_t i; (i = next.fetch_add(1)) < batchCount;) {
+			{
+				// No adelantarse demasiado a la escritura: acota la memoria de los lotes pendientes
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [&] { return failed || i < written + inFlight; });
+				if (failed) return;
+			}
+			Batch& batch = batches[i];
+			gathered.clear();
+			const size_t last = (std::min)(dirty.size(), (i + 1) * size_t(PAGES_PER_BATCH));
+			for (size_t j = i * PAGES_PER_BATCH; j < last; ++j) {
+				const uint8_t* page = base + (uint64_t(dirty[j]) << MemoryDevice::DIRTY_PAGE_SHIFT);
+				const size_t bytes = size_t(PageBytes(device, dirty[j]));
+				if (IsZeroPage(page, bytes)) continue;
+				batch.pages.push_back(dirty[j]);
+				gathered.insert(gathered.end(), page, page + bytes);
+			}
+			batch.data.resize(Lz4CompressBound(gathered.size()));
+			size_t compressed = gathered.size();
+			if (Compressible(gathered, batch.data.data()))
+				compressed = Lz4Compress(gathered.data(), gathered.size(), batch.data.data());
+			if (compressed < gathered.size()) {
+				batch.data.resize(compressed);
+				batch.flags = BATCH_LZ4;
+			}
+			else batch.data.assign(gathered.begin(), gathered.end());
+			std::lock_guard<std::mutex> lock(mutex);
+			batch.ready = true;
+			changed.notify_all();
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (unsigned t = 0; t < (std::min<size_t>)(threads_, batchCount); ++t) pool.emplace_back(compress);
+	try {
+		for (size_t i = 0; i < batchCount; ++i) {
+			Batch& batch = batches[i];
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [&] { return batch.ready; });
+			}
+			if (!batch.pages.empty()) {
+				Put(out_, uint32_t(batch.pages.size()));
+				Put(out_, uint32_t(batch.data.size()));
+				Put(out_, batch.flags);
+				for (uint32_t page : batch.pages) Put(out_, page);
+				out_.write(reinterpret_cast<const char*>(batch.data.data()), std::streamsize(batch.data.size()));
+				pages_ += batch.pages.size();
+			}
+			std::lock_guard<std::mutex> lock(mutex);
+			batch = Batch{};
+			written = i + 1;
+			changed.notify_all();
+		}
+	}
+	catch (...) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			failed = true;
+			changed.notify_all();
+		}
+		for (std::thread& t : pool) t.join();
+		throw;
+	}
+	for (std::thread& t : pool) t.join();
+	EndSection();
+}
+
+void SnapshotWriter::Finish() {
+	WriteSection(TAG_END, std::string());
+	out_.flush();
+	if (!out_) throw std::runtime_error("Cannot write snapshot: " + path_);
+	bytes_ = uint64_t(out_.tellp());
+	out_.close();
+}
+
+SnapshotReader::SnapshotReader(const std::string& path, unsigned threads)
+	: file_(path), threads_(ThreadCount(threads)) {
+	Cursor cursor{ file_.GetData(), file_.GetData() + file_.GetSize() };
+	if (std::memcmp(cursor.Take(sizeof(SNAPSHOT_MAGIC)), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+		throw std::runtime_error("Not a snapshot: " + path);
+	const uint32_t version = cursor.Get<uint32_t>();
+	if (version != SNAPSHOT_VERSION)
+		throw std::runtime_error("Snapshot " + path + ": unsupported version " + std::to_string(version));
+	cursor.Get<uint32_t>();
+	for (;;) {
+		Section section;
+		section.tag = cursor.Get<uint32_t>();
+		cursor.Get<uint32_t>();
+		section.size = cursor.Get<uint64_t>();
+		section.data = cursor.Take(section.size);
+		if (section.tag == TAG_END) break;
+		sections_.push_back(section);
+	}
+}
+
+size_t SnapshotReader::GetCPUCount() const {
+	return size_t(std::count_if(sections_.begin(), sections_.end(), [](const Section& s) { return s.tag == TAG_CPU; }));
+}
+
+void SnapshotReader::RestoreCPU(size_t index, CPU& cpu) const {
+	size_t remaining = index;
+	for (const Section& section : sections_) {
+		if (section.tag != TAG_CPU || remaining--) continue;
+		MemoryBuffer buffer(section.data, size_t(section.size));
+		std::istream in(&buffer);
+		cpu.DeserializeState(in);
+		return;
+	}
+	throw std::runtime_error("Snapshot: no state for CPU " + std::to_string(index));
+}
+
+void SnapshotReader::RestoreDevices(const DeviceList& devices) const {
+	for (const Section& section : sections_) {
+		Cursor cursor{ section.data, section.data + section.size };
+		if (section.tag == TAG_DEV) {
+			MemoryDevice* device = FindDevice(devices, cursor.GetString());
+			MemoryBuffer buffer(cursor.p, size_t(cursor.end - cursor.p));
+			std::istream in(&buffer);
+			device->DeserializeState(in);
+		}
+		else if (section.tag == TAG_PAGE) {
+			RestorePages(section, *FindDevice(devices, cursor.GetString()));
+		}
+	}
+}
+
+void SnapshotReader::RestorePages(const Section& section, MemoryDevice& device) const {
+	Cursor cursor{ section.data, section.data + section.size };
+	const std::string name = cursor.GetString();
+	const uint64_t size = cursor.Get<uint64_t>();
+	const uint32_t shift = cursor.Get<uint32_t>();
+	std::atomic<uint64_t>* dirty = device.GetDirtyPages();
+	if (size != device.GetSize() || shift != MemoryDevice::DIRTY_PAGE_SHIFT || !dirty || !device.IsDirectMapped())
+		throw std::runtime_error("Snapshot: memory of " + name + " does not match this machine");
+
+	struct Batch {
+		const uint8_t* pages; // u32 little-endian
+		uint32_t count;
+		const uint8_t* data;
+		uint32_t stored;
+		uint32_t flags;
+	};
+	const uint64_t pageCount = (size + MemoryDevice::DIRTY_PAGE_SIZE - 1) >> MemoryDevice::DIRTY_PAGE_SHIFT;
+	std::vector<uint64_t> restored((pageCount + 63) / 64, 0);
+	std::vector<Batch> batches;
+	while (!cursor.AtEnd()) {
+		Batch batch;
+		batch.count = cursor.Get<uint32_t>();
+		batch.stored = cursor.Get<uint32_t>();
+		batch.flags = cursor.Get<uint32_t>();
+		// Un lote vacío o con más páginas de las que caben en la sección es un snapshot corrupto
+		if (batch.count == 0 || batch.count > pageCount || uint64_t(batch.count) * 4 > cursor.Remaining())
+			throw std::runtime_error("Snapshot: corrupt page batch in " + name);
+		batch.pages = cursor.Take(uint64_t(batch.count) * 4);
+		batch.data = cursor.Take(batch.stored);
+		for (uint32_t i = 0; i < batch.count; ++i) {
+			const uint32_t page = LoadLE32(batch.pages + 4 * i);
+			if (page >= pageCount) throw std::runtime_error("Snapshot: page out of range in " + name);
+			restored[page >> 6] |= 1ull << (page & 63);
+		}
+		batches.push_back(batch);
+	}
+
+	// Lo escrito desde entonces y que no está en el snapshot vuelve a su contenido inicial; en tramos
+	// seguidos, para que la RAM los devuelva al SO de una vez
+	for (uint64_t page = 0; page < pageCount;) {
+		const uint64_t word = dirty[page >> 6].load(std::memory_order_relaxed) & ~restored[page >> 6];
+		if (!((word >> (page & 63)) & 1)) { ++page; continue; }
+		uint64_t end = page + 1;
+		while (end < pageCount && ((dirty[end >> 6].load(std::memory_order_relaxed) & ~restored[end >> 6]) >> (end & 63) & 1)) ++end;
+		const uint64_t offset = page << MemoryDevice::DIRTY_PAGE_SHIFT;
+		device.ResetPages(offset, (std::min)(end << MemoryDevice::DIRTY_PAGE_SHIFT, size) - offset);
+		page = end;
+	}
+
+	uint8_t* base = device.GetPointerToAddress(0);
+	ParallelFor(batches.size(), threads_, [&](size_t i) {
+		const Batch& batch = batches[i];
+		uint64_t bytes = 0;
+		bool contiguous = true;
+		for (uint32_t j = 0; j < batch.count; ++j) {
+			const uint32_t page = LoadLE32(batch.pages + 4 * j);
+			contiguous = contiguous && (j == 0 || page == LoadLE32(batch.pages + 4 * (j - 1)) + 1);
+			bytes += PageBytes(device, page);
+		}
+		// Páginas seguidas: directamente sobre la memoria del dispositivo; si no, a un buffer y se reparten
+		std::vector<uint8_t> buffer;
+		uint8_t* target = base + (uint64_t(LoadLE32(batch.pages)) << MemoryDevice::DIRTY_PAGE_SHIFT);
+		if (!contiguous) {
+			buffer.resize(size_t(bytes));
+			target = buffer.data();
+		}
+		if (batch.flags & BATCH_LZ4) {
+			if (!Lz4Decompress(batch.data, batch.stored, target, size_t(bytes)))
+				throw std::runtime_error("Snapshot: corrupt page data in " + name);
+		}
+		else {
+			if (batch.stored != bytes) throw std::runtime_error("Snapshot: corrupt page data in " + name);
+			std::memcpy(target, batch.data, size_t(bytes));
+		}
+		if (contiguous) return;
+		for (uint32_t j = 0, at = 0; j < batch.count; ++j) {
+			const uint32_t page = LoadLE32(batch.pages + 4 * j);
+			const size_t pageBytes = size_t(PageBytes(device, page));
+			std::memcpy(base + (uint64_t(page) << MemoryDevice::DIRTY_PAGE_SHIFT), buffer.data() + at, pageBytes);
+			at += uint32_t(pageBytes);
+		}
+	});
+
+	// Las páginas restauradas cuentan como escritas: un snapshot posterior las vuelve a guardar
+	for (size_t i = 0; i < restored.size(); ++i)
+		dirty[i].store(restored[i], std::memory_order_relaxed);
+	for (const Batch& batch : batches) pages_ += batch.count;
+}
+
+void SnapshotReader::RestoreRegions(MMU& mmu, const DeviceList& devices) const {
+	for (const Section& section : sections_) {
+		if (section.tag != TAG_MMU) continue;
+		Cursor cursor{ section.data, section.data + section.size };
+		const uint32_t count = cursor.Get<uint32_t>();
+		struct Mapping {
+			std::shared_ptr<MemoryDevice> device;
+			uint64_t start, end, physical;
+			uint32_t flags;
+		};
+		std::vector<Mapping> mappings;
+		for (uint32_t i = 0; i < count; ++i) {
+			const std::string name = cursor.GetString();
+			Mapping mapping;
+			mapping.start = cursor.Get<uint64_t>();
+			mapping.end = cursor.Get<uint64_t>();
+			mapping.physical = cursor.Get<uint64_t>();
+			mapping.flags = cursor.Get<uint32_t>();
+			for (const auto& device : devices) {
+				if (device->GetName() != name) continue;
+				mapping.device = device;
+				break;
+			}
+			FindDevice(devices, name); // lanza si no existe
+			mappings.push_back(std::move(mapping));
+		}
+		// Los snapshots anteriores al mapa sin solapes pueden traer regiones solapadas, donde
+		// ganaba la primera: de la última a la primera con RemapMemory, cada una tapa a las siguientes
+		mmu.ClearRegions();
+		for (auto it = mappings.rbegin(); it != mappings.rend(); ++it)
+			mmu.RemapMemory(it->device, it->start, it->end, it->physical, it->flags & 1, it->flags & 2, it->flags & 4);
+		return;
+	}
+	throw std::runtime_error("Snapshot: no memory map");
+}
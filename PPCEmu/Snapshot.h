@@ -0,0 +1,86 @@
+// Snapshot.h
+#pragma once
+#include "CPU.h"
+#include "MMU.h"
+#include "MappedFile.h"
+#include "MemoryDevice.h"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Snapshot de la máquina: cabecera ("PPCSNAP", versión) y secciones {tag, tamaño, datos}.
+//   CPU   registros de un hilo de hardware (CPU::SerializeState), el principal primero
+//   DEV   estado propio de un dispositivo (MemoryDevice::SerializeState)
+//   PAGE  memoria de un dispositivo con bitmap de páginas sucias (RAM, ficheros copy-on-write):
+//         sólo las páginas escritas que no están a cero, en lotes comprimidos con LZ4
+//   MMU   tabla de regiones: dispositivo (por nombre), rango virtual, offset físico y permisos
+//   END   fin; sin él el fichero está truncado
+// Las secciones con tags desconocidos se saltan al leer. SNAPSHOT_VERSION sólo cambia si cambia
+// el formato de alguna sección existente.
+//
+// Guardar: los lotes de páginas se comprimen en hilos de fondo y el hilo que llama los escribe en
+// orden según van saliendo. Restaurar: el fichero se proyecta en memoria y los lotes se
+// descomprimen en paralelo, directamente sobre la memoria de cada dispositivo.
+// En los dos casos las CPUs tienen que estar paradas.
+
+class SnapshotWriter {
+public:
+    // threads: hilos de compresión (0 = std::thread::hardware_concurrency())
+    explicit SnapshotWriter(const std::string& path, unsigned threads = 0);
+
+    void WriteCPU(CPU& cpu);
+    void WriteRegions(const MMU& mmu);
+    // DEV y, si el dispositivo lleva páginas sucias y es memoria directa, PAGE
+    void WriteDevice(MemoryDevice& device);
+    // Cierra el fichero (sección END); lanza si algo no se pudo escribir
+    void Finish();
+
+    uint64_t GetPagesWritten() const { return pages_; }
+    uint64_t GetBytesWritten() const { return bytes_; } // tras Finish
+
+private:
+    void BeginSection(uint32_t tag);
+    void EndSection();
+    void WriteSection(uint32_t tag, const std::string& data);
+    void WritePages(MemoryDevice& device);
+
+    std::string path_;
+    std::ofstream out_;
+    std::streamoff sectionStart_ = -1;
+    unsigned threads_;
+    uint64_t pages_ = 0;
+    uint64_t bytes_ = 0;
+};
+
+class SnapshotReader {
+public:
+    using DeviceList = std::vector<std::shared_ptr<MemoryDevice>>;
+
+    explicit SnapshotReader(const std::string& path, unsigned threads = 0);
+
+    size_t GetCPUCount() const;
+    void RestoreCPU(size_t index, CPU& cpu) const;
+    // Estado y páginas de cada dispositivo del snapshot, buscados por nombre en devices. En los que
+    // tienen páginas sucias, las que no están en el snapshot vuelven a su contenido inicial.
+    void RestoreDevices(const DeviceList& devices) const;
+    // Rehace el mapa de memoria de mmu (y vacía su TLB)
+    void RestoreRegions(MMU& mmu, const DeviceList& devices) const;
+
+    uint64_t GetPagesRestored() const { return pages_; }
+    uint64_t GetSize() const { return file_.GetSize(); }
+
+private:
+    struct Section {
+        uint32_t tag;
+        const uint8_t* data;
+        uint64_t size;
+    };
+    void RestorePages(const Section& section, MemoryDevice& device) const;
+
+    MappedFile file_;
+    std::vector<Section> sections_;
+    unsigned threads_;
+    mutable uint64_t pages_ = 0;
+};
@@ -0,0 +1,1482 @@
+// VMXKernels.cpp
+#include "VMXKernels.h"
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(PPC_VECTOR_SSE2)
+#include <immintrin.h>
+#define PPC_VMX_SIMD 1
+// MSVC deja usar cualquier intrínseco sin opciones de compilación; GCC/Clang lo piden por función
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define VMX_SSE41
+#define VMX_AVX2
+#else
+#define VMX_SSE41 __attribute__((target("sse4.1")))
+#define VMX_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+// Todos los kernels tienen la misma firma; cada uno usa sólo los operandos que necesita
+#define VMX_KERNEL(name) bool name(VectorRegister& d, [[maybe_unused]] const VectorRegister& a, \
+    [[maybe_unused]] const VectorRegister& b, [[maybe_unused]] const VectorRegister& c, [[maybe_unused]] uint32_t imm)
+
+namespace {
+
+// --- Carriles ---
+template <typename T> struct Lanes;
+#define VMX_LANES(T, field) \
+    template <> struct Lanes<T> { \
+        static T* Of(VectorRegister& v) { return v.field; } \
+        static const T* Of(const VectorRegister& v) { return v.field; } \
+    };
+VMX_LANES(uint8_t, u8)
+VMX_LANES(uint16_t, u16)
+VMX_LANES(uint32_t, u32)
+VMX_LANES(uint64_t, u64)
+VMX_LANES(int8_t, s8)
+VMX_LANES(int16_t, s16)
+VMX_LANES(int32_t, s32)
+VMX_LANES(float, f32)
+#undef VMX_LANES
+
+template <typename T> constexpr int LaneCount() { return int(16 / sizeof(T)); }
+
+// Elemento i de la ISA: los carriles van en orden inverso (VectorRegister.h)
+template <typename T> T Elem(const VectorRegister& v, int i) { return Lanes<T>::Of(v)[LaneCount<T>() - 1 - i]; }
+template <typename T> void SetElem(VectorRegister& v, int i, T x) { Lanes<T>::Of(v)[LaneCount<T>() - 1 - i] = x; }
+
+template <typename T>
+T Saturate(int64_t v, bool& sat) {
+	if (v > int64_t(std::numeric_limits<T>::max())) { sat = true; return std::numeric_limits<T>::max(); }
+	if (v < int64_t(std::numeric_limits<T>::min())) { sat = true; return std::numeric_limits<T>::min(); }
+	return T(v);
+}
+
+// vspltis*: SIMM de 5 bits con signo
+int32_t SignExtend5(uint32_t imm) {
+	return (imm & 0x10) ? int32_t(imm | ~0x1Fu) : int32_t(imm & 0x1F);
+}
+
+// --- Coma flotante ---
+// VMX propaga el primer operando NaN (silenciado) y, en operaciones inválidas, genera 0x7FC00000.
+// x86 genera 0xFFC00000 y en max/min devuelve el segundo operando: los resultados se corrigen.
+constexpr uint32_t QUIET_BIT = 0x00400000;
+constexpr uint32_t DEFAULT_NAN = 0x7FC00000;
+
+uint32_t FloatBits(float f) {
+	uint32_t u;
+	std::memcpy(&u, &f, 4);
+	return u;
+}
+
+float BitsFloat(uint32_t u) {
+	float f;
+	std::memcpy(&f, &u, 4);
+	return f;
+}
+
+float Quiet(float f) { return BitsFloat(FloatBits(f) | QUIET_BIT); }
+
+float PropagateNaN(float r, float a, float b, float c) {
+	if (std::isnan(a)) return Quiet(a);
+	if (std::isnan(b)) return Quiet(b);
+	if (std::isnan(c)) return Quiet(c);
+	if (std::isnan(r)) return BitsFloat(DEFAULT_NAN);
+	return r;
+}
+
+// 2^e exacto, |e| < 127
+float Pow2(int e) { return BitsFloat(uint32_t(127 + e) << 23); }
+
+namespace scalar {
+
+// --- Recorridos por carril: d puede ser a o b, así que se escribe en un temporal ---
+template <typename T, typename F>
+void Map(VectorRegister& d, const VectorRegister& a, const VectorRegister& b, F f) {
+	VectorRegister r;
+	const T* x = Lanes<T>::Of(a);
+	const T* y = Lanes<T>::Of(b);
+	T* z = Lanes<T>::Of(r);
+	for (int i = 0; i < LaneCount<T>(); ++i) z[i] = f(x[i], y[i]);
+	d = r;
+}
+
+template <typename F>
+void MapFloat(VectorRegister& d, const VectorRegister& a, const VectorRegister& b, const VectorRegister& c, F f) {
+	VectorRegister r;
+	for (int i = 0; i < 4; ++i) r.f32[i] = f(a.f32[i], b.f32[i], c.f32[i]);
+	d = r;
+}
+
+template <typename F>
+void MapFloatMask(VectorRegister& d, const VectorRegister& a, const VectorRegister& b, F f) {
+	VectorRegister r;
+	for (int i = 0; i < 4; ++i) r.u32[i] = f(a.f32[i], b.f32[i]);
+	d = r;
+}
+
+// --- Enteros: suma y resta ---
+template <typename T> VMX_KERNEL(AddModulo) {
+	Map<T>(d, a, b, [](T x, T y) { return T(x + y); });
+	return false;
+}
+
+template <typename T> VMX_KERNEL(SubModulo) {
+	Map<T>(d, a, b, [](T x, T y) { return T(x - y); });
+	return false;
+}
+
+template <typename T> VMX_KERNEL(AddSaturate) {
+	bool sat = false;
+	Map<T>(d, a, b, [&sat](T x, T y) { return Saturate<T>(int64_t(x) + int64_t(y), sat); });
+	return sat;
+}
+
+template <typename T> VMX_KERNEL(SubSaturate) {
+	bool sat = false;
+	Map<T>(d, a, b, [&sat](T x, T y) { return Saturate<T>(int64_t(x) - int64_t(y), sat); });
+	return sat;
+}
+
+VMX_KERNEL(vaddcuw) {
+	Map<uint32_t>(d, a, b, [](uint32_t x, uint32_t y) { return uint32_t(uint32_t(x + y) < x); });
+	return false;
+}
+
+VMX_KERNEL(vsubcuw) {
+	Map<uint32_t>(d, a, b, [](uint32_t x, uint32_t y) { return uint32_t(x >= y); });
+	return false;
+}
+
+template <typename T> VMX_KERNEL(Max) {
+	Map<T>(d, a, b, [](T x, T y) { return x > y ? x : y; });
+	return false;
+}
+
+template <typename T> VMX_KERNEL(Min) {
+	Map<T>(d, a, b, [](T x, T y) { return x < y ? x : y; });
+	return false;
+}
+
+// (x + y + 1) >> 1 sin perder el acarreo
+template <typename T> VMX_KERNEL(Average) {
+	Map<T>(d, a, b, [](T x, T y) { return T((int64_t(x) + int64_t(y) + 1) >> 1); });
+	return false;
+}
+
+// --- Enteros: productos ---
+// vmule*/vmulo*: elementos pares/impares de la ISA, resultado al doble de ancho
+template <typename T, typename W, int Odd> VMX_KERNEL(MultiplyWide) {
+	VectorRegister r;
+	for (int i = 0; i < LaneCount<W>(); ++i)
+		SetElem<W>(r, i, W(int64_t(Elem<T>(a, 2 * i + Odd)) * int64_t(Elem<T>(b, 2 * i + Odd))));
+	d = r;
+	return false;
+}
+
+template <bool Round> VMX_KERNEL(MultiplyHighAdd) {
+	VectorRegister r;
+	bool sat = false;
+	for (int i = 0; i < 8; ++i) {
+		const int32_t p = int32_t(Elem<int16_t>(a, i)) * Elem<int16_t>(b, i) + (Round ? 0x4000 : 0);
+		SetElem<int16_t>(r, i, Saturate<int16_t>(int64_t(p >> 15) + Elem<int16_t>(c, i), sat));
+	}
+	d = r;
+	return sat;
+}
+
+VMX_KERNEL(vmladduhm) {
+	VectorRegister r;
+	for (int i = 0; i < 8; ++i)
+		r.u16[i] = uint16_t(uint32_t(a.u16[i]) * b.u16[i] + c.u16[i]);
+	d = r;
+	return false;
+}
+
+// vmsum*: cada word de c más los productos de los elementos de a y b que caen en ese word
+template <typename A, typename B, typename Sum, bool Saturating> VMX_KERNEL(MultiplySum) {
+	constexpr int PER_WORD = LaneCount<A>() / 4;
+	VectorRegister r;
+	bool sat = false;
+	for (int i = 0; i < 4; ++i) {
+		int64_t s = int64_t(Elem<Sum>(c, i));
+		for (int j = 0; j < PER_WORD; ++j)
+			s += int64_t(Elem<A>(a, PER_WORD * i + j)) * int64_t(Elem<B>(b, PER_WORD * i + j));
+		SetElem<Sum>(r, i, Saturating ? Saturate<Sum>(s, sat) : Sum(uint32_t(s)));
+	}
+	d = r;
+	return sat;
+}
+
+// vsum4*: los elementos de a que caen en cada word más el word de b, con saturación
+template <typename A, typename Sum> VMX_KERNEL(SumAcross4) {
+	constexpr int PER_WORD = LaneCount<A>() / 4;
+	VectorRegister r;
+	bool sat = false;
+	for (int i = 0; i < 4; ++i) {
+		int64_t s = int64_t(Elem<Sum>(b, i));
+		for (int j = 0; j < PER_WORD; ++j) s += Elem<A>(a, PER_WORD * i + j);
+		SetElem<Sum>(r, i, Saturate<Sum>(s, sat));
+	}
+	d = r;
+	return sat;
+}
+
+VMX_KERNEL(vsum2sws) {
+	VectorRegister r{};
+	bool sat = false;
+	for (int i = 0; i < 2; ++i) {
+		const int64_t s = int64_t(Elem<int32_t>(a, 2 * i)) + Elem<int32_t>(a, 2 * i + 1) + Elem<int32_t>(b, 2 * i + 1);
+		SetElem<int32_t>(r, 2 * i + 1, Saturate<int32_t>(s, sat));
+	}
+	d = r;
+	return sat;
+}
+
+VMX_KERNEL(vsumsws) {
+	VectorRegister r{};
+	bool sat = false;
+	int64_t s = Elem<int32_t>(b, 3);
+	for (int i = 0; i < 4; ++i) s += Elem<int32_t>(a, i);
+	SetElem<int32_t>(r, 3, Saturate<int32_t>(s, sat));
+	d = r;
+	return sat;
+}
+
+// --- Lógicas ---
+VMX_KERNEL(vand) { Map<uint64_t>(d, a, b, [](uint64_t x, uint64_t y) { return x & y; }); return false; }
+VMX_KERNEL(vandc) { Map<uint64_t>(d, a, b, [](uint64_t x, uint64_t y) { return x & ~y; }); return false; }
+VMX_KERNEL(vor) { Map<uint64_t>(d, a, b, [](uint64_t x, uint64_t y) { return x | y; }); return false; }
+VMX_KERNEL(vxor) { Map<uint64_t>(d, a, b, [](uint64_t x, uint64_t y) { return x ^ y; }); return false; }
+VMX_KERNEL(vnor) { Map<uint64_t>(d, a, b, [](uint64_t x, uint64_t y) { return ~(x | y); }); return false; }
+
+VMX_KERNEL(vsel) {
+	VectorRegister r;
+	for (int i = 0; i < 2; ++i) r.u64[i] = (a.u64[i] & ~c.u64[i]) | (b.u64[i] & c.u64[i]);
+	d = r;
+	return false;
+}
+
+// --- Desplazamientos por elemento: la cuenta es el elemento de b módulo el ancho ---
+template <typename T> VMX_KERNEL(ShiftLeft) {
+	Map<T>(d, a, b, [](T x, T y) { return T(x << (y & (sizeof(T) * 8 - 1))); });
+	return false;
+}
+
+// Lógico para T sin signo, aritmético con signo
+template <typename T> VMX_KERNEL(ShiftRight) {
+	Map<T>(d, a, b, [](T x, T y) { return T(x >> (y & (sizeof(T) * 8 - 1))); });
+	return false;
+}
+
+template <typename T> VMX_KERNEL(RotateLeft) {
+	constexpr unsigned BITS = sizeof(T) * 8;
+	Map<T>(d, a, b, [](T x, T y) {
+		const unsigned n = y & (BITS - 1);
+		return T((x << n) | (x >> ((BITS - n) & (BITS - 1))));
+	});
+	return false;
+}
+
+// --- Desplazamientos del registro entero (índices de la ISA: byte 0 = el más significativo) ---
+VMX_KERNEL(vsl) {
+	const unsigned sh = b.Byte(15) & 7;
+	VectorRegister r;
+	for (int i = 0; i < 16; ++i)
+		r.SetByte(i, uint8_t((a.Byte(i) << sh) | (i < 15 ? a.Byte(i + 1) >> (8 - sh) : 0)));
+	d = r;
+	return false;
+}
+
+VMX_KERNEL(vsr) {
+	const unsigned sh = b.Byte(15) & 7;
+	VectorRegister r;
+	for (int i = 0; i < 16; ++i)
+		r.SetByte(i, uint8_t((a.Byte(i) >> sh) | (i > 0 ? a.Byte(i - 1) << (8 - sh) : 0)));
+	d = r;
+	return false;
+}
+
+VMX_KERNEL(vslo) {
+	const int n = (b.Byte(15) >> 3) & 0xF;
+	VectorRegister r;
+	for (int i = 0; i < 16; ++i) r.SetByte(i, i + n < 16 ? a.Byte(i + n) : 0);
+	d = r;
+	return false;
+}
+
+VMX_KERNEL(vsro) {
+	const int n = (b.Byte(15) >> 3) & 0xF;
+	VectorRegister r;
+	for (int i = 0; i < 16; ++i) r.SetByte(i, i >= n ? a.Byte(i - n) : 0);
+	d = r;
+	return false;
+}
+
+// vsldoi: bytes sh..sh+15 de a:b
+VMX_KERNEL(vsldoi) {
+	const int sh = int(imm & 0xF);
+	VectorRegister r;
+	for (int i = 0; i < 16; ++i) r.SetByte(i, i + sh < 16 ? a.Byte(i + sh) : b.Byte(i + sh - 16));
+	d = r;
+	return false;
+}
+
+// --- Comparaciones ---
+template <typename T> VMX_KERNEL(CompareEqual) {
+	Map<T>(d, a, b, [](T x, T y) { return T(x == y ? -1 : 0); });
+	return false;
+}
+
+template <typename T> VMX_KERNEL(CompareGreater) {
+	Map<T>(d, a, b, [](T x, T y) { return T(x > y ? -1 : 0); });
+	return false;
+}
+
+VMX_KERNEL(vcmpeqfp) { MapFloatMask(d, a, b, [](float x, float y) { return x == y ? 0xFFFFFFFFu : 0u; }); return false; }
+VMX_KERNEL(vcmpgefp) { MapFloatMask(d, a, b, [](float x, float y) { return x >= y ? 0xFFFFFFFFu : 0u; }); return false; }
+VMX_KERNEL(vcmpgtfp) { MapFloatMask(d, a, b, [](float x, float y) { return x > y ? 0xFFFFFFFFu : 0u; }); return false; }
+
+// vcmpbfp: bit 0 si no a <= b, bit 1 si no a >= -b (con NaN, los dos)
+VMX_KERNEL(vcmpbfp) {
+	MapFloatMask(d, a, b, [](float x, float y) {
+		return (x <= y ? 0u : 0x80000000u) | (x >= -y ? 0u : 0x40000000u);
+	});
+	return false;
+}
+
+// --- Permutaciones ---
+VMX_KERNEL(vperm) {
+	VectorRegister r;
+	for (int i = 0; i < 16; ++i) {
+		const int j = c.Byte(i) & 0x1F;
+		r.SetByte(i, j < 16 ? a.Byte(j) : b.Byte(j - 16));
+	}
+	d = r;
+	return false;
+}
+
+template <typename T> VMX_KERNEL(MergeHigh) {
+	constexpr int N = LaneCount<T>();
+	VectorRegister r;
+	for (int i = 0; i < N / 2; ++i) {
+		SetElem<T>(r, 2 * i, Elem<T>(a, i));
+		SetElem<T>(r, 2 * i + 1, Elem<T>(b, i));
+	}
+	d = r;
+	return false;
+}
+
+template <typename T> VMX_KERNEL(MergeLow) {
+	constexpr int N = LaneCount<T>();
+	VectorRegister r;
+	for (int i = 0; i < N / 2; ++i) {
+		SetElem<T>(r, 2 * i, Elem<T>(a, N / 2 + i));
+		SetElem<T>(r, 2 * i + 1, Elem<T>(b, N / 2 + i));
+	}
+	d = r;
+	return false;
+}
+
+template <typename T> VMX_KERNEL(Splat) {
+	const T x = Elem<T>(b, int(imm) & (LaneCount<T>() - 1));
+	VectorRegister r;
+	for (int i = 0; i < LaneCount<T>(); ++i) SetElem<T>(r, i, x);
+	d = r;
+	return false;
+}
+
+template <typename T> VMX_KERNEL(SplatImmediate) {
+	const T x = T(SignExtend5(imm));
+	VectorRegister r;
+	for (int i = 0; i < LaneCount<T>(); ++i) SetElem<T>(r, i, x);
+	d = r;
+	return false;
+}
+
+// --- Empaquetado: los elementos de a y después los de b, a la mitad de ancho ---
+template <typename Src, typename Dst, bool Saturating> VMX_KERNEL(Pack) {
+	constexpr int N = LaneCount<Src>();
+	VectorRegister r;
+	bool sat = false;
+	for (int i = 0; i < N; ++i) {
+		const Src x = Elem<Src>(a, i), y = Elem<Src>(b, i);
+		SetElem<Dst>(r, i, Saturating ? Saturate<Dst>(x, sat) : Dst(x));
+		SetElem<Dst>(r, N + i, Saturating ? Saturate<Dst>(y, sat) : Dst(y));
+	}
+	d = r;
+	return sat;
+}
+
+// Píxel 8:8:8:8 -> 1:5:5:5
+uint16_t PackPixel(uint32_t w) {
+	return uint16_t((((w >> 24) & 1) << 15) | (((w >> 19) & 0x1F) << 10) | (((w >> 11) & 0x1F) << 5) | ((w >> 3) & 0x1F));
+}
+
+VMX_KERNEL(vpkpx) {
+	VectorRegister r;
+	for (int i = 0; i < 4; ++i) {
+		r.SetHalfWord(i, PackPixel(a.Word(i)));
+		r.SetHalfWord(4 + i, PackPixel(b.Word(i)));
+	}
+	d = r;
+	return false;
+}
+
+// vupk*: mitad alta (elementos 0..N/2-1) o baja de b, extendida con signo
+template <typename Src, typename Dst, bool Low> VMX_KERNEL(Unpack) {
+	constexpr int N = LaneCount<Dst>();
+	VectorRegister r;
+	for (int i = 0; i < N; ++i) SetElem<Dst>(r, i, Dst(Elem<Src>(b, (Low ? N : 0) + i)));
+	d = r;
+	return false;
+}
+
+// Píxel 1:5:5:5 -> 8:8:8:8, con el bit alto extendido a todo el byte
+template <bool Low> VMX_KERNEL(UnpackPixel) {
+	VectorRegister r;
+	for (int i = 0; i < 4; ++i) {
+		const uint32_t h = b.HalfWord((Low ? 4 : 0) + i);
+		r.SetWord(i, ((h & 0x8000) ? 0xFF000000u : 0u) | (((h >> 10) & 0x1F) << 16) | (((h >> 5) & 0x1F) << 8) | (h & 0x1F));
+	}
+	d = r;
+	return false;
+}
+
+// --- Coma flotante (siempre redondeo al más cercano; NJ no se modela) ---
+float MaxFloat(float x, float y) {
+	if (std::isnan(x) || std::isnan(y)) return PropagateNaN(x, x, y, y);
+	if (x == y) return BitsFloat(FloatBits(x) & FloatBits(y)); // max(+0, -0) = +0
+	return x > y ? x : y;
+}
+
+float MinFloat(float x, float y) {
+	if (std::isnan(x) || std::isnan(y)) return PropagateNaN(x, x, y, y);
+	if (x == y) return BitsFloat(FloatBits(x) | FloatBits(y)); // min(+0, -0) = -0
+	return x < y ? x : y;
+}
+
+VMX_KERNEL(vaddfp) { MapFloat(d, a, b, c, [](float x, float y, float) { return PropagateNaN(x + y, x, y, y); }); return false; }
+VMX_KERNEL(vsubfp) { MapFloat(d, a, b, c, [](float x, float y, float) { return PropagateNaN(x - y, x, y, y); }); return false; }
+VMX_KERNEL(vmulfp128) { MapFloat(d, a, b, c, [](float x, float y, float) { return PropagateNaN(x * y, x, y, y); }); return false; }
+VMX_KERNEL(vmaxfp) { MapFloat(d, a, b, c, [](float x, float y, float) { return MaxFloat(x, y); }); return false; }
+VMX_KERNEL(vminfp) { MapFloat(d, a, b, c, [](float x, float y, float) { return MinFloat(x, y); }); return false; }
+
+// vmaddfp/vnmsubfp son fusionadas: un solo redondeo
+VMX_KERNEL(vmaddfp) {
+	MapFloat(d, a, b, c, [](float x, float y, float z) { return PropagateNaN(std::fma(x, z, y), x, y, z); });
+	return false;
+}
+
+VMX_KERNEL(vnmsubfp) {
+	MapFloat(d, a, b, c, [](float x, float y, float z) { return PropagateNaN(-std::fma(x, z, -y), x, y, z); });
+	return false;
+}
+
+// VMX128: el sumando o uno de los factores es vD (c)
+VMX_KERNEL(vmaddfp128) {
+	MapFloat(d, a, b, c, [](float x, float y, float z) { return PropagateNaN(std::fma(x, y, z), x, y, z); });
+	return false;
+}
+
+VMX_KERNEL(vmaddcfp128) {
+	MapFloat(d, a, b, c, [](float x, float y, float z) { return PropagateNaN(std::fma(x, z, y), x, y, z); });
+	return false;
+}
+
+VMX_KERNEL(vnmsubfp128) {
+	MapFloat(d, a, b, c, [](float x, float y, float z) { return PropagateNaN(-std::fma(x, y, -z), x, y, z); });
+	return false;
+}
+
+// Estimaciones: se calcula el valor exacto, que está dentro de la precisión que pide la ISA
+VMX_KERNEL(vrefp) { MapFloat(d, a, b, c, [](float, float y, float) { return PropagateNaN(1.0f / y, y, y, y); }); return false; }
+VMX_KERNEL(vrsqrtefp) { MapFloat(d, a, b, c, [](float, float y, float) { return PropagateNaN(1.0f / std::sqrt(y), y, y, y); }); return false; }
+VMX_KERNEL(vexptefp) { MapFloat(d, a, b, c, [](float, float y, float) { return PropagateNaN(std::exp2(y), y, y, y); }); return false; }
+VMX_KERNEL(vlogefp) { MapFloat(d, a, b, c, [](float, float y, float) { return PropagateNaN(std::log2(y), y, y, y); }); return false; }
+
+VMX_KERNEL(vrfin) { MapFloat(d, a, b, c, [](float, float y, float) { return PropagateNaN(std::nearbyint(y), y, y, y); }); return false; }
+VMX_KERNEL(vrfiz) { MapFloat(d, a, b, c, [](float, float y, float) { return PropagateNaN(std::trunc(y), y, y, y); }); return false; }
+VMX_KERNEL(vrfip) { MapFloat(d, a, b, c, [](float, float y, float) { return PropagateNaN(std::ceil(y), y, y, y); }); return false; }
+VMX_KERNEL(vrfim) { MapFloat(d, a, b, c, [](float, float y, float) { return PropagateNaN(std::floor(y), y, y, y); }); return false; }
+
+// Conversiones con coma fija: imm es el número de bits fraccionarios
+VMX_KERNEL(vcfux) {
+	VectorRegister r;
+	const float scale = Pow2(-int(imm & 0x1F));
+	for (int i = 0; i < 4; ++i) r.f32[i] = float(b.u32[i]) * scale;
+	d = r;
+	return false;
+}
+
+VMX_KERNEL(vcfsx) {
+	VectorRegister r;
+	const float scale = Pow2(-int(imm & 0x1F));
+	for (int i = 0; i < 4; ++i) r.f32[i] = float(b.s32[i]) * scale;
+	d = r;
+	return false;
+}
+
+// Truncan hacia cero y saturan; NaN da 0
+VMX_KERNEL(vctsxs) {
+	VectorRegister r;
+	bool sat = false;
+	const float scale = Pow2(int(imm & 0x1F));
+	for (int i = 0; i < 4; ++i) {
+		const float x = b.f32[i] * scale;
+		if (std::isnan(x)) r.s32[i] = 0;
+		else if (x >= 2147483648.0f) { r.s32[i] = std::numeric_limits<int32_t>::max(); sat = true; }
+		else if (x < -2147483648.0f) { r.s32[i] = std::numeric_limits<int32_t>::min(); sat = true; }
+		else r.s32[i] = int32_t(x);
+	}
+	d = r;
+	return sat;
+}
+
+VMX_KERNEL(vctuxs) {
+	VectorRegister r;
+	bool sat = false;
+	const float scale = Pow2(int(imm & 0x1F));
+	for (int i = 0; i < 4; ++i) {
+		const float x = b.f32[i] * scale;
+		if (std::isnan(x)) r.u32[i] = 0;
+		else if (x >= 4294967296.0f) { r.u32[i] = 0xFFFFFFFF; sat = true; }
+		else if (x <= -1.0f) { r.u32[i] = 0; sat = true; }
+		else r.u32[i] = x > 0.0f ? uint32_t(x) : 0;
+	}
+	d = r;
+	return sat;
+}
+
+// --- VMX128 ---
+// vmsum3fp128/vmsum4fp128: producto escalar en orden x, y, z, w (sin fusionar) en los 4 elementos
+template <int N> VMX_KERNEL(DotProduct) {
+	float s = a.Float(0) * b.Float(0);
+	for (int i = 1; i < N; ++i) s += a.Float(i) * b.Float(i);
+	if (std::isnan(s)) {
+		s = BitsFloat(DEFAULT_NAN);
+		for (int i = N - 1; i >= 0; --i) {
+			if (std::isnan(b.Float(i))) s = Quiet(b.Float(i));
+			if (std::isnan(a.Float(i))) s = Quiet(a.Float(i));
+		}
+	}
+	VectorRegister r;
+	for (int i = 0; i < 4; ++i) r.f32[i] = s;
+	d = r;
+	return false;
+}
+
+// vpermwi128: word i = word ((imm >> (6 - 2i)) & 3) de b
+VMX_KERNEL(vpermwi128) {
+	VectorRegister r;
+	for (int i = 0; i < 4; ++i) r.SetWord(i, b.Word((imm >> (6 - 2 * i)) & 3));
+	d = r;
+	return false;
+}
+
+// vrlimi128: b rotado (imm >> 5) words a la izquierda, insertado en vD (c) según la máscara imm & 0xF
+VMX_KERNEL(vrlimi128) {
+	const uint32_t mask = imm & 0xF, rot = (imm >> 5) & 3;
+	VectorRegister r = c;
+	for (int i = 0; i < 4; ++i)
+		if ((mask >> (3 - i)) & 1) r.SetWord(i, b.Word((i + rot) & 3));
+	d = r;
+	return false;
+}
+
+void Fill(VMXKernelTable& t) {
+	const auto set = [&t](VMXOp op, VMXKernel k) {
+		t.kernels[int(op)] = k;
+		t.native[int(op)] = true;
+	};
+	set(VMXOp::vaddubm, AddModulo<uint8_t>);
+	set(VMXOp::vadduhm, AddModulo<uint16_t>);
+	set(VMXOp::vadduwm, AddModulo<uint32_t>);
+	set(VMXOp::vaddubs, AddSaturate<uint8_t>);
+	set(VMXOp::vadduhs, AddSaturate<uint16_t>);
+	set(VMXOp::vadduws, AddSaturate<uint32_t>);
+	set(VMXOp::vaddsbs, AddSaturate<int8_t>);
+	set(VMXOp::vaddshs, AddSaturate<int16_t>);
+	set(VMXOp::vaddsws, AddSaturate<int32_t>);
+	set(VMXOp::vaddcuw, vaddcuw);
+	set(VMXOp::vsububm, SubModulo<uint8_t>);
+	set(VMXOp::vsubuhm, SubModulo<uint16_t>);
+	set(VMXOp::vsubuwm, SubModulo<uint32_t>);
+	set(VMXOp::vsububs, SubSaturate<uint8_t>);
+	set(VMXOp::vsubuhs, SubSaturate<uint16_t>);
+	set(VMXOp::vsubuws, SubSaturate<uint32_t>);
+	set(VMXOp::vsubsbs, SubSaturate<int8_t>);
+	set(VMXOp::vsubshs, SubSaturate<int16_t>);
+	set(VMXOp::vsubsws, SubSaturate<int32_t>);
+	set(VMXOp::vsubcuw, vsubcuw);
+	set(VMXOp::vmaxub, Max<uint8_t>);
+	set(VMXOp::vmaxuh, Max<uint16_t>);
+	set(VMXOp::vmaxuw, Max<uint32_t>);
+	set(VMXOp::vmaxsb, Max<int8_t>);
+	set(VMXOp::vmaxsh, Max<int16_t>);
+	set(VMXOp::vmaxsw, Max<int32_t>);
+	set(VMXOp::vminub, Min<uint8_t>);
+	set(VMXOp::vminuh, Min<uint16_t>);
+	set(VMXOp::vminuw, Min<uint32_t>);
+	set(VMXOp::vminsb, Min<int8_t>);
+	set(VMXOp::vminsh, Min<int16_t>);
+	set(VMXOp::vminsw, Min<int32_t>);
+	set(VMXOp::vavgub, Average<uint8_t>);
+	set(VMXOp::vavguh, Average<uint16_t>);
+	set(VMXOp::vavguw, Average<uint32_t>);
+	set(VMXOp::vavgsb, Average<int8_t>);
+	set(VMXOp::vavgsh, Average<int16_t>);
+	set(VMXOp::vavgsw, Average<int32_t>);
+
+	set(VMXOp::vmuleub, MultiplyWide<uint8_t, uint16_t, 0>);
+	set(VMXOp::vmuleuh, MultiplyWide<uint16_t, uint32_t, 0>);
+	set(VMXOp::vmulesb, MultiplyWide<int8_t, int16_t, 0>);
+	set(VMXOp::vmulesh, MultiplyWide<int16_t, int32_t, 0>);
+	set(VMXOp::vmuloub, MultiplyWide<uint8_t, uint16_t, 1>);
+	set(VMXOp::vmulouh, MultiplyWide<uint16_t, uint32_t, 1>);
+	set(VMXOp::vmulosb, MultiplyWide<int8_t, int16_t, 1>);
+	set(VMXOp::vmulosh, MultiplyWide<int16_t, int32_t, 1>);
+	set(VMXOp::vmhaddshs, MultiplyHighAdd<false>);
+	set(VMXOp::vmhraddshs, MultiplyHighAdd<true>);
+	set(VMXOp::vmladduhm, vmladduhm);
+	set(VMXOp::vmsumubm, MultiplySum<uint8_t, uint8_t, uint32_t, false>);
+	set(VMXOp::vmsummbm, MultiplySum<int8_t, uint8_t, int32_t, false>);
+	set(VMXOp::vmsumuhm, MultiplySum<uint16_t, uint16_t, uint32_t, false>);
+	set(VMXOp::vmsumuhs, MultiplySum<uint16_t, uint16_t, uint32_t, true>);
+	set(VMXOp::vmsumshm, MultiplySum<int16_t, int16_t, int32_t, false>);
+	set(VMXOp::vmsumshs, MultiplySum<int16_t, int16_t, int32_t, true>);
+	set(VMXOp::vsum4ubs, SumAcross4<uint8_t, uint32_t>);
+	set(VMXOp::vsum4sbs, SumAcross4<int8_t, int32_t>);
+	set(VMXOp::vsum4shs, SumAcross4<int16_t, int32_t>);
+	set(VMXOp::vsum2sws, vsum2sws);
+	set(VMXOp::vsumsws, vsumsws);
+
+	set(VMXOp::vand, vand);
+	set(VMXOp::vandc, vandc);
+	set(VMXOp::vor, vor);
+	set(VMXOp::vxor, vxor);
+	set(VMXOp::vnor, vnor);
+	set(VMXOp::vsel, vsel);
+	set(VMXOp::vslb, ShiftLeft<uint8_t>);
+	set(VMXOp::vslh, ShiftLeft<uint16_t>);
+	set(VMXOp::vslw, ShiftLeft<uint32_t>);
+	set(VMXOp::vsrb, ShiftRight<uint8_t>);
+	set(VMXOp::vsrh, ShiftRight<uint16_t>);
+	set(VMXOp::vsrw, ShiftRight<uint32_t>);
+	set(VMXOp::vsrab, ShiftRight<int8_t>);
+	set(VMXOp::vsrah, ShiftRight<int16_t>);
+	set(VMXOp::vsraw, ShiftRight<int32_t>);
+	set(VMXOp::vrlb, RotateLeft<uint8_t>);
+	set(VMXOp::vrlh, RotateLeft<uint16_t>);
+	set(VMXOp::vrlw, RotateLeft<uint32_t>);
+	set(VMXOp::vsl, vsl);
+	set(VMXOp::vsr, vsr);
+	set(VMXOp::vslo, vslo);
+	set(VMXOp::vsro, vsro);
+	set(VMXOp::vsldoi, vsldoi);
+
+	set(VMXOp::vcmpequb, CompareEqual<uint8_t>);
+	set(VMXOp::vcmpequh, CompareEqual<uint16_t>);
+	set(VMXOp::vcmpequw, CompareEqual<uint32_t>);
+	set(VMXOp::vcmpgtub, CompareGreater<uint8_t>);
+	set(VMXOp::vcmpgtuh, CompareGreater<uint16_t>);
+	set(VMXOp::vcmpgtuw, CompareGreater<uint32_t>);
+	set(VMXOp::vcmpgtsb, CompareGreater<int8_t>);
+	set(VMXOp::vcmpgtsh, CompareGreater<int16_t>);
+	set(VMXOp::vcmpgtsw, CompareGreater<int32_t>);
+	set(VMXOp::vcmpeqfp, vcmpeqfp);
+	set(VMXOp::vcmpgefp, vcmpgefp);
+	set(VMXOp::vcmpgtfp, vcmpgtfp);
+	set(VMXOp::vcmpbfp, vcmpbfp);
+
+	set(VMXOp::vperm, vperm);
+	set(VMXOp::vmrghb, MergeHigh<uint8_t>);
+	set(VMXOp::vmrghh, MergeHigh<uint16_t>);
+	set(VMXOp::vmrghw, MergeHigh<uint32_t>);
+	set(VMXOp::vmrglb, MergeLow<uint8_t>);
+	set(VMXOp::vmrglh, MergeLow<uint16_t>);
+	set(VMXOp::vmrglw, MergeLow<uint32_t>);
+	set(VMXOp::vspltb, Splat<uint8_t>);
+	set(VMXOp::vsplth, Splat<uint16_t>);
+	set(VMXOp::vspltw, Splat<uint32_t>);
+	set(VMXOp::vspltisb, SplatImmediate<int8_t>);
+	set(VMXOp::vspltish, SplatImmediate<int16_t>);
+	set(VMXOp::vspltisw, SplatImmediate<int32_t>);
+
+	set(VMXOp::vpkuhum, Pack<uint16_t, uint8_t, false>);
+	set(VMXOp::vpkuwum, Pack<uint32_t, uint16_t, false>);
+	set(VMXOp::vpkuhus, Pack<uint16_t, uint8_t, true>);
+	set(VMXOp::vpkuwus, Pack<uint32_t, uint16_t, true>);
+	set(VMXOp::vpkshus, Pack<int16_t, uint8_t, true>);
+	set(VMXOp::vpkswus, Pack<int32_t, uint16_t, true>);
+	set(VMXOp::vpkshss, Pack<int16_t, int8_t, true>);
+	set(VMXOp::vpkswss, Pack<int32_t, int16_t, true>);
+	set(VMXOp::vpkpx, vpkpx);
+	set(VMXOp::vupkhsb, Unpack<int8_t, int16_t, false>);
+	set(VMXOp::vupkhsh, Unpack<int16_t, int32_t, false>);
+	set(VMXOp::vupklsb, Unpack<int8_t, int16_t, true>);
+	set(VMXOp::vupklsh, Unpack<int16_t, int32_t, true>);
+	set(VMXOp::vupkhpx, UnpackPixel<false>);
+	set(VMXOp::vupklpx, UnpackPixel<true>);
+
+	set(VMXOp::vaddfp, vaddfp);
+	set(VMXOp::vsubfp, vsubfp);
+	set(VMXOp::vmaddfp, vmaddfp);
+	set(VMXOp::vnmsubfp, vnmsubfp);
+	set(VMXOp::vmaxfp, vmaxfp);
+	set(VMXOp::vminfp, vminfp);
+	set(VMXOp::vrefp, vrefp);
+	set(VMXOp::vrsqrtefp, vrsqrtefp);
+	set(VMXOp::vexptefp, vexptefp);
+	set(VMXOp::vlogefp, vlogefp);
+	set(VMXOp::vrfin, vrfin);
+	set(VMXOp::vrfiz, vrfiz);
+	set(VMXOp::vrfip, vrfip);
+	set(VMXOp::vrfim, vrfim);
+	set(VMXOp::vcfux, vcfux);
+	set(VMXOp::vcfsx, vcfsx);
+	set(VMXOp::vctuxs, vctuxs);
+	set(VMXOp::vctsxs, vctsxs);
+
+	set(VMXOp::vmulfp128, vmulfp128);
+	set(VMXOp::vmaddfp128, vmaddfp128);
+	set(VMXOp::vmaddcfp128, vmaddcfp128);
+	set(VMXOp::vnmsubfp128, vnmsubfp128);
+	set(VMXOp::vmsum3fp128, DotProduct<3>);
+	set(VMXOp::vmsum4fp128, DotProduct<4>);
+	set(VMXOp::vpermwi128, vpermwi128);
+	set(VMXOp::vrlimi128, vrlimi128);
+}
+
+} // namespace scalar
+
+#if defined(PPC_VMX_SIMD)
+namespace sse41 {
+
+VMX_SSE41 inline __m128i Load(const VectorRegister& v) { return _mm_load_si128(&v.m128); }
+VMX_SSE41 inline __m128 LoadFloat(const VectorRegister& v) { return _mm_load_ps(v.f32); }
+VMX_SSE41 inline void Store(VectorRegister& d, __m128i x) { _mm_store_si128(&d.m128, x); }
+VMX_SSE41 inline void StoreFloat(VectorRegister& d, __m128 x) { _mm_store_ps(d.f32, x); }
+VMX_SSE41 inline bool Differ(__m128i x, __m128i y) { return _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF; }
+// Clamp de x a [lo, hi] distinto de x: hubo saturación
+VMX_SSE41 inline bool OutOfRange16(__m128i x, int lo, int hi) {
+	return Differ(x, _mm_min_epi16(_mm_max_epi16(x, _mm_set1_epi16(short(lo))), _mm_set1_epi16(short(hi))));
+}
+VMX_SSE41 inline bool OutOfRange32(__m128i x, int lo, int hi) {
+	return Differ(x, _mm_min_epi32(_mm_max_epi32(x, _mm_set1_epi32(lo)), _mm_set1_epi32(hi)));
+}
+// Índices de carril 0..15, para construir máscaras de pshufb
+VMX_SSE41 inline __m128i LaneIndex() { return _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15); }
+
+VMX_SSE41 inline __m128 Quiet(__m128 x) { return _mm_or_ps(x, _mm_castsi128_ps(_mm_set1_epi32(int(QUIET_BIT)))); }
+
+// Misma regla que PropagateNaN escalar, carril a carril
+VMX_SSE41 inline __m128 PropagateNaN(__m128 r, __m128 a, __m128 b, __m128 c) {
+	r = _mm_blendv_ps(r, _mm_castsi128_ps(_mm_set1_epi32(int(DEFAULT_NAN))), _mm_cmpunord_ps(r, r));
+	r = _mm_blendv_ps(r, Quiet(c), _mm_cmpunord_ps(c, c));
+	r = _mm_blendv_ps(r, Quiet(b), _mm_cmpunord_ps(b, b));
+	return _mm_blendv_ps(r, Quiet(a), _mm_cmpunord_ps(a, a));
+}
+
+#define VMX_SIMD_BINARY(name, expr) \
+	VMX_SSE41 VMX_KERNEL(name) { \
+		const __m128i x = Load(a), y = Load(b); \
+		Store(d, expr); \
+		return false; \
+	}
+// Con saturación: hubo saturación si el resultado difiere del que da la versión modular
+#define VMX_SIMD_SATURATE(name, saturated, wrapped) \
+	VMX_SSE41 VMX_KERNEL(name) { \
+		const __m128i x = Load(a), y = Load(b); \
+		const __m128i r = saturated; \
+		Store(d, r); \
+		return Differ(r, wrapped); \
+	}
+#define VMX_SIMD_FLOAT(name, expr) \
+	VMX_SSE41 VMX_KERNEL(name) { \
+		const __m128 x = LoadFloat(a), y = LoadFloat(b); \
+		StoreFloat(d, PropagateNaN(expr, x, y, y)); \
+		return false; \
+	}
+#define VMX_SIMD_UNARY_FLOAT(name, expr) \
+	VMX_SSE41 VMX_KERNEL(name) { \
+		const __m128 y = LoadFloat(b); \
+		StoreFloat(d, PropagateNaN(expr, y, y, y)); \
+		return false; \
+	}
+#define VMX_SIMD_FLOAT_MASK(name, expr) \
+	VMX_SSE41 VMX_KERNEL(name) { \
+		const __m128 x = LoadFloat(a), y = LoadFloat(b); \
+		Store(d, _mm_castps_si128(expr)); \
+		return false; \
+	}
+
+// Comparaciones sin signo: se invierte el bit alto y se compara con signo
+#define BIAS8 _mm_set1_epi8(char(0x80))
+#define BIAS16 _mm_set1_epi16(short(0x8000))
+#define BIAS32 _mm_set1_epi32(int(0x80000000))
+
+// --- Enteros: suma y resta ---
+VMX_SIMD_BINARY(vaddubm, _mm_add_epi8(x, y))
+VMX_SIMD_BINARY(vadduhm, _mm_add_epi16(x, y))
+VMX_SIMD_BINARY(vadduwm, _mm_add_epi32(x, y))
+VMX_SIMD_BINARY(vsububm, _mm_sub_epi8(x, y))
+VMX_SIMD_BINARY(vsubuhm, _mm_sub_epi16(x, y))
+VMX_SIMD_BINARY(vsubuwm, _mm_sub_epi32(x, y))
+VMX_SIMD_SATURATE(vaddubs, _mm_adds_epu8(x, y), _mm_add_epi8(x, y))
+VMX_SIMD_SATURATE(vadduhs, _mm_adds_epu16(x, y), _mm_add_epi16(x, y))
+VMX_SIMD_SATURATE(vaddsbs, _mm_adds_epi8(x, y), _mm_add_epi8(x, y))
+VMX_SIMD_SATURATE(vaddshs, _mm_adds_epi16(x, y), _mm_add_epi16(x, y))
+VMX_SIMD_SATURATE(vsububs, _mm_subs_epu8(x, y), _mm_sub_epi8(x, y))
+VMX_SIMD_SATURATE(vsubuhs, _mm_subs_epu16(x, y), _mm_sub_epi16(x, y))
+VMX_SIMD_SATURATE(vsubsbs, _mm_subs_epi8(x, y), _mm_sub_epi8(x, y))
+VMX_SIMD_SATURATE(vsubshs, _mm_subs_epi16(x, y), _mm_sub_epi16(x, y))
+
+// 32 bits: no hay suma saturada, se detecta el desbordamiento
+VMX_SSE41 VMX_KERNEL(vadduws) {
+	const __m128i x = Load(a), y = Load(b), r = _mm_add_epi32(x, y);
+	const __m128i carry = _mm_cmpgt_epi32(_mm_xor_si128(x, BIAS32), _mm_xor_si128(r, BIAS32));
+	Store(d, _mm_or_si128(r, carry));
+	return _mm_movemask_epi8(carry) != 0;
+}
+
+VMX_SSE41 VMX_KERNEL(vsubuws) {
+	const __m128i x = Load(a), y = Load(b), r = _mm_sub_epi32(x, y);
+	const __m128i borrow = _mm_cmpgt_epi32(_mm_xor_si128(y, BIAS32), _mm_xor_si128(x, BIAS32));
+	Store(d, _mm_andnot_si128(borrow, r));
+	return _mm_movemask_epi8(borrow) != 0;
+}
+
+// Desborda si los operandos tienen el mismo signo (resta: distinto) y el resultado otro; se
+// satura hacia el signo de x
+VMX_SSE41 VMX_KERNEL(vaddsws) {
+	const __m128i x = Load(a), y = Load(b), r = _mm_add_epi32(x, y);
+	const __m128i overflow = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(x, r), _mm_xor_si128(y, r)), 31);
+	const __m128i limit = _mm_xor_si128(_mm_srai_epi32(x, 31), _mm_set1_epi32(0x7FFFFFFF));
+	Store(d, _mm_blendv_epi8(r, limit, overflow));
+	return _mm_movemask_epi8(overflow) != 0;
+}
+
+VMX_SSE41 VMX_KERNEL(vsubsws) {
+	const __m128i x = Load(a), y = Load(b), r = _mm_sub_epi32(x, y);
+	const __m128i overflow = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(x, y), _mm_xor_si128(x, r)), 31);
+	const __m128i limit = _mm_xor_si128(_mm_srai_epi32(x, 31), _mm_set1_epi32(0x7FFFFFFF));
+	Store(d, _mm_blendv_epi8(r, limit, overflow));
+	return _mm_movemask_epi8(overflow) != 0;
+}
+
+VMX_SIMD_BINARY(vaddcuw, _mm_srli_epi32(_mm_cmpgt_epi32(_mm_xor_si128(x, BIAS32), _mm_xor_si128(_mm_add_epi32(x, y), BIAS32)), 31))
+VMX_SIMD_BINARY(vsubcuw, _mm_andnot_si128(_mm_cmpgt_epi32(_mm_xor_si128(y, BIAS32), _mm_xor_si128(x, BIAS32)), _mm_set1_epi32(1)))
+
+VMX_SIMD_BINARY(vmaxub, _mm_max_epu8(x, y))
+VMX_SIMD_BINARY(vmaxuh, _mm_max_epu16(x, y))
+VMX_SIMD_BINARY(vmaxuw, _mm_max_epu32(x, y))
+VMX_SIMD_BINARY(vmaxsb, _mm_max_epi8(x, y))
+VMX_SIMD_BINARY(vmaxsh, _mm_max_epi16(x, y))
+VMX_SIMD_BINARY(vmaxsw, _mm_max_epi32(x, y))
+VMX_SIMD_BINARY(vminub, _mm_min_epu8(x, y))
+VMX_SIMD_BINARY(vminuh, _mm_min_epu16(x, y))
+VMX_SIMD_BINARY(vminuw, _mm_min_epu32(x, y))
+VMX_SIMD_BINARY(vminsb, _mm_min_epi8(x, y))
+VMX_SIMD_BINARY(vminsh, _mm_min_epi16(x, y))
+VMX_SIMD_BINARY(vminsw, _mm_min_epi32(x, y))
+
+// pavg redondea hacia arriba como VMX; con signo, sobre los valores desplazados a sin signo
+VMX_SIMD_BINARY(vavgub, _mm_avg_epu8(x, y))
+VMX_SIMD_BINARY(vavguh, _mm_avg_epu16(x, y))
+VMX_SIMD_BINARY(vavgsb, _mm_xor_si128(_mm_avg_epu8(_mm_xor_si128(x, BIAS8), _mm_xor_si128(y, BIAS8)), BIAS8))
+VMX_SIMD_BINARY(vavgsh, _mm_xor_si128(_mm_avg_epu16(_mm_xor_si128(x, BIAS16), _mm_xor_si128(y, BIAS16)), BIAS16))
+
+// (x | y) - ((x ^ y) >> 1) = (x + y + 1) >> 1 sin acarreo
+VMX_SSE41 inline __m128i AverageU32(__m128i x, __m128i y) {
+	return _mm_sub_epi32(_mm_or_si128(x, y), _mm_srli_epi32(_mm_xor_si128(x, y), 1));
+}
+VMX_SIMD_BINARY(vavguw, AverageU32(x, y))
+VMX_SIMD_BINARY(vavgsw, _mm_xor_si128(AverageU32(_mm_xor_si128(x, BIAS32), _mm_xor_si128(y, BIAS32)), BIAS32))
+
+// --- Enteros: productos ---
+// Con los carriles invertidos, el elemento par de la ISA es la mitad alta de cada carril doble
+#define LOW16(v) _mm_and_si128(v, _mm_set1_epi32(0xFFFF))
+#define LOW8(v) _mm_and_si128(v, _mm_set1_epi16(0xFF))
+VMX_SIMD_BINARY(vmuleub, _mm_mullo_epi16(_mm_srli_epi16(x, 8), _mm_srli_epi16(y, 8)))
+VMX_SIMD_BINARY(vmuloub, _mm_mullo_epi16(LOW8(x), LOW8(y)))
+VMX_SIMD_BINARY(vmulesb, _mm_mullo_epi16(_mm_srai_epi16(x, 8), _mm_srai_epi16(y, 8)))
+VMX_SIMD_BINARY(vmulosb, _mm_mullo_epi16(_mm_srai_epi16(_mm_slli_epi16(x, 8), 8), _mm_srai_epi16(_mm_slli_epi16(y, 8), 8)))
+VMX_SIMD_BINARY(vmuleuh, _mm_mullo_epi32(_mm_srli_epi32(x, 16), _mm_srli_epi32(y, 16)))
+VMX_SIMD_BINARY(vmulouh, _mm_mullo_epi32(LOW16(x), LOW16(y)))
+VMX_SIMD_BINARY(vmulesh, _mm_mullo_epi32(_mm_srai_epi32(x, 16), _mm_srai_epi32(y, 16)))
+VMX_SIMD_BINARY(vmulosh, _mm_mullo_epi32(_mm_srai_epi32(_mm_slli_epi32(x, 16), 16), _mm_srai_epi32(_mm_slli_epi32(y, 16), 16)))
+
+VMX_SIMD_BINARY(vmladduhm, _mm_add_epi16(_mm_mullo_epi16(x, y), Load(c)))
+// pmaddwd suma los dos productos de cada word: exactamente vmsumshm
+VMX_SIMD_BINARY(vmsumshm, _mm_add_epi32(_mm_madd_epi16(x, y), Load(c)))
+VMX_SIMD_BINARY(vmsumuhm, _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(LOW16(x), LOW16(y)),
+	_mm_mullo_epi32(_mm_srli_epi32(x, 16), _mm_srli_epi32(y, 16))), Load(c)))
+
+VMX_SSE41 VMX_KERNEL(vmsumubm) {
+	const __m128i x = Load(a), y = Load(b);
+	const __m128i even = _mm_mullo_epi16(_mm_srli_epi16(x, 8), _mm_srli_epi16(y, 8));
+	const __m128i odd = _mm_mullo_epi16(LOW8(x), LOW8(y));
+	const __m128i sum = _mm_add_epi32(_mm_add_epi32(LOW16(even), _mm_srli_epi32(even, 16)),
+		_mm_add_epi32(LOW16(odd), _mm_srli_epi32(odd, 16)));
+	Store(d, _mm_add_epi32(sum, Load(c)));
+	return false;
+}
+
+// --- Lógicas ---
+VMX_SIMD_BINARY(vand, _mm_and_si128(x, y))
+VMX_SIMD_BINARY(vandc, _mm_andnot_si128(y, x))
+VMX_SIMD_BINARY(vor, _mm_or_si128(x, y))
+VMX_SIMD_BINARY(vxor, _mm_xor_si128(x, y))
+VMX_SIMD_BINARY(vnor, _mm_xor_si128(_mm_or_si128(x, y), _mm_set1_epi32(-1)))
+
+VMX_SSE41 VMX_KERNEL(vsel) {
+	const __m128i mask = Load(c);
+	Store(d, _mm_or_si128(_mm_andnot_si128(mask, Load(a)), _mm_and_si128(Load(b), mask)));
+	return false;
+}
+
+// --- Desplazamientos del registro entero: es un entero de 128 bits little-endian ---
+VMX_SSE41 VMX_KERNEL(vsl) {
+	const int sh = b.u8[0] & 7; // byte 15 de la ISA
+	const __m128i x = Load(a);
+	const __m128i carry = _mm_srl_epi64(_mm_slli_si128(x, 8), _mm_cvtsi32_si128(64 - sh));
+	Store(d, _mm_or_si128(_mm_sll_epi64(x, _mm_cvtsi32_si128(sh)), carry));
+	return false;
+}
+
+VMX_SSE41 VMX_KERNEL(vsr) {
+	const int sh = b.u8[0] & 7;
+	const __m128i x = Load(a);
+	const __m128i carry = _mm_sll_epi64(_mm_srli_si128(x, 8), _mm_cvtsi32_si128(64 - sh));
+	Store(d, _mm_or_si128(_mm_srl_epi64(x, _mm_cvtsi32_si128(sh)), carry));
+	return false;
+}
+
+// pshufb pone a cero los carriles cuyo índice tiene el bit 7
+VMX_SSE41 VMX_KERNEL(vslo) {
+	const int n = (b.u8[0] >> 3) & 0xF;
+	Store(d, _mm_shuffle_epi8(Load(a), _mm_sub_epi8(LaneIndex(), _mm_set1_epi8(char(n)))));
+	return false;
+}
+
+VMX_SSE41 VMX_KERNEL(vsro) {
+	const int n = (b.u8[0] >> 3) & 0xF;
+	const __m128i index = _mm_add_epi8(LaneIndex(), _mm_set1_epi8(char(n)));
+	Store(d, _mm_shuffle_epi8(Load(a), _mm_or_si128(index, _mm_cmpgt_epi8(index, _mm_set1_epi8(15)))));
+	return false;
+}
+
+// Carril p = byte p + 16 - sh de b:a (b en los carriles bajos): palignr con desplazamiento variable
+VMX_SSE41 VMX_KERNEL(vsldoi) {
+	const int sh = int(imm & 0xF);
+	const __m128i index = _mm_add_epi8(LaneIndex(), _mm_set1_epi8(char(16 - sh)));
+	const __m128i low = _mm_and_si128(index, _mm_set1_epi8(15));
+	Store(d, _mm_blendv_epi8(_mm_shuffle_epi8(Load(b), low), _mm_shuffle_epi8(Load(a), low),
+		_mm_cmpgt_epi8(index, _mm_set1_epi8(15))));
+	return false;
+}
+
+// --- Comparaciones ---
+VMX_SIMD_BINARY(vcmpequb, _mm_cmpeq_epi8(x, y))
+VMX_SIMD_BINARY(vcmpequh, _mm_cmpeq_epi16(x, y))
+VMX_SIMD_BINARY(vcmpequw, _mm_cmpeq_epi32(x, y))
+VMX_SIMD_BINARY(vcmpgtsb, _mm_cmpgt_epi8(x, y))
+VMX_SIMD_BINARY(vcmpgtsh, _mm_cmpgt_epi16(x, y))
+VMX_SIMD_BINARY(vcmpgtsw, _mm_cmpgt_epi32(x, y))
+VMX_SIMD_BINARY(vcmpgtub, _mm_cmpgt_epi8(_mm_xor_si128(x, BIAS8), _mm_xor_si128(y, BIAS8)))
+VMX_SIMD_BINARY(vcmpgtuh, _mm_cmpgt_epi16(_mm_xor_si128(x, BIAS16), _mm_xor_si128(y, BIAS16)))
+VMX_SIMD_BINARY(vcmpgtuw, _mm_cmpgt_epi32(_mm_xor_si128(x, BIAS32), _mm_xor_si128(y, BIAS32)))
+VMX_SIMD_FLOAT_MASK(vcmpeqfp, _mm_cmpeq_ps(x, y))
+VMX_SIMD_FLOAT_MASK(vcmpgefp, _mm_cmpge_ps(x, y))
+VMX_SIMD_FLOAT_MASK(vcmpgtfp, _mm_cmpgt_ps(x, y))
+
+VMX_SSE41 VMX_KERNEL(vcmpbfp) {
+	const __m128 x = LoadFloat(a), y = LoadFloat(b);
+	const __m128 negY = _mm_xor_ps(y, _mm_castsi128_ps(BIAS32));
+	const __m128i le = _mm_castps_si128(_mm_cmple_ps(x, y)), ge = _mm_castps_si128(_mm_cmpge_ps(x, negY));
+	Store(d, _mm_or_si128(_mm_andnot_si128(le, BIAS32), _mm_andnot_si128(ge, _mm_set1_epi32(0x40000000))));
+	return false;
+}
+
+// --- Permutaciones ---
+// Índice j de la ISA (0..31) -> carril 15 - (j & 15) de a o de b según el bit 4
+VMX_SSE41 VMX_KERNEL(vperm) {
+	const __m128i control = Load(c);
+	const __m128i lane = _mm_andnot_si128(control, _mm_set1_epi8(0x0F));
+	const __m128i selectB = _mm_slli_epi16(control, 3); // bit 4 -> bit 7 de cada byte
+	Store(d, _mm_blendv_epi8(_mm_shuffle_epi8(Load(a), lane), _mm_shuffle_epi8(Load(b), lane), selectB));
+	return false;
+}
+
+// Los elementos altos de la ISA están en los carriles altos: unpackhi(b, a)
+VMX_SIMD_BINARY(vmrghb, _mm_unpackhi_epi8(y, x))
+VMX_SIMD_BINARY(vmrghh, _mm_unpackhi_epi16(y, x))
+VMX_SIMD_BINARY(vmrghw, _mm_unpackhi_epi32(y, x))
+VMX_SIMD_BINARY(vmrglb, _mm_unpacklo_epi8(y, x))
+VMX_SIMD_BINARY(vmrglh, _mm_unpacklo_epi16(y, x))
+VMX_SIMD_BINARY(vmrglw, _mm_unpacklo_epi32(y, x))
+
+VMX_SSE41 VMX_KERNEL(vspltb) { Store(d, _mm_set1_epi8(char(b.Byte(imm & 15)))); return false; }
+VMX_SSE41 VMX_KERNEL(vsplth) { Store(d, _mm_set1_epi16(short(b.HalfWord(imm & 7)))); return false; }
+VMX_SSE41 VMX_KERNEL(vspltw) { Store(d, _mm_set1_epi32(int(b.Word(imm & 3)))); return false; }
+VMX_SSE41 VMX_KERNEL(vspltisb) { Store(d, _mm_set1_epi8(char(SignExtend5(imm)))); return false; }
+VMX_SSE41 VMX_KERNEL(vspltish) { Store(d, _mm_set1_epi16(short(SignExtend5(imm)))); return false; }
+VMX_SSE41 VMX_KERNEL(vspltisw) { Store(d, _mm_set1_epi32(SignExtend5(imm))); return false; }
+
+// --- Empaquetado: a va a los carriles altos, así que es pack(b, a) ---
+VMX_SIMD_BINARY(vpkuhum, _mm_packus_epi16(_mm_and_si128(y, _mm_set1_epi16(0xFF)), _mm_and_si128(x, _mm_set1_epi16(0xFF))))
+VMX_SIMD_BINARY(vpkuwum, _mm_packus_epi32(LOW16(y), LOW16(x)))
+
+// packus lee la fuente con signo: las fuentes sin signo se recortan antes con min
+VMX_SSE41 VMX_KERNEL(vpkuhus) {
+	const __m128i x = Load(a), y = Load(b), limit = _mm_set1_epi16(0xFF);
+	const __m128i cx = _mm_min_epu16(x, limit), cy = _mm_min_epu16(y, limit);
+	Store(d, _mm_packus_epi16(cy, cx));
+	return Differ(cx, x) || Differ(cy, y);
+}
+
+VMX_SSE41 VMX_KERNEL(vpkuwus) {
+	const __m128i x = Load(a), y = Load(b), limit = _mm_set1_epi32(0xFFFF);
+	const __m128i cx = _mm_min_epu32(x, limit), cy = _mm_min_epu32(y, limit);
+	Store(d, _mm_packus_epi32(cy, cx));
+	return Differ(cx, x) || Differ(cy, y);
+}
+
+VMX_SSE41 VMX_KERNEL(vpkshus) {
+	const __m128i x = Load(a), y = Load(b);
+	Store(d, _mm_packus_epi16(y, x));
+	return OutOfRange16(x, 0, 0xFF) || OutOfRange16(y, 0, 0xFF);
+}
+
+VMX_SSE41 VMX_KERNEL(vpkswus) {
+	const __m128i x = Load(a), y = Load(b);
+	Store(d, _mm_packus_epi32(y, x));
+	return OutOfRange32(x, 0, 0xFFFF) || OutOfRange32(y, 0, 0xFFFF);
+}
+
+VMX_SSE41 VMX_KERNEL(vpkshss) {
+	const __m128i x = Load(a), y = Load(b);
+	Store(d, _mm_packs_epi16(y, x));
+	return OutOfRange16(x, -128, 127) || OutOfRange16(y, -128, 127);
+}
+
+VMX_SSE41 VMX_KERNEL(vpkswss) {
+	const __m128i x = Load(a), y = Load(b);
+	Store(d, _mm_packs_epi32(y, x));
+	return OutOfRange32(x, -32768, 32767) || OutOfRange32(y, -32768, 32767);
+}
+
+// Los elementos altos de la ISA son los 8 bytes altos
+VMX_SSE41 VMX_KERNEL(vupkhsb) { Store(d, _mm_cvtepi8_epi16(_mm_srli_si128(Load(b), 8))); return false; }
+VMX_SSE41 VMX_KERNEL(vupklsb) { Store(d, _mm_cvtepi8_epi16(Load(b))); return false; }
+VMX_SSE41 VMX_KERNEL(vupkhsh) { Store(d, _mm_cvtepi16_epi32(_mm_srli_si128(Load(b), 8))); return false; }
+VMX_SSE41 VMX_KERNEL(vupklsh) { Store(d, _mm_cvtepi16_epi32(Load(b))); return false; }
+
+// --- Coma flotante ---
+VMX_SIMD_FLOAT(vaddfp, _mm_add_ps(x, y))
+VMX_SIMD_FLOAT(vsubfp, _mm_sub_ps(x, y))
+VMX_SIMD_FLOAT(vmulfp128, _mm_mul_ps(x, y))
+
+// maxps/minps: con ±0 iguales se combinan los signos como en la escalar; los NaN los corrige PropagateNaN
+VMX_SIMD_FLOAT(vmaxfp, _mm_blendv_ps(_mm_max_ps(x, y), _mm_and_ps(x, y), _mm_cmpeq_ps(x, y)))
+VMX_SIMD_FLOAT(vminfp, _mm_blendv_ps(_mm_min_ps(x, y), _mm_or_ps(x, y), _mm_cmpeq_ps(x, y)))
+
+// rcpps/rsqrtps no coinciden con la referencia: división y raíz exactas
+VMX_SIMD_UNARY_FLOAT(vrefp, _mm_div_ps(_mm_set1_ps(1.0f), y))
+VMX_SIMD_UNARY_FLOAT(vrsqrtefp, _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(y)))
+VMX_SIMD_UNARY_FLOAT(vrfin, _mm_round_ps(y, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC))
+VMX_SIMD_UNARY_FLOAT(vrfiz, _mm_round_ps(y, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC))
+VMX_SIMD_UNARY_FLOAT(vrfip, _mm_round_ps(y, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC))
+VMX_SIMD_UNARY_FLOAT(vrfim, _mm_round_ps(y, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC))
+
+VMX_SSE41 VMX_KERNEL(vcfsx) {
+	StoreFloat(d, _mm_mul_ps(_mm_cvtepi32_ps(Load(b)), _mm_set1_ps(Pow2(-int(imm & 0x1F)))));
+	return false;
+}
+
+// Sin signo: las dos mitades de 16 bits son exactas y la suma redondea una sola vez
+VMX_SSE41 VMX_KERNEL(vcfux) {
+	const __m128i x = Load(b);
+	const __m128 high = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(x, 16)), _mm_set1_ps(65536.0f));
+	const __m128 value = _mm_add_ps(high, _mm_cvtepi32_ps(LOW16(x)));
+	StoreFloat(d, _mm_mul_ps(value, _mm_set1_ps(Pow2(-int(imm & 0x1F)))));
+	return false;
+}
+
+// cvttps da 0x80000000 fuera de rango y con NaN: se corrige a los valores saturados y a 0
+VMX_SSE41 VMX_KERNEL(vctsxs) {
+	const __m128 x = _mm_mul_ps(LoadFloat(b), _mm_set1_ps(Pow2(int(imm & 0x1F))));
+	const __m128 over = _mm_cmpge_ps(x, _mm_set1_ps(2147483648.0f));
+	const __m128 under = _mm_cmplt_ps(x, _mm_set1_ps(-2147483648.0f));
+	__m128i r = _mm_blendv_epi8(_mm_cvttps_epi32(x), _mm_set1_epi32(0x7FFFFFFF), _mm_castps_si128(over));
+	r = _mm_andnot_si128(_mm_castps_si128(_mm_cmpunord_ps(x, x)), r);
+	Store(d, r);
+	return _mm_movemask_ps(_mm_or_ps(over, under)) != 0;
+}
+
+// Por encima de 2^31 se resta 2^31 antes de convertir y se vuelve a poner en el bit alto
+VMX_SSE41 VMX_KERNEL(vctuxs) {
+	const __m128 x = _mm_mul_ps(LoadFloat(b), _mm_set1_ps(Pow2(int(imm & 0x1F))));
+	const __m128 two31 = _mm_set1_ps(2147483648.0f);
+	const __m128 high = _mm_cmpge_ps(x, two31);
+	__m128i r = _mm_cvttps_epi32(_mm_sub_ps(x, _mm_and_ps(high, two31)));
+	r = _mm_xor_si128(r, _mm_and_si128(_mm_castps_si128(high), BIAS32));
+	const __m128 over = _mm_cmpge_ps(x, _mm_set1_ps(4294967296.0f));
+	r = _mm_or_si128(r, _mm_castps_si128(over));
+	// x <= 0 y NaN: 0
+	r = _mm_and_si128(r, _mm_castps_si128(_mm_cmpgt_ps(x, _mm_setzero_ps())));
+	Store(d, r);
+	return _mm_movemask_ps(_mm_or_ps(over, _mm_cmple_ps(x, _mm_set1_ps(-1.0f)))) != 0;
+}
+
+void Fill(VMXKernelTable& t) {
+	const auto set = [&t](VMXOp op, VMXKernel k) {
+		t.kernels[int(op)] = k;
+		t.native[int(op)] = true;
+	};
+	set(VMXOp::vaddubm, vaddubm);
+	set(VMXOp::vadduhm, vadduhm);
+	set(VMXOp::vadduwm, vadduwm);
+	set(VMXOp::vaddubs, vaddubs);
+	set(VMXOp::vadduhs, vadduhs);
+	set(VMXOp::vadduws, vadduws);
+	set(VMXOp::vaddsbs, vaddsbs);
+	set(VMXOp::vaddshs, vaddshs);
+	set(VMXOp::vaddsws, vaddsws);
+	set(VMXOp::vaddcuw, vaddcuw);
+	set(VMXOp::vsububm, vsububm);
+	set(VMXOp::vsubuhm, vsubuhm);
+	set(VMXOp::vsubuwm, vsubuwm);
+	set(VMXOp::vsububs, vsububs);
+	set(VMXOp::vsubuhs, vsubuhs);
+	set(VMXOp::vsubuws, vsubuws);
+	set(VMXOp::vsubsbs, vsubsbs);
+	set(VMXOp::vsubshs, vsubshs);
+	set(VMXOp::vsubsws, vsubsws);
+	set(VMXOp::vsubcuw, vsubcuw);
+	set(VMXOp::vmaxub, vmaxub);
+	set(VMXOp::vmaxuh, vmaxuh);
+	set(VMXOp::vmaxuw, vmaxuw);
+	set(VMXOp::vmaxsb, vmaxsb);
+	set(VMXOp::vmaxsh, vmaxsh);
+	set(VMXOp::vmaxsw, vmaxsw);
+	set(VMXOp::vminub, vminub);
+	set(VMXOp::vminuh, vminuh);
+	set(VMXOp::vminuw, vminuw);
+	set(VMXOp::vminsb, vminsb);
+	set(VMXOp::vminsh, vminsh);
+	set(VMXOp::vminsw, vminsw);
+	set(VMXOp::vavgub, vavgub);
+	set(VMXOp::vavguh, vavguh);
+	set(VMXOp::vavguw, vavguw);
+	set(VMXOp::vavgsb, vavgsb);
+	set(VMXOp::vavgsh, vavgsh);
+	set(VMXOp::vavgsw, vavgsw);
+
+	set(VMXOp::vmuleub, vmuleub);
+	set(VMXOp::vmuleuh, vmuleuh);
+	set(VMXOp::vmulesb, vmulesb);
+	set(VMXOp::vmulesh, vmulesh);
+	set(VMXOp::vmuloub, vmuloub);
+	set(VMXOp::vmulouh, vmulouh);
+	set(VMXOp::vmulosb, vmulosb);
+	set(VMXOp::vmulosh, vmulosh);
+	set(VMXOp::vmladduhm, vmladduhm);
+	set(VMXOp::vmsumubm, vmsumubm);
+	set(VMXOp::vmsumuhm, vmsumuhm);
+	set(VMXOp::vmsumshm, vmsumshm);
+
+	set(VMXOp::vand, vand);
+	set(VMXOp::vandc, vandc);
+	set(VMXOp::vor, vor);
+	set(VMXOp::vxor, vxor);
+	set(VMXOp::vnor, vnor);
+	set(VMXOp::vsel, vsel);
+	set(VMXOp::vsl, vsl);
+	set(VMXOp::vsr, vsr);
+	set(VMXOp::vslo, vslo);
+	set(VMXOp::vsro, vsro);
+	set(VMXOp::vsldoi, vsldoi);
+
+	set(VMXOp::vcmpequb, vcmpequb);
+	set(VMXOp::vcmpequh, vcmpequh);
+	set(VMXOp::vcmpequw, vcmpequw);
+	set(VMXOp::vcmpgtub, vcmpgtub);
+	set(VMXOp::vcmpgtuh, vcmpgtuh);
+	set(VMXOp::vcmpgtuw, vcmpgtuw);
+	set(VMXOp::vcmpgtsb, vcmpgtsb);
+	set(VMXOp::vcmpgtsh, vcmpgtsh);
+	set(VMXOp::vcmpgtsw, vcmpgtsw);
+	set(VMXOp::vcmpeqfp, vcmpeqfp);
+	set(VMXOp::vcmpgefp, vcmpgefp);
+	set(VMXOp::vcmpgtfp, vcmpgtfp);
+	set(VMXOp::vcmpbfp, vcmpbfp);
+
+	set(VMXOp::vperm, vperm);
+	set(VMXOp::vmrghb, vmrghb);
+	set(VMXOp::vmrghh, vmrghh);
+	set(VMXOp::vmrghw, vmrghw);
+	set(VMXOp::vmrglb, vmrglb);
+	set(VMXOp::vmrglh, vmrglh);
+	set(VMXOp::vmrglw, vmrglw);
+	set(VMXOp::vspltb, vspltb);
+	set(VMXOp::vsplth, vsplth);
+	set(VMXOp::vspltw, vspltw);
+	set(VMXOp::vspltisb, vspltisb);
+	set(VMXOp::vspltish, vspltish);
+	set(VMXOp::vspltisw, vspltisw);
+
+	set(VMXOp::vpkuhum, vpkuhum);
+	set(VMXOp::vpkuwum, vpkuwum);
+	set(VMXOp::vpkuhus, vpkuhus);
+	set(VMXOp::vpkuwus, vpkuwus);
+	set(VMXOp::vpkshus, vpkshus);
+	set(VMXOp::vpkswus, vpkswus);
+	set(VMXOp::vpkshss, vpkshss);
+	set(VMXOp::vpkswss, vpkswss);
+	set(VMXOp::vupkhsb, vupkhsb);
+	set(VMXOp::vupkhsh, vupkhsh);
+	set(VMXOp::vupklsb, vupklsb);
+	set(VMXOp::vupklsh, vupklsh);
+
+	set(VMXOp::vaddfp, vaddfp);
+	set(VMXOp::vsubfp, vsubfp);
+	set(VMXOp::vmulfp128, vmulfp128);
+	set(VMXOp::vmaxfp, vmaxfp);
+	set(VMXOp::vminfp, vminfp);
+	set(VMXOp::vrefp, vrefp);
+	set(VMXOp::vrsqrtefp, vrsqrtefp);
+	set(VMXOp::vrfin, vrfin);
+	set(VMXOp::vrfiz, vrfiz);
+	set(VMXOp::vrfip, vrfip);
+	set(VMXOp::vrfim, vrfim);
+	set(VMXOp::vcfux, vcfux);
+	set(VMXOp::vcfsx, vcfsx);
+	set(VMXOp::vctuxs, vctuxs);
+	set(VMXOp::vctsxs, vctsxs);
+}
+
+} // namespace sse41
+
+// AVX2 aporta desplazamientos con cuenta por elemento (vpsllvd...) y FMA para vmaddfp/vnmsubfp,
+// que en SSE4.1 se quedan en la versión escalar (fmaf) para no redondear dos veces.
+namespace avx2 {
+
+using sse41::Load;
+using sse41::LoadFloat;
+using sse41::Store;
+using sse41::StoreFloat;
+using sse41::PropagateNaN;
+
+#define VMX_AVX2_BINARY(name, expr) \
+	VMX_AVX2 VMX_KERNEL(name) { \
+		const __m128i x = Load(a), y = Load(b); \
+		Store(d, expr); \
+		return false; \
+	}
+
+VMX_AVX2_BINARY(vslw, _mm_sllv_epi32(x, _mm_and_si128(y, _mm_set1_epi32(31))))
+VMX_AVX2_BINARY(vsrw, _mm_srlv_epi32(x, _mm_and_si128(y, _mm_set1_epi32(31))))
+VMX_AVX2_BINARY(vsraw, _mm_srav_epi32(x, _mm_and_si128(y, _mm_set1_epi32(31))))
+
+VMX_AVX2 VMX_KERNEL(vrlw) {
+	const __m128i x = Load(a), n = _mm_and_si128(Load(b), _mm_set1_epi32(31));
+	Store(d, _mm_or_si128(_mm_sllv_epi32(x, n), _mm_srlv_epi32(x, _mm_sub_epi32(_mm_set1_epi32(32), n))));
+	return false;
+}
+
+// Halfwords: se amplían a 32 bits en un registro de 256, se desplazan y se vuelven a empaquetar
+VMX_AVX2 inline __m128i Narrow16(__m256i v) {
+	v = _mm256_and_si256(v, _mm256_set1_epi32(0xFFFF));
+	return _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+}
+
+VMX_AVX2 VMX_KERNEL(vslh) {
+	const __m256i x = _mm256_cvtepu16_epi32(Load(a)), n = _mm256_cvtepu16_epi32(_mm_and_si128(Load(b), _mm_set1_epi16(15)));
+	Store(d, Narrow16(_mm256_sllv_epi32(x, n)));
+	return false;
+}
+
+VMX_AVX2 VMX_KERNEL(vsrh) {
+	const __m256i x = _mm256_cvtepu16_epi32(Load(a)), n = _mm256_cvtepu16_epi32(_mm_and_si128(Load(b), _mm_set1_epi16(15)));
+	Store(d, Narrow16(_mm256_srlv_epi32(x, n)));
+	return false;
+}
+
+VMX_AVX2 VMX_KERNEL(vsrah) {
+	const __m256i x = _mm256_cvtepi16_epi32(Load(a)), n = _mm256_cvtepu16_epi32(_mm_and_si128(Load(b), _mm_set1_epi16(15)));
+	Store(d, Narrow16(_mm256_srav_epi32(x, n)));
+	return false;
+}
+
+VMX_AVX2 VMX_KERNEL(vrlh) {
+	const __m256i x = _mm256_cvtepu16_epi32(Load(a)), n = _mm256_cvtepu16_epi32(_mm_and_si128(Load(b), _mm_set1_epi16(15)));
+	const __m256i doubled = _mm256_or_si256(x, _mm256_slli_epi32(x, 16)); // x:x, rotar es desplazar
+	Store(d, Narrow16(_mm256_srlv_epi32(doubled, _mm256_sub_epi32(_mm256_set1_epi32(16), n))));
+	return false;
+}
+
+// Fusionadas, como la referencia (std::fma)
+VMX_AVX2 inline __m128 Negate(__m128 v) { return _mm_xor_ps(v, _mm_castsi128_ps(_mm_set1_epi32(int(0x80000000)))); }
+
+VMX_AVX2 VMX_KERNEL(vmaddfp) {
+	const __m128 x = LoadFloat(a), y = LoadFloat(b), z = LoadFloat(c);
+	StoreFloat(d, PropagateNaN(_mm_fmadd_ps(x, z, y), x, y, z));
+	return false;
+}
+
+VMX_AVX2 VMX_KERNEL(vnmsubfp) {
+	const __m128 x = LoadFloat(a), y = LoadFloat(b), z = LoadFloat(c);
+	StoreFloat(d, PropagateNaN(Negate(_mm_fmsub_ps(x, z, y)), x, y, z));
+	return false;
+}
+
+VMX_AVX2 VMX_KERNEL(vmaddfp128) {
+	const __m128 x = LoadFloat(a), y = LoadFloat(b), z = LoadFloat(c);
+	StoreFloat(d, PropagateNaN(_mm_fmadd_ps(x, y, z), x, y, z));
+	return false;
+}
+
+VMX_AVX2 VMX_KERNEL(vmaddcfp128) {
+	const __m128 x = LoadFloat(a), y = LoadFloat(b), z = LoadFloat(c);
+	StoreFloat(d, PropagateNaN(_mm_fmadd_ps(x, z, y), x, y, z));
+	return false;
+}
+
+VMX_AVX2 VMX_KERNEL(vnmsubfp128) {
+	const __m128 x = LoadFloat(a), y = LoadFloat(b), z = LoadFloat(c);
+	StoreFloat(d, PropagateNaN(Negate(_mm_fmsub_ps(x, y, z)), x, y, z));
+	return false;
+}
+
+void Fill(VMXKernelTable& t) {
+	const auto set = [&t](VMXOp op, VMXKernel k) {
+		t.kernels[int(op)] = k;
+		t.native[int(op)] = true;
+	};
+	set(VMXOp::vslw, vslw);
+	set(VMXOp::vsrw, vsrw);
+	set(VMXOp::vsraw, vsraw);
+	set(VMXOp::vrlw, vrlw);
+	set(VMXOp::vslh, vslh);
+	set(VMXOp::vsrh, vsrh);
+	set(VMXOp::vsrah, vsrah);
+	set(VMXOp::vrlh, vrlh);
+	set(VMXOp::vmaddfp, vmaddfp);
+	set(VMXOp::vnmsubfp, vnmsubfp);
+	set(VMXOp::vmaddfp128, vmaddfp128);
+	set(VMXOp::vmaddcfp128, vmaddcfp128);
+	set(VMXOp::vnmsubfp128, vnmsubfp128);
+}
+
+} // namespace avx2
+
+struct HostFeatures {
+	bool sse41 = false;
+	bool avx2 = false; // AVX2 + FMA, con el estado AVX guardado por el SO
+};
+
+HostFeatures DetectHost() {
+	HostFeatures f;
+#if defined(_MSC_VER) && !defined(__clang__)
+	int r[4];
+	__cpuid(r, 0);
+	const int maxLeaf = r[0];
+	__cpuid(r, 1);
+	f.sse41 = (r[2] >> 19) & 1;
+	const bool fma = (r[2] >> 12) & 1, osxsave = (r[2] >> 27) & 1, avx = (r[2] >> 28) & 1;
+	if (maxLeaf >= 7 && fma && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+		__cpuidex(r, 7, 0);
+		f.avx2 = (r[1] >> 5) & 1;
+	}
+#else
+	__builtin_cpu_init();
+	f.sse41 = __builtin_cpu_supports("sse4.1");
+	f.avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+	return f;
+}
+
+const HostFeatures& Host() {
+	static const HostFeatures features = DetectHost();
+	return features;
+}
+#endif // PPC_VMX_SIMD
+
+VMXKernelTable BuildTable(VMXIsa isa) {
+	VMXKernelTable t;
+	t.isa = isa;
+	scalar::Fill(t);
+#if defined(PPC_VMX_SIMD)
+	if (isa != VMXIsa::Scalar) {
+		for (bool& native : t.native) native = false;
+		sse41::Fill(t);
+	}
+	if (isa == VMXIsa::AVX2) {
+		for (bool& native : t.native) native = false;
+		avx2::Fill(t);
+	}
+#endif
+	return t;
+}
+
+std::atomic<const VMXKernelTable*>& ActiveTable() {
+	static std::atomic<const VMXKernelTable*> active{ &VMXKernelsFor(BestVMXIsa()) };
+	return active;
+}
+
+} // namespace
+
+const char* VMXOpName(VMXOp op) {
+	static const char* const NAMES[] = {
+#define VMX_OP_NAME(name) #name,
+		VMX_OPS(VMX_OP_NAME)
+#undef VMX_OP_NAME
+	};
+	return int(op) < VMX_OP_COUNT ? NAMES[int(op)] : "?";
+}
+
+const char* VMXIsaName(VMXIsa isa) {
+	switch (isa) {
+	case VMXIsa::SSE41: return "sse4.1";
+	case VMXIsa::AVX2: return "avx2";
+	default: return "scalar";
+	}
+}
+
+bool VMXIsaSupported(VMXIsa isa) {
+	switch (isa) {
+	case VMXIsa::Scalar: return true;
+#if defined(PPC_VMX_SIMD)
+	case VMXIsa::SSE41: return Host().sse41;
+	case VMXIsa::AVX2: return Host().sse41 && Host().avx2;
+#endif
+	default: return false;
+	}
+}
+
+VMXIsa BestVMXIsa() {
+	if (VMXIsaSupported(VMXIsa::AVX2)) return VMXIsa::AVX2;
+	if (VMXIsaSupported(VMXIsa::SSE41)) return VMXIsa::SSE41;
+	return VMXIsa::Scalar;
+}
+
+const VMXKernelTable& VMXKernelsFor(VMXIsa isa) {
+	static const VMXKernelTable tables[] = { BuildTable(VMXIsa::Scalar), BuildTable(VMXIsa::SSE41), BuildTable(VMXIsa::AVX2) };
+	return tables[int(isa)];
+}
+
+const VMXKernelTable& VMXKernels() {
+	return *ActiveTable().load(std::memory_order_relaxed);
+}
+
+bool SelectVMXIsa(VMXIsa isa) {
+	if (!VMXIsaSupported(isa)) return false;
+	ActiveTable().store(&VMXKernelsFor(isa), std::memory_order_relaxed);
+	return true;
+}
@@ -0,0 +1,79 @@
+// VMXKernels.h
+#pragma once
+#include "VectorRegister.h"
+#include <cstdint>
+
+// Operaciones VMX/VMX128 sobre VectorRegister, indexadas por VMXOp. Cada una tiene una versión
+// escalar, que es la referencia, y las que lo merecen una SSE4.1 y/o AVX2(+FMA). La tabla activa
+// se elige una vez según la CPU del host; las versiones vectoriales tienen que dar el mismo
+// resultado, carril a carril, que la escalar (bench/VMXBench.cpp lo comprueba).
+//
+// Los argumentos son los campos de la instrucción: a = vA, b = vB, c = vC (o vD en VMX128, que lo
+// usan como tercer operando), imm = UIMM/SIMM/SH. Las operaciones de un operando leen vB.
+#define VMX_OPS(X) \
+    /* Enteros: suma y resta */ \
+    X(vaddubm) X(vadduhm) X(vadduwm) X(vaddubs) X(vadduhs) X(vadduws) X(vaddsbs) X(vaddshs) X(vaddsws) X(vaddcuw) \
+    X(vsububm) X(vsubuhm) X(vsubuwm) X(vsububs) X(vsubuhs) X(vsubuws) X(vsubsbs) X(vsubshs) X(vsubsws) X(vsubcuw) \
+    X(vmaxub) X(vmaxuh) X(vmaxuw) X(vmaxsb) X(vmaxsh) X(vmaxsw) \
+    X(vminub) X(vminuh) X(vminuw) X(vminsb) X(vminsh) X(vminsw) \
+    X(vavgub) X(vavguh) X(vavguw) X(vavgsb) X(vavgsh) X(vavgsw) \
+    /* Enteros: productos y sumas */ \
+    X(vmuleub) X(vmuleuh) X(vmulesb) X(vmulesh) X(vmuloub) X(vmulouh) X(vmulosb) X(vmulosh) \
+    X(vmhaddshs) X(vmhraddshs) X(vmladduhm) \
+    X(vmsumubm) X(vmsummbm) X(vmsumuhm) X(vmsumuhs) X(vmsumshm) X(vmsumshs) \
+    X(vsum4ubs) X(vsum4sbs) X(vsum4shs) X(vsum2sws) X(vsumsws) \
+    /* Lógicas, desplazamientos y rotaciones */ \
+    X(vand) X(vandc) X(vor) X(vxor) X(vnor) X(vsel) \
+    X(vslb) X(vslh) X(vslw) X(vsrb) X(vsrh) X(vsrw) X(vsrab) X(vsrah) X(vsraw) X(vrlb) X(vrlh) X(vrlw) \
+    X(vsl) X(vsr) X(vslo) X(vsro) X(vsldoi) \
+    /* Comparaciones: cada elemento a todo unos o todo ceros */ \
+    X(vcmpequb) X(vcmpequh) X(vcmpequw) X(vcmpgtub) X(vcmpgtuh) X(vcmpgtuw) X(vcmpgtsb) X(vcmpgtsh) X(vcmpgtsw) \
+    X(vcmpeqfp) X(vcmpgefp) X(vcmpgtfp) X(vcmpbfp) \
+    /* Permutaciones, mezclas y splats */ \
+    X(vperm) X(vmrghb) X(vmrghh) X(vmrghw) X(vmrglb) X(vmrglh) X(vmrglw) \
+    X(vspltb) X(vsplth) X(vspltw) X(vspltisb) X(vspltish) X(vspltisw) \
+    /* Empaquetado y desempaquetado */ \
+    X(vpkuhum) X(vpkuwum) X(vpkuhus) X(vpkuwus) X(vpkshus) X(vpkswus) X(vpkshss) X(vpkswss) X(vpkpx) \
+    X(vupkhsb) X(vupkhsh) X(vupklsb) X(vupklsh) X(vupkhpx) X(vupklpx) \
+    /* Coma flotante */ \
+    X(vaddfp) X(vsubfp) X(vmaddfp) X(vnmsubfp) X(vmaxfp) X(vminfp) \
+    X(vrefp) X(vrsqrtefp) X(vexptefp) X(vlogefp) X(vrfin) X(vrfiz) X(vrfip) X(vrfim) \
+    X(vcfux) X(vcfsx) X(vctuxs) X(vctsxs) \
+    /* Sólo VMX128 */ \
+    X(vmulfp128) X(vmaddfp128) X(vmaddcfp128) X(vnmsubfp128) X(vmsum3fp128) X(vmsum4fp128) \
+    X(vpermwi128) X(vrlimi128)
+
+enum class VMXOp : uint16_t {
+#define VMX_OP_ENUM(name) name,
+    VMX_OPS(VMX_OP_ENUM)
+#undef VMX_OP_ENUM
+    Count
+};
+constexpr int VMX_OP_COUNT = int(VMXOp::Count);
+
+// d = op(a, b, c, imm). d puede ser el mismo registro que un operando. Devuelve true si algún
+// elemento saturó (VSCR[SAT]).
+using VMXKernel = bool (*)(VectorRegister& d, const VectorRegister& a, const VectorRegister& b, const VectorRegister& c, uint32_t imm);
+
+enum class VMXIsa { Scalar, SSE41, AVX2 };
+
+struct VMXKernelTable {
+    VMXIsa isa = VMXIsa::Scalar;
+    VMXKernel kernels[VMX_OP_COUNT] = {};
+    // Qué entradas tienen versión propia de este nivel (las demás son las del nivel inferior)
+    bool native[VMX_OP_COUNT] = {};
+};
+
+const char* VMXOpName(VMXOp op);
+const char* VMXIsaName(VMXIsa isa);
+// El host puede ejecutar ese nivel (CPUID, y que el SO guarde los registros AVX)
+bool VMXIsaSupported(VMXIsa isa);
+// El mejor nivel soportado
+VMXIsa BestVMXIsa();
+// Tabla de un nivel concreto, para comparar implementaciones
+const VMXKernelTable& VMXKernelsFor(VMXIsa isa);
+// Tabla que usa el intérprete: BestVMXIsa() salvo que se fije otra con SelectVMXIsa
+const VMXKernelTable& VMXKernels();
+// Fija el nivel (p.ej. escalar para depurar). Hay que llamarla antes de arrancar las CPUs.
+// Devuelve false, sin cambiar nada, si el host no lo soporta.
+bool SelectVMXIsa(VMXIsa isa);
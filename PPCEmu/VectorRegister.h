@@ -0,0 +1,59 @@
+// VectorRegister.h
+#pragma once
+#include "Endian.h"
+#include <cstdint>
+#include <cstring>
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define PPC_VECTOR_SSE2 1
+#endif
+
+// Registro VMX/VMX128 de 128 bits, alineado a 16 bytes: se carga y guarda entero con
+// _mm_load_si128/_mm_store_si128 (o movdqa) sin copias intermedias.
+//
+// Los 16 bytes se guardan al revés que en memoria: el registro entero es el valor big-endian de
+// 128 bits visto como un little-endian del host. Así todo elemento (byte, halfword, word, float)
+// está en orden de host en su carril y las operaciones por elemento de VMXKernels son una sola
+// instrucción SSE, sea cual sea el ancho. El precio es que el elemento i de la ISA está en el
+// carril N-1-i: los accesos por índice de la ISA pasan por Byte/HalfWord/Word/Float, y lvx/stvx
+// (FromGuest/ToGuest) invierten el orden de los bytes.
+union alignas(16) VectorRegister {
+    uint8_t u8[16];
+    uint16_t u16[8];
+    uint32_t u32[4];
+    uint64_t u64[2];
+    int8_t s8[16];
+    int16_t s16[8];
+    int32_t s32[4];
+    float f32[4];
+#ifdef PPC_VECTOR_SSE2
+    __m128i m128;
+#endif
+
+    // Elementos por índice de la ISA (0 = el de menor dirección en memoria)
+    uint8_t Byte(int i) const { return u8[15 - i]; }
+    void SetByte(int i, uint8_t value) { u8[15 - i] = value; }
+    uint16_t HalfWord(int i) const { return u16[7 - i]; }
+    void SetHalfWord(int i, uint16_t value) { u16[7 - i] = value; }
+    uint32_t Word(int i) const { return u32[3 - i]; }
+    void SetWord(int i, uint32_t value) { u32[3 - i] = value; }
+    float Float(int i) const { return f32[3 - i]; }
+    void SetFloat(int i, float value) { f32[3 - i] = value; }
+
+    // 16 bytes en orden de memoria <-> registro
+    static VectorRegister FromGuest(const uint8_t* bytes) {
+        VectorRegister v;
+        v.u64[1] = LoadBE<uint64_t>(bytes);
+        v.u64[0] = LoadBE<uint64_t>(bytes + 8);
+        return v;
+    }
+    void ToGuest(uint8_t* bytes) const {
+        StoreBE<uint64_t>(bytes, u64[1]);
+        StoreBE<uint64_t>(bytes + 8, u64[0]);
+    }
+};
+static_assert(sizeof(VectorRegister) == 16 && alignof(VectorRegister) == 16, "VectorRegister must be a 16-byte aligned 128-bit value");
+
+// VMX tiene 32 registros; VMX128 (Xenon) amplía el banco a 128, y los 32 primeros son los de VMX
+constexpr int VMX_REGISTER_COUNT = 32;
+constexpr int VMX128_REGISTER_COUNT = 128;
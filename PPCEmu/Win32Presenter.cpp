@@ -0,0 +1,80 @@
+// Win32Presenter.cpp
+#include "Win32Presenter.h"
+#include <shellscalingapi.h>
+#include <stdexcept>
+
+static const wchar_t* WC_NAME = L"EmuFrameWnd";
+
+Win32Presenter::Win32Presenter(const std::string& title, int width, int height)
+	: width_(width), height_(height) {
+	SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_SYSTEM_AWARE);
+
+	ZeroMemory(&bmi_, sizeof(bmi_));
+	bmi_.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi_.bmiHeader.biWidth = width_;
+	bmi_.bmiHeader.biHeight = -height_;
+	bmi_.bmiHeader.biPlanes = 1;
+	bmi_.bmiHeader.biBitCount = 32;
+	bmi_.bmiHeader.biCompression = BI_RGB;
+
+	WNDCLASSW wc = {};
+	wc.lpfnWndProc = WndProc;
+	wc.hInstance = GetModuleHandle(nullptr);
+	wc.lpszClassName = WC_NAME;
+
+	static bool classRegistered = false;
+	if (!classRegistered) {
+		RegisterClassW(&wc);
+		classRegistered = true;
+	}
+
+	std::wstring wtitle(title.begin(), title.end());
+	hwnd_ = CreateWindowExW(0, WC_NAME, wtitle.c_str(), WS_OVERLAPPEDWINDOW,
+		CW_USEDEFAULT, CW_USEDEFAULT, width_ + 16, height_ + 39,
+		nullptr, nullptr, GetModuleHandle(nullptr), this);
+	if (!hwnd_) throw std::runtime_error("Failed to create display window");
+
+	ShowWindow(hwnd_, SW_SHOW);
+	HDC hdcWindow = GetDC(hwnd_);
+	hdcMem_ = CreateCompatibleDC(hdcWindow);
+	hBmp_ = CreateCompatibleBitmap(hdcWindow, width_, height_);
+	SelectObject(hdcMem_, hBmp_);
+	ReleaseDC(hwnd_, hdcWindow);
+}
+
+Win32Presenter::~Win32Presenter() {
+	if (hdcMem_) DeleteDC(hdcMem_);
+	if (hBmp_) DeleteObject(hBmp_);
+	if (hwnd_) DestroyWindow(hwnd_);
+}
+
+bool Win32Presenter::ProcessEvents() {
+	MSG msg;
+	while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+		if (msg.message == WM_QUIT) return false;
+		TranslateMessage(&msg);
+		DispatchMessage(&msg);
+	}
+	return true;
+}
+
+void Win32Presenter::Present(const uint8_t* pixels, int width, int height) {
+	HDC hdcWindow = GetDC(hwnd_);
+	SetDIBits(hdcMem_, hBmp_, 0, height_, pixels, &bmi_, DIB_RGB_COLORS);
+	BitBlt(hdcWindow, 0, 0, width_, height_, hdcMem_, 0, 0, SRCCOPY);
+	ReleaseDC(hwnd_, hdcWindow);
+}
+
+LRESULT CALLBACK Win32Presenter::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+	switch (msg) {
+	case WM_CREATE: {
+		auto cs = reinterpret_cast<CREATESTRUCT*>(lParam);
+		SetWindowLongPtr(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(cs->lpCreateParams));
+		break;
+	}
+	case WM_DESTROY:
+		PostQuitMessage(0);
+		return 0;
+	}
+	return DefWindowProc(hwnd, msg, wParam, lParam);
+}
@@ -0,0 +1,26 @@
+// Win32Presenter.h
+#pragma once
+#include "FramePresenter.h"
+#include <string>
+#include <windows.h>
+
+// Shows the framebuffer in a GDI window (SetDIBits + BitBlt)
+class Win32Presenter : public FramePresenter {
+public:
+    Win32Presenter(const std::string& title, int width, int height);
+    ~Win32Presenter() override;
+    Win32Presenter(const Win32Presenter&) = delete;
+    Win32Presenter& operator=(const Win32Presenter&) = delete;
+
+    void Present(const uint8_t* pixels, int width, int height) override;
+    bool ProcessEvents() override;
+
+private:
+    static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+
+    HWND hwnd_{ nullptr };
+    HDC hdcMem_{ nullptr };
+    HBITMAP hBmp_{ nullptr };
+    BITMAPINFO bmi_{};
+    int width_, height_;
+};
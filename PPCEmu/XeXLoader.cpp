@@ -1,79 +1,411 @@
 /* Made by Slam */
 /*
-XeX loader {soon}
+XeX loader: XEX2 (cabeceras opcionales, formato basic/LZX, AES-128, importaciones)
 */
-#include <cstdint>
-#include <array>
-#include <memory>
-#include <vector>
+#include "XeXLoader.h"
+#include "Aes128.h"
+#include "LzxDecoder.h"
+#include "Endian.h"
+#include "Log.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
 #include <cstring>
-#include <stdexcept>
-#include <iostream>
+#include <exception>
 #include <fstream>
-#include <chrono>
+#include <iterator>
+#include <tuple>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <thread>
-#include <windows.h>
-#include <filesystem>
-#include "MMU.h"
 
+namespace {
 
 #pragma pack(push, 1)
 struct XEXHeader {
 	char magic[4]; // "XEX2"
 	uint32_t module_flags;
-	uint32_t code_offset;
+	uint32_t pe_offset;       // inicio de la imagen en el fichero
 	uint32_t reserved;
-	uint32_t cert_offset;
-	uint32_t section_count;
-	// Seguido por section_count entradas de sección
+	uint32_t security_offset;
+	uint32_t header_count;
+	// Seguido por header_count cabeceras opcionales
 };
 
-struct XEXSection {
-	uint32_t virtual_address;
-	uint32_t virtual_size;
-	uint32_t file_offset;
-	uint32_t file_size;
+struct XEXOptionalHeader {
+	uint32_t key;   // byte bajo: 0x00/0x01 = value es el dato; 0xFF = value apunta a {tamaño, datos}; si no, tamaño en palabras
+	uint32_t value;
 };
 #pragma pack(pop)
-void LoadXEX(const std::string& filename, MMU& mmu) {
-	std::ifstream file(filename, std::ios::binary);
-	if (!file) {
-		std::cerr << "Error: No se pudo abrir el archivo " << filename << std::endl;
-		throw std::runtime_error("No se pudo abrir el XEX");
+
+// Cabeceras opcionales que se usan
+constexpr uint32_t XEX_HEADER_FILE_FORMAT_INFO = 0x000003FF;
+constexpr uint32_t XEX_HEADER_IMAGE_BASE_ADDRESS = 0x00010001;
+constexpr uint32_t XEX_HEADER_ENTRY_POINT = 0x00010100;
+constexpr uint32_t XEX_HEADER_IMPORT_LIBRARIES = 0x000103FF;
+constexpr uint32_t XEX_HEADER_ORIGINAL_PE_NAME = 0x000183FF;
+constexpr uint32_t XEX_HEADER_DEFAULT_STACK_SIZE = 0x00020200;
+constexpr uint32_t XEX_HEADER_EXECUTION_INFO = 0x00040006;
+
+// Información de seguridad (offsets)
+constexpr uint32_t SECURITY_IMAGE_SIZE = 0x004;
+constexpr uint32_t SECURITY_IMAGE_FLAGS = 0x10C;
+constexpr uint32_t SECURITY_LOAD_ADDRESS = 0x110;
+constexpr uint32_t SECURITY_AES_KEY = 0x150;
+constexpr uint32_t SECURITY_MIN_SIZE = 0x184;
+
+// Cada bloque LZX empieza con el tamaño y el SHA-1 del siguiente
+constexpr uint32_t LZX_BLOCK_HEADER_SIZE = 24;
+// Trozo de imagen sin comprimir que descifra cada hilo
+constexpr uint32_t PARALLEL_PART_SIZE = 1 << 20;
+
+struct OptionalHeader {
+	uint32_t key = 0;
+	uint32_t value = 0;
+};
+
+const OptionalHeader* FindHeader(const std::vector<OptionalHeader>& headers, uint32_t key) {
+	for (const OptionalHeader& h : headers)
+		if (h.key == key) return &h;
+	return nullptr;
+}
+
+// Datos de una cabecera opcional que apunta a otra parte del fichero: offset y tamaño
+std::pair<uint32_t, uint32_t> HeaderData(const MappedFile& file, const OptionalHeader& h) {
+	const uint32_t size = (h.key & 0xFF) == 0xFF ? LoadBE32(file.At(h.value, 4)) : (h.key & 0xFF) * 4;
+	file.At(h.value, size);
+	return { h.value, size };
+}
+
+void ParseImports(const MappedFile& file, uint32_t offset, uint32_t size, XexModule& module) {
+	// {tamaño, tamaño de la tabla de cadenas, número de cadenas, cadenas (alineadas a 4), bibliotecas}
+	if (size < 12) throw std::runtime_error("XEX: import header too small");
+	const uint8_t* p = file.At(offset, size);
+	const uint32_t stringsSize = LoadBE32(p + 4);
+	const uint32_t stringCount = LoadBE32(p + 8);
+	if (12ull + stringsSize > size) throw std::runtime_error("XEX: import string table out of bounds");
+
+	std::vector<std::string> names;
+	for (uint32_t pos = 0; names.size() < stringCount && pos < stringsSize;) {
+		const char* s = reinterpret_cast<const char*>(p + 12 + pos);
+		const size_t len = strnlen(s, stringsSize - pos);
+		names.emplace_back(s, len);
+		pos += uint32_t((len + 1 + 3) & ~size_t(3));
 	}
 
-	// Leer encabezado
-	XEXHeader header;
-	file.read(reinterpret_cast<char*>(&header), sizeof(XEXHeader));
-	if (std::string(header.magic, 4) != "XEX2") {
-		std::cerr << "Error: No es un archivo XEX válido" << std::endl;
-		throw std::runtime_error("Formato XEX inválido");
+	for (uint32_t pos = 12 + stringsSize; pos + 0x28 <= size;) {
+		const uint8_t* lib = p + pos;
+		const uint32_t libSize = LoadBE32(lib);
+		const uint16_t nameIndex = LoadBE16(lib + 0x24);
+		const uint16_t count = LoadBE16(lib + 0x26);
+		if (libSize < 0x28 || libSize > size - pos || 0x28ull + count * 4ull > libSize)
+			throw std::runtime_error("XEX: import library out of bounds");
+		XexImportLibrary import;
+		import.name = nameIndex < names.size() ? names[nameIndex] : "?";
+		import.version = LoadBE32(lib + 0x1C);
+		import.versionMin = LoadBE32(lib + 0x20);
+		for (uint16_t i = 0; i < count; ++i) import.records.push_back(LoadBE32(lib + 0x28 + 4 * i));
+		module.imports.push_back(std::move(import));
+		pos += libSize;
 	}
+}
 
-	// Leer secciones
-	std::vector<XEXSection> sections(header.section_count);
-	file.seekg(header.code_offset);
-	file.read(reinterpret_cast<char*>(sections.data()), header.section_count * sizeof(XEXSection));
-
-	// Cargar secciones
-	for (const auto& section : sections) {
-		std::vector<u8> buffer(section.file_size);
-		file.seekg(section.file_offset);
-		file.read(reinterpret_cast<char*>(buffer.data()), section.file_size);
-		mmu.Write(section.virtual_address, buffer.data(), buffer.size());
-		std::cout << "Cargada sección en 0x" << std::hex << section.virtual_address
-			<< ", tamaño: 0x" << section.virtual_size << std::endl;
+// 16 bytes en binario o 32 dígitos hexadecimales (se ignoran los espacios)
+void ReadKeyFile(const std::string& path, uint8_t key[16]) {
+	std::ifstream f(path, std::ios::binary);
+	if (!f) throw std::runtime_error("Cannot open key file: " + path);
+	const std::string data{ std::istreambuf_iterator<char>(f), {} };
+	if (data.size() == 16) {
+		std::memcpy(key, data.data(), 16);
+		return;
 	}
+	std::string hex;
+	for (char c : data)
+		if (!std::isspace(static_cast<unsigned char>(c))) hex += c;
+	if (hex.size() != 32 || hex.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+		throw std::runtime_error("Key file " + path + ": expected 16 bytes or 32 hex digits");
+	for (int i = 0; i < 16; ++i) key[i] = uint8_t(std::stoul(hex.substr(2 * i, 2), nullptr, 16));
+}
 
-	file.close();
+// Con la clave de imagen correcta el primer bloque descifrado tiene sentido: la cabecera MZ del PE
+// (sin comprimir y basic) o una cadena de chunks que termina dentro del bloque (LZX)
+bool PlausibleKey(const MappedFile& file, const XexModule& module, const Aes128Decryptor& aes) {
+	const uint64_t dataSize = file.GetSize() - module.dataOffset;
+	const uint8_t* data = file.GetData() + module.dataOffset;
+	uint8_t iv[16] = {};
+	if (module.compression != XexCompression::Normal) {
+		if (dataSize < 16) return false;
+		uint8_t block[16];
+		aes.DecryptCBC(data, block, 16, iv);
+		return block[0] == 'M' && block[1] == 'Z';
+	}
+	const uint32_t blockSize = LoadBE32(file.GetData() + module.formatOffset + 12);
+	if (blockSize < LZX_BLOCK_HEADER_SIZE + 2 || blockSize % 16 || blockSize > dataSize) return false;
+	std::vector<uint8_t> block(blockSize);
+	aes.DecryptCBC(data, block.data(), blockSize, iv);
+	for (uint32_t pos = LZX_BLOCK_HEADER_SIZE; pos + 2 <= blockSize;) {
+		const uint32_t chunk = LoadBE16(&block[pos]);
+		if (!chunk) return true;
+		pos += 2 + chunk;
+	}
+	return false;
+}
 
-	// Log de la primera instrucción en el punto de entrada
-	try {
-		u32 first_instr = mmu.Read32(sections[0].virtual_address);
-		std::cout << "Primera instrucción en 0x" << std::hex << sections[0].virtual_address
-			<< ": 0x" << first_instr << std::endl;
+std::unique_ptr<Aes128Decryptor> ImageKey(const MappedFile& file, const XexModule& module, const XexLoadOptions& options) {
+	if (options.keyFiles.empty())
+		throw std::runtime_error("XEX: image is encrypted, a console key file is needed (--xex-key)");
+	for (const std::string& path : options.keyFiles) {
+		uint8_t consoleKey[16], imageKey[16];
+		ReadKeyFile(path, consoleKey);
+		Aes128Decryptor(consoleKey).DecryptBlock(module.encryptedKey, imageKey);
+		auto aes = std::make_unique<Aes128Decryptor>(imageKey);
+		if (PlausibleKey(file, module, *aes)) {
+			LOG_INFO("Loader", "XEX: image key decrypted with %s%s", path.c_str(), Aes128Decryptor::HasHardwareSupport() ? " (AES-NI)" : "");
+			return aes;
+		}
 	}
-	catch (const std::exception& e) {
-		std::cerr << "Error al leer la primera instrucción: " << e.what() << std::endl;
+	throw std::runtime_error("XEX: none of the key files decrypts this image");
+}
+
+// Trozo de la imagen que sale tal cual (descifrado si hace falta) del fichero
+struct CopyTask {
+	uint64_t fileOffset;
+	uint32_t size;
+	uint32_t imageOffset;
+	uint32_t zeroSize; // ceros a continuación (formato basic)
+};
+
+// Sin cifrar es un memcpy por trozo desde la proyección. Cifrado en CBC, cada trozo se descifra por
+// separado (el IV es el bloque cifrado anterior, que está en el fichero), así que se reparten entre
+// hilos; la escritura en la MMU se serializa.
+void RunCopyTasks(const std::vector<CopyTask>& tasks, const MappedFile& file, const XexModule& module, MMU& mmu,
+	const Aes128Decryptor* aes, unsigned threads) {
+	if (!aes) {
+		for (const CopyTask& t : tasks) {
+			if (t.size) mmu.Write(module.baseAddress + t.imageOffset, file.GetData() + t.fileOffset, t.size);
+			if (t.zeroSize) mmu.MemSet(module.baseAddress + t.imageOffset + t.size, 0, t.zeroSize);
+		}
+		return;
 	}
+
+	std::atomic<size_t> next{ 0 };
+	std::mutex mmuMutex;
+	std::exception_ptr error;
+	auto worker = [&]() {
+		std::vector<uint8_t> buffer;
+		try {
+			for (size_t i; (i = next.fetch_add(1)) < tasks.size();) {
+				const CopyTask& t = tasks[i];
+				uint8_t iv[16] = {};
+				if (t.fileOffset > module.dataOffset) std::memcpy(iv, file.GetData() + t.fileOffset - 16, 16);
+				buffer.resize(t.size);
+				aes->DecryptCBC(file.GetData() + t.fileOffset, buffer.data(), t.size, iv);
+				std::lock_guard<std::mutex> lock(mmuMutex);
+				if (t.size) mmu.Write(module.baseAddress + t.imageOffset, buffer.data(), t.size);
+				if (t.zeroSize) mmu.MemSet(module.baseAddress + t.imageOffset + t.size, 0, t.zeroSize);
+			}
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(mmuMutex);
+			if (!error) error = std::current_exception();
+			next = tasks.size();
+		}
+	};
+	std::vector<std::thread> pool;
+	for (unsigned i = 1; i < (std::min<size_t>)(threads, tasks.size()); ++i) pool.emplace_back(worker);
+	worker();
+	for (std::thread& t : pool) t.join();
+	if (error) std::rethrow_exception(error);
+}
+
+// Formato "normal": cadena de bloques {tamaño y hash del siguiente, chunks {u16 tamaño, datos LZX}, 0}.
+// Los chunks forman un único flujo LZX; cada bloque se descifra (CBC continuo) según se necesita.
+void LoadCompressed(const MappedFile& file, const XexModule& module, MMU& mmu, const Aes128Decryptor* aes) {
+	const uint8_t* format = file.GetData() + module.formatOffset;
+	if (module.formatSize < 16 + 20) throw std::runtime_error("XEX: LZX format header too small");
+	const uint32_t windowSize = LoadBE32(format + 8);
+
+	uint64_t blockOffset = module.dataOffset;
+	uint32_t blockSize = LoadBE32(format + 12);
+	std::vector<uint8_t> decrypted;
+	uint8_t iv[16] = {};
+	const uint8_t* block = nullptr;
+	uint32_t cursor = 0; // dentro del bloque actual
+
+	LzxDecoder lzx(windowSize);
+	lzx.Decompress(module.imageSize,
+		[&](const uint8_t*& data, size_t& size) {
+			for (;;) {
+				if (block) {
+					if (cursor + 2 > blockSize) throw std::runtime_error("XEX: LZX chunk list runs past its block");
+					const uint32_t chunk = LoadBE16(block + cursor);
+					if (chunk) {
+						if (cursor + 2 + chunk > blockSize) throw std::runtime_error("XEX: LZX chunk out of bounds");
+						data = block + cursor + 2;
+						size = chunk;
+						cursor += 2 + chunk;
+						return true;
+					}
+					// Fin de los chunks: el bloque siguiente empieza tras éste
+					blockOffset += blockSize;
+					blockSize = LoadBE32(block);
+					block = nullptr;
+				}
+				if (!blockSize) return false;
+				if (blockSize < LZX_BLOCK_HEADER_SIZE + 2) throw std::runtime_error("XEX: LZX block too small");
+				const uint8_t* src = file.At(blockOffset, blockSize);
+				if (aes) {
+					if (blockSize % 16) throw std::runtime_error("XEX: encrypted LZX block is not a multiple of 16 bytes");
+					decrypted.resize(blockSize);
+					aes->DecryptCBC(src, decrypted.data(), blockSize, iv);
+					src = decrypted.data();
+				}
+				block = src;
+				cursor = LZX_BLOCK_HEADER_SIZE;
+			}
+		},
+		[&, written = uint64_t(0)](const uint8_t* data, size_t size) mutable {
+			mmu.Write(module.baseAddress + written, data, size);
+			written += size;
+		});
+}
+
+// Las funciones importadas son thunks de 16 bytes que saltarían al kernel: sin kernel HLE, se
+// convierten en "li r3,0; blr" (devuelven STATUS_SUCCESS). Las variables quedan sin resolver.
+void StubImports(const XexModule& module, MMU& mmu) {
+	static const uint32_t STUB[] = { 0x38600000, 0x4E800020, 0x60000000, 0x60000000 };
+	for (const XexImportLibrary& lib : module.imports) {
+		uint32_t functions = 0, variables = 0;
+		for (uint32_t record : lib.records) {
+			const uint32_t value = mmu.Read32(record);
+			if ((value >> 24) == 1) {
+				for (int i = 0; i < 4; ++i) mmu.Write32(record + 4 * i, STUB[i]);
+				++functions;
+			}
+			else ++variables;
+		}
+		LOG_INFO("Loader", "XEX import %s %u.%u.%u.%u: %u functions stubbed, %u variables unresolved", lib.name.c_str(),
+			lib.version >> 28, (lib.version >> 24) & 0xF, (lib.version >> 8) & 0xFFFF, lib.version & 0xFF, functions, variables);
+	}
+}
+
+} // namespace
+
+XexModule ParseXEX(const MappedFile& file) {
+	if (file.GetSize() < sizeof(XEXHeader) || std::memcmp(file.GetData(), "XEX2", 4) != 0)
+		throw std::runtime_error("Formato XEX inválido");
+	const XEXHeader& header = file.As<XEXHeader>(0);
+	XexModule module;
+	module.moduleFlags = FromBE(header.module_flags);
+	module.dataOffset = FromBE(header.pe_offset);
+	if (module.dataOffset > file.GetSize()) throw std::runtime_error("XEX: image offset out of bounds");
+
+	const uint32_t headerCount = FromBE(header.header_count);
+	const auto* raw = reinterpret_cast<const XEXOptionalHeader*>(file.At(sizeof(XEXHeader), uint64_t(headerCount) * sizeof(XEXOptionalHeader)));
+	std::vector<OptionalHeader> headers(headerCount);
+	for (uint32_t i = 0; i < headerCount; ++i) headers[i] = { FromBE(raw[i].key), FromBE(raw[i].value) };
+
+	// Información de seguridad
+	const uint8_t* security = file.At(FromBE(header.security_offset), SECURITY_MIN_SIZE);
+	module.imageSize = LoadBE32(security + SECURITY_IMAGE_SIZE);
+	module.imageFlags = LoadBE32(security + SECURITY_IMAGE_FLAGS);
+	module.baseAddress = LoadBE32(security + SECURITY_LOAD_ADDRESS);
+	std::memcpy(module.encryptedKey, security + SECURITY_AES_KEY, 16);
+
+	// Formato de la imagen: {tamaño, cifrado, compresión, datos del formato}
+	const OptionalHeader* format = FindHeader(headers, XEX_HEADER_FILE_FORMAT_INFO);
+	if (!format) throw std::runtime_error("XEX: missing file format header");
+	std::tie(module.formatOffset, module.formatSize) = HeaderData(file, *format);
+	if (module.formatSize < 8) throw std::runtime_error("XEX: file format header too small");
+	module.encryption = XexEncryption(LoadBE16(file.GetData() + module.formatOffset + 4));
+	module.compression = XexCompression(LoadBE16(file.GetData() + module.formatOffset + 6));
+
+	if (const OptionalHeader* h = FindHeader(headers, XEX_HEADER_IMAGE_BASE_ADDRESS)) module.baseAddress = h->value;
+	if (const OptionalHeader* h = FindHeader(headers, XEX_HEADER_ENTRY_POINT)) module.entryPoint = h->value;
+	else throw std::runtime_error("XEX: missing entry point");
+	if (const OptionalHeader* h = FindHeader(headers, XEX_HEADER_DEFAULT_STACK_SIZE)) module.stackSize = h->value;
+	if (const OptionalHeader* h = FindHeader(headers, XEX_HEADER_EXECUTION_INFO)) {
+		const auto data = HeaderData(file, *h);
+		if (data.second >= 16) module.titleId = LoadBE32(file.GetData() + data.first + 12);
+	}
+	if (const OptionalHeader* h = FindHeader(headers, XEX_HEADER_ORIGINAL_PE_NAME)) {
+		const auto data = HeaderData(file, *h);
+		const char* name = reinterpret_cast<const char*>(file.GetData() + data.first + 4);
+		if (data.second > 4) module.originalName.assign(name, strnlen(name, data.second - 4));
+	}
+	if (const OptionalHeader* h = FindHeader(headers, XEX_HEADER_IMPORT_LIBRARIES)) {
+		const auto data = HeaderData(file, *h);
+		ParseImports(file, data.first, data.second, module);
+	}
+
+	if (!module.imageSize || uint64_t(module.baseAddress) + module.imageSize > 0x100000000ull)
+		throw std::runtime_error("XEX: invalid image size or base address");
+	if (module.entryPoint < module.baseAddress || module.entryPoint >= module.baseAddress + module.imageSize)
+		throw std::runtime_error("XEX: entry point outside the image");
+	return module;
+}
+
+void LoadXEXImage(const MappedFile& file, const XexModule& module, MMU& mmu, const XexLoadOptions& options) {
+	const auto start = std::chrono::steady_clock::now();
+	std::unique_ptr<Aes128Decryptor> aes;
+	if (module.encryption == XexEncryption::Normal) aes = ImageKey(file, module, options);
+	else if (module.encryption != XexEncryption::None) throw std::runtime_error("XEX: unknown encryption type");
+	const unsigned threads = options.threads ? options.threads : (std::max)(1u, std::thread::hardware_concurrency());
+
+	const uint64_t dataSize = file.GetSize() - module.dataOffset;
+	std::vector<CopyTask> tasks;
+	uint32_t written = 0; // bytes de imagen que deja el formato; el resto se pone a cero
+	switch (module.compression) {
+	case XexCompression::None: {
+		written = uint32_t((std::min<uint64_t>)(module.imageSize, dataSize));
+		if (aes) written &= ~15u;
+		for (uint32_t off = 0; off < written; off += PARALLEL_PART_SIZE)
+			tasks.push_back({ module.dataOffset + uint64_t(off), (std::min)(PARALLEL_PART_SIZE, written - off), off, 0 });
+		break;
+	}
+	case XexCompression::Basic: {
+		// {tamaño de datos, ceros a continuación} por bloque, los datos seguidos en el fichero
+		const uint8_t* blocks = file.GetData() + module.formatOffset + 8;
+		uint64_t in = module.dataOffset;
+		for (uint32_t i = 0; i < (module.formatSize - 8) / 8; ++i) {
+			const uint32_t dataBytes = LoadBE32(blocks + 8 * i), zeroBytes = LoadBE32(blocks + 8 * i + 4);
+			if (aes && dataBytes % 16) throw std::runtime_error("XEX: encrypted basic block is not a multiple of 16 bytes");
+			if (uint64_t(written) + dataBytes + zeroBytes > module.imageSize) throw std::runtime_error("XEX: basic blocks overflow the image");
+			file.At(in, dataBytes);
+			tasks.push_back({ in, dataBytes, written, zeroBytes });
+			in += dataBytes;
+			written += dataBytes + zeroBytes;
+		}
+		break;
+	}
+	case XexCompression::Normal:
+		LoadCompressed(file, module, mmu, aes.get());
+		written = module.imageSize;
+		break;
+	default:
+		throw std::runtime_error("XEX: unsupported compression type " + std::to_string(unsigned(module.compression)));
+	}
+	RunCopyTasks(tasks, file, module, mmu, aes.get(), threads);
+	if (written < module.imageSize) mmu.MemSet(module.baseAddress + written, 0, module.imageSize - written);
+
+	if (mmu.Read8(module.baseAddress) != 'M' || mmu.Read8(module.baseAddress + 1) != 'Z')
+		LOG_WARNING("Loader", "XEX: image at 0x%08X does not start with a PE header", module.baseAddress);
+	StubImports(module, mmu);
+
+	static const char* const COMPRESSION[] = { "uncompressed", "basic", "LZX", "delta" };
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	LOG_INFO("Loader", "XEX %s: %s%s, 0x%08X-0x%08X, entry 0x%08X, title %08X, %.1f ms (%u threads)",
+		module.originalName.empty() ? file.GetPath().c_str() : module.originalName.c_str(),
+		COMPRESSION[unsigned(module.compression) & 3], aes ? ", encrypted" : "", module.baseAddress,
+		module.baseAddress + module.imageSize, module.entryPoint, module.titleId, seconds * 1e3,
+		aes && !tasks.empty() ? unsigned((std::min<size_t>)(threads, tasks.size())) : 1u);
+}
+
+XexModule LoadXEX(const std::string& filename, MMU& mmu, const XexLoadOptions& options) {
+	const MappedFile file(filename);
+	XexModule module = ParseXEX(file);
+	LoadXEXImage(file, module, mmu, options);
+	return module;
 }
@@ -0,0 +1,59 @@
+// XeXLoader.h
+#pragma once
+#include "MappedFile.h"
+#include "MMU.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Ejecutables XEX2 de Xbox 360: cabecera, cabeceras opcionales, información de seguridad y la
+// imagen PE, que puede ir tal cual, comprimida por bloques ("basic") o con LZX ("normal"), y
+// cifrada o no con AES-128.
+//
+// ParseXEX lee las cabeceras en su sitio, sobre la proyección del fichero. LoadXEXImage deja la
+// imagen en su dirección base: descifra y descomprime bloque a bloque escribiendo directamente en
+// memoria del guest (nunca hay una copia de la imagen entera en el host) y reparte entre hilos los
+// bloques independientes.
+
+enum class XexEncryption : uint16_t { None = 0, Normal = 1 };
+enum class XexCompression : uint16_t { None = 0, Basic = 1, Normal = 2, Delta = 3 };
+
+struct XexImportLibrary {
+    std::string name;              // p.ej. "xboxkrnl.exe"
+    uint32_t version = 0;
+    uint32_t versionMin = 0;
+    std::vector<uint32_t> records; // direcciones de sus registros de importación dentro de la imagen
+};
+
+struct XexModule {
+    uint32_t moduleFlags = 0;
+    uint32_t baseAddress = 0;      // cabecera IMAGE_BASE_ADDRESS o, si no está, la de seguridad
+    uint32_t entryPoint = 0;
+    uint32_t imageSize = 0;
+    uint32_t imageFlags = 0;
+    uint32_t stackSize = 0;        // 0 = no lo fija
+    uint32_t titleId = 0;
+    std::string originalName;      // nombre del PE original, si viene
+    XexEncryption encryption = XexEncryption::None;
+    XexCompression compression = XexCompression::None;
+    uint32_t dataOffset = 0;       // inicio de la imagen (comprimida/cifrada) en el fichero
+    uint32_t formatOffset = 0;     // cabecera de formato: bloques basic, o ventana y primer bloque LZX
+    uint32_t formatSize = 0;
+    uint8_t encryptedKey[16] = {}; // clave de la imagen, cifrada con la de consola
+    std::vector<XexImportLibrary> imports;
+};
+
+struct XexLoadOptions {
+    // Claves AES-128 de consola: ficheros de 16 bytes o con 32 dígitos hexadecimales. Se prueban en
+    // orden hasta que una descifra la imagen.
+    std::vector<std::string> keyFiles;
+    unsigned threads = 0; // 0 = std::thread::hardware_concurrency()
+};
+
+// Lanza std::runtime_error si el fichero no es un XEX2 válido
+XexModule ParseXEX(const MappedFile& file);
+// Imagen a partir de module.baseAddress (tiene que estar mapeada) y las importaciones de funciones
+// sustituidas por "li r3,0; blr", ya que no hay kernel que las resuelva
+void LoadXEXImage(const MappedFile& file, const XexModule& module, MMU& mmu, const XexLoadOptions& options = {});
+// Las dos cosas, desde la ruta
+XexModule LoadXEX(const std::string& filename, MMU& mmu, const XexLoadOptions& options = {});
@@ -2,30 +2,34 @@
 
 #include "XenonReservations.h"
 
-XenonReservations::XenonReservations() {
-  nReservations = 0;
-  nProcessors = 0;
-  Reservations[0] = nullptr;
+#include <thread>
+
+XenonReservations::XenonReservations() : slots_(new std::atomic<uint64_t>[SLOTS]()) {
+}
+
+uint64_t XenonReservations::Acquire(uint64_t address) {
+  std::atomic<uint64_t>& slot = Slot(address >> GRANULE_SHIFT);
+  for (;;) {
+    const uint64_t stamp = slot.load(std::memory_order_acquire);
+    if (!(stamp & 1))
+      return stamp;
+    std::this_thread::yield();
+  }
 }
 
-bool XenonReservations::Register(PPU_RES *Res) {
-  AcquireLock();
-  Reservations[nProcessors] = Res;
-  nProcessors++;
-  ReleaseLock();
-  return true;
+void XenonReservations::Invalidate(uint64_t address, uint64_t size) {
+  const uint64_t first = address >> GRANULE_SHIFT;
+  const uint64_t last = (address + size - 1) >> GRANULE_SHIFT;
+  // Con un sello por entrada basta recorrer la tabla una vez, por grande que sea el rango
+  const uint64_t count = last - first + 1 < SLOTS ? last - first + 1 : SLOTS;
+  for (uint64_t i = 0; i < count; i++)
+    Slot(first + i).fetch_add(2, std::memory_order_release);
 }
 
-void XenonReservations::Scan(uint64_t PhysAddress) {
-  PhysAddress &= ~3;
+bool XenonReservations::Lock(uint64_t address, uint64_t stamp) {
+  return Slot(address >> GRANULE_SHIFT).compare_exchange_strong(stamp, stamp + 1, std::memory_order_acquire);
+}
 
-  AcquireLock();
-  for (int i = 0; i < nProcessors; i++) {
-    // NB: order of checks matters!
-    if ((Reservations[i]->V) && PhysAddress >= Reservations[i]->resAddr) {
-      Reservations[i]->V = false;
-      Decrement();
-    }
-  }
-  ReleaseLock();
+void XenonReservations::Unlock(uint64_t address) {
+  Slot(address >> GRANULE_SHIFT).fetch_add(1, std::memory_order_release);
 }
@@ -2,44 +2,43 @@
 
 #pragma once
 
-#include <mutex>
-#include <vector>
-#include "Tipos.h"
-
-struct PPU_RES {
-  uint8_t ppuID;
-  volatile bool V;
-  volatile uint64_t resAddr;
-};
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 
+// Reservas de lwarx/ldarx de todos los hilos de hardware, sin locks.
+// Cada granulo de reserva (linea de 128 bytes en espacio real: las direcciones que recibe son
+// reales, ver MMU::TrackWrite) tiene un sello en una tabla de atomics:
+//   - lwarx guarda el sello (par) del granulo y el valor leido
+//   - mientras haya alguna reserva viva, cada escritura suma 2 al sello de los granulos que toca
+//   - stwcx. toma el granulo con un CAS del sello (par -> impar), escribe con un CAS del host
+//     contra el valor que leyo lwarx y lo suelta con un sello nuevo
+// Granulos que caen en la misma entrada comparten sello: un stwcx. puede fallar de mas (la
+// arquitectura lo permite), nunca acertar de mas.
 class XenonReservations {
 public:
+  static constexpr uint32_t GRANULE_SHIFT = 7;
+  static constexpr size_t SLOTS = 16384; // potencia de 2
+
   XenonReservations();
-  virtual bool Register(PPU_RES *Res);
-  void Increment(void) {
-    std::lock_guard lck(ReservationLock);
-    nReservations++;
-  }
-  void Decrement(void) {
-    std::lock_guard lck(ReservationLock);
-    nReservations--;
-  }
-  void Check(u64 x) {
-    if (nReservations)
-      Scan(x);
-  }
-  virtual void Scan(u64 PhysAddress);
-
-  void AcquireLock(void) {
-    ReservationLock.lock();
-  }
-  void ReleaseLock(void) {
-    ReservationLock.unlock();
-  }
+
+  // Hay algun hilo con una reserva viva. Si no, las escrituras no tocan la tabla.
+  bool Active() const { return active_.load(std::memory_order_relaxed) != 0; }
+  void AddReserver() { active_.fetch_add(1, std::memory_order_relaxed); }
+  void RemoveReserver() { active_.fetch_sub(1, std::memory_order_relaxed); }
+
+  // Sello del granulo de address; espera mientras haya un stwcx. en curso sobre el
+  uint64_t Acquire(uint64_t address);
+  // Rompe las reservas sobre los granulos de [address, address + size)
+  void Invalidate(uint64_t address, uint64_t size);
+  // stwcx.: toma el granulo si su sello sigue siendo stamp. Unlock lo suelta con un sello nuevo.
+  bool Lock(uint64_t address, uint64_t stamp);
+  void Unlock(uint64_t address);
 
 private:
-  long nReservations;
-  std::recursive_mutex ReservationLock;
-  int nProcessors;
-  struct PPU_RES *Reservations[6];
+  std::atomic<uint64_t>& Slot(uint64_t granule) { return slots_[granule & (SLOTS - 1)]; }
+
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  std::atomic<int> active_{0};
 };
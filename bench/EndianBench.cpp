@@ -0,0 +1,101 @@
+// EndianBench.cpp: coste por acceso de las lecturas/escrituras big-endian
+//
+//   endian_bench [iterations]
+//
+// Compara, sobre el mismo patrón de direcciones (aleatorio, alineado, dentro de L2):
+//   shifts   composición byte a byte, como hacían Memory/MMU antes de Endian.h
+//   native   memcpy sin swap (cota inferior: lo que cuesta la carga en sí)
+//   Endian.h LoadBE/StoreBE (memcpy + bswap)
+//   Memory   Memory::Read32/Write32 (comprobaciones de límites + alineación)
+//   MMU      MMU::Read32/Write32 con el TLB caliente (camino rápido sobre RAM)
+#include "Endian.h"
+#include "MMU.h"
+#include "Memory.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr size_t BUFFER_SIZE = 256 * 1024;
+constexpr size_t ACCESSES = 1 << 16;
+
+uint32_t ShiftLoad32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+uint64_t ShiftLoad64(const uint8_t* p) {
+    return (uint64_t(ShiftLoad32(p)) << 32) | ShiftLoad32(p + 4);
+}
+void ShiftStore32(uint8_t* p, uint32_t v) {
+    p[0] = uint8_t(v >> 24); p[1] = uint8_t(v >> 16); p[2] = uint8_t(v >> 8); p[3] = uint8_t(v);
+}
+uint32_t NativeLoad32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+uint64_t NativeLoad64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+void NativeStore32(uint8_t* p, uint32_t v) { std::memcpy(p, &v, 4); }
+
+// El resultado se acumula en un volatile para que el compilador no elimine los accesos
+volatile uint64_t g_sink;
+
+template <typename Body>
+void Run(const char* name, int iterations, Body body) {
+    body(); // calentamiento (caché, TLB)
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for (int i = 0; i < iterations; ++i) sum += body();
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    g_sink = sum;
+    printf("  %-22s %6.2f ns/access\n", name, ns / (double(iterations) * ACCESSES));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? atoi(argv[1]) : 200;
+
+    std::mt19937_64 rng(1234);
+    std::vector<uint8_t> buffer(BUFFER_SIZE);
+    for (auto& b : buffer) b = uint8_t(rng());
+    std::vector<uint32_t> offsets(ACCESSES);
+    for (auto& o : offsets) o = uint32_t(rng() % (BUFFER_SIZE / 8)) * 8;
+
+    auto ram = std::make_shared<Memory>("RAM", BUFFER_SIZE);
+    ram->Write(0, buffer.data(), buffer.size());
+    MMU mmu;
+    mmu.MapMemory(ram, 0x80000000, 0x80000000 + BUFFER_SIZE, 0, true, true, true);
+
+    const uint8_t* base = buffer.data();
+    uint8_t* wbase = buffer.data();
+
+    printf("Read32 (%zu accesses x %d):\n", ACCESSES, iterations);
+    Run("shifts", iterations, [&] { uint64_t s = 0; for (uint32_t o : offsets) s += ShiftLoad32(base + o); return s; });
+    Run("native (no swap)", iterations, [&] { uint64_t s = 0; for (uint32_t o : offsets) s += NativeLoad32(base + o); return s; });
+    Run("Endian.h LoadBE32", iterations, [&] { uint64_t s = 0; for (uint32_t o : offsets) s += LoadBE32(base + o); return s; });
+    Run("Memory::Read32", iterations, [&] { uint64_t s = 0; for (uint32_t o : offsets) s += ram->Read32(o); return s; });
+    Run("MMU::Read32", iterations, [&] { uint64_t s = 0; for (uint32_t o : offsets) s += mmu.Read32(0x80000000 + o); return s; });
+
+    printf("Read64:\n");
+    Run("shifts", iterations, [&] { uint64_t s = 0; for (uint32_t o : offsets) s += ShiftLoad64(base + o); return s; });
+    Run("native (no swap)", iterations, [&] { uint64_t s = 0; for (uint32_t o : offsets) s += NativeLoad64(base + o); return s; });
+    Run("Endian.h LoadBE64", iterations, [&] { uint64_t s = 0; for (uint32_t o : offsets) s += LoadBE64(base + o); return s; });
+    Run("Memory::Read64", iterations, [&] { uint64_t s = 0; for (uint32_t o : offsets) s += ram->Read64(o); return s; });
+    Run("MMU::Read64", iterations, [&] { uint64_t s = 0; for (uint32_t o : offsets) s += mmu.Read64(0x80000000 + o); return s; });
+
+    printf("Write32:\n");
+    Run("shifts", iterations, [&] { uint32_t v = 0; for (uint32_t o : offsets) ShiftStore32(wbase + o, v++); return uint64_t(v); });
+    Run("native (no swap)", iterations, [&] { uint32_t v = 0; for (uint32_t o : offsets) NativeStore32(wbase + o, v++); return uint64_t(v); });
+    Run("Endian.h StoreBE32", iterations, [&] { uint32_t v = 0; for (uint32_t o : offsets) StoreBE32(wbase + o, v++); return uint64_t(v); });
+    Run("Memory::Write32", iterations, [&] { uint32_t v = 0; for (uint32_t o : offsets) ram->Write32(o, v++); return uint64_t(v); });
+    Run("MMU::Write32", iterations, [&] { uint32_t v = 0; for (uint32_t o : offsets) mmu.Write32(0x80000000 + o, v++); return uint64_t(v); });
+
+    // Comprobación: las tres variantes deben leer el mismo valor
+    for (uint32_t o : offsets) {
+        if (ShiftLoad64(base + o) != LoadBE64(base + o) || ByteSwap64(NativeLoad64(base + o)) != LoadBE64(base + o)) {
+            fprintf(stderr, "mismatch at offset 0x%X\n", o);
+            return 1;
+        }
+    }
+    return 0;
+}
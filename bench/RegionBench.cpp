@@ -0,0 +1,129 @@
+// RegionBench.cpp: mapa de regiones de la MMU con cientos de ventanas MMIO
+//
+//   region_bench [windows] [iterations]
+//
+// Mapea RAM y windows ventanas MMIO de 4 KiB separadas 64 KiB a partir de 0x200_0000_0000 (la
+// zona de dispositivos del SoC de la Xenon: PCI, bridge, puertos...) y mide:
+//   map      MapMemory de todas las ventanas, en orden aleatorio
+//   lookup   lecturas MMIO en ventanas al azar; las ventanas comparten pocas entradas del TLB,
+//            así que casi todas las lecturas buscan la región (RefillTLB -> FindRegion)
+//   linear   la misma búsqueda recorriendo GetRegions() de principio a fin (como antes del mapa
+//            ordenado), como referencia
+//   remap    RemapMemory sobre la mitad de las ventanas
+// Comprueba también que MapMemory rechaza solapes y que cada ventana responde con su índice.
+#include "MMU.h"
+#include "Memory.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t WINDOW_BASE = 0x20000000000ull;
+constexpr uint64_t WINDOW_SIZE = 0x1000;
+constexpr uint64_t WINDOW_STRIDE = 0x10000;
+constexpr size_t ACCESSES = 1 << 16;
+
+// Registros de una ventana MMIO: cada lectura devuelve el índice de la ventana
+class Window : public MemoryDevice {
+public:
+    explicit Window(uint32_t index) : MemoryDevice("MMIO" + std::to_string(index)), index_(index) {}
+    void Read(uint64_t, void* data, size_t size) override { std::memset(data, int(index_), size); }
+    void Write(uint64_t, const void*, size_t) override {}
+    void MemSet(uint64_t, uint8_t, size_t) override {}
+    uint32_t Read32(uint64_t) override { return index_; }
+    uint64_t Read64(uint64_t) override { return index_; }
+    void Write32(uint64_t, uint32_t) override {}
+    void Write64(uint64_t, uint64_t) override {}
+    uint8_t* GetPointerToAddress(uint64_t) override { return nullptr; }
+    uint64_t GetSize() const override { return WINDOW_SIZE; }
+
+private:
+    uint32_t index_;
+};
+
+double Nanoseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// El resultado se acumula en un volatile para que el compilador no elimine las búsquedas
+volatile uint64_t g_sink;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const uint32_t windows = argc > 1 ? uint32_t(atoi(argv[1])) : 512;
+    const int iterations = argc > 2 ? atoi(argv[2]) : 20;
+
+    std::vector<std::shared_ptr<Window>> devices;
+    for (uint32_t i = 0; i < windows; ++i) devices.push_back(std::make_shared<Window>(i));
+    std::mt19937_64 rng(1234);
+    std::vector<uint32_t> order(windows);
+    for (uint32_t i = 0; i < windows; ++i) order[i] = i;
+    std::shuffle(order.begin(), order.end(), rng);
+
+    MMU mmu;
+    auto ram = std::make_shared<Memory>("RAM", 0x100000);
+    mmu.MapMemory(ram, 0x80000000, 0x80000000 + ram->GetSize(), 0, true, true, true);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i : order)
+        mmu.MapMemory(devices[i], WINDOW_BASE + i * WINDOW_STRIDE, WINDOW_BASE + i * WINDOW_STRIDE + WINDOW_SIZE, 0, true, true, false);
+    const double mapNs = Nanoseconds(start);
+
+    bool ok = mmu.GetRegionCount() == size_t(windows) + 1;
+    try {
+        mmu.MapMemory(ram, WINDOW_BASE + WINDOW_SIZE / 2, WINDOW_BASE + WINDOW_STRIDE, 0, true, true, false);
+        ok = false;
+    } catch (const std::runtime_error&) {
+    }
+
+    std::vector<uint32_t> targets(ACCESSES);
+    for (auto& t : targets) t = uint32_t(rng() % windows);
+    auto address = [](uint32_t window) { return WINDOW_BASE + window * WINDOW_STRIDE + 8; };
+    for (uint32_t t : targets) ok = ok && mmu.Read32(address(t)) == t;
+
+    start = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for (int i = 0; i < iterations; ++i)
+        for (uint32_t t : targets) sum += mmu.Read32(address(t));
+    const double lookupNs = Nanoseconds(start);
+
+    start = std::chrono::steady_clock::now();
+    const std::vector<MemoryRegion>& regions = mmu.GetRegions();
+    for (int i = 0; i < iterations; ++i) {
+        for (uint32_t t : targets) {
+            const uint64_t addr = address(t);
+            for (const MemoryRegion& region : regions) {
+                if (addr >= region.virtual_start && addr < region.virtual_end) { sum += region.device->Read32(addr - region.virtual_start); break; }
+            }
+        }
+    }
+    const double linearNs = Nanoseconds(start);
+    g_sink = sum;
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < windows; i += 2) {
+        const uint32_t other = (i + 1) % windows;
+        mmu.RemapMemory(devices[other], WINDOW_BASE + i * WINDOW_STRIDE, WINDOW_BASE + i * WINDOW_STRIDE + WINDOW_SIZE, 0, true, true, false);
+    }
+    const double remapNs = Nanoseconds(start);
+    for (uint32_t i = 0; i < windows; ++i)
+        ok = ok && mmu.Read32(address(i)) == (i % 2 ? i : (i + 1) % windows);
+    ok = ok && mmu.GetRegionCount() == size_t(windows) + 1;
+
+    const double accesses = double(iterations) * ACCESSES;
+    printf("%u MMIO windows + RAM:\n", windows);
+    printf("  map      %8.1f ns/region\n", mapNs / windows);
+    printf("  lookup   %8.1f ns/access (MMU::Read32, TLB miss + FindRegion)\n", lookupNs / accesses);
+    printf("  linear   %8.1f ns/access (linear scan over GetRegions, reference)\n", linearNs / accesses);
+    printf("  remap    %8.1f ns/region\n", remapNs / ((windows + 1) / 2));
+    printf("  %s\n", ok ? "ok" : "MISMATCH");
+    return ok ? 0 : 1;
+}
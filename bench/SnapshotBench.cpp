@@ -0,0 +1,79 @@
+// SnapshotBench.cpp: guardar y restaurar una RAM de 512 MB con Snapshot.h
+//
+//   snapshot_bench [file] [threads]
+//
+// Escribe toda la RAM con dos patrones y mide SnapshotWriter/SnapshotReader en cada uno:
+//   code     palabras de instrucciones repetitivas (LZ4 comprime ~8:1)
+//   random   bytes con poca redundancia (las muestras fallan y los lotes se guardan sin comprimir)
+// Una de cada 8 páginas queda a cero (no se guarda). Antes de restaurar se escriben páginas fuera
+// del snapshot, que la restauración tiene que devolver a cero; al final se compara toda la RAM.
+#include "MMU.h"
+#include "Memory.h"
+#include "Snapshot.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+double Milliseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Fill>
+bool Measure(const char* name, const std::string& path, unsigned threads, Fill fill) {
+    MMU mmu;
+    CPU cpu(&mmu);
+    auto ram = std::make_shared<Memory>("RAM");
+    mmu.MapMemory(ram, 0x80000000, 0x80000000 + ram->GetSize(), 0, true, true, true);
+    for (uint64_t offset = 0; offset < ram->GetSize(); offset += 8) {
+        if ((offset >> MemoryDevice::DIRTY_PAGE_SHIFT) % 8 == 7) continue;
+        ram->Write64(offset, fill(offset));
+    }
+    const std::vector<uint8_t> reference(ram->GetPointerToAddress(0), ram->GetPointerToAddress(0) + ram->GetSize());
+
+    auto start = std::chrono::steady_clock::now();
+    SnapshotWriter writer(path, threads);
+    writer.WriteCPU(cpu);
+    writer.WriteDevice(*ram);
+    writer.WriteRegions(mmu);
+    writer.Finish();
+    const double saveMs = Milliseconds(start);
+
+    for (uint64_t page = 7; page < 4096; page += 8)
+        ram->MemSet(page << MemoryDevice::DIRTY_PAGE_SHIFT, 0xCC, MemoryDevice::DIRTY_PAGE_SIZE);
+
+    start = std::chrono::steady_clock::now();
+    const SnapshotReader reader(path, threads);
+    const SnapshotReader::DeviceList devices{ ram };
+    reader.RestoreDevices(devices);
+    reader.RestoreCPU(0, cpu);
+    reader.RestoreRegions(mmu, devices);
+    const double restoreMs = Milliseconds(start);
+
+    const bool same = std::memcmp(reference.data(), ram->GetPointerToAddress(0), reference.size()) == 0;
+    printf("  %-8s %7.1f MB file  save %7.1f ms  restore %7.1f ms  %s\n", name, writer.GetBytesWritten() / 1048576.0,
+        saveMs, restoreMs, same ? "ok" : "MISMATCH");
+    return same;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string path = argc > 1 ? argv[1] : "snapshot_bench.snap";
+    const unsigned threads = argc > 2 ? unsigned(atoi(argv[2])) : 0;
+
+    printf("512 MB RAM, %s:\n", path.c_str());
+    bool ok = Measure("code", path, threads, [](uint64_t offset) {
+        return ((offset >> 6) * 0x9E3779B1ull & 0xFFFF000000ull) | 0x38600000ull;
+    });
+    std::mt19937_64 rng(1234);
+    ok = Measure("random", path, threads, [&](uint64_t) { return rng() & 0x00FF00FF0000FFFFull; }) && ok;
+    std::remove(path.c_str());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+// VMXBench.cpp: comprobación y coste de las implementaciones SSE4.1/AVX2 de VMXKernels
+//
+//   vmx_bench [iterations]
+//
+// Primero ejecuta cada operación de cada nivel soportado por el host sobre los mismos operandos
+// (aleatorios, mezclados con valores límite: NaN con y sin señal, ±0, ±inf, denormales, los
+// extremos de cada ancho entero) y compara carril a carril, junto con el flag de saturación, con
+// la versión escalar. También la ejecuta con el destino igual a vA, como hace el intérprete con
+// "vaddfp v1,v1,v2". Cualquier diferencia se imprime y el programa termina con código 1.
+//
+// Después mide ns/operación de la escalar y de cada nivel en las operaciones que ese nivel
+// implementa por sí mismo.
+#include "VMXKernels.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr size_t CASES = 4096;
+
+struct Case {
+    VectorRegister a, b, c;
+    uint32_t imm;
+};
+
+// Palabras de 32 bits que suelen romper las implementaciones vectoriales
+const uint32_t SPECIAL_WORDS[] = {
+    0x00000000, 0x80000000, 0x7FFFFFFF, 0xFFFFFFFF, 0x00000001,
+    0x7FC00000, 0xFFC00000, 0x7F800001, 0xFF812345, 0x7FA00000, // NaN silenciosos y con señal
+    0x7F800000, 0xFF800000, 0x00000003, 0x807FFFFF, 0x00800000, // ±inf, denormales, mínimo normal
+    0x3F800000, 0xBF800000, 0x3F000000, 0xBF000000, 0x3FC00000, // ±1, ±0.5, 1.5
+    0x4F000000, 0xCF000000, 0x4F800000, 0x4EFFFFFF, 0xBF7FFFFF, // ±2^31, 2^32, bajo 2^31, bajo -1
+    0x00007FFF, 0x00008000, 0x0000FFFF, 0x7FFF8000, 0x80007FFF,
+    0x7F807F80, 0x80FF7F00, 0xFF00FF00, 0x00FF00FF, 0x01010101,
+};
+
+uint32_t RandomWord(std::mt19937_64& rng) {
+    switch (rng() % 4) {
+    case 0: return SPECIAL_WORDS[rng() % (sizeof(SPECIAL_WORDS) / sizeof(SPECIAL_WORDS[0]))];
+    case 1: { // float "normal" en un rango razonable
+        std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+        float f = dist(rng);
+        uint32_t u;
+        std::memcpy(&u, &f, 4);
+        return u;
+    }
+    default: return uint32_t(rng());
+    }
+}
+
+VectorRegister RandomVector(std::mt19937_64& rng) {
+    VectorRegister v;
+    for (auto& w : v.u32) w = RandomWord(rng);
+    return v;
+}
+
+void PrintVector(const char* label, const VectorRegister& v) {
+    printf("    %s %08X %08X %08X %08X\n", label, v.Word(0), v.Word(1), v.Word(2), v.Word(3));
+}
+
+// Devuelve el número de casos que no coinciden con la escalar
+int Verify(const VMXKernelTable& table, const VMXKernelTable& reference, const std::vector<Case>& cases) {
+    int failures = 0;
+    for (int op = 0; op < VMX_OP_COUNT; ++op) {
+        if (table.kernels[op] == reference.kernels[op]) continue;
+        int opFailures = 0;
+        for (const Case& t : cases) {
+            VectorRegister expected, actual;
+            const bool expectedSat = reference.kernels[op](expected, t.a, t.b, t.c, t.imm);
+            const bool actualSat = table.kernels[op](actual, t.a, t.b, t.c, t.imm);
+            VectorRegister inPlace = t.a;
+            const bool inPlaceSat = table.kernels[op](inPlace, inPlace, t.b, t.c, t.imm);
+            const bool ok = !std::memcmp(&expected, &actual, 16) && !std::memcmp(&expected, &inPlace, 16)
+                && expectedSat == actualSat && expectedSat == inPlaceSat;
+            if (ok) continue;
+            if (opFailures++ < 3) {
+                printf("  MISMATCH %s/%s imm=%u sat=%d/%d\n", VMXIsaName(table.isa), VMXOpName(VMXOp(op)), t.imm, expectedSat, actualSat);
+                PrintVector("a  ", t.a);
+                PrintVector("b  ", t.b);
+                PrintVector("c  ", t.c);
+                PrintVector("ref", expected);
+                PrintVector("got", actual);
+            }
+        }
+        failures += opFailures;
+    }
+    return failures;
+}
+
+// El resultado se acumula en un volatile para que el compilador no elimine las llamadas
+volatile uint32_t g_sink;
+
+double Time(VMXKernel kernel, int iterations, const std::vector<Case>& cases) {
+    VectorRegister d{};
+    uint32_t sum = 0;
+    for (const Case& t : cases) sum += kernel(d, t.a, t.b, t.c, t.imm); // calentamiento
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        for (const Case& t : cases) {
+            sum += kernel(d, t.a, t.b, t.c, t.imm);
+            sum += d.u32[0];
+        }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    g_sink = sum;
+    return ns / (double(iterations) * cases.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? atoi(argv[1]) : 50;
+
+    std::mt19937_64 rng(1234);
+    std::vector<Case> cases(CASES);
+    for (Case& t : cases) {
+        t.a = RandomVector(rng);
+        t.b = RandomVector(rng);
+        t.c = RandomVector(rng);
+        t.imm = uint32_t(rng() & 0xFF);
+    }
+
+    const VMXKernelTable& scalar = VMXKernelsFor(VMXIsa::Scalar);
+    std::vector<VMXIsa> tiers;
+    for (VMXIsa isa : { VMXIsa::SSE41, VMXIsa::AVX2 }) {
+        if (VMXIsaSupported(isa)) tiers.push_back(isa);
+        else printf("%s: not supported by this host\n", VMXIsaName(isa));
+    }
+
+    int failures = 0;
+    for (VMXIsa isa : tiers) {
+        const int n = Verify(VMXKernelsFor(isa), scalar, cases);
+        printf("%s: %s (%zu cases per op)\n", VMXIsaName(isa), n ? "MISMATCH" : "matches scalar", CASES);
+        failures += n;
+    }
+
+    for (VMXIsa isa : tiers) {
+        const VMXKernelTable& table = VMXKernelsFor(isa);
+        printf("%s vs scalar (%zu ops x %d):\n", VMXIsaName(isa), CASES, iterations);
+        for (int op = 0; op < VMX_OP_COUNT; ++op) {
+            if (!table.native[op]) continue;
+            const double base = Time(scalar.kernels[op], iterations, cases);
+            const double fast = Time(table.kernels[op], iterations, cases);
+            printf("  %-12s %6.2f -> %6.2f ns/op  x%.1f\n", VMXOpName(VMXOp(op)), base, fast, base / fast);
+        }
+    }
+    return failures ? 1 : 0;
+}